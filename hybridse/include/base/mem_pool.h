@@ -18,8 +18,12 @@
 #define INCLUDE_BASE_MEM_POOL_H_
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <list>
+#include <new>
 #include <thread>  //NOLINT
+#include <type_traits>
+#include <utility>
 #include "glog/logging.h"
 namespace hybridse {
 namespace base {
@@ -96,6 +100,205 @@ class ByteMemoryPool {
  private:
     MemoryChunk* chucks_;
 };
+
+/// Bump allocator for memory which lives until the next `Reset()`.
+///
+/// Unlike ByteMemoryPool, chunks are rewound and reused after reset, up to
+/// `retain_bytes` of them, and objects constructed by `New()` are destructed
+/// on reset without any per-object heap bookkeeping.
+///
+/// Every `trim_interval` resets, retained chunks are trimmed to the peak bytes
+/// of those resets, so a pool which served one large step does not keep its
+/// chunks forever.
+class ArenaMemoryPool {
+ public:
+    enum {
+        DEFAULT_CHUNK_SIZE = 4096,
+        MAX_CHUNK_SIZE = 1 << 20,
+        DEFAULT_TRIM_INTERVAL = 1024
+    };
+
+    explicit ArenaMemoryPool(size_t retain_bytes = MAX_CHUNK_SIZE,
+                             uint32_t trim_interval = DEFAULT_TRIM_INTERVAL)
+        : retain_bytes_(retain_bytes),
+          trim_interval_(trim_interval),
+          head_(nullptr),
+          current_(nullptr),
+          destructors_(nullptr),
+          allocated_bytes_(0),
+          peak_bytes_(0),
+          reserved_bytes_(0),
+          resets_(0),
+          interval_peak_bytes_(0) {}
+    ~ArenaMemoryPool() {
+        RunDestructors();
+        FreeChunks(head_);
+    }
+    ArenaMemoryPool(const ArenaMemoryPool&) = delete;
+    ArenaMemoryPool& operator=(const ArenaMemoryPool&) = delete;
+
+    char* Alloc(size_t request_size, size_t align = alignof(int64_t)) {
+        while (current_ != nullptr) {
+            char* addr = current_->Alloc(request_size, align);
+            if (addr != nullptr) {
+                allocated_bytes_ += request_size;
+                return addr;
+            }
+            // reuse the next chunk if it is large enough
+            if (current_->next == nullptr ||
+                current_->next->capacity < request_size + align) {
+                break;
+            }
+            current_ = current_->next;
+        }
+        ExpandStorage(request_size + align);
+        allocated_bytes_ += request_size;
+        return current_->Alloc(request_size, align);
+    }
+
+    /// Construct an object in the pool, which is destructed on reset.
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        T* obj = new (Alloc(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value) {
+            AddDestructor(
+                [](void* ptr) { static_cast<T*>(ptr)->~T(); }, obj);
+        }
+        return obj;
+    }
+
+    /// Call `fn(obj)` on reset, in the reverse order of registration.
+    void AddDestructor(void (*fn)(void*), void* obj) {
+        auto record = reinterpret_cast<DestructorRecord*>(
+            Alloc(sizeof(DestructorRecord), alignof(DestructorRecord)));
+        record->fn = fn;
+        record->obj = obj;
+        record->prev = destructors_;
+        destructors_ = record;
+    }
+
+    /// Destruct objects and rewind all chunks, chunks beyond the retained
+    /// bytes are freed.
+    void Reset() {
+        RunDestructors();
+        if (allocated_bytes_ > peak_bytes_) {
+            peak_bytes_ = allocated_bytes_;
+        }
+        if (allocated_bytes_ > interval_peak_bytes_) {
+            interval_peak_bytes_ = allocated_bytes_;
+        }
+        allocated_bytes_ = 0;
+        size_t retain_bytes = retain_bytes_;
+        if (trim_interval_ > 0 && ++resets_ >= trim_interval_) {
+            if (interval_peak_bytes_ < retain_bytes) {
+                retain_bytes = interval_peak_bytes_;
+            }
+            resets_ = 0;
+            interval_peak_bytes_ = 0;
+        }
+        size_t kept = 0;
+        Chunk* last = nullptr;
+        for (Chunk* chunk = head_; chunk != nullptr; chunk = chunk->next) {
+            if (last != nullptr && kept + chunk->capacity > retain_bytes) {
+                last->next = nullptr;
+                FreeChunks(chunk);
+                break;
+            }
+            chunk->used = 0;
+            kept += chunk->capacity;
+            last = chunk;
+        }
+        current_ = head_;
+    }
+
+    /// Bytes allocated since the last reset
+    size_t allocated_bytes() const { return allocated_bytes_; }
+    /// Max bytes allocated between two resets
+    size_t peak_bytes() const {
+        return allocated_bytes_ > peak_bytes_ ? allocated_bytes_ : peak_bytes_;
+    }
+    /// Bytes of chunks held by the pool
+    size_t reserved_bytes() const { return reserved_bytes_; }
+
+ private:
+    struct alignas(16) Chunk {
+        Chunk* next;
+        size_t capacity;
+        size_t used;
+
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+        char* Alloc(size_t request_size, size_t align) {
+            uintptr_t addr = reinterpret_cast<uintptr_t>(data()) + used;
+            size_t padding = (align - addr % align) % align;
+            if (used + padding + request_size > capacity) {
+                return nullptr;
+            }
+            used += padding + request_size;
+            return reinterpret_cast<char*>(addr + padding);
+        }
+    };
+    struct DestructorRecord {
+        void (*fn)(void*);
+        void* obj;
+        DestructorRecord* prev;
+    };
+
+    void ExpandStorage(size_t request_size) {
+        size_t capacity = current_ == nullptr ? DEFAULT_CHUNK_SIZE
+                                              : current_->capacity * 2;
+        if (capacity > MAX_CHUNK_SIZE) {
+            capacity = MAX_CHUNK_SIZE;
+        }
+        if (capacity < request_size) {
+            capacity = request_size;
+        }
+        Chunk* chunk =
+            static_cast<Chunk*>(malloc(sizeof(Chunk) + capacity));
+        chunk->capacity = capacity;
+        chunk->used = 0;
+        reserved_bytes_ += capacity;
+        // keep following chunks for reuse
+        if (current_ == nullptr) {
+            chunk->next = head_;
+            head_ = chunk;
+        } else {
+            chunk->next = current_->next;
+            current_->next = chunk;
+        }
+        current_ = chunk;
+    }
+
+    void FreeChunks(Chunk* chunk) {
+        while (chunk != nullptr) {
+            Chunk* next = chunk->next;
+            reserved_bytes_ -= chunk->capacity;
+            free(chunk);
+            chunk = next;
+        }
+    }
+
+    void RunDestructors() {
+        // records live in the chunks, which are not rewound yet
+        while (destructors_ != nullptr) {
+            DestructorRecord* record = destructors_;
+            destructors_ = record->prev;
+            record->fn(record->obj);
+        }
+    }
+
+    const size_t retain_bytes_;
+    const uint32_t trim_interval_;
+    Chunk* head_;
+    Chunk* current_;
+    DestructorRecord* destructors_;
+    size_t allocated_bytes_;
+    size_t peak_bytes_;
+    size_t reserved_bytes_;
+    // resets and peak bytes since the last trim
+    uint32_t resets_;
+    size_t interval_peak_bytes_;
+};
 }  // namespace base
 }  // namespace hybridse
 
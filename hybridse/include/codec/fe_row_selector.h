@@ -47,6 +47,49 @@ class RowSelector {
     RowBuilder target_row_builder_;
 };
 
+/// Re-encode rows with a subset of their columns.
+///
+/// Fixed-size fields are copied as is and only the selected strings are
+/// read, so the cost does not grow with the width of the source row.
+/// Unlike RowSelector, a projector is immutable after construction and can
+/// be shared by concurrent readers.
+class RowProjector {
+ public:
+    RowProjector(const hybridse::codec::Schema& schema,
+                 const std::vector<size_t>& indices);
+
+    /// Return `false` if some index is out of the source schema.
+    bool IsValid() const { return is_valid_; }
+    const hybridse::codec::Schema* GetOutputSchema() const {
+        return &output_schema_;
+    }
+    const std::vector<size_t>& indices() const { return indices_; }
+
+    /// Project the first slice of `row`. Return an empty row on failure.
+    Row Project(const Row& row) const;
+    bool Project(const int8_t* slice, size_t size, int8_t** out_slice,
+                 size_t* out_size) const;
+
+ private:
+    struct FieldInfo {
+        size_t col_idx;
+        bool is_string;
+        // source field offset and size for fixed-size fields,
+        // or index among output string fields
+        uint32_t offset;
+        uint32_t size;
+        uint32_t output_offset;
+    };
+
+    const std::vector<size_t> indices_;
+    hybridse::codec::Schema output_schema_;
+    RowView row_view_;
+    std::vector<FieldInfo> fields_;
+    uint32_t str_field_cnt_;
+    uint32_t str_field_start_offset_;
+    bool is_valid_;
+};
+
 }  // namespace codec
 }  // namespace hybridse
 #endif  // INCLUDE_CODEC_FE_ROW_SELECTOR_H_
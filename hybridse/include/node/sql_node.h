@@ -2267,7 +2267,8 @@ class UdafDefNode : public FnDefNode {
           init_expr_(init_expr),
           update_(update_func),
           merge_(merge_func),
-          output_(output_func) {}
+          output_(output_func),
+          list_func_(nullptr) {}
 
     const std::string GetName() const override { return name_; }
 
@@ -2279,6 +2280,12 @@ class UdafDefNode : public FnDefNode {
     FnDefNode *merge_func() const { return merge_; }
     FnDefNode *output_func() const { return output_; }
 
+    // Optional native function over the whole input lists, which computes
+    // the same output as the init, update and output loop, e.g. a vectorized
+    // kernel. It is only valid for the input list types of the udaf.
+    FnDefNode *list_func() const { return list_func_; }
+    void set_list_func(FnDefNode *list_func) { list_func_ = list_func; }
+
     bool AllowMerge() const { return merge_ != nullptr; }
 
     base::Status Validate(const std::vector<const TypeNode *> &arg_types) const override;
@@ -2329,6 +2336,7 @@ class UdafDefNode : public FnDefNode {
     FnDefNode *update_;
     FnDefNode *merge_;
     FnDefNode *output_;
+    FnDefNode *list_func_;
 };
 
 class PartitionMetaNode : public SqlNode {
@@ -16,6 +16,7 @@
 #ifndef INCLUDE_SDK_CODEC_SDK_H_
 #define INCLUDE_SDK_CODEC_SDK_H_
 
+#include <string>
 #include <vector>
 #include "butil/iobuf.h"
 #include "codec/fe_row_codec.h"
@@ -39,6 +40,8 @@ class RowBaseView {
     virtual bool IsNULL(uint32_t idx) = 0;
 };
 
+// View of a row in an IOBuf. The fields are read in place if the row is in
+// one block of the IOBuf, or else from a contiguous copy of the row.
 class RowIOBufView : public RowBaseView {
  public:
     explicit RowIOBufView(const hybridse::codec::Schema& schema);
@@ -53,13 +56,16 @@ class RowIOBufView : public RowBaseView {
     int32_t GetDate(uint32_t, int32_t* year, int32_t* month, int32_t* day);
     int32_t GetDate(uint32_t, int32_t* date);
     int32_t GetString(uint32_t idx, butil::IOBuf* buf);
-    int32_t GetString(uint32_t idx, char** val, uint32_t* length) { return -1; }
+    // `val` points into the row, which is valid until the next Reset
+    int32_t GetString(uint32_t idx, char** val, uint32_t* length);
     int32_t GetBool(uint32_t idx, bool* val);
 
     inline bool IsNULL(uint32_t idx) {
-        uint32_t offset = codec::HEADER_LENGTH + (idx >> 3);
-        uint8_t val = 0;
-        row_.copy_to(reinterpret_cast<void*>(&val), 1, offset);
+        if (buf_ == nullptr) {
+            return false;
+        }
+        uint8_t val =
+            static_cast<uint8_t>(buf_[codec::HEADER_LENGTH + (idx >> 3)]);
         return val & (1 << (idx & 0x07));
     }
 
@@ -68,6 +74,9 @@ class RowIOBufView : public RowBaseView {
 
  private:
     butil::IOBuf row_;
+    // the contiguous bytes of row_
+    const int8_t* buf_;
+    std::string flat_row_;
     uint8_t str_addr_length_;
     bool is_valid_;
     uint32_t string_field_cnt_;
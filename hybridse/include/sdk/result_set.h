@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include "sdk/base.h"
 
 namespace hybridse {
@@ -37,6 +38,11 @@ class ResultSet {
     virtual bool Reset() = 0;
     virtual bool Next() = 0;
 
+    /// Status of the result set. It is not ok if `Next()` or `Reset()`
+    /// failed rather than reached the end of rows, e.g. the rest of the rows
+    /// on the server is expired, and the result set is unusable since then.
+    virtual Status GetStatus() { return Status(); }
+
     virtual bool GetString(uint32_t index, std::string* val) = 0;
 
     inline std::string GetStringUnsafe(int index) {
@@ -216,6 +222,77 @@ class ResultSet {
     virtual bool IsNULL(int index) = 0;
 
     virtual int32_t Size() = 0;
+
+    // Read the column `index` of at most `max_cnt` rows after the current
+    // one in one call, and move to the last row read. The values of nulls
+    // are 0 and are marked in `nulls`. Integer and timestamp columns are read
+    // as int64, float columns as double
+    bool GetInt64Column(uint32_t index, uint32_t max_cnt,
+                        std::vector<int64_t>* values,
+                        std::vector<bool>* nulls) {
+        if (values == nullptr || nulls == nullptr ||
+            !IsColumnType(index, {kTypeInt16, kTypeInt32, kTypeInt64,
+                                  kTypeTimestamp})) {
+            return false;
+        }
+        values->clear();
+        nulls->clear();
+        auto type = GetSchema()->GetColumnType(index);
+        while (values->size() < max_cnt && Next()) {
+            bool is_null = IsNULL(index);
+            nulls->push_back(is_null);
+            if (is_null) {
+                values->push_back(0);
+            } else if (type == kTypeInt16) {
+                values->push_back(GetInt16Unsafe(index));
+            } else if (type == kTypeInt32) {
+                values->push_back(GetInt32Unsafe(index));
+            } else {
+                values->push_back(GetInt64Unsafe(index));
+            }
+        }
+        return true;
+    }
+
+    bool GetDoubleColumn(uint32_t index, uint32_t max_cnt,
+                         std::vector<double>* values,
+                         std::vector<bool>* nulls) {
+        if (values == nullptr || nulls == nullptr ||
+            !IsColumnType(index, {kTypeFloat, kTypeDouble})) {
+            return false;
+        }
+        values->clear();
+        nulls->clear();
+        auto type = GetSchema()->GetColumnType(index);
+        while (values->size() < max_cnt && Next()) {
+            bool is_null = IsNULL(index);
+            nulls->push_back(is_null);
+            if (is_null) {
+                values->push_back(0);
+            } else if (type == kTypeFloat) {
+                values->push_back(GetFloatUnsafe(index));
+            } else {
+                values->push_back(GetDoubleUnsafe(index));
+            }
+        }
+        return true;
+    }
+
+ private:
+    bool IsColumnType(uint32_t index, const std::vector<DataType>& types) {
+        auto schema = GetSchema();
+        if (schema == nullptr ||
+            static_cast<int32_t>(index) >= schema->GetColumnCnt()) {
+            return false;
+        }
+        auto type = schema->GetColumnType(index);
+        for (auto t : types) {
+            if (t == type) {
+                return true;
+            }
+        }
+        return false;
+    }
 };
 
 }  // namespace sdk
@@ -50,6 +50,7 @@ struct IndexSt {
     uint32_t index;             ///< position of index
     uint32_t ts_pos;            ///< second key column position
     std::vector<ColInfo> keys;  ///< first keys set
+    type::TTLType ttl_type = type::kTTLTimeLive;  ///< ttl type of index
 };
 
 /// \typedef IndexList repeated fields of IndexDef
@@ -245,6 +246,20 @@ class TableHandler : public DataHandler {
     /// and return OrderType::kNoneOrder by default.
     virtual const OrderType GetOrderType() const { return kNoneOrder; }
 
+    /// Return the number of rows taken from metadata without scanning the
+    /// dataset, which may count rows not yet expired or garbage collected.
+    /// Return `-1` by default if the count is unknown.
+    virtual int64_t GetCountEstimate() { return -1; }
+
+    /// Return a dataset holding only the columns at `column_idxs` of every
+    /// row, in the given order, so that storage can skip the bytes of
+    /// unused columns when it reads rows or ships them to other tablets.
+    /// Return `null` by default, and the caller projects rows itself.
+    virtual std::shared_ptr<TableHandler> ProjectColumns(
+        const std::vector<size_t>& column_idxs) {
+        return std::shared_ptr<TableHandler>();
+    }
+
     /// Return Tablet binding to specify index and key.
     /// Return `null` by default.
     virtual std::shared_ptr<Tablet> GetTablet(const std::string& index_name,
@@ -462,6 +477,27 @@ class Tablet {
         const bool is_procedure, const bool is_debug) = 0;
 };
 
+/// \brief Restrict the tables scanned by a single run, e.g. to some
+/// partitions of a distributed table.
+///
+/// Plans are cached and shared by queries, so a restriction of one query
+/// is given to its run session instead of the catalog.
+class ScanFilter {
+ public:
+    ScanFilter() {}
+    virtual ~ScanFilter() {}
+    /// Return the table to scan in place of `table`, or `table` itself if
+    /// its scans are not restricted.
+    virtual std::shared_ptr<TableHandler> Filter(
+        std::shared_ptr<TableHandler> table) = 0;
+    /// Return the partition to scan in place of `partition`, `partition`
+    /// itself by default.
+    virtual std::shared_ptr<PartitionHandler> FilterPartition(
+        std::shared_ptr<PartitionHandler> partition) {
+        return partition;
+    }
+};
+
 /// \brief A Catalog handler which defines a set of operation for, e.g,
 /// database, table and index management.
 ///
@@ -17,6 +17,7 @@
 #ifndef INCLUDE_VM_ENGINE_H_
 #define INCLUDE_VM_ENGINE_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>  //NOLINT
@@ -41,6 +42,7 @@ namespace vm {
 using ::hybridse::codec::Row;
 
 class Engine;
+class CompilePool;
 /// \brief An options class for controlling engine behaviour.
 class EngineOptions {
  public:
@@ -125,6 +127,76 @@ class EngineOptions {
         return enable_spark_unsaferow_format_;
     }
 
+    /// Set the memory budget in bytes of partition buffers in one batch
+    /// query, rows beyond the budget are spilled to disk, default `0`
+    /// which means unlimited.
+    inline EngineOptions* set_max_batch_memory_bytes(uint64_t bytes) {
+        max_batch_memory_bytes_ = bytes;
+        return this;
+    }
+    /// Return the memory budget of partition buffers in one batch query.
+    inline uint64_t max_batch_memory_bytes() const {
+        return max_batch_memory_bytes_;
+    }
+
+    /// Set the directory of spilled batch rows, default `/tmp`.
+    inline EngineOptions* set_spill_dir(const std::string& dir) {
+        spill_dir_ = dir;
+        return this;
+    }
+    /// Return the directory of spilled batch rows.
+    inline const std::string& spill_dir() const { return spill_dir_; }
+
+    /// Set `true` to compile batch queries with minimal optimizations first
+    /// and re-optimize them in background threads, default `false`.
+    ///
+    /// Sessions got after the re-optimization run the optimized code.
+    inline EngineOptions* set_enable_tiered_compile(bool flag) {
+        enable_tiered_compile_ = flag;
+        return this;
+    }
+    /// Return if the engine compiles batch queries in two tiers.
+    inline bool is_enable_tiered_compile() const {
+        return enable_tiered_compile_;
+    }
+
+    /// Set the number of background threads of tiered compile, default `1`.
+    inline EngineOptions* set_tiered_compile_threads(uint32_t num) {
+        tiered_compile_threads_ = num;
+        return this;
+    }
+    /// Return the number of background threads of tiered compile.
+    inline uint32_t tiered_compile_threads() const {
+        return tiered_compile_threads_;
+    }
+
+    /// Set `true` to lift literals compared in where clauses of batch
+    /// queries into query parameters, default `false`.
+    ///
+    /// Queries differing only in those literals share one compiled plan.
+    inline EngineOptions* set_enable_literal_normalize(bool flag) {
+        enable_literal_normalize_ = flag;
+        return this;
+    }
+    /// Return if the engine normalizes literals of batch queries.
+    inline bool is_enable_literal_normalize() const {
+        return enable_literal_normalize_;
+    }
+
+    /// Set the max rows projected by batch queries which are interpreted
+    /// instead of jit compiled, default `0` (never interpret).
+    ///
+    /// Only plans of simple projections and filters are interpreted. The
+    /// budget is shared by all runs of a cached plan, which is jit compiled
+    /// in background once the budget runs out. Plans over tables whose
+    /// metadata already count more rows are jit compiled at once.
+    inline EngineOptions* set_interpret_max_rows(uint64_t rows) {
+        interpret_max_rows_ = rows;
+        return this;
+    }
+    /// Return the max rows projected by interpreted batch queries.
+    inline uint64_t interpret_max_rows() const { return interpret_max_rows_; }
+
     /// Return JitOptions
     inline hybridse::vm::JitOptions& jit_options() { return jit_options_; }
 
@@ -139,9 +211,29 @@ class EngineOptions {
     bool enable_batch_window_parallelization_;
     uint32_t max_sql_cache_size_;
     bool enable_spark_unsaferow_format_;
+    uint64_t max_batch_memory_bytes_;
+    std::string spill_dir_;
+    bool enable_tiered_compile_;
+    uint32_t tiered_compile_threads_;
+    bool enable_literal_normalize_;
+    uint64_t interpret_max_rows_;
     JitOptions jit_options_;
 };
 
+/// \brief Counters of sql compiling of an Engine.
+struct EngineCompileStats {
+    /// Number of `Engine::Get` served by the compiled plan cache
+    uint64_t cache_hit = 0;
+    /// Number of `Engine::Get` which compile the sql
+    uint64_t cache_miss = 0;
+    /// Number of cache hits of literal normalized sql
+    uint64_t normalized_hit = 0;
+    /// Number of sql failed to compile
+    uint64_t compile_fail = 0;
+    /// Total time of compiling sql in microseconds
+    uint64_t compile_time_us = 0;
+};
+
 /// \brief A RunSession maintain SQL running context, including compile information, procedure name.
 ///
 class RunSession {
@@ -180,12 +272,17 @@ class RunSession {
     void SetSpName(const std::string& sp_name) { sp_name_ = sp_name; }
     /// Return the engine mode of this run session
     EngineMode engine_mode() const { return engine_mode_; }
+    /// Restrict the tables scanned by the following runs of the session.
+    void SetScanFilter(std::shared_ptr<ScanFilter> scan_filter) {
+        scan_filter_ = scan_filter;
+    }
 
  protected:
     std::shared_ptr<hybridse::vm::CompileInfo> compile_info_;
     hybridse::vm::EngineMode engine_mode_;
     bool is_debug_;
     std::string sp_name_;
+    std::shared_ptr<ScanFilter> scan_filter_;
     friend Engine;
 };
 
@@ -208,8 +305,28 @@ class BatchRunSession : public RunSession {
     void SetParameterSchema(const codec::Schema& schema) { parameter_schema_ = schema; }
     /// Return query parameter schema.
     virtual const Schema& GetParameterSchema() const { return parameter_schema_; }
+    /// Return if the parameters are literals lifted by the engine.
+    bool IsLiteralNormalized() const { return literal_normalized_; }
+
  private:
+    // bind literals lifted from the sql, which are used when running without
+    // a parameter row
+    void BindLiteralParameters(const codec::Schema& schema, const Row& row) {
+        parameter_schema_ = schema;
+        literal_row_ = row;
+        literal_normalized_ = true;
+    }
+    void ResetLiteralParameters() {
+        if (literal_normalized_) {
+            parameter_schema_.Clear();
+            literal_row_ = Row();
+            literal_normalized_ = false;
+        }
+    }
     codec::Schema parameter_schema_;
+    Row literal_row_;
+    bool literal_normalized_ = false;
+    friend Engine;
 };
 /// \brief RequestRunSession is a kind of RunSession designed for request mode query.
 ///
@@ -325,6 +442,13 @@ class Engine {
     /// \brief Initialize LLVM environments
     static void InitializeGlobalLLVM();
 
+    /// \brief Load a shared library of native udfs and udafs into the
+    /// default udf library
+    ///
+    /// It should be called at startup before any sql is compiled, see
+    /// udf/udf_plugin.h for how to write a plugin.
+    static base::Status LoadUdfPlugin(const std::string& path);
+
     ~Engine();
 
     /// \brief Compile sql in db and stored the results in the session
@@ -371,6 +495,19 @@ class Engine {
     /// \brief Clear engine's compiling result cache
     void ClearCacheLocked(const std::string& db);
 
+    /// \brief Return a snapshot of compiling counters
+    EngineCompileStats GetCompileStats() const;
+
+    /// \brief Return jit memory held by all compiled sql of the process
+    ///
+    /// The memory of a compiled sql is freed once both the cache entry and
+    /// sessions running it are gone.
+    static JitMemoryStats GetJitMemoryStats();
+
+    /// \brief Return max bytes allocated by the jit runtime in one run step
+    /// of the process, i.e. the peak memory of a single request or batch
+    static size_t GetRunStepPeakBytes();
+
  private:
     bool GetDependentTables(node::PlanNode* node, std::set<std::string>* tables,
                             base::Status& status);  // NOLINT
@@ -385,6 +522,19 @@ class Engine {
                            std::shared_ptr<CompileInfo> info,
                            base::Status& status);  // NOLINT
 
+    // look up the compiled plan of `sql` cached as `cache_key`, or compile it
+    bool Get(const std::string& sql, const std::string& cache_key,
+             const std::string& db, RunSession& session,  // NOLINT
+             base::Status& status);                        // NOLINT
+
+    bool Compile(std::shared_ptr<CompileInfo> info,
+                 base::Status& status);  // NOLINT
+
+    // re-optimize fast compiled or interpreted info in background
+    void TierUp(std::shared_ptr<CompileInfo> fast_info);
+    // pin the fast compiled jit of `info` until the returned info is dropped
+    static std::shared_ptr<CompileInfo> PinJit(const std::shared_ptr<CompileInfo>& info);
+
     bool Explain(const std::string& sql, const std::string& db,
                  EngineMode engine_mode, const codec::Schema& parameter_schema,
                  const std::set<size_t>& common_column_indices,
@@ -393,6 +543,12 @@ class Engine {
     EngineOptions options_;
     base::SpinMutex mu_;
     EngineLRUCache lru_cache_;
+    std::unique_ptr<CompilePool> compile_pool_;
+    std::atomic<uint64_t> cache_hit_;
+    std::atomic<uint64_t> cache_miss_;
+    std::atomic<uint64_t> normalized_hit_;
+    std::atomic<uint64_t> compile_fail_;
+    std::atomic<uint64_t> compile_time_us_;
 };
 
 /// \brief Local tablet is responsible to run a task locally.
@@ -41,6 +41,14 @@ struct BatchRequestInfo {
 enum ComileType {
     kCompileSql,
 };
+/// Sizes of code and data sections of jit compiled object code
+struct JitMemoryStats {
+    uint64_t code_bytes = 0;
+    uint64_t data_bytes = 0;
+    // number of loaded objects
+    uint64_t object_cnt = 0;
+};
+
 class CompileInfo {
  public:
     CompileInfo() {}
@@ -62,6 +70,12 @@ class CompileInfo {
                                   const std::string& tab) = 0;
     virtual void DumpClusterJob(std::ostream& output,
                                 const std::string& tab) = 0;
+    /// Return jit memory held by the compile result
+    virtual JitMemoryStats GetJitMemoryStats() const {
+        return JitMemoryStats();
+    }
+    /// Return true if the query runs sub queries on tablets
+    virtual bool HasSubQuery() const { return false; }
 };
 
 typedef std::map<
@@ -94,11 +108,23 @@ class JitOptions {
     bool is_enable_perf() const { return enable_perf_; }
     void set_enable_perf(bool flag) { enable_perf_ = flag; }
 
+    // compile with minimal optimization passes for a lower latency
+    bool is_enable_fast_compile() const { return enable_fast_compile_; }
+    void set_enable_fast_compile(bool flag) { enable_fast_compile_ = flag; }
+
+    // directory of cached object code of compiled sql, empty means disabled
+    const std::string& object_cache_dir() const { return object_cache_dir_; }
+    void set_object_cache_dir(const std::string& dir) {
+        object_cache_dir_ = dir;
+    }
+
  private:
     bool enable_mcjit_ = false;
     bool enable_vtune_ = false;
     bool enable_gdb_ = false;
     bool enable_perf_ = false;
+    bool enable_fast_compile_ = false;
+    std::string object_cache_dir_;
 };
 }  // namespace vm
 }  // namespace hybridse
@@ -169,6 +169,7 @@ class MemTableHandler : public TableHandler {
     void AddRow(const Row& row);
     void Reverse();
     virtual const uint64_t GetCount() { return table_.size(); }
+    int64_t GetCountEstimate() override { return table_.size(); }
     virtual Row At(uint64_t pos) {
         return pos < table_.size() ? table_.at(pos) : Row();
     }
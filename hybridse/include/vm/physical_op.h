@@ -100,6 +100,8 @@ inline const std::string PhysicalOpTypeName(const PhysicalOpType &type) {
     }
 }
 
+class ExprInterpreter;
+
 /**
  * Function codegen information for physical node. It should
  * provide full information to generate execution code.
@@ -141,6 +143,7 @@ class FnInfo {
         frames_.clear();
         schemas_ctx_ = nullptr;
         fn_ptr_ = nullptr;
+        interpreter_ = nullptr;
     }
 
     const node::FrameNode *GetFrame(size_t idx) const {
@@ -156,6 +159,14 @@ class FnInfo {
     const int8_t *fn_ptr() const { return fn_ptr_; }
     void SetFnPtr(const int8_t *fn) { fn_ptr_ = fn; }
 
+    // interpreter of the function, used instead of fn_ptr if not compiled
+    const std::shared_ptr<ExprInterpreter> &interpreter() const {
+        return interpreter_;
+    }
+    void SetInterpreter(const std::shared_ptr<ExprInterpreter> &interpreter) {
+        interpreter_ = interpreter;
+    }
+
  private:
     std::string fn_name_ = "";
     vm::Schema fn_schema_;
@@ -172,6 +183,8 @@ class FnInfo {
 
     // function ptr
     const int8_t *fn_ptr_ = nullptr;
+
+    std::shared_ptr<ExprInterpreter> interpreter_;
 };
 
 class FnComponent {
@@ -779,6 +792,10 @@ class PhysicalSimpleProjectNode : public PhysicalUnaryNode {
     // from one input schema source with consistent order. return -1 otherwise.
     int GetSelectSourceIndex() const;
 
+    // return true and fill column indexes if target projects just select
+    // columns from an input with one schema source, e.g. a pruned table.
+    bool GetSelectColumnIndexes(std::vector<size_t> *column_idxs) const;
+
  private:
     ColumnProjects project_;
 };
@@ -893,13 +910,19 @@ class Filter {
         : condition_(condition),
           left_key_(nullptr),
           right_key_(nullptr),
-          index_key_(nullptr) {}
+          index_key_(nullptr),
+          has_ts_range_(false),
+          ts_start_(0),
+          ts_end_(INT64_MAX) {}
     Filter(const node::ExprNode *condition, const node::ExprListNode *left_keys,
            const node::ExprListNode *right_keys)
         : condition_(condition),
           left_key_(left_keys),
           right_key_(right_keys),
-          index_key_(nullptr) {}
+          index_key_(nullptr),
+          has_ts_range_(false),
+          ts_start_(0),
+          ts_end_(INT64_MAX) {}
     virtual ~Filter() {}
 
     bool Valid() {
@@ -933,6 +956,18 @@ class Filter {
         condition_.ResolvedRelatedColumns(columns);
     }
 
+    // Closed range on the ts column of the scanned index implied by the
+    // condition. Rows out of it never pass the condition, so a segment
+    // scan can seek to the end and stop before the start of the range.
+    void set_ts_range(int64_t start, int64_t end) {
+        has_ts_range_ = true;
+        ts_start_ = start;
+        ts_end_ = end;
+    }
+    const bool has_ts_range() const { return has_ts_range_; }
+    const int64_t ts_start() const { return ts_start_; }
+    const int64_t ts_end() const { return ts_end_; }
+
     base::Status ReplaceExpr(const passes::ExprReplacer &replacer,
                              node::NodeManager *nm, Filter *out) const;
 
@@ -940,6 +975,11 @@ class Filter {
     Key left_key_;
     Key right_key_;
     Key index_key_;
+
+ private:
+    bool has_ts_range_;
+    int64_t ts_start_;
+    int64_t ts_end_;
 };
 
 class Join : public Filter {
@@ -984,6 +1024,8 @@ class Join : public Filter {
     }
     const node::JoinType join_type() const { return join_type_; }
     const Sort &right_sort() const { return right_sort_; }
+    const bool hash_join() const { return hash_join_; }
+    void set_hash_join(const bool hash_join) { hash_join_ = hash_join; }
     void ResolvedRelatedColumns(
         std::vector<const node::ExprNode *> *columns) const {
         Filter::ResolvedRelatedColumns(columns);
@@ -995,6 +1037,9 @@ class Join : public Filter {
 
     node::JoinType join_type_;
     Sort right_sort_;
+    // build right table into hash buckets once and probe with left rows,
+    // only set by HashJoinOptimized when right table has no usable index
+    bool hash_join_ = false;
 };
 
 class WindowJoinList {
@@ -1485,6 +1530,12 @@ class PhysicalRequestUnionNode : public PhysicalBinaryNode {
     const RequestWindowUnionList &window_unions() const {
         return window_unions_;
     }
+    /// Return the request union whose window covers this window, or null.
+    /// Rows of this window are then taken from output of the shared one.
+    PhysicalRequestUnionNode *shared_window() const { return shared_window_; }
+    void set_shared_window(PhysicalRequestUnionNode *shared_window) {
+        shared_window_ = shared_window;
+    }
 
     base::Status WithNewChildren(node::NodeManager *nm,
                                  const std::vector<PhysicalOpNode *> &children,
@@ -1495,6 +1546,10 @@ class PhysicalRequestUnionNode : public PhysicalBinaryNode {
     const bool exclude_current_time_;
     const bool output_request_row_;
     RequestWindowUnionList window_unions_;
+
+ private:
+    // set by CommonWindowSharing pass, not printed with the plan
+    PhysicalRequestUnionNode *shared_window_ = nullptr;
 };
 
 class PhysicalSortNode : public PhysicalUnaryNode {
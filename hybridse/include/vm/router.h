@@ -18,11 +18,20 @@
 #define INCLUDE_VM_ROUTER_H_
 
 #include <string>
+#include <vector>
 #include "vm/physical_op.h"
 
 namespace hybridse {
 namespace vm {
 
+/// How a column of the partial aggregation results of partitions is merged
+enum PartialAggMerge {
+    kMergeByKey,  ///< group key, rows with equal keys are merged
+    kMergeBySum,  ///< sum and count
+    kMergeByMin,
+    kMergeByMax,
+};
+
 class Router {
  public:
     void SetMainTable(const std::string& main_table) {
@@ -35,12 +44,35 @@ class Router {
 
     const std::string& GetRouterCol() const { return router_col_; }
 
+    /// Check whether the batch plan only scans, filters and projects rows
+    /// of the main table row by row, so that it can run on every partition
+    /// separately and the results are concatenated.
+    void ParseScatter(const PhysicalOpNode* physical_plan);
+
+    bool IsScatterable() const { return scatterable_; }
+
+    /// Whether the results of the scattered fragments are partial
+    /// aggregations, which are merged by `GetPartialAggMerges` for every
+    /// output column. A global aggregation or a group aggregation with only
+    /// `count`, `sum`, `min` and `max` over a scan can be scattered this way.
+    bool IsPartialAggregation() const { return !partial_agg_merges_.empty(); }
+
+    const std::vector<PartialAggMerge>& GetPartialAggMerges() const {
+        return partial_agg_merges_;
+    }
+
  private:
     bool IsWindowNode(const PhysicalOpNode* physical_node);
 
+    bool IsRowWiseScan(const PhysicalOpNode* physical_node);
+
+    bool ParsePartialAggregation(const PhysicalOpNode* physical_node);
+
  private:
     std::string main_table_;
     std::string router_col_;
+    bool scatterable_ = false;
+    std::vector<PartialAggMerge> partial_agg_merges_;
 };
 
 }  // namespace vm
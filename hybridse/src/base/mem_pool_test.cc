@@ -51,6 +51,82 @@ TEST_F(MemPoolTest, ByteMemoryPoolTest) {
         ASSERT_EQ("helloworldhybri", std::string(s3, 15));
     }
 }
+
+struct Counted {
+    explicit Counted(int* cnt) : cnt_(cnt) { ++*cnt_; }
+    ~Counted() { --*cnt_; }
+    int* cnt_;
+    std::string value_ = std::string(100, 'x');
+};
+
+TEST_F(MemPoolTest, ArenaMemoryPoolTest) {
+    int alive = 0;
+    ArenaMemoryPool arena(3 * ArenaMemoryPool::DEFAULT_CHUNK_SIZE);
+    char* s1 = arena.Alloc(10);
+    memcpy(s1, "helloworld", 10);
+    auto obj = arena.New<Counted>(&alive);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(obj) % alignof(Counted));
+    ASSERT_EQ(1, alive);
+    // larger than a chunk
+    char* s2 = arena.Alloc(10000);
+    memset(s2, 'a', 10000);
+    ASSERT_EQ("helloworld", std::string(s1, 10));
+    ASSERT_GE(arena.allocated_bytes(), 10000u + 10u + sizeof(Counted));
+
+    arena.Reset();
+    ASSERT_EQ(0, alive);
+    ASSERT_EQ(0u, arena.allocated_bytes());
+    ASSERT_GE(arena.peak_bytes(), 10000u);
+    size_t reserved = arena.reserved_bytes();
+    ASSERT_GT(reserved, 0u);
+
+    // chunks are reused
+    for (int i = 0; i < 10; ++i) {
+        arena.New<Counted>(&alive);
+        arena.Alloc(100);
+        ASSERT_EQ(reserved, arena.reserved_bytes());
+        arena.Reset();
+        ASSERT_EQ(0, alive);
+    }
+
+    // chunks beyond the retained bytes are freed
+    for (int i = 0; i < 10; ++i) {
+        arena.Alloc(ArenaMemoryPool::DEFAULT_CHUNK_SIZE);
+    }
+    ASSERT_GT(arena.reserved_bytes(), 3u * ArenaMemoryPool::DEFAULT_CHUNK_SIZE);
+    arena.Reset();
+    ASSERT_LE(arena.reserved_bytes(), 3u * ArenaMemoryPool::DEFAULT_CHUNK_SIZE);
+}
+
+TEST_F(MemPoolTest, ArenaMemoryPoolTrimTest) {
+    ArenaMemoryPool arena(ArenaMemoryPool::MAX_CHUNK_SIZE, 4);
+    // one large step
+    for (int i = 0; i < 64; ++i) {
+        arena.Alloc(ArenaMemoryPool::DEFAULT_CHUNK_SIZE);
+    }
+    arena.Reset();
+    size_t reserved = arena.reserved_bytes();
+    ASSERT_GT(reserved, 64u * ArenaMemoryPool::DEFAULT_CHUNK_SIZE);
+
+    // small steps keep the chunks until the end of the interval
+    for (int i = 0; i < 2; ++i) {
+        arena.Alloc(100);
+        arena.Reset();
+        ASSERT_EQ(reserved, arena.reserved_bytes());
+    }
+    // the rest of the interval with the large step, then an interval of
+    // small steps, which trims the chunks
+    for (int i = 0; i < 5; ++i) {
+        arena.Alloc(100);
+        arena.Reset();
+    }
+    ASSERT_LT(arena.reserved_bytes(), reserved);
+    ASSERT_LE(arena.reserved_bytes(),
+              2u * ArenaMemoryPool::DEFAULT_CHUNK_SIZE);
+    char* s = arena.Alloc(100);
+    memset(s, 'a', 100);
+    arena.Reset();
+}
 }  // namespace base
 }  // namespace hybridse
 
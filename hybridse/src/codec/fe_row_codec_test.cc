@@ -17,6 +17,7 @@
 #include "codec/fe_row_codec.h"
 #include <string>
 #include <vector>
+#include "codec/fe_row_selector.h"
 #include "gtest/gtest.h"
 
 DECLARE_bool(enable_spark_unsaferow_format);
@@ -651,6 +652,69 @@ TEST_F(CodecTest, RowFormatOffsetLongHeaderTest) {
         ASSERT_EQ(50u, str_info.str_start_offset);
     }
 }
+TEST_F(CodecTest, RowProjectorTest) {
+    FLAGS_enable_spark_unsaferow_format = false;
+    Schema schema;
+    std::vector<::hybridse::type::Type> types = {
+        ::hybridse::type::kInt32,   ::hybridse::type::kVarchar,
+        ::hybridse::type::kInt64,   ::hybridse::type::kVarchar,
+        ::hybridse::type::kDouble,  ::hybridse::type::kVarchar,
+        ::hybridse::type::kInt16,   ::hybridse::type::kTimestamp};
+    for (size_t i = 0; i < types.size(); ++i) {
+        ::hybridse::type::ColumnDef* col = schema.Add();
+        col->set_name("col" + std::to_string(i));
+        col->set_type(types[i]);
+    }
+    RowBuilder builder(schema);
+    std::string str1 = "hello";
+    std::string str5 = "a string to keep";
+    uint32_t size = builder.CalTotalLength(str1.size() + str5.size());
+    std::string row;
+    row.resize(size);
+    builder.SetBuffer(reinterpret_cast<int8_t*>(&(row[0])), size);
+    ASSERT_TRUE(builder.AppendInt32(1));
+    ASSERT_TRUE(builder.AppendString(str1.c_str(), str1.size()));
+    ASSERT_TRUE(builder.AppendNULL());
+    ASSERT_TRUE(builder.AppendNULL());
+    ASSERT_TRUE(builder.AppendDouble(4.5));
+    ASSERT_TRUE(builder.AppendString(str5.c_str(), str5.size()));
+    ASSERT_TRUE(builder.AppendInt16(6));
+    ASSERT_TRUE(builder.AppendTimestamp(1590115420000L));
+
+    RowProjector projector(schema, {5, 2, 3, 7, 4});
+    ASSERT_TRUE(projector.IsValid());
+    const Schema& output_schema = *projector.GetOutputSchema();
+    ASSERT_EQ(5, output_schema.size());
+    ASSERT_EQ("col5", output_schema.Get(0).name());
+
+    int8_t* out = nullptr;
+    size_t out_size = 0;
+    ASSERT_TRUE(projector.Project(reinterpret_cast<int8_t*>(&(row[0])), size,
+                                  &out, &out_size));
+    RowView view(output_schema, out, out_size);
+    const char* ch = nullptr;
+    uint32_t length = 0;
+    ASSERT_EQ(0, view.GetString(0, &ch, &length));
+    ASSERT_EQ(str5, std::string(ch, length));
+    ASSERT_TRUE(view.IsNULL(1));
+    ASSERT_TRUE(view.IsNULL(2));
+    int64_t ts = 0;
+    ASSERT_EQ(0, view.GetTimestamp(3, &ts));
+    ASSERT_EQ(1590115420000L, ts);
+    double val = 0;
+    ASSERT_EQ(0, view.GetDouble(4, &val));
+    ASSERT_EQ(4.5, val);
+    free(out);
+
+    // the projected row is as large as the one encoded by RowBuilder
+    RowBuilder expect_builder(output_schema);
+    uint32_t expect_size = expect_builder.CalTotalLength(str5.size());
+    ASSERT_EQ(expect_size, out_size);
+
+    RowProjector invalid_projector(schema, {8});
+    ASSERT_FALSE(invalid_projector.IsValid());
+}
+
 TEST_F(CodecTest, SparkUnsaferowBitMapSizeTest) {
     FLAGS_enable_spark_unsaferow_format = false;
     ASSERT_EQ(BitMapSize(3), 1);
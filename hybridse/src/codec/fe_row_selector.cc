@@ -15,11 +15,14 @@
  */
 
 #include "codec/fe_row_selector.h"
+#include <cstring>
 #include <string>
 #include <utility>
 #include "codec/type_codec.h"
 #include "glog/logging.h"
 
+DECLARE_bool(enable_spark_unsaferow_format);
+
 namespace hybridse {
 namespace codec {
 
@@ -256,5 +259,132 @@ bool RowSelector::Select(const int8_t* slice, size_t size, int8_t** out_slice,
     return true;
 }
 
+RowProjector::RowProjector(const hybridse::codec::Schema& schema,
+                           const std::vector<size_t>& indices)
+    : indices_(indices),
+      output_schema_(),
+      row_view_(schema),
+      fields_(),
+      str_field_cnt_(0),
+      str_field_start_offset_(0),
+      is_valid_(true) {
+    if (FLAGS_enable_spark_unsaferow_format) {
+        LOG(WARNING) << "Row projection does not support UnsafeRow format";
+        is_valid_ = false;
+        return;
+    }
+    for (size_t idx : indices_) {
+        if (idx >= static_cast<size_t>(schema.size())) {
+            LOG(WARNING) << "Column idx out of bound: " << idx;
+            is_valid_ = false;
+            return;
+        }
+        *output_schema_.Add() = schema.Get(idx);
+    }
+    uint32_t offset = HEADER_LENGTH + BitMapSize(output_schema_.size());
+    for (size_t idx : indices_) {
+        FieldInfo field;
+        field.col_idx = idx;
+        field.is_string = schema.Get(idx).type() == type::kVarchar;
+        if (field.is_string) {
+            field.offset = 0;
+            field.size = 0;
+            field.output_offset = str_field_cnt_++;
+        } else {
+            auto& type_size_map = GetTypeSizeMap();
+            auto iter = type_size_map.find(schema.Get(idx).type());
+            if (iter == type_size_map.end()) {
+                LOG(WARNING) << type::Type_Name(schema.Get(idx).type())
+                             << " is not supported";
+                is_valid_ = false;
+                return;
+            }
+            field.offset = row_view_.GetPrimaryFieldOffset(idx);
+            field.size = iter->second;
+            field.output_offset = offset;
+            offset += iter->second;
+        }
+        fields_.push_back(field);
+    }
+    str_field_start_offset_ = offset;
+}
+
+Row RowProjector::Project(const Row& row) const {
+    int8_t* buf = nullptr;
+    size_t size = 0;
+    if (row.GetRowPtrCnt() < 1 ||
+        !Project(row.buf(0), row.size(0), &buf, &size)) {
+        return Row();
+    }
+    return Row(base::RefCountedSlice::CreateManaged(buf, size));
+}
+
+bool RowProjector::Project(const int8_t* slice, size_t size,
+                           int8_t** out_slice, size_t* out_size) const {
+    if (!is_valid_ || slice == nullptr || size <= HEADER_LENGTH) {
+        return false;
+    }
+    // collect selected strings first to size the output row
+    std::vector<std::pair<const char*, uint32_t>> strs(str_field_cnt_,
+                                                       {nullptr, 0});
+    uint32_t str_size = 0;
+    for (auto& field : fields_) {
+        if (!field.is_string) {
+            continue;
+        }
+        auto& str = strs[field.output_offset];
+        if (0 == row_view_.GetValue(slice, field.col_idx, &str.first,
+                                    &str.second)) {
+            str_size += str.second;
+        }
+    }
+    uint32_t total_size = str_field_start_offset_ + str_size;
+    if (total_size + str_field_cnt_ <= UINT8_MAX) {
+        total_size += str_field_cnt_;
+    } else if (total_size + str_field_cnt_ * 2 <= UINT16_MAX) {
+        total_size += str_field_cnt_ * 2;
+    } else if (total_size + str_field_cnt_ * 3 <= UINT24_MAX) {
+        total_size += str_field_cnt_ * 3;
+    } else {
+        total_size += str_field_cnt_ * 4;
+    }
+    uint8_t addr_length = GetAddrLength(total_size);
+
+    int8_t* buf = reinterpret_cast<int8_t*>(malloc(total_size));
+    *(buf) = 1;      // FVersion
+    *(buf + 1) = 1;  // SVersion
+    *(reinterpret_cast<uint32_t*>(buf + VERSION_LENGTH)) = total_size;
+    memset(buf + HEADER_LENGTH, 0, BitMapSize(output_schema_.size()));
+    uint32_t str_offset =
+        str_field_start_offset_ + addr_length * str_field_cnt_;
+    for (size_t i = 0; i < fields_.size(); ++i) {
+        auto& field = fields_[i];
+        bool is_null = row_view_.IsNULL(slice, field.col_idx);
+        if (is_null) {
+            v1::AppendNullBit(buf, i, true);
+        }
+        if (!field.is_string) {
+            if (!is_null) {
+                memcpy(buf + field.output_offset, slice + field.offset,
+                       field.size);
+            }
+            continue;
+        }
+        // a null string points to where the next string starts
+        FillNullStringOffset(buf, str_field_start_offset_, addr_length,
+                             field.output_offset, str_offset);
+        if (!is_null) {
+            auto& str = strs[field.output_offset];
+            if (str.second != 0) {
+                memcpy(buf + str_offset, str.first, str.second);
+            }
+            str_offset += str.second;
+        }
+    }
+    *out_slice = buf;
+    *out_size = total_size;
+    return true;
+}
+
 }  // namespace codec
 }  // namespace hybridse
@@ -490,6 +490,11 @@ Status UdfIRBuilder::BuildUdafCall(
     const node::UdafDefNode* fn,
     const std::vector<const node::TypeNode*>& arg_types,
     const std::vector<NativeValue>& args, NativeValue* output) {
+    // native function over whole lists takes place of the update loop
+    if (fn->list_func() != nullptr) {
+        return BuildCall(fn->list_func(), arg_types, args, output);
+    }
+
     // udaf state type
     const node::TypeNode* state_type = fn->GetStateType();
     CHECK_TRUE(state_type != nullptr, kCodegenError, "Missing state type");
@@ -225,9 +225,11 @@ Status ExprInplaceTransformUp::VisitUdaf(
     }
 
     if (changed) {
-        *out = ctx_->node_manager()->MakeUdafDefNode(
+        auto new_udaf = ctx_->node_manager()->MakeUdafDefNode(
             udaf->GetName(), udaf->GetArgTypeList(), init, update, merge,
             output_fn);
+        new_udaf->set_list_func(udaf->list_func());
+        *out = new_udaf;
     } else {
         *out = udaf;
     }
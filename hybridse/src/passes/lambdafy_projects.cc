@@ -16,6 +16,7 @@
 
 #include "passes/lambdafy_projects.h"
 #include "passes/resolve_fn_and_attrs.h"
+#include "vm/transform.h"
 
 namespace hybridse {
 namespace passes {
@@ -56,7 +57,8 @@ Status LambdafyProjects::Transform(
                     require_agg_vec->push_back(false);
                 }
             }
-        } else if (legacy_agg_opt_ && FallBackToLegacyAgg(origin_expr)) {
+        } else if (legacy_agg_opt_ && !HasListUdaf(origin_expr) &&
+                   FallBackToLegacyAgg(origin_expr)) {
             auto expr = origin_expr->DeepCopy(nm);
             CHECK_TRUE(expr != nullptr, kCodegenError);
             out_list->AddChild(expr);
@@ -218,6 +220,20 @@ Status LambdafyProjects::VisitAggExpr(node::CallExprNode* call,
     auto fn = dynamic_cast<const node::ExternalFnDefNode*>(call->GetFnDef());
     CHECK_TRUE(fn != nullptr, kCodegenError, "Fail to visit agg expression with null function definition node");
 
+    // sum(col) -> sum(col), computed by the list function of sum over the
+    // window column, without the iteration form
+    node::UdafDefNode* list_udaf = nullptr;
+    CHECK_STATUS(ResolveListUdaf(call, &list_udaf));
+    if (list_udaf != nullptr) {
+        std::vector<node::ExprNode*> columns;
+        for (size_t i = 0; i < call->GetChildNum(); ++i) {
+            columns.push_back(call->GetChild(i));
+        }
+        *out = nm->MakeFuncNode(list_udaf, columns, nullptr);
+        *is_window_agg = true;
+        return Status::OK();
+    }
+
     // represent row argument in window iteration
     node::ExprIdNode* iter_row = nullptr;
 
@@ -386,6 +402,60 @@ Status LambdafyProjects::VisitAggExpr(node::CallExprNode* call,
     return Status::OK();
 }
 
+Status LambdafyProjects::ResolveListUdaf(const node::CallExprNode* call,
+                                         node::UdafDefNode** out) {
+    *out = nullptr;
+    auto fn = dynamic_cast<const node::ExternalFnDefNode*>(call->GetFnDef());
+    if (fn == nullptr || fn->IsResolved() || call->GetChildNum() == 0 ||
+        !ctx_->library()->IsUdaf(fn->function_name(), call->GetChildNum())) {
+        return Status::OK();
+    }
+    auto nm = ctx_->node_manager();
+    auto schemas_ctx = ctx_->schemas_context();
+    std::vector<node::ExprNode*> list_args;
+    for (size_t i = 0; i < call->GetChildNum(); ++i) {
+        auto child = call->GetChild(i);
+        if (child->GetExprType() != node::kExprColumnRef ||
+            !call->RequireListAt(ctx_, i)) {
+            return Status::OK();
+        }
+        size_t schema_idx;
+        size_t col_idx;
+        CHECK_STATUS(schemas_ctx->ResolveColumnRefIndex(
+            dynamic_cast<const node::ColumnRefNode*>(child), &schema_idx,
+            &col_idx));
+        auto& column = schemas_ctx->GetSchema(schema_idx)->Get(col_idx);
+        node::DataType dtype;
+        if (!column.is_not_null() ||
+            !vm::SchemaType2DataType(column.type(), &dtype)) {
+            return Status::OK();
+        }
+        auto arg = nm->MakeExprIdNode("udaf_list_arg_" + std::to_string(i));
+        arg->SetOutputType(nm->MakeTypeNode(node::kList, dtype));
+        arg->SetNullable(false);
+        list_args.push_back(arg);
+    }
+    // udafs not resolved here fall back to the iteration form
+    node::FnDefNode* fn_def = nullptr;
+    auto status = ctx_->library()->ResolveFunction(fn->function_name(),
+                                                   list_args, nm, &fn_def);
+    auto udaf = dynamic_cast<node::UdafDefNode*>(fn_def);
+    if (status.isOK() && udaf != nullptr && udaf->list_func() != nullptr) {
+        *out = udaf;
+    }
+    return Status::OK();
+}
+
+bool LambdafyProjects::HasListUdaf(const node::ExprNode* expr) {
+    if (expr->GetExprType() != node::kExprCall) {
+        return false;
+    }
+    node::UdafDefNode* udaf = nullptr;
+    auto status = ResolveListUdaf(
+        dynamic_cast<const node::CallExprNode*>(expr), &udaf);
+    return status.isOK() && udaf != nullptr;
+}
+
 bool LambdafyProjects::FallBackToLegacyAgg(const node::ExprNode* expr) {
     switch (expr->expr_type_) {
         case node::kExprCall: {
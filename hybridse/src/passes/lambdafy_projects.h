@@ -80,6 +80,13 @@ class LambdafyProjects {
  private:
     node::ExprAnalysisContext* ctx_;
 
+    // Resolve `call` to the udaf with a native list function if all its
+    // arguments are window columns declared NOT NULL, else output nullptr.
+    // The list function only sees the values, not the null flags.
+    Status ResolveListUdaf(const node::CallExprNode* call,
+                           node::UdafDefNode** out);
+    bool HasListUdaf(const node::ExprNode* expr);
+
     // to make compatible with legacy agg builder
     bool FallBackToLegacyAgg(const node::ExprNode* expr);
     bool legacy_agg_opt_;
@@ -15,6 +15,8 @@
  */
 
 #include "passes/lambdafy_projects.h"
+#include <string>
+#include <vector>
 #include "gtest/gtest.h"
 #include "plan/plan_api.h"
 #include "udf/default_udf_library.h"
@@ -83,6 +85,75 @@ TEST_F(LambdafyProjectsTest, Test) {
     lambda->Print(std::cerr, "");
 }
 
+// return the name of udaf called at the root of `expr`
+static std::string UdafName(node::ExprNode *expr) {
+    auto call = dynamic_cast<node::CallExprNode *>(expr);
+    if (call == nullptr) {
+        return "";
+    }
+    auto udaf = dynamic_cast<const node::UdafDefNode *>(call->GetFnDef());
+    return udaf == nullptr ? "" : udaf->GetName();
+}
+
+TEST_F(LambdafyProjectsTest, ListUdafTest) {
+    auto schema = udf::MakeLiteralSchema<int32_t, double, bool, int32_t>();
+    schema.Mutable(0)->set_is_not_null(true);
+    schema.Mutable(1)->set_is_not_null(true);
+    schema.Mutable(2)->set_is_not_null(true);
+    vm::SchemasContext schemas_ctx;
+    schemas_ctx.BuildTrivial({&schema});
+
+    Status status;
+    node::NodeManager nm;
+    const std::string sql =
+        "select "
+        "    sum(col_0), "
+        "    max(col_1), "
+        "    count_where(col_0, col_2), "
+        "    sum(col_3), "
+        "    count_where(col_3, col_2), "
+        "    sum(col_0 + 1) "
+        "from t1;";
+    node::PlanNodeList trees;
+    ASSERT_TRUE(plan::PlanAPI::CreatePlanTreeFromScript(sql, trees, &nm, status)) << status;
+    auto query_plan = dynamic_cast<node::QueryPlanNode *>(trees[0]);
+    auto project_plan =
+        dynamic_cast<node::ProjectPlanNode *>(query_plan->GetChildren()[0]);
+    auto project_list_node = dynamic_cast<node::ProjectListNode *>(
+        project_plan->project_list_vec_[0]);
+    std::vector<const node::ExprNode *> exprs;
+    for (auto plan_node : project_list_node->GetProjects()) {
+        auto pp_node = dynamic_cast<node::ProjectNode *>(plan_node);
+        exprs.push_back(pp_node->GetExpression());
+    }
+
+    auto lib = udf::DefaultUdfLibrary::get();
+    node::ExprAnalysisContext ctx(&nm, lib, &schemas_ctx, nullptr);
+    LambdafyProjects transformer(&ctx, true);
+    std::vector<int> is_agg_vec;
+    node::LambdaNode *lambda;
+    status = transformer.Transform(exprs, &lambda, &is_agg_vec);
+    ASSERT_TRUE(status.isOK()) << status;
+    ASSERT_EQ(std::vector<int>({1, 1, 1, 1, 1, 1}), is_agg_vec);
+
+    // NOT NULL window columns call the udafs with list functions directly,
+    // even the ones the legacy agg builder supports
+    auto outputs = lambda->body();
+    ASSERT_EQ("sum", UdafName(outputs->GetChild(0)));
+    ASSERT_EQ("max", UdafName(outputs->GetChild(1)));
+    ASSERT_EQ("count_where", UdafName(outputs->GetChild(2)));
+    for (size_t i = 0; i < 3; ++i) {
+        auto call = dynamic_cast<node::CallExprNode *>(outputs->GetChild(i));
+        auto udaf = dynamic_cast<const node::UdafDefNode *>(call->GetFnDef());
+        ASSERT_TRUE(udaf->list_func() != nullptr) << i;
+    }
+
+    // nullable columns and expressions are not
+    ASSERT_EQ("", UdafName(outputs->GetChild(3)));
+    ASSERT_EQ(0u, UdafName(outputs->GetChild(4)).find("window_agg_$count_where"));
+    ASSERT_EQ(0u, UdafName(outputs->GetChild(5)).find("window_agg_$sum"));
+}
+
 }  // namespace passes
 }  // namespace hybridse
 
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "passes/physical/common_window_sharing.h"
+
+#include <sstream>
+
+namespace hybridse {
+namespace passes {
+
+using hybridse::common::kPlanError;
+using hybridse::vm::kPhysicalOpDataProvider;
+using hybridse::vm::kPhysicalOpRequestUnion;
+
+// last ts offset of the window relative to the request ts
+static int64_t HistoryEnd(const node::FrameNode* frame,
+                          bool exclude_current_time) {
+    int64_t end = frame->GetHistoryRangeEnd();
+    return (exclude_current_time && 0 == end) ? -1 : end;
+}
+
+// subqueries create their own data providers, providers of the same table
+// and index output the same rows
+static std::string ProducerSignature(const PhysicalOpNode* node) {
+    if (kPhysicalOpDataProvider == node->GetOpType()) {
+        return node->GetTreeString();
+    }
+    return std::to_string(node->node_id());
+}
+
+Status CommonWindowSharing::Apply(PhysicalPlanContext* ctx,
+                                  PhysicalOpNode* input, PhysicalOpNode** out) {
+    CHECK_TRUE(input != nullptr, kPlanError);
+    visited_.clear();
+    groups_.clear();
+    CollectRequestUnions(input);
+    for (auto& group : groups_) {
+        auto& nodes = group.second;
+        if (nodes.size() < 2) {
+            continue;
+        }
+        // a node is a root if no other window dominates it, identical
+        // windows are shared by the one with the smallest node id
+        auto dominate = [](const PhysicalRequestUnionNode* lhs,
+                           const PhysicalRequestUnionNode* rhs) {
+            return CoverWindow(lhs, rhs) &&
+                   (!CoverWindow(rhs, lhs) || lhs->node_id() < rhs->node_id());
+        };
+        std::vector<PhysicalRequestUnionNode*> roots;
+        for (auto node : nodes) {
+            bool is_root = true;
+            for (auto other : nodes) {
+                if (other != node && dominate(other, node)) {
+                    is_root = false;
+                    break;
+                }
+            }
+            if (is_root) {
+                roots.push_back(node);
+            }
+        }
+        for (auto node : nodes) {
+            node->set_shared_window(nullptr);
+            for (auto root : roots) {
+                if (root != node && CoverWindow(root, node)) {
+                    DLOG(INFO) << "window " << node->node_id()
+                               << " shares rows of window " << root->node_id();
+                    node->set_shared_window(root);
+                    break;
+                }
+            }
+        }
+    }
+    *out = input;
+    return Status::OK();
+}
+
+void CommonWindowSharing::CollectRequestUnions(PhysicalOpNode* input) {
+    if (nullptr == input || visited_.count(input->node_id()) > 0) {
+        return;
+    }
+    visited_.insert(input->node_id());
+    for (size_t i = 0; i < input->GetProducerCnt(); ++i) {
+        CollectRequestUnions(input->GetProducer(i));
+    }
+    if (kPhysicalOpRequestUnion != input->GetOpType()) {
+        return;
+    }
+    auto union_op = dynamic_cast<PhysicalRequestUnionNode*>(input);
+    // only windows scanning a single segment of the right input are shared
+    if (union_op->instance_not_in_window() ||
+        !union_op->window_unions().Empty() ||
+        !union_op->window().range_.Valid() ||
+        nullptr == union_op->window().range_.frame()) {
+        return;
+    }
+    groups_[SegmentSignature(union_op)].push_back(union_op);
+}
+
+std::string CommonWindowSharing::SegmentSignature(
+    const PhysicalRequestUnionNode* node) {
+    std::ostringstream oss;
+    const auto& window = node->window();
+    oss << ProducerSignature(node->GetProducer(0)) << ";"
+        << ProducerSignature(node->GetProducer(1)) << ";"
+        << window.partition_.ToString() << ";" << window.sort_.ToString()
+        << ";" << window.index_key_.ToString() << ";"
+        << window.range_.range_key()->GetExprString();
+    return oss.str();
+}
+
+bool CommonWindowSharing::CoverWindow(const PhysicalRequestUnionNode* large,
+                                      const PhysicalRequestUnionNode* small) {
+    auto large_frame = large->window().range_.frame();
+    auto small_frame = small->window().range_.frame();
+    if (nullptr == large_frame || nullptr == small_frame ||
+        large_frame->frame_type() != small_frame->frame_type() ||
+        large_frame->frame_maxsize() > 0) {
+        return false;
+    }
+    int64_t large_end =
+        HistoryEnd(large_frame, large->exclude_current_time());
+    int64_t small_end =
+        HistoryEnd(small_frame, small->exclude_current_time());
+    switch (large_frame->frame_type()) {
+        case node::kFrameRowsRange: {
+            // rows of a range window are decided by ts only
+            return large_frame->GetHistoryRangeStart() <=
+                       small_frame->GetHistoryRangeStart() &&
+                   large_end >= small_end;
+        }
+        case node::kFrameRows: {
+            // rows windows count rows from the same end
+            return large_end == small_end &&
+                   large->exclude_current_time() ==
+                       small->exclude_current_time() &&
+                   large_frame->GetHistoryRowsStart() <=
+                       small_frame->GetHistoryRowsStart();
+        }
+        default:
+            return false;
+    }
+}
+
+}  // namespace passes
+}  // namespace hybridse
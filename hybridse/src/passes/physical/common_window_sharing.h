@@ -0,0 +1,64 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_PASSES_PHYSICAL_COMMON_WINDOW_SHARING_H_
+#define SRC_PASSES_PHYSICAL_COMMON_WINDOW_SHARING_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "passes/physical/physical_pass.h"
+#include "vm/physical_op.h"
+
+namespace hybridse {
+namespace passes {
+
+using hybridse::base::Status;
+using hybridse::vm::PhysicalRequestUnionNode;
+
+/**
+ * Share request windows over the same partition and order.
+ *
+ * Feature scripts usually define several windows on the same PARTITION BY
+ * and ORDER BY with different ranges. For every request union covered by
+ * a larger request union on the same inputs, mark the larger one as its
+ * shared window so that the runner evaluates the smaller window over the
+ * rows of the larger one instead of scanning the storage again.
+ */
+class CommonWindowSharing : public PhysicalPass {
+ public:
+    Status Apply(PhysicalPlanContext* ctx, PhysicalOpNode* input,
+                 PhysicalOpNode** out) override;
+
+    /// Return `true` if window of `large` covers all rows window of `small`
+    /// may take from the same segment.
+    static bool CoverWindow(const PhysicalRequestUnionNode* large,
+                            const PhysicalRequestUnionNode* small);
+
+ private:
+    void CollectRequestUnions(PhysicalOpNode* input);
+    // signature of the segment a request union scans
+    static std::string SegmentSignature(const PhysicalRequestUnionNode* node);
+
+    std::set<size_t> visited_;
+    std::map<std::string, std::vector<PhysicalRequestUnionNode*>> groups_;
+};
+
+}  // namespace passes
+}  // namespace hybridse
+#endif  // SRC_PASSES_PHYSICAL_COMMON_WINDOW_SHARING_H_
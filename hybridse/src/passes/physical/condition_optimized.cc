@@ -15,6 +15,7 @@
  */
 #include "passes/physical/condition_optimized.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -233,6 +234,129 @@ bool ConditionOptimized::ExtractEqualExprPair(
         }
     }
 }
+// Resolve `expr` as the column at (0, col_idx) of schemas context
+static bool IsColumnOf(const SchemasContext* schemas_ctx, size_t col_idx,
+                       const node::ExprNode* expr) {
+    size_t schema_idx;
+    size_t idx;
+    Status status;
+    switch (expr->GetExprType()) {
+        case node::kExprColumnRef: {
+            status = schemas_ctx->ResolveColumnRefIndex(
+                dynamic_cast<const node::ColumnRefNode*>(expr), &schema_idx,
+                &idx);
+            break;
+        }
+        case node::kExprColumnId: {
+            status = schemas_ctx->ResolveColumnIndexByID(
+                dynamic_cast<const node::ColumnIdNode*>(expr)->GetColumnID(),
+                &schema_idx, &idx);
+            break;
+        }
+        default:
+            return false;
+    }
+    return status.isOK() && 0 == schema_idx && col_idx == idx;
+}
+
+static bool IsIntegerConst(const node::ExprNode* expr) {
+    if (node::kExprPrimary != expr->GetExprType()) {
+        return false;
+    }
+    switch (dynamic_cast<const node::ConstNode*>(expr)->GetDataType()) {
+        case node::kInt16:
+        case node::kInt32:
+        case node::kInt64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// e.g.
+// condition: ts >= 100 and 200 > ts and col1 > 3
+// range: [100, 199]
+bool ConditionOptimized::ExtractColumnRange(const SchemasContext* schemas_ctx,
+                                            size_t col_idx,
+                                            const node::ExprNode* condition,
+                                            int64_t* start, int64_t* end) {
+    node::ExprListNode and_conditions;
+    if (!TransfromAndConditionList(condition, &and_conditions)) {
+        return false;
+    }
+    bool bounded = false;
+    for (auto expr : and_conditions.children_) {
+        if (node::kExprBinary != expr->GetExprType()) {
+            continue;
+        }
+        auto binary = dynamic_cast<const node::BinaryExpr*>(expr);
+        auto op = binary->GetOp();
+        auto lhs = binary->GetChild(0);
+        auto rhs = binary->GetChild(1);
+        // normalize to `col op const`
+        if (IsIntegerConst(lhs) && IsColumnOf(schemas_ctx, col_idx, rhs)) {
+            std::swap(lhs, rhs);
+            switch (op) {
+                case node::kFnOpLt:
+                    op = node::kFnOpGt;
+                    break;
+                case node::kFnOpLe:
+                    op = node::kFnOpGe;
+                    break;
+                case node::kFnOpGt:
+                    op = node::kFnOpLt;
+                    break;
+                case node::kFnOpGe:
+                    op = node::kFnOpLe;
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (!IsIntegerConst(rhs) || !IsColumnOf(schemas_ctx, col_idx, lhs)) {
+            continue;
+        }
+        int64_t value = dynamic_cast<const node::ConstNode*>(rhs)->GetAsInt64();
+        switch (op) {
+            case node::kFnOpEq: {
+                *start = std::max(*start, value);
+                *end = std::min(*end, value);
+                break;
+            }
+            case node::kFnOpGt: {
+                if (value == INT64_MAX) {
+                    *start = INT64_MAX;
+                    *end = INT64_MIN;
+                } else {
+                    *start = std::max(*start, value + 1);
+                }
+                break;
+            }
+            case node::kFnOpGe: {
+                *start = std::max(*start, value);
+                break;
+            }
+            case node::kFnOpLt: {
+                if (value == INT64_MIN) {
+                    *start = INT64_MAX;
+                    *end = INT64_MIN;
+                } else {
+                    *end = std::min(*end, value - 1);
+                }
+                break;
+            }
+            case node::kFnOpLe: {
+                *end = std::min(*end, value);
+                break;
+            }
+            default:
+                continue;
+        }
+        bounded = true;
+    }
+    return bounded;
+}
+
 // Return CosntExpr Equal Expr Pair
 // Const Expr should be first of pair
 bool ConditionOptimized::TransformConstEqualExprPair(
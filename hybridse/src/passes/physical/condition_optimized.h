@@ -53,6 +53,13 @@ class ConditionOptimized : public TransformUpPysicalPass {
     static bool MakeConstEqualExprPair(
         const std::pair<node::ExprNode*, node::ExprNode*> expr_pair,
         const SchemasContext* right_schemas_ctx, ExprPair* output);
+    // Narrow [start, end] with conditions like `col > const` and
+    // `col = const` on the column at (0, col_idx) of schemas context.
+    // Return true if any condition bounds the column.
+    static bool ExtractColumnRange(const SchemasContext* schemas_ctx,
+                                   size_t col_idx,
+                                   const node::ExprNode* condition,
+                                   int64_t* start, int64_t* end);
 
  private:
     bool Transform(PhysicalOpNode* in, PhysicalOpNode** output);
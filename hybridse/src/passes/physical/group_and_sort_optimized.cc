@@ -20,6 +20,7 @@
 #include <set>
 #include <string>
 #include <vector>
+#include "passes/physical/condition_optimized.h"
 #include "vm/physical_op.h"
 
 namespace hybridse {
@@ -192,6 +193,7 @@ bool GroupAndSortOptimized::Transform(PhysicalOpNode* in,
                 if (!ResetProducer(plan_ctx_, filter_op, 0, new_producer)) {
                     return false;
                 }
+                FilterTsRangeOptimized(new_producer, &filter_op->filter_);
             }
         }
         default: {
@@ -294,6 +296,29 @@ bool GroupAndSortOptimized::KeysOptimized(
         }
         *new_in = new_simple_op;
         return true;
+    } else if (PhysicalOpType::kPhysicalOpFilter == in->GetOpType()) {
+        // scan index segments of a filtered table, e.g. window on a subquery
+        // with where clause, instead of partitioning the filtered rows
+        auto filter_op = dynamic_cast<PhysicalFilterNode*>(in);
+        if (filter_op->filter_.index_key().ValidKey()) {
+            return false;
+        }
+        PhysicalOpNode* new_depend;
+        if (!KeysOptimized(root_schemas_ctx, filter_op->producers()[0],
+                           left_key, index_key, right_key, sort,
+                           &new_depend)) {
+            return false;
+        }
+        PhysicalFilterNode* new_filter_op = nullptr;
+        Status status = plan_ctx_->CreateOp<PhysicalFilterNode>(
+            &new_filter_op, new_depend, filter_op->filter_);
+        if (!status.isOK()) {
+            LOG(WARNING) << "Fail to create filter op: " << status;
+            return false;
+        }
+        FilterTsRangeOptimized(new_depend, &new_filter_op->filter_);
+        *new_in = new_filter_op;
+        return true;
     } else if (PhysicalOpType::kPhysicalOpRename == in->GetOpType()) {
         PhysicalOpNode* new_depend;
         if (!KeysOptimized(root_schemas_ctx, in->producers()[0], left_key,
@@ -350,6 +375,35 @@ bool GroupAndSortOptimized::FilterAndOrderOptimized(
                          new_in);
 }
 
+// Let segment scans of filter skip rows out of the ts range implied by the
+// condition, e.g. `where key = "a" and ts > 1000` seeks to ts 1000 in the
+// segment of key "a" and stops there.
+void GroupAndSortOptimized::FilterTsRangeOptimized(const PhysicalOpNode* in,
+                                                   Filter* filter) {
+    if (PhysicalOpType::kPhysicalOpDataProvider != in->GetOpType() ||
+        !filter->condition_.ValidCondition()) {
+        return;
+    }
+    auto provider = dynamic_cast<const PhysicalDataProviderNode*>(in);
+    if (DataProviderType::kProviderTypePartition != provider->provider_type_) {
+        return;
+    }
+    auto partition = dynamic_cast<const PhysicalPartitionProviderNode*>(in);
+    auto& index_hint = provider->table_handler_->GetIndex();
+    auto iter = index_hint.find(partition->index_name_);
+    if (iter == index_hint.cend() || INVALID_POS == iter->second.ts_pos) {
+        return;
+    }
+    // segment keys are unsigned
+    int64_t start = 0;
+    int64_t end = INT64_MAX;
+    if (ConditionOptimized::ExtractColumnRange(
+            in->schemas_ctx(), iter->second.ts_pos,
+            filter->condition_.condition(), &start, &end)) {
+        filter->set_ts_range(start, end);
+    }
+}
+
 bool GroupAndSortOptimized::GroupOptimized(
     const SchemasContext* root_schemas_ctx, PhysicalOpNode* in, Key* group,
     PhysicalOpNode** new_in) {
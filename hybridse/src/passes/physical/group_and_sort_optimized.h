@@ -61,6 +61,7 @@ class GroupAndSortOptimized : public TransformUpPysicalPass {
     bool FilterOptimized(const SchemasContext* root_schemas_ctx,
                          PhysicalOpNode* in, Filter* filter,
                          PhysicalOpNode** new_in);
+    void FilterTsRangeOptimized(const PhysicalOpNode* in, Filter* filter);
     bool JoinKeysOptimized(const SchemasContext* schemas_ctx,
                            PhysicalOpNode* in, Join* join,
                            PhysicalOpNode** new_in);
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2021 4paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "passes/physical/hash_join_optimized.h"
+
+namespace hybridse {
+namespace passes {
+
+bool HashJoinOptimized::Transform(PhysicalOpNode* in,
+                                  PhysicalOpNode** output) {
+    *output = in;
+    if (vm::kPhysicalOpJoin != in->GetOpType()) {
+        return false;
+    }
+    auto join_op = dynamic_cast<vm::PhysicalJoinNode*>(in);
+    if (node::kJoinTypeLast != join_op->join().join_type()) {
+        return false;
+    }
+    if (join_op->join().index_key().ValidKey()) {
+        DLOG(INFO) << "HashJoin optimized skip: right table join with index";
+        return false;
+    }
+    if (!join_op->join().right_key().ValidKey()) {
+        DLOG(INFO) << "HashJoin optimized skip: join without equal keys";
+        return false;
+    }
+    if (vm::kSchemaTypeTable != join_op->GetProducer(1)->GetOutputType()) {
+        DLOG(INFO) << "HashJoin optimized skip: right input isn't table";
+        return false;
+    }
+    if (vm::kSchemaTypeRow == join_op->GetProducer(0)->GetOutputType()) {
+        DLOG(INFO) << "HashJoin optimized skip: left input is row";
+        return false;
+    }
+    if (join_op->join().hash_join()) {
+        return false;
+    }
+    // the origin join node may be shared by other plans, mark a copy of it
+    vm::Join join(join_op->join_);
+    join.set_hash_join(true);
+    vm::PhysicalJoinNode* new_join_op = nullptr;
+    Status status = plan_ctx_->CreateOp<vm::PhysicalJoinNode>(
+        &new_join_op, join_op->GetProducer(0), join_op->GetProducer(1), join,
+        join_op->output_right_only());
+    if (!status.isOK()) {
+        LOG(WARNING) << "HashJoin optimized fail: " << status;
+        return false;
+    }
+    new_join_op->SetLimitCnt(join_op->GetLimitCnt());
+    *output = new_join_op;
+    return true;
+}
+}  // namespace passes
+}  // namespace hybridse
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2021 4paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_PASSES_PHYSICAL_HASH_JOIN_OPTIMIZED_H_
+#define SRC_PASSES_PHYSICAL_HASH_JOIN_OPTIMIZED_H_
+
+#include "passes/physical/transform_up_physical_pass.h"
+
+namespace hybridse {
+namespace passes {
+
+// Mark batch mode LAST JOIN as hash join when right table has no usable
+// index, so that right rows are bucketed once by right keys instead of
+// being scanned and sorted for each left row
+class HashJoinOptimized : public TransformUpPysicalPass {
+ public:
+    explicit HashJoinOptimized(PhysicalPlanContext* plan_ctx)
+        : TransformUpPysicalPass(plan_ctx) {}
+    ~HashJoinOptimized() {}
+
+ private:
+    bool Transform(PhysicalOpNode* in, PhysicalOpNode** output);
+};
+}  // namespace passes
+}  // namespace hybridse
+
+#endif  // SRC_PASSES_PHYSICAL_HASH_JOIN_OPTIMIZED_H_
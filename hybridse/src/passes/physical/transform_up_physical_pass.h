@@ -34,7 +34,8 @@ enum PhysicalPlanPassType {
     kPassGroupAndSortOptimized,
     kPassLeftJoinOptimized,
     kPassClusterOptimized,
-    kPassLimitOptimized
+    kPassLimitOptimized,
+    kPassHashJoinOptimized
 };
 
 inline std::string PhysicalPlanPassTypeName(PhysicalPlanPassType type) {
@@ -51,6 +52,8 @@ inline std::string PhysicalPlanPassTypeName(PhysicalPlanPassType type) {
             return "PassLimitOptimized";
         case kPassClusterOptimized:
             return "PassClusterOptimized";
+        case kPassHashJoinOptimized:
+            return "PassHashJoinOptimized";
         default:
             return "unknowPass";
     }
@@ -186,6 +186,7 @@ Status ResolveFnAndAttrs::VisitUdafDef(
     *output = ctx_->node_manager()->MakeUdafDefNode(
         lambda->GetName(), arg_types, resolved_init, resolved_update,
         resolved_merge, resolved_output);
+    (*output)->set_list_func(lambda->list_func());
     CHECK_STATUS((*output)->Validate(arg_types), "Illegal resolved udaf: \n",
                  (*output)->GetTreeString());
     return Status::OK();
@@ -15,12 +15,15 @@
 #include "sdk/codec_sdk.h"
 
 #include "butil/iobuf.h"
+#include "codec/type_codec.h"
 
 namespace hybridse {
 namespace sdk {
 
 RowIOBufView::RowIOBufView(const hybridse::codec::Schema& schema)
     : row_(),
+      buf_(nullptr),
+      flat_row_(),
       str_addr_length_(0),
       is_valid_(true),
       string_field_cnt_(0),
@@ -60,16 +63,24 @@ bool RowIOBufView::Init() {
 
 bool RowIOBufView::Reset(const butil::IOBuf& buf) {
     row_ = buf;
+    buf_ = nullptr;
     if (schema_.size() == 0 || row_.size() <= codec::HEADER_LENGTH) {
         is_valid_ = false;
         return false;
     }
+    if (row_.backing_block_num() == 1) {
+        buf_ = reinterpret_cast<const int8_t*>(row_.backing_block(0).data());
+    } else {
+        // the row is split across blocks, which is rare
+        row_.copy_to(&flat_row_);
+        buf_ = reinterpret_cast<const int8_t*>(flat_row_.data());
+    }
     size_ = row_.size();
-    uint32_t tmp_size = 0;
-    row_.copy_to(reinterpret_cast<void*>(&tmp_size), codec::SIZE_LENGTH,
-                 codec::VERSION_LENGTH);
+    uint32_t tmp_size =
+        *(reinterpret_cast<const uint32_t*>(buf_ + codec::VERSION_LENGTH));
     if (tmp_size != size_) {
         is_valid_ = false;
+        buf_ = nullptr;
         return false;
     }
     str_addr_length_ = codec::GetAddrLength(size_);
@@ -78,103 +89,103 @@ bool RowIOBufView::Reset(const butil::IOBuf& buf) {
 }
 
 int32_t RowIOBufView::GetBool(uint32_t idx, bool* val) {
-    if (val == NULL) return -1;
+    if (val == NULL || buf_ == nullptr) return -1;
     if (IsNULL(idx)) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetBoolField(row_, offset) == 1 ? true : false;
+    *val = codec::v1::GetBoolFieldUnsafe(buf_, offset) == 1 ? true : false;
     return 0;
 }
 
 int32_t RowIOBufView::GetInt16(uint32_t idx, int16_t* val) {
-    if (val == NULL) return -1;
+    if (val == NULL || buf_ == nullptr) return -1;
     if (IsNULL(idx)) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetInt16Field(row_, offset);
+    *val = codec::v1::GetInt16FieldUnsafe(buf_, offset);
     return 0;
 }
 
 int32_t RowIOBufView::GetInt32(uint32_t idx, int32_t* val) {
-    if (val == NULL) return -1;
+    if (val == NULL || buf_ == nullptr) return -1;
     if (IsNULL(idx)) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetInt32Field(row_, offset);
+    *val = codec::v1::GetInt32FieldUnsafe(buf_, offset);
     return 0;
 }
 
 int32_t RowIOBufView::GetInt64(uint32_t idx, int64_t* val) {
-    if (val == NULL) return -1;
+    if (val == NULL || buf_ == nullptr) return -1;
     if (IsNULL(idx)) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetInt64Field(row_, offset);
+    *val = codec::v1::GetInt64FieldUnsafe(buf_, offset);
     return 0;
 }
 
 int32_t RowIOBufView::GetFloat(uint32_t idx, float* val) {
-    if (val == NULL) return -1;
+    if (val == NULL || buf_ == nullptr) return -1;
     if (IsNULL(idx)) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetFloatField(row_, offset);
+    *val = codec::v1::GetFloatFieldUnsafe(buf_, offset);
     return 0;
 }
 
 int32_t RowIOBufView::GetDouble(uint32_t idx, double* val) {
-    if (val == NULL) return -1;
+    if (val == NULL || buf_ == nullptr) return -1;
     if (IsNULL(idx)) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetDoubleField(row_, offset);
+    *val = codec::v1::GetDoubleFieldUnsafe(buf_, offset);
     return 0;
 }
 
 int32_t RowIOBufView::GetTimestamp(uint32_t idx, int64_t* val) {
-    if (val == NULL) return -1;
+    if (val == NULL || buf_ == nullptr) return -1;
     if (IsNULL(idx)) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *val = v1::GetInt64Field(row_, offset);
+    *val = codec::v1::GetInt64FieldUnsafe(buf_, offset);
     return 0;
 }
 int32_t RowIOBufView::GetDate(uint32_t idx, int32_t* date) {
-    if (date == NULL) {
+    if (date == NULL || buf_ == nullptr) {
         return -1;
     }
     if (IsNULL(idx)) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    *date = static_cast<int32_t>(v1::GetInt32Field(row_, offset));
+    *date = codec::v1::GetInt32FieldUnsafe(buf_, offset);
     return 0;
 }
 int32_t RowIOBufView::GetDate(uint32_t idx, int32_t* year, int32_t* month,
                               int32_t* day) {
-    if (year == NULL || month == NULL || day == NULL) {
+    if (year == NULL || month == NULL || day == NULL || buf_ == nullptr) {
         return -1;
     }
     if (IsNULL(idx)) {
         return 1;
     }
     uint32_t offset = offset_vec_.at(idx);
-    int32_t date = static_cast<int32_t>(v1::GetInt32Field(row_, offset));
+    int32_t date = codec::v1::GetInt32FieldUnsafe(buf_, offset);
     *day = date & 0x0000000FF;
     date = date >> 8;
     *month = 1 + (date & 0x0000FF);
     *year = 1900 + (date >> 8);
     return 0;
 }
-int32_t RowIOBufView::GetString(uint32_t idx, butil::IOBuf* buf) {
-    if (buf == NULL) return -1;
+int32_t RowIOBufView::GetString(uint32_t idx, char** val, uint32_t* length) {
+    if (val == NULL || length == NULL || buf_ == nullptr) return -1;
     if (IsNULL(idx)) {
         return 1;
     }
@@ -183,8 +194,24 @@ int32_t RowIOBufView::GetString(uint32_t idx, butil::IOBuf* buf) {
     if (offset_vec_.at(idx) < string_field_cnt_ - 1) {
         next_str_field_offset = field_offset + 1;
     }
-    return v1::GetStrField(row_, field_offset, next_str_field_offset,
-                           str_field_start_offset_, str_addr_length_, buf);
+    const char* data = nullptr;
+    int32_t ret = codec::v1::GetStrFieldUnsafe(
+        buf_, idx, field_offset, next_str_field_offset,
+        str_field_start_offset_, str_addr_length_, &data, length);
+    *val = const_cast<char*>(data);
+    return ret;
+}
+int32_t RowIOBufView::GetString(uint32_t idx, butil::IOBuf* buf) {
+    if (buf == NULL) return -1;
+    char* data = nullptr;
+    uint32_t length = 0;
+    int32_t ret = GetString(idx, &data, &length);
+    if (ret != 0) {
+        return ret;
+    }
+    // share the block of the row
+    row_.append_to(buf, length, data - reinterpret_cast<const char*>(buf_));
+    return 0;
 }
 
 namespace v1 {
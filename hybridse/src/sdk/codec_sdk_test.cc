@@ -214,6 +214,54 @@ TEST_F(CodecSDKTest, Encode) {
     }
 }
 
+TEST_F(CodecSDKTest, SplitRowTest) {
+    codec::Schema schema;
+    ::hybridse::type::ColumnDef* col = schema.Add();
+    col->set_name("col1");
+    col->set_type(::hybridse::type::kInt64);
+    col = schema.Add();
+    col->set_name("col2");
+    col->set_type(::hybridse::type::kVarchar);
+    col = schema.Add();
+    col->set_name("col3");
+    col->set_type(::hybridse::type::kDouble);
+    codec::RowBuilder builder(schema);
+    std::string st("hello");
+    uint32_t size = builder.CalTotalLength(st.size());
+    std::string row;
+    row.resize(size);
+    builder.SetBuffer(reinterpret_cast<int8_t*>(&(row[0])), size);
+    ASSERT_TRUE(builder.AppendInt64(-7));
+    ASSERT_TRUE(builder.AppendString(st.c_str(), st.size()));
+    ASSERT_TRUE(builder.AppendDouble(1.5));
+    // the row is split in the middle of the int64 field
+    std::string head = row.substr(0, 10);
+    std::string tail = row.substr(10);
+    butil::IOBuf buf;
+    buf.append_user_data(&head[0], head.size(), [](void*) {});
+    buf.append_user_data(&tail[0], tail.size(), [](void*) {});
+    ASSERT_EQ(2u, buf.backing_block_num());
+    butil::IOBuf one_block;
+    one_block.append(row);
+    for (auto& input : {buf, one_block}) {
+        RowIOBufView view(schema);
+        ASSERT_TRUE(view.Reset(input));
+        int64_t val = 0;
+        ASSERT_EQ(view.GetInt64(0, &val), 0);
+        ASSERT_EQ(val, -7);
+        char* data = nullptr;
+        uint32_t length = 0;
+        ASSERT_EQ(view.GetString(1, &data, &length), 0);
+        ASSERT_EQ(st, std::string(data, length));
+        butil::IOBuf str_buf;
+        ASSERT_EQ(view.GetString(1, &str_buf), 0);
+        ASSERT_EQ(st, str_buf.to_string());
+        double val1 = 0;
+        ASSERT_EQ(view.GetDouble(2, &val1), 0);
+        ASSERT_EQ(val1, 1.5);
+    }
+}
+
 }  // namespace sdk
 }  // namespace hybridse
 
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// udf plugin loaded by udf_library_test
+
+#include "udf/udf_plugin.h"
+
+namespace {
+
+int64_t test_plugin_add(int64_t x, int64_t y) { return x + y; }
+
+int64_t test_plugin_sum_square_update(int64_t state, int64_t x) {
+    return state + x * x;
+}
+
+int64_t test_plugin_sum_square_output(int64_t state) { return state; }
+
+}  // namespace
+
+HYBRIDSE_UDF_PLUGIN(library) {
+    library->RegisterExternal("test_plugin_add")
+        .args<int64_t, int64_t>(test_plugin_add)
+        .doc("@brief Add two int64");
+    library->RegisterUdaf("test_plugin_sum_square")
+        .templates<int64_t, int64_t, int64_t>()
+        .const_init(int64_t(0))
+        .update("test_plugin_sum_square_update",
+                test_plugin_sum_square_update)
+        .output("test_plugin_sum_square_output",
+                test_plugin_sum_square_output)
+        .finalize();
+    return true;
+}
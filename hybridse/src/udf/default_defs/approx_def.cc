@@ -0,0 +1,294 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "udf/containers.h"
+#include "udf/default_udf_library.h"
+#include "udf/sketches.h"
+#include "udf/udf.h"
+#include "udf/udf_registry.h"
+
+using hybridse::codec::Date;
+using hybridse::codec::StringRef;
+using hybridse::codec::Timestamp;
+
+namespace hybridse {
+namespace udf {
+
+template <typename T>
+struct ApproxDistinctCountDef {
+    using InputT = typename DataTypeTrait<T>::CCallArgType;
+    using StorageT = typename container::ContainerStorageTypeTrait<T>::type;
+    using ContainerT = container::HyperLogLog;
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix = ".opaque_hll_" + DataTypeTrait<T>::to_string();
+        helper.templates<int64_t, Opaque<ContainerT>, Nullable<T>>()
+            .init("approx_distinct_count_init" + suffix, Init)
+            .update("approx_distinct_count_update" + suffix, Update)
+            .merge("approx_distinct_count_merge" + suffix,
+                   reinterpret_cast<void*>(Merge))
+            .output("approx_distinct_count_output" + suffix, Output);
+    }
+
+    static void Init(ContainerT* addr) { new (addr) ContainerT(); }
+
+    static ContainerT* Update(ContainerT* ptr, InputT value, bool is_null) {
+        if (!is_null) {
+            StorageT stored =
+                container::ContainerStorageTypeTrait<T>::to_stored_value(
+                    value);
+            ptr->Add(container::SketchHash(stored));
+        }
+        return ptr;
+    }
+
+    // `other` is released like an output state
+    static ContainerT* Merge(ContainerT* ptr, ContainerT* other) {
+        ptr->Merge(*other);
+        other->~ContainerT();
+        return ptr;
+    }
+
+    static int64_t Output(ContainerT* ptr) {
+        int64_t cnt = ptr->Estimate();
+        ptr->~ContainerT();
+        return cnt;
+    }
+};
+
+template <typename T>
+struct ApproxPercentileDef {
+    struct ContainerT {
+        container::TDigest digest;
+        double percentage = 0.5;
+    };
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix =
+            ".opaque_tdigest_" + DataTypeTrait<T>::to_string();
+        helper.templates<double, Opaque<ContainerT>, Nullable<T>, double>()
+            .init("approx_percentile_init" + suffix, Init)
+            .update("approx_percentile_update" + suffix, Update)
+            .merge("approx_percentile_merge" + suffix,
+                   reinterpret_cast<void*>(Merge))
+            .output("approx_percentile_output" + suffix, Output);
+    }
+
+    static void Init(ContainerT* addr) { new (addr) ContainerT(); }
+
+    static ContainerT* Update(ContainerT* ptr, T value, bool is_null,
+                              double percentage) {
+        ptr->percentage = percentage;
+        if (!is_null) {
+            ptr->digest.Add(static_cast<double>(value));
+        }
+        return ptr;
+    }
+
+    static ContainerT* Merge(ContainerT* ptr, ContainerT* other) {
+        if (ptr->digest.total_weight() <= 0) {
+            ptr->percentage = other->percentage;
+        }
+        ptr->digest.Merge(other->digest);
+        other->~ContainerT();
+        return ptr;
+    }
+
+    static double Output(ContainerT* ptr) {
+        double result = ptr->digest.Quantile(ptr->percentage);
+        ptr->~ContainerT();
+        return result;
+    }
+};
+
+template <typename T>
+struct ApproxTopKDef {
+    using InputT = typename DataTypeTrait<T>::CCallArgType;
+    using StorageT = typename container::ContainerStorageTypeTrait<T>::type;
+
+    // keep more keys than asked to bound the error of the last ones
+    static const size_t CAPACITY_FACTOR = 4;
+    static const size_t MIN_CAPACITY = 64;
+    static const size_t MAXIMUM_TOPN = 1024;
+
+    struct ContainerT {
+        container::SpaceSaving<StorageT> sketch;
+        size_t top_n = 0;
+    };
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix =
+            ".opaque_space_saving_" + DataTypeTrait<T>::to_string();
+        helper.templates<StringRef, Opaque<ContainerT>, Nullable<T>, int32_t>()
+            .init("approx_top_k_init" + suffix, Init)
+            .update("approx_top_k_update" + suffix, Update)
+            .merge("approx_top_k_merge" + suffix,
+                   reinterpret_cast<void*>(Merge))
+            .output("approx_top_k_output" + suffix, Output);
+    }
+
+    static void Init(ContainerT* addr) { new (addr) ContainerT(); }
+
+    static ContainerT* Update(ContainerT* ptr, InputT value, bool is_null,
+                              int32_t top_n) {
+        if (ptr->top_n == 0 && top_n > 0) {
+            ptr->top_n = std::min(static_cast<size_t>(top_n), MAXIMUM_TOPN);
+            ptr->sketch.set_capacity(
+                std::max(ptr->top_n * CAPACITY_FACTOR, MIN_CAPACITY));
+        }
+        if (!is_null) {
+            ptr->sketch.Add(
+                container::ContainerStorageTypeTrait<T>::to_stored_value(
+                    value));
+        }
+        return ptr;
+    }
+
+    static ContainerT* Merge(ContainerT* ptr, ContainerT* other) {
+        if (ptr->top_n == 0) {
+            ptr->top_n = other->top_n;
+        }
+        ptr->sketch.Merge(other->sketch);
+        other->~ContainerT();
+        return ptr;
+    }
+
+    static void Output(ContainerT* ptr, StringRef* output) {
+        auto top = ptr->sketch.TopK(ptr->top_n);
+        if (top.empty()) {
+            output->data_ = "";
+            output->size_ = 0;
+            ptr->~ContainerT();
+            return;
+        }
+        // "k,k,k"
+        uint32_t str_len = 0;
+        for (auto& kv : top) {
+            str_len += v1::to_string_len(kv.first) + 1;
+        }
+        char* buffer = udf::v1::AllocManagedStringBuf(str_len);
+        char* cur = buffer;
+        uint32_t remain_space = str_len;
+        for (auto& kv : top) {
+            uint32_t key_len = v1::format_string(kv.first, cur, remain_space);
+            cur += key_len;
+            remain_space -= key_len;
+            if (remain_space-- > 0) {
+                *(cur++) = ',';
+            }
+        }
+        *(buffer + str_len - 1) = '\0';
+        output->data_ = buffer;
+        output->size_ = str_len - 1;
+        ptr->~ContainerT();
+    }
+};
+
+void DefaultUdfLibrary::InitApproxUdafs() {
+    RegisterUdafTemplate<ApproxDistinctCountDef>("approx_distinct_count")
+        .doc(R"(
+            @brief Compute approximate number of distinct values with
+            HyperLogLog, with a standard error of about 1.6%. Null values
+            are ignored.
+
+            Memory usage is fixed, no matter how many distinct values the
+            window has.
+
+            @param value  Specify value column to aggregate on.
+
+            Example:
+
+            |value|
+            |--|
+            |0|
+            |0|
+            |2|
+            |2|
+            |4|
+            @code{.sql}
+                SELECT approx_distinct_count(value) OVER w;
+                -- output 3
+            @endcode
+            @since 0.4.0
+        )")
+        .args_in<bool, int16_t, int32_t, int64_t, float, double, Timestamp,
+                 Date, StringRef>();
+
+    RegisterUdafTemplate<ApproxPercentileDef>("approx_percentile")
+        .doc(R"(
+            @brief Compute approximate percentile of values with t-digest,
+            which is more accurate towards both ends. Null values are
+            ignored, and NaN is returned for windows of null values only.
+
+            @param value  Specify value column to aggregate on.
+            @param percentage  Percentage between 0 and 1, e.g. 0.99 for p99.
+
+            Example:
+
+            |value|
+            |--|
+            |1|
+            |2|
+            |3|
+            |4|
+            |5|
+            @code{.sql}
+                SELECT approx_percentile(value, 0.5) OVER w;
+                -- output 3
+            @endcode
+            @since 0.4.0
+        )")
+        .args_in<int16_t, int32_t, int64_t, float, double>();
+
+    RegisterUdafTemplate<ApproxTopKDef>("approx_top_k")
+        .doc(R"(
+            @brief Compute approximate most frequent k values with
+            space-saving counters, and output string separated by comma.
+            The most frequent value is the first. Null values are ignored.
+
+            Values which take more than 1 / (4 * k) of the window are always
+            found.
+
+            @param value  Specify value column to aggregate on.
+            @param k  Fetch top k values, at most 1024.
+
+            Example:
+
+            |value|
+            |--|
+            |1|
+            |2|
+            |2|
+            |3|
+            |3|
+            |3|
+            @code{.sql}
+                SELECT approx_top_k(value, 2) OVER w;
+                -- output "3,2"
+            @endcode
+            @since 0.4.0
+        )")
+        .args_in<int16_t, int32_t, int64_t, float, double, Date, Timestamp,
+                 StringRef>();
+}
+
+}  // namespace udf
+}  // namespace hybridse
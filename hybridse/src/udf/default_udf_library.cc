@@ -27,6 +27,7 @@
 #include "codegen/string_ir_builder.h"
 #include "codegen/timestamp_ir_builder.h"
 #include "udf/containers.h"
+#include "udf/simd_kernels.h"
 #include "udf/udf.h"
 #include "udf/udf_registry.h"
 
@@ -97,8 +98,8 @@ struct BuildGetSecondUdf {
 template <typename T>
 struct SumUdafDef {
     void operator()(UdafRegistryHelper& helper) {  // NOLINT
-        helper.templates<T, T, T>()
-            .const_init(T(0))
+        auto impl = helper.templates<T, T, T>();
+        impl.const_init(T(0))
             .update([](UdfResolveContext* ctx, ExprNode* cur_sum,
                        ExprNode* input) {
                 auto nm = ctx->node_manager();
@@ -108,14 +109,18 @@ struct SumUdafDef {
                 return nm->MakeCondExpr(is_null, cur_sum, new_sum);
             })
             .output("identity");
+        if constexpr (simd::IsVectorizable<T>::value) {
+            impl.list_fn("sum_list." + DataTypeTrait<T>::to_string(),
+                         reinterpret_cast<void*>(simd::SumList<T>));
+        }
     }
 };
 
 template <typename T>
 struct MinUdafDef {
     void operator()(UdafRegistryHelper& helper) {  // NOLINT
-        helper.templates<T, Tuple<bool, T>, T>()
-            .const_init(MakeTuple(true, DataTypeTrait<T>::maximum_value()))
+        auto impl = helper.templates<T, Tuple<bool, T>, T>();
+        impl.const_init(MakeTuple(true, DataTypeTrait<T>::maximum_value()))
             .update([](UdfResolveContext* ctx, ExprNode* state,
                        ExprNode* input) {
                 auto nm = ctx->node_manager();
@@ -140,6 +145,10 @@ struct MinUdafDef {
                                      nm->MakeConstNode()),
                     cur_min);
             });
+        if constexpr (simd::IsVectorizable<T>::value) {
+            impl.list_fn("min_list." + DataTypeTrait<T>::to_string(),
+                         reinterpret_cast<void*>(simd::MinList<T>), true);
+        }
     }
 };
 
@@ -177,8 +186,8 @@ struct MinUdafDef<StringRef> {
 template <typename T>
 struct MaxUdafDef {
     void operator()(UdafRegistryHelper& helper) {  // NOLINT
-        helper.templates<T, Tuple<bool, T>, T>()
-            .const_init(MakeTuple(true, DataTypeTrait<T>::minimum_value()))
+        auto impl = helper.templates<T, Tuple<bool, T>, T>();
+        impl.const_init(MakeTuple(true, DataTypeTrait<T>::minimum_value()))
             .update([](UdfResolveContext* ctx, ExprNode* state,
                        ExprNode* input) {
                 auto nm = ctx->node_manager();
@@ -203,6 +212,10 @@ struct MaxUdafDef {
                                      nm->MakeConstNode()),
                     cur_max);
             });
+        if constexpr (simd::IsVectorizable<T>::value) {
+            impl.list_fn("max_list." + DataTypeTrait<T>::to_string(),
+                         reinterpret_cast<void*>(simd::MaxList<T>), true);
+        }
     }
 };
 
@@ -226,8 +239,8 @@ struct CountUdafDef {
 template <typename T>
 struct AvgUdafDef {
     void operator()(UdafRegistryHelper& helper) {  // NOLINT
-        helper.templates<double, Tuple<int64_t, double>, T>()
-            .const_init(MakeTuple(static_cast<int64_t>(0), 0.0))
+        auto impl = helper.templates<double, Tuple<int64_t, double>, T>();
+        impl.const_init(MakeTuple(static_cast<int64_t>(0), 0.0))
             .update(
                 [](UdfResolveContext* ctx, ExprNode* state, ExprNode* input) {
                     auto nm = ctx->node_manager();
@@ -250,6 +263,10 @@ struct AvgUdafDef {
                     nm->MakeBinaryExprNode(sum, cnt, node::kFnOpFDiv);
                 return avg;
             });
+        if constexpr (simd::IsVectorizable<T>::value) {
+            impl.list_fn("avg_list." + DataTypeTrait<T>::to_string(),
+                         reinterpret_cast<void*>(simd::AvgList<T>));
+        }
     }
 };
 
@@ -316,8 +333,8 @@ struct SumWhereDef {
 template <typename T>
 struct CountWhereDef {
     void operator()(UdafRegistryHelper& helper) {  // NOLINT
-        helper.templates<int64_t, int64_t, T, bool>()
-            .const_init(0)
+        auto impl = helper.templates<int64_t, int64_t, T, bool>();
+        impl.const_init(0)
             .update([](UdfResolveContext* ctx, ExprNode* cnt, ExprNode* elem,
                        ExprNode* cond) {
                 auto nm = ctx->node_manager();
@@ -330,6 +347,10 @@ struct CountWhereDef {
                 return update;
             })
             .output("identity");
+        if constexpr (simd::IsVectorizable<T>::value) {
+            impl.list_fn("count_where_list." + DataTypeTrait<T>::to_string(),
+                         reinterpret_cast<void*>(simd::CountWhereList<T>));
+        }
     }
 };
 
@@ -2051,6 +2072,7 @@ void DefaultUdfLibrary::InitUdaf() {
                  StringRef>();
 
     InitAggByCateUdafs();
+    InitApproxUdafs();
 }
 
 }  // namespace udf
@@ -0,0 +1,296 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udf/simd_kernels.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "codec/list_iterator_codec.h"
+
+// ifunc based dispatch is only available for elf targets of gcc and clang
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__ELF__)
+#define SIMD_KERNEL \
+    __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SIMD_KERNEL
+#endif
+
+namespace hybridse {
+namespace udf {
+namespace simd {
+
+// Independent accumulators of a reduction, enough to fill a 512 bits
+// register of 16 bits values. Without them floating point reductions can
+// not be vectorized, since reassociation is not allowed.
+static const size_t LANES = 32;
+
+template <typename T, typename Acc>
+static inline Acc SumImpl(const T* values, size_t size) {
+    Acc lanes[LANES] = {0};
+    size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        for (size_t j = 0; j < LANES; ++j) {
+            lanes[j] += static_cast<Acc>(values[i + j]);
+        }
+    }
+    Acc sum = 0;
+    for (size_t j = 0; j < LANES; ++j) {
+        sum += lanes[j];
+    }
+    for (; i < size; ++i) {
+        sum += static_cast<Acc>(values[i]);
+    }
+    return sum;
+}
+
+// `v < cur ? v : cur` keeps `cur` if `v` is NaN
+template <typename T>
+static inline T MinImpl(const T* values, size_t size, T init) {
+    T lanes[LANES];
+    for (size_t j = 0; j < LANES; ++j) {
+        lanes[j] = init;
+    }
+    size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        for (size_t j = 0; j < LANES; ++j) {
+            T v = values[i + j];
+            lanes[j] = v < lanes[j] ? v : lanes[j];
+        }
+    }
+    T res = init;
+    for (size_t j = 0; j < LANES; ++j) {
+        res = lanes[j] < res ? lanes[j] : res;
+    }
+    for (; i < size; ++i) {
+        res = values[i] < res ? values[i] : res;
+    }
+    return res;
+}
+
+template <typename T>
+static inline T MaxImpl(const T* values, size_t size, T init) {
+    T lanes[LANES];
+    for (size_t j = 0; j < LANES; ++j) {
+        lanes[j] = init;
+    }
+    size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        for (size_t j = 0; j < LANES; ++j) {
+            T v = values[i + j];
+            lanes[j] = v > lanes[j] ? v : lanes[j];
+        }
+    }
+    T res = init;
+    for (size_t j = 0; j < LANES; ++j) {
+        res = lanes[j] > res ? lanes[j] : res;
+    }
+    for (; i < size; ++i) {
+        res = values[i] > res ? values[i] : res;
+    }
+    return res;
+}
+
+// unsigned sums wrap around without undefined behavior
+SIMD_KERNEL int16_t Sum(const int16_t* values, size_t size) {
+    return static_cast<int16_t>(SumImpl<uint16_t, uint16_t>(
+        reinterpret_cast<const uint16_t*>(values), size));
+}
+SIMD_KERNEL int32_t Sum(const int32_t* values, size_t size) {
+    return static_cast<int32_t>(SumImpl<uint32_t, uint32_t>(
+        reinterpret_cast<const uint32_t*>(values), size));
+}
+SIMD_KERNEL int64_t Sum(const int64_t* values, size_t size) {
+    return static_cast<int64_t>(SumImpl<uint64_t, uint64_t>(
+        reinterpret_cast<const uint64_t*>(values), size));
+}
+SIMD_KERNEL float Sum(const float* values, size_t size) {
+    return SumImpl<float, float>(values, size);
+}
+SIMD_KERNEL double Sum(const double* values, size_t size) {
+    return SumImpl<double, double>(values, size);
+}
+
+SIMD_KERNEL double SumAsDouble(const int16_t* values, size_t size) {
+    return SumImpl<int16_t, double>(values, size);
+}
+SIMD_KERNEL double SumAsDouble(const int32_t* values, size_t size) {
+    return SumImpl<int32_t, double>(values, size);
+}
+SIMD_KERNEL double SumAsDouble(const int64_t* values, size_t size) {
+    return SumImpl<int64_t, double>(values, size);
+}
+SIMD_KERNEL double SumAsDouble(const float* values, size_t size) {
+    return SumImpl<float, double>(values, size);
+}
+SIMD_KERNEL double SumAsDouble(const double* values, size_t size) {
+    return SumImpl<double, double>(values, size);
+}
+
+SIMD_KERNEL int16_t Min(const int16_t* values, size_t size, int16_t init) {
+    return MinImpl(values, size, init);
+}
+SIMD_KERNEL int32_t Min(const int32_t* values, size_t size, int32_t init) {
+    return MinImpl(values, size, init);
+}
+SIMD_KERNEL int64_t Min(const int64_t* values, size_t size, int64_t init) {
+    return MinImpl(values, size, init);
+}
+SIMD_KERNEL float Min(const float* values, size_t size, float init) {
+    return MinImpl(values, size, init);
+}
+SIMD_KERNEL double Min(const double* values, size_t size, double init) {
+    return MinImpl(values, size, init);
+}
+
+SIMD_KERNEL int16_t Max(const int16_t* values, size_t size, int16_t init) {
+    return MaxImpl(values, size, init);
+}
+SIMD_KERNEL int32_t Max(const int32_t* values, size_t size, int32_t init) {
+    return MaxImpl(values, size, init);
+}
+SIMD_KERNEL int64_t Max(const int64_t* values, size_t size, int64_t init) {
+    return MaxImpl(values, size, init);
+}
+SIMD_KERNEL float Max(const float* values, size_t size, float init) {
+    return MaxImpl(values, size, init);
+}
+SIMD_KERNEL double Max(const double* values, size_t size, double init) {
+    return MaxImpl(values, size, init);
+}
+
+SIMD_KERNEL int64_t CountTrue(const bool* values, size_t size) {
+    return static_cast<int64_t>(SumImpl<uint8_t, uint64_t>(
+        reinterpret_cast<const uint8_t*>(values), size));
+}
+
+// call `fn(value, is_null)` on each element of the list in order
+template <typename V, typename F>
+static void ForEachElement(codec::ListRef<V>* list, F fn) {
+    auto list_v = reinterpret_cast<codec::ListV<V>*>(list->list);
+    auto column = dynamic_cast<codec::ColumnImpl<V>*>(list_v);
+    if (column != nullptr) {
+        auto iter = column->root()->GetIterator();
+        if (iter) {
+            V value;
+            bool is_null;
+            for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+                column->GetField(iter->GetValue(), &value, &is_null);
+                fn(value, is_null);
+            }
+        }
+    } else {
+        auto iter = list_v->GetIterator();
+        if (iter) {
+            for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+                fn(iter->GetValue(), false);
+            }
+        }
+    }
+}
+
+template <typename V>
+const V* Gather(codec::ListRef<V>* list, size_t* size) {
+    // std::vector<bool> has no data()
+    using StorageT = typename std::conditional<std::is_same<V, bool>::value,
+                                               uint8_t, V>::type;
+    static thread_local std::vector<StorageT> buffer;
+    buffer.clear();
+    ForEachElement(list, [](const V& value, bool is_null) {
+        if (!is_null) {
+            buffer.push_back(value);
+        }
+    });
+    *size = buffer.size();
+    return reinterpret_cast<const V*>(buffer.data());
+}
+
+template <typename V>
+V SumList(codec::ListRef<V>* list) {
+    size_t size = 0;
+    const V* values = Gather(list, &size);
+    return Sum(values, size);
+}
+
+template <typename V>
+double AvgList(codec::ListRef<V>* list) {
+    size_t size = 0;
+    const V* values = Gather(list, &size);
+    return SumAsDouble(values, size) / static_cast<double>(size);
+}
+
+template <typename V>
+void MinList(codec::ListRef<V>* list, V* output, bool* is_null) {
+    size_t size = 0;
+    const V* values = Gather(list, &size);
+    *is_null = size == 0;
+    *output = Min(values, size, std::numeric_limits<V>::max());
+}
+
+template <typename V>
+void MaxList(codec::ListRef<V>* list, V* output, bool* is_null) {
+    size_t size = 0;
+    const V* values = Gather(list, &size);
+    *is_null = size == 0;
+    *output = Max(values, size, std::numeric_limits<V>::lowest());
+}
+
+template <typename V>
+int64_t CountWhereList(codec::ListRef<V>* list, codec::ListRef<bool>* cond) {
+    // flags[i] is set if the i-th value is not null and the i-th cond is
+    // true, values and conds are aligned so nulls are not skipped here
+    static thread_local std::vector<uint8_t> flags;
+    flags.clear();
+    ForEachElement(list, [](const V&, bool is_null) {
+        flags.push_back(!is_null);
+    });
+    size_t idx = 0;
+    ForEachElement(cond, [&idx](const bool& value, bool is_null) {
+        if (idx < flags.size()) {
+            flags[idx] &= !is_null && value;
+        }
+        ++idx;
+    });
+    if (idx < flags.size()) {
+        flags.resize(idx);
+    }
+    return CountTrue(reinterpret_cast<const bool*>(flags.data()),
+                     flags.size());
+}
+
+#define INSTANTIATE_LIST_KERNELS(V)                                        \
+    template const V* Gather<V>(codec::ListRef<V>*, size_t*);              \
+    template V SumList<V>(codec::ListRef<V>*);                             \
+    template double AvgList<V>(codec::ListRef<V>*);                        \
+    template void MinList<V>(codec::ListRef<V>*, V*, bool*);               \
+    template void MaxList<V>(codec::ListRef<V>*, V*, bool*);               \
+    template int64_t CountWhereList<V>(codec::ListRef<V>*,                 \
+                                       codec::ListRef<bool>*);
+
+INSTANTIATE_LIST_KERNELS(int16_t)
+INSTANTIATE_LIST_KERNELS(int32_t)
+INSTANTIATE_LIST_KERNELS(int64_t)
+INSTANTIATE_LIST_KERNELS(float)
+INSTANTIATE_LIST_KERNELS(double)
+template const bool* Gather<bool>(codec::ListRef<bool>*, size_t*);
+
+#undef INSTANTIATE_LIST_KERNELS
+
+}  // namespace simd
+}  // namespace udf
+}  // namespace hybridse
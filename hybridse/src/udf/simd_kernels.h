@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_UDF_SIMD_KERNELS_H_
+#define SRC_UDF_SIMD_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "codec/type_codec.h"
+
+namespace hybridse {
+namespace udf {
+namespace simd {
+
+/**
+ * Reductions over contiguous values. On x86-64 each kernel is compiled for
+ * avx512f, avx2 and the baseline, and the widest one supported by the cpu
+ * is picked at load time.
+ *
+ * Integer sums wrap around like the scalar `+`. Floating point sums are
+ * accumulated in several lanes, so the rounding may differ slightly from a
+ * sequential sum.
+ */
+
+// types with kernels, i.e. int16_t, int32_t, int64_t, float and double
+template <typename T>
+struct IsVectorizable {
+    static const bool value =
+        std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+        !std::is_same<T, int8_t>::value && !std::is_same<T, uint8_t>::value;
+};
+
+int16_t Sum(const int16_t* values, size_t size);
+int32_t Sum(const int32_t* values, size_t size);
+int64_t Sum(const int64_t* values, size_t size);
+float Sum(const float* values, size_t size);
+double Sum(const double* values, size_t size);
+
+/// Sum of values converted to double, as `avg` does
+double SumAsDouble(const int16_t* values, size_t size);
+double SumAsDouble(const int32_t* values, size_t size);
+double SumAsDouble(const int64_t* values, size_t size);
+double SumAsDouble(const float* values, size_t size);
+double SumAsDouble(const double* values, size_t size);
+
+/// Return `init` if `size` is 0. NaN values are skipped, as `min` does.
+int16_t Min(const int16_t* values, size_t size, int16_t init);
+int32_t Min(const int32_t* values, size_t size, int32_t init);
+int64_t Min(const int64_t* values, size_t size, int64_t init);
+float Min(const float* values, size_t size, float init);
+double Min(const double* values, size_t size, double init);
+
+/// Return `init` if `size` is 0. NaN values are skipped, as `max` does.
+int16_t Max(const int16_t* values, size_t size, int16_t init);
+int32_t Max(const int32_t* values, size_t size, int32_t init);
+int64_t Max(const int64_t* values, size_t size, int64_t init);
+float Max(const float* values, size_t size, float init);
+double Max(const double* values, size_t size, double init);
+
+int64_t CountTrue(const bool* values, size_t size);
+
+/**
+ * Gather all values of a list into a thread local buffer. Window columns
+ * are read from the rows directly instead of through the column iterator,
+ * and their NULL cells are skipped as the builtin udafs do. The buffer is
+ * valid until the next gather of the same type on the thread.
+ */
+template <typename V>
+const V* Gather(codec::ListRef<V>* list, size_t* size);
+
+// Native functions over whole lists for the builtin udafs, see
+// `UdafRegistryHelperImpl::list_fn`.
+template <typename V>
+V SumList(codec::ListRef<V>* list);
+
+template <typename V>
+double AvgList(codec::ListRef<V>* list);
+
+template <typename V>
+void MinList(codec::ListRef<V>* list, V* output, bool* is_null);
+
+template <typename V>
+void MaxList(codec::ListRef<V>* list, V* output, bool* is_null);
+
+template <typename V>
+int64_t CountWhereList(codec::ListRef<V>* list, codec::ListRef<bool>* cond);
+
+}  // namespace simd
+}  // namespace udf
+}  // namespace hybridse
+
+#endif  // SRC_UDF_SIMD_KERNELS_H_
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udf/simd_kernels.h"
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include "codec/fe_row_codec.h"
+#include "codec/list_iterator_codec.h"
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace udf {
+namespace simd {
+
+class SimdKernelsTest : public ::testing::Test {};
+
+template <typename T>
+static std::vector<T> RandomValues(size_t size, T low, T high) {
+    std::mt19937 rand(size);
+    std::vector<T> values;
+    for (size_t i = 0; i < size; ++i) {
+        values.push_back(static_cast<T>(
+            low + (high - low) * (static_cast<double>(rand()) / rand.max())));
+    }
+    return values;
+}
+
+template <typename T>
+static void CheckIntegerKernels() {
+    // sizes around the lanes
+    for (size_t size : {0, 1, 31, 32, 33, 100, 1000}) {
+        auto values = RandomValues<T>(size, std::numeric_limits<T>::lowest(),
+                                      std::numeric_limits<T>::max());
+        T sum = 0;
+        double sum_double = 0;
+        T min = std::numeric_limits<T>::max();
+        T max = std::numeric_limits<T>::lowest();
+        for (T v : values) {
+            // overflow wraps around
+            sum = static_cast<T>(static_cast<uint64_t>(sum) +
+                                 static_cast<uint64_t>(v));
+            sum_double += v;
+            min = std::min(min, v);
+            max = std::max(max, v);
+        }
+        ASSERT_EQ(sum, Sum(values.data(), size));
+        ASSERT_DOUBLE_EQ(sum_double, SumAsDouble(values.data(), size));
+        ASSERT_EQ(min, Min(values.data(), size, std::numeric_limits<T>::max()));
+        ASSERT_EQ(max,
+                  Max(values.data(), size, std::numeric_limits<T>::lowest()));
+    }
+}
+
+TEST_F(SimdKernelsTest, integer_test) {
+    CheckIntegerKernels<int16_t>();
+    CheckIntegerKernels<int32_t>();
+    CheckIntegerKernels<int64_t>();
+}
+
+TEST_F(SimdKernelsTest, float_test) {
+    auto values = RandomValues<double>(1001, -100, 100);
+    double sum = 0;
+    for (double v : values) {
+        sum += v;
+    }
+    ASSERT_NEAR(sum, Sum(values.data(), values.size()), 1e-9);
+
+    std::vector<float> floats(values.begin(), values.end());
+    ASSERT_NEAR(sum, Sum(floats.data(), floats.size()), 1e-2);
+    ASSERT_NEAR(sum, SumAsDouble(floats.data(), floats.size()), 1e-3);
+
+    // NaN is skipped by min and max
+    floats[7] = std::numeric_limits<float>::quiet_NaN();
+    floats[500] = -1000;
+    floats[999] = 1000;
+    ASSERT_EQ(-1000, Min(floats.data(), floats.size(),
+                         std::numeric_limits<float>::max()));
+    ASSERT_EQ(1000, Max(floats.data(), floats.size(),
+                        std::numeric_limits<float>::lowest()));
+}
+
+TEST_F(SimdKernelsTest, count_true_test) {
+    std::vector<uint8_t> conds;
+    int64_t cnt = 0;
+    for (size_t i = 0; i < 1000; ++i) {
+        conds.push_back(i % 3 == 0);
+        cnt += i % 3 == 0;
+    }
+    ASSERT_EQ(cnt, CountTrue(reinterpret_cast<const bool*>(conds.data()),
+                             conds.size()));
+}
+
+TEST_F(SimdKernelsTest, list_test) {
+    std::vector<int32_t> values = {3, 1, 4, 1, 5, 9, 2, 6};
+    codec::ArrayListV<int32_t> list_v(&values);
+    codec::ListRef<int32_t> list;
+    list.list = reinterpret_cast<int8_t*>(&list_v);
+
+    ASSERT_EQ(31, SumList(&list));
+    ASSERT_DOUBLE_EQ(31.0 / 8, AvgList(&list));
+    int32_t res = 0;
+    bool is_null = true;
+    MinList(&list, &res, &is_null);
+    ASSERT_FALSE(is_null);
+    ASSERT_EQ(1, res);
+    MaxList(&list, &res, &is_null);
+    ASSERT_FALSE(is_null);
+    ASSERT_EQ(9, res);
+
+    std::vector<int32_t> empty;
+    codec::ArrayListV<int32_t> empty_v(&empty);
+    codec::ListRef<int32_t> empty_list;
+    empty_list.list = reinterpret_cast<int8_t*>(&empty_v);
+    ASSERT_EQ(0, SumList(&empty_list));
+    ASSERT_TRUE(std::isnan(AvgList(&empty_list)));
+    MinList(&empty_list, &res, &is_null);
+    ASSERT_TRUE(is_null);
+}
+
+TEST_F(SimdKernelsTest, column_with_null_test) {
+    codec::Schema schema;
+    auto col = schema.Add();
+    col->set_name("c1");
+    col->set_type(type::kInt32);
+    col = schema.Add();
+    col->set_name("c2");
+    col->set_type(type::kBool);
+
+    // c1, c2 of each row, -1 is NULL
+    std::vector<std::pair<int32_t, int>> values = {
+        {1, 1}, {-1, 1}, {3, -1}, {4, 0}, {5, 1}, {-1, 0}};
+    std::vector<codec::Row> rows;
+    for (auto& value : values) {
+        codec::RowBuilder builder(schema);
+        uint32_t size = builder.CalTotalLength(0);
+        int8_t* buf = static_cast<int8_t*>(malloc(size));
+        builder.SetBuffer(buf, size);
+        if (value.first < 0) {
+            builder.AppendNULL();
+        } else {
+            builder.AppendInt32(value.first);
+        }
+        if (value.second < 0) {
+            builder.AppendNULL();
+        } else {
+            builder.AppendBool(value.second == 1);
+        }
+        rows.push_back(
+            codec::Row(base::RefCountedSlice::CreateManaged(buf, size)));
+    }
+    codec::ArrayListV<codec::Row> rows_v(&rows);
+    codec::RowFormat format(&schema);
+    codec::ColumnImpl<int32_t> c1_v(&rows_v, 0, 0,
+                                    format.GetColumnInfo(0)->offset);
+    codec::ColumnImpl<bool> c2_v(&rows_v, 0, 1,
+                                 format.GetColumnInfo(1)->offset);
+    codec::ListRef<int32_t> c1;
+    c1.list = reinterpret_cast<int8_t*>(&c1_v);
+    codec::ListRef<bool> c2;
+    c2.list = reinterpret_cast<int8_t*>(&c2_v);
+
+    // NULL cells are skipped as the builtin udafs do
+    ASSERT_EQ(13, SumList(&c1));
+    ASSERT_DOUBLE_EQ(13.0 / 4, AvgList(&c1));
+    int32_t res = 0;
+    bool is_null = true;
+    MinList(&c1, &res, &is_null);
+    ASSERT_FALSE(is_null);
+    ASSERT_EQ(1, res);
+    MaxList(&c1, &res, &is_null);
+    ASSERT_FALSE(is_null);
+    ASSERT_EQ(5, res);
+    // rows 0 and 4, the NULL elements and conds are not aligned
+    ASSERT_EQ(2, CountWhereList(&c1, &c2));
+
+    // all NULL
+    codec::ArrayListV<codec::Row> null_rows_v(&rows, 1, 2);
+    codec::ColumnImpl<int32_t> null_v(&null_rows_v, 0, 0,
+                                      format.GetColumnInfo(0)->offset);
+    codec::ListRef<int32_t> null_list;
+    null_list.list = reinterpret_cast<int8_t*>(&null_v);
+    ASSERT_EQ(0, SumList(&null_list));
+    MinList(&null_list, &res, &is_null);
+    ASSERT_TRUE(is_null);
+    MaxList(&null_list, &res, &is_null);
+    ASSERT_TRUE(is_null);
+}
+
+}  // namespace simd
+}  // namespace udf
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,367 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_UDF_SKETCHES_H_
+#define SRC_UDF_SKETCHES_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "base/fe_hash.h"
+#include "codec/type_codec.h"
+
+namespace hybridse {
+namespace udf {
+namespace container {
+
+/**
+ * Fixed size summaries of a stream of values. Summaries of two streams
+ * merge into the summary of the concatenated stream, so partial results,
+ * e.g. of window segments, can be combined.
+ */
+
+static const uint32_t SKETCH_HASH_SEED = 0xe17a1465;
+
+template <typename T>
+inline uint64_t SketchHash(const T& value) {
+    return base::MurmurHash64A(&value, sizeof(T), SKETCH_HASH_SEED);
+}
+inline uint64_t SketchHash(float value) {
+    // +0.0 and -0.0 are the same value
+    if (value == 0) value = 0;
+    return base::MurmurHash64A(&value, sizeof(float), SKETCH_HASH_SEED);
+}
+inline uint64_t SketchHash(double value) {
+    if (value == 0) value = 0;
+    return base::MurmurHash64A(&value, sizeof(double), SKETCH_HASH_SEED);
+}
+inline uint64_t SketchHash(const codec::StringRef& value) {
+    return base::MurmurHash64A(value.data_, value.size_, SKETCH_HASH_SEED);
+}
+inline uint64_t SketchHash(const codec::Date& value) {
+    return SketchHash(value.date_);
+}
+inline uint64_t SketchHash(const codec::Timestamp& value) {
+    return SketchHash(value.ts_);
+}
+
+/**
+ * HyperLogLog estimation of the number of distinct hashes, with a relative
+ * standard error of about 1.04 / sqrt(2 ^ precision).
+ */
+class HyperLogLog {
+ public:
+    static const uint32_t DEFAULT_PRECISION = 12;
+
+    explicit HyperLogLog(uint32_t precision = DEFAULT_PRECISION)
+        : precision_(precision), registers_(1u << precision, 0) {}
+
+    void Add(uint64_t hash) {
+        uint32_t idx = static_cast<uint32_t>(hash >> (64 - precision_));
+        uint64_t rest = hash << precision_;
+        uint8_t rank = rest == 0 ? static_cast<uint8_t>(64 - precision_ + 1)
+                                 : static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+        if (rank > registers_[idx]) {
+            registers_[idx] = rank;
+        }
+    }
+
+    /// Return false if the precisions differ
+    bool Merge(const HyperLogLog& other) {
+        if (other.precision_ != precision_) {
+            return false;
+        }
+        for (size_t i = 0; i < registers_.size(); ++i) {
+            registers_[i] = std::max(registers_[i], other.registers_[i]);
+        }
+        return true;
+    }
+
+    uint64_t Estimate() const {
+        double m = registers_.size();
+        double sum = 0;
+        size_t zeros = 0;
+        for (uint8_t reg : registers_) {
+            sum += std::ldexp(1.0, -reg);
+            zeros += reg == 0;
+        }
+        double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        // linear counting for small cardinalities
+        if (estimate <= 2.5 * m && zeros > 0) {
+            estimate = m * std::log(m / zeros);
+        }
+        return static_cast<uint64_t>(std::llround(estimate));
+    }
+
+ private:
+    uint32_t precision_;
+    std::vector<uint8_t> registers_;
+};
+
+/**
+ * Merging t-digest for quantiles, which keeps about `compression` centroids
+ * and is more accurate towards both tails.
+ */
+class TDigest {
+ public:
+    static constexpr double DEFAULT_COMPRESSION = 100;
+
+    explicit TDigest(double compression = DEFAULT_COMPRESSION)
+        : compression_(compression),
+          total_weight_(0),
+          min_(std::numeric_limits<double>::infinity()),
+          max_(-std::numeric_limits<double>::infinity()) {}
+
+    void Add(double value, double weight = 1) {
+        if (std::isnan(value) || weight <= 0) {
+            return;
+        }
+        buffer_.push_back({value, weight});
+        total_weight_ += weight;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        if (buffer_.size() >= BufferLimit()) {
+            Compress();
+        }
+    }
+
+    void Merge(const TDigest& other) {
+        if (other.total_weight_ <= 0) {
+            return;
+        }
+        buffer_.insert(buffer_.end(), other.centroids_.begin(),
+                       other.centroids_.end());
+        buffer_.insert(buffer_.end(), other.buffer_.begin(),
+                       other.buffer_.end());
+        total_weight_ += other.total_weight_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        Compress();
+    }
+
+    double total_weight() const { return total_weight_; }
+
+    /// Return NaN if nothing is added
+    double Quantile(double q) {
+        Compress();
+        if (centroids_.empty()) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if (q <= 0 || centroids_.size() == 1) {
+            return q <= 0 ? min_ : centroids_[0].mean;
+        }
+        if (q >= 1) {
+            return max_;
+        }
+        double index = q * total_weight_;
+        // centroid i is centered at the middle of its weight
+        double left_center = centroids_[0].weight / 2;
+        if (index < left_center) {
+            return Interpolate(index, 0, min_, left_center,
+                               centroids_[0].mean);
+        }
+        double cumulative = centroids_[0].weight;
+        for (size_t i = 1; i < centroids_.size(); ++i) {
+            double right_center = cumulative + centroids_[i].weight / 2;
+            if (index < right_center) {
+                return Interpolate(index, left_center, centroids_[i - 1].mean,
+                                   right_center, centroids_[i].mean);
+            }
+            left_center = right_center;
+            cumulative += centroids_[i].weight;
+        }
+        return Interpolate(index, left_center, centroids_.back().mean,
+                           total_weight_, max_);
+    }
+
+ private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    size_t BufferLimit() const {
+        return static_cast<size_t>(compression_) * 5;
+    }
+
+    // k1 scale function and its inverse
+    double ScaleK(double q) const {
+        return compression_ / (2 * M_PI) * std::asin(2 * q - 1);
+    }
+    double ScaleQ(double k) const {
+        return (std::sin(std::min(k * 2 * M_PI / compression_, M_PI / 2)) +
+                1) /
+               2;
+    }
+
+    static double Interpolate(double x, double x0, double y0, double x1,
+                              double y1) {
+        if (x1 <= x0) {
+            return y0;
+        }
+        return y0 + (x - x0) / (x1 - x0) * (y1 - y0);
+    }
+
+    void Compress() {
+        if (buffer_.empty()) {
+            return;
+        }
+        buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+        std::sort(buffer_.begin(), buffer_.end(),
+                  [](const Centroid& l, const Centroid& r) {
+                      return l.mean < r.mean;
+                  });
+        centroids_.clear();
+        Centroid cur = buffer_[0];
+        double weight_so_far = 0;
+        double q_limit = ScaleQ(ScaleK(0) + 1);
+        for (size_t i = 1; i < buffer_.size(); ++i) {
+            const Centroid& next = buffer_[i];
+            double q = (weight_so_far + cur.weight + next.weight) /
+                       total_weight_;
+            if (q <= q_limit) {
+                cur.mean += (next.mean - cur.mean) * next.weight /
+                            (cur.weight + next.weight);
+                cur.weight += next.weight;
+            } else {
+                centroids_.push_back(cur);
+                weight_so_far += cur.weight;
+                q_limit =
+                    ScaleQ(ScaleK(weight_so_far / total_weight_) + 1);
+                cur = next;
+            }
+        }
+        centroids_.push_back(cur);
+        buffer_.clear();
+    }
+
+    double compression_;
+    double total_weight_;
+    double min_;
+    double max_;
+    std::vector<Centroid> centroids_;
+    std::vector<Centroid> buffer_;
+};
+
+/**
+ * Space-saving summary of the most frequent keys, keys with a frequency
+ * above total / capacity are always kept.
+ */
+template <typename K>
+class SpaceSaving {
+ public:
+    explicit SpaceSaving(size_t capacity = 0) : capacity_(capacity) {}
+
+    size_t capacity() const { return capacity_; }
+    void set_capacity(size_t capacity) { capacity_ = capacity; }
+
+    void Add(const K& key, uint64_t cnt = 1) {
+        auto iter = counts_.find(key);
+        if (iter != counts_.end()) {
+            order_.erase({iter->second, key});
+            iter->second += cnt;
+            order_.insert({iter->second, key});
+            return;
+        }
+        if (counts_.size() < capacity_) {
+            counts_.insert(iter, {key, cnt});
+            order_.insert({cnt, key});
+            return;
+        }
+        if (order_.empty()) {
+            return;
+        }
+        // take over the least frequent key, and its count as the error
+        auto min_iter = order_.begin();
+        uint64_t min_cnt = min_iter->first;
+        counts_.erase(min_iter->second);
+        order_.erase(min_iter);
+        counts_.insert({key, min_cnt + cnt});
+        order_.insert({min_cnt + cnt, key});
+    }
+
+    void Merge(const SpaceSaving& other) {
+        // keys missing in one summary may have up to its min count there
+        uint64_t min_self = counts_.size() < capacity_ || order_.empty()
+                                ? 0
+                                : order_.begin()->first;
+        uint64_t min_other =
+            other.counts_.size() < other.capacity_ || other.order_.empty()
+                ? 0
+                : other.order_.begin()->first;
+        std::map<K, uint64_t> merged;
+        for (auto& kv : counts_) {
+            auto iter = other.counts_.find(kv.first);
+            merged[kv.first] = kv.second + (iter == other.counts_.end()
+                                                ? min_other
+                                                : iter->second);
+        }
+        for (auto& kv : other.counts_) {
+            if (counts_.find(kv.first) == counts_.end()) {
+                merged[kv.first] = kv.second + min_self;
+            }
+        }
+        capacity_ = std::max(capacity_, other.capacity_);
+        std::vector<std::pair<uint64_t, K>> entries;
+        for (auto& kv : merged) {
+            entries.push_back({kv.second, kv.first});
+        }
+        std::sort(entries.begin(), entries.end(), Greater);
+        if (entries.size() > capacity_) {
+            entries.resize(capacity_);
+        }
+        counts_.clear();
+        order_.clear();
+        for (auto& entry : entries) {
+            counts_.insert({entry.second, entry.first});
+            order_.insert(entry);
+        }
+    }
+
+    /// Return at most `k` keys, the most frequent first
+    std::vector<std::pair<K, uint64_t>> TopK(size_t k) const {
+        std::vector<std::pair<uint64_t, K>> entries(order_.begin(),
+                                                    order_.end());
+        std::sort(entries.begin(), entries.end(), Greater);
+        std::vector<std::pair<K, uint64_t>> top;
+        for (size_t i = 0; i < k && i < entries.size(); ++i) {
+            top.push_back({entries[i].second, entries[i].first});
+        }
+        return top;
+    }
+
+ private:
+    // by count desc, then key asc
+    static bool Greater(const std::pair<uint64_t, K>& l,
+                        const std::pair<uint64_t, K>& r) {
+        return l.first > r.first || (l.first == r.first && l.second < r.second);
+    }
+
+    size_t capacity_;
+    std::map<K, uint64_t> counts_;
+    std::set<std::pair<uint64_t, K>> order_;
+};
+
+}  // namespace container
+}  // namespace udf
+}  // namespace hybridse
+
+#endif  // SRC_UDF_SKETCHES_H_
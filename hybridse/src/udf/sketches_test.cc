@@ -0,0 +1,121 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udf/sketches.h"
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace udf {
+namespace container {
+
+class SketchesTest : public ::testing::Test {};
+
+TEST_F(SketchesTest, hyper_log_log_test) {
+    HyperLogLog empty;
+    ASSERT_EQ(0u, empty.Estimate());
+
+    HyperLogLog small;
+    for (int64_t i = 0; i < 100; ++i) {
+        small.Add(SketchHash(i % 10));
+    }
+    ASSERT_EQ(10u, small.Estimate());
+
+    HyperLogLog left;
+    HyperLogLog right;
+    for (int64_t i = 0; i < 100000; ++i) {
+        left.Add(SketchHash(i));
+        right.Add(SketchHash(i + 50000));
+    }
+    ASSERT_NEAR(100000, left.Estimate(), 100000 * 0.05);
+    ASSERT_TRUE(left.Merge(right));
+    ASSERT_NEAR(150000, left.Estimate(), 150000 * 0.05);
+    ASSERT_FALSE(left.Merge(HyperLogLog(10)));
+
+    HyperLogLog strs;
+    std::vector<std::string> values = {"a", "b", "c", "a", "b", ""};
+    for (auto& value : values) {
+        strs.Add(SketchHash(codec::StringRef(value)));
+    }
+    ASSERT_EQ(4u, strs.Estimate());
+}
+
+TEST_F(SketchesTest, t_digest_test) {
+    TDigest empty;
+    ASSERT_TRUE(std::isnan(empty.Quantile(0.5)));
+
+    TDigest single;
+    single.Add(3.5);
+    ASSERT_DOUBLE_EQ(3.5, single.Quantile(0.5));
+
+    TDigest left;
+    TDigest right;
+    for (int i = 1; i <= 50000; ++i) {
+        left.Add(i);
+        right.Add(i + 50000);
+    }
+    ASSERT_DOUBLE_EQ(1, left.Quantile(0));
+    ASSERT_DOUBLE_EQ(50000, left.Quantile(1));
+    ASSERT_NEAR(25000, left.Quantile(0.5), 50000 * 0.01);
+    left.Merge(right);
+    ASSERT_DOUBLE_EQ(100000, left.total_weight());
+    ASSERT_NEAR(50000, left.Quantile(0.5), 100000 * 0.01);
+    ASSERT_NEAR(99000, left.Quantile(0.99), 100000 * 0.001);
+    ASSERT_NEAR(1000, left.Quantile(0.01), 100000 * 0.001);
+}
+
+TEST_F(SketchesTest, space_saving_test) {
+    SpaceSaving<int64_t> sketch(8);
+    // 1 is the most frequent, then 2, and noise of distinct keys
+    for (int64_t i = 0; i < 1000; ++i) {
+        sketch.Add(1);
+        if (i % 2 == 0) {
+            sketch.Add(2);
+        }
+        sketch.Add(100 + i);
+    }
+    auto top = sketch.TopK(2);
+    ASSERT_EQ(2u, top.size());
+    ASSERT_EQ(1, top[0].first);
+    ASSERT_EQ(2, top[1].first);
+
+    SpaceSaving<codec::StringRef> left(4);
+    SpaceSaving<codec::StringRef> right(4);
+    std::string a = "a", b = "b", c = "c";
+    for (int i = 0; i < 10; ++i) {
+        left.Add(codec::StringRef(a));
+        right.Add(codec::StringRef(b));
+        right.Add(codec::StringRef(b));
+    }
+    right.Add(codec::StringRef(c));
+    left.Merge(right);
+    auto str_top = left.TopK(3);
+    ASSERT_EQ(3u, str_top.size());
+    ASSERT_EQ("b", str_top[0].first.ToString());
+    ASSERT_EQ(20u, str_top[0].second);
+    ASSERT_EQ("a", str_top[1].first.ToString());
+    ASSERT_EQ("c", str_top[2].first.ToString());
+}
+
+}  // namespace container
+}  // namespace udf
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -194,6 +194,190 @@ TEST_F(UdafTest, topk_test) {
         "top", StringRef(""), MakeList<int32_t>({}), MakeList<int32_t>({}));
 }
 
+TEST_F(UdafTest, approx_distinct_count_test) {
+    CheckUdf<int64_t, ListRef<int32_t>>(
+        "approx_distinct_count", 3, MakeList<int32_t>({0, 0, 2, 2, 4}));
+    CheckUdf<int64_t, ListRef<StringRef>>(
+        "approx_distinct_count", 2,
+        MakeList<StringRef>({StringRef("a"), StringRef("b"), StringRef("a")}));
+    CheckUdf<int64_t, ListRef<Nullable<int64_t>>>(
+        "approx_distinct_count", 2,
+        MakeList<Nullable<int64_t>>({1, nullptr, 3, nullptr, 1}));
+    // empty
+    CheckUdf<int64_t, ListRef<int32_t>>("approx_distinct_count", 0,
+                                        MakeList<int32_t>({}));
+}
+
+TEST_F(UdafTest, approx_percentile_test) {
+    CheckUdf<double, ListRef<int32_t>, ListRef<double>>(
+        "approx_percentile", 3, MakeList<int32_t>({5, 1, 3, 2, 4}),
+        MakeList<double>({0.5, 0.5, 0.5, 0.5, 0.5}));
+    CheckUdf<double, ListRef<double>, ListRef<double>>(
+        "approx_percentile", 5.0, MakeList<double>({5, 1, 3, 2, 4}),
+        MakeList<double>({1, 1, 1, 1, 1}));
+    CheckUdf<double, ListRef<Nullable<int64_t>>, ListRef<double>>(
+        "approx_percentile", 1,
+        MakeList<Nullable<int64_t>>({nullptr, 1, 3}),
+        MakeList<double>({0, 0, 0}));
+    // empty
+    CheckUdf<double, ListRef<double>, ListRef<double>>(
+        "approx_percentile", 0.0 / 0, MakeList<double>({}),
+        MakeList<double>({}));
+}
+
+TEST_F(UdafTest, approx_top_k_test) {
+    CheckUdf<StringRef, ListRef<int32_t>, ListRef<int32_t>>(
+        "approx_top_k", StringRef("3,2"), MakeList<int32_t>({1, 2, 2, 3, 3, 3}),
+        MakeList<int32_t>({2, 2, 2, 2, 2, 2}));
+    CheckUdf<StringRef, ListRef<Nullable<StringRef>>, ListRef<int32_t>>(
+        "approx_top_k", StringRef("b,a"),
+        MakeList<Nullable<StringRef>>(
+            {StringRef("a"), nullptr, StringRef("b"), StringRef("b")}),
+        MakeList<int32_t>({4, 4, 4, 4}));
+    // empty
+    CheckUdf<StringRef, ListRef<int32_t>, ListRef<int32_t>>(
+        "approx_top_k", StringRef(""), MakeList<int32_t>({}),
+        MakeList<int32_t>({}));
+}
+
+// native functions of a udaf registered with external init, update, merge
+// and output functions over an opaque state
+struct ExternalUdafFns {
+    size_t state_bytes = 0;
+    void *init = nullptr;
+    void *update = nullptr;
+    void *merge = nullptr;
+    void *output = nullptr;
+};
+
+static void *GetFnPtr(const node::FnDefNode *fn) {
+    auto external = dynamic_cast<const node::ExternalFnDefNode *>(fn);
+    return external == nullptr ? nullptr : external->function_ptr();
+}
+
+template <class... Args>
+static bool GetExternalUdafFns(const std::string &name,
+                               node::NodeManager *nm, ExternalUdafFns *fns) {
+    std::vector<node::TypeNode *> arg_types(
+        {DataTypeTrait<Args>::to_type_node(nm)...});
+    std::vector<node::ExprNode *> args;
+    for (size_t i = 0; i < arg_types.size(); ++i) {
+        auto expr = nm->MakeExprIdNode("arg_" + std::to_string(i));
+        expr->SetOutputType(arg_types[i]);
+        args.push_back(expr);
+    }
+    node::ExprNode *transformed = nullptr;
+    auto status =
+        DefaultUdfLibrary::get()->Transform(name, args, nm, &transformed);
+    if (!status.isOK() || transformed->GetExprType() != node::kExprCall) {
+        return false;
+    }
+    auto udaf = dynamic_cast<const node::UdafDefNode *>(
+        reinterpret_cast<node::CallExprNode *>(transformed)->GetFnDef());
+    if (udaf == nullptr || !udaf->AllowMerge() ||
+        udaf->init_expr()->GetExprType() != node::kExprCall) {
+        return false;
+    }
+    auto init = dynamic_cast<const node::ExternalFnDefNode *>(
+        reinterpret_cast<node::CallExprNode *>(udaf->init_expr())
+            ->GetFnDef());
+    if (init == nullptr || init->GetReturnType() == nullptr ||
+        init->GetReturnType()->base() != node::kOpaque) {
+        return false;
+    }
+    fns->state_bytes =
+        dynamic_cast<const node::OpaqueTypeNode *>(init->GetReturnType())
+            ->bytes();
+    fns->init = init->function_ptr();
+    fns->update = GetFnPtr(udaf->update_func());
+    fns->merge = GetFnPtr(udaf->merge_func());
+    fns->output = GetFnPtr(udaf->output_func());
+    return fns->update != nullptr && fns->merge != nullptr &&
+           fns->output != nullptr;
+}
+
+TEST_F(UdafTest, approx_merge_test) {
+    // two states merged give the output of one state over all values
+    node::NodeManager nm;
+    ExternalUdafFns fns;
+    ASSERT_TRUE(GetExternalUdafFns<ListRef<Nullable<int32_t>>>(
+        "approx_distinct_count", &nm, &fns));
+    {
+        auto init = reinterpret_cast<void (*)(int8_t *)>(fns.init);
+        auto update =
+            reinterpret_cast<int8_t *(*)(int8_t *, int32_t, bool)>(fns.update);
+        auto merge = reinterpret_cast<int8_t *(*)(int8_t *, int8_t *)>(
+            fns.merge);
+        auto output = reinterpret_cast<int64_t (*)(int8_t *)>(fns.output);
+        std::vector<int8_t> left(fns.state_bytes);
+        std::vector<int8_t> right(fns.state_bytes);
+        init(left.data());
+        init(right.data());
+        for (int32_t i = 0; i < 100; ++i) {
+            update(left.data(), i, false);
+            update(right.data(), i + 50, false);
+        }
+        update(right.data(), 0, true);
+        ASSERT_EQ(left.data(), merge(left.data(), right.data()));
+        ASSERT_NEAR(150, output(left.data()), 150 * 0.05);
+    }
+
+    ASSERT_TRUE(
+        (GetExternalUdafFns<ListRef<Nullable<double>>, ListRef<double>>(
+            "approx_percentile", &nm, &fns)));
+    {
+        auto init = reinterpret_cast<void (*)(int8_t *)>(fns.init);
+        auto update =
+            reinterpret_cast<int8_t *(*)(int8_t *, double, bool, double)>(
+                fns.update);
+        auto merge = reinterpret_cast<int8_t *(*)(int8_t *, int8_t *)>(
+            fns.merge);
+        auto output = reinterpret_cast<double (*)(int8_t *)>(fns.output);
+        std::vector<int8_t> left(fns.state_bytes);
+        std::vector<int8_t> right(fns.state_bytes);
+        init(left.data());
+        init(right.data());
+        for (int32_t i = 1; i <= 50; ++i) {
+            update(left.data(), i, false, 0.5);
+            update(right.data(), i + 50, false, 0.5);
+        }
+        ASSERT_EQ(left.data(), merge(left.data(), right.data()));
+        ASSERT_NEAR(50.5, output(left.data()), 1);
+    }
+
+    ASSERT_TRUE(
+        (GetExternalUdafFns<ListRef<Nullable<int32_t>>, ListRef<int32_t>>(
+            "approx_top_k", &nm, &fns)));
+    {
+        auto init = reinterpret_cast<void (*)(int8_t *)>(fns.init);
+        auto update =
+            reinterpret_cast<int8_t *(*)(int8_t *, int32_t, bool, int32_t)>(
+                fns.update);
+        auto merge = reinterpret_cast<int8_t *(*)(int8_t *, int8_t *)>(
+            fns.merge);
+        auto output =
+            reinterpret_cast<void (*)(int8_t *, StringRef *)>(fns.output);
+        std::vector<int8_t> left(fns.state_bytes);
+        std::vector<int8_t> right(fns.state_bytes);
+        init(left.data());
+        init(right.data());
+        // 1 is the most frequent of the left, 3 of all
+        for (int32_t i = 0; i < 5; ++i) {
+            update(left.data(), 1, false, 2);
+            update(right.data(), 3, false, 2);
+            update(right.data(), 3, false, 2);
+        }
+        for (int32_t i = 0; i < 3; ++i) {
+            update(left.data(), 2, false, 2);
+            update(right.data(), 2, false, 2);
+        }
+        ASSERT_EQ(left.data(), merge(left.data(), right.data()));
+        StringRef result;
+        output(left.data(), &result);
+        ASSERT_EQ("3,2", result.ToString());
+    }
+}
+
 TEST_F(UdafTest, sum_cate_test) {
     CheckUdf<StringRef, ListRef<int32_t>, ListRef<int32_t>>(
         "sum_cate", StringRef("1:4,2:6"), MakeList<int32_t>({1, 2, 3, 4}),
@@ -16,6 +16,7 @@
 
 #include "udf/udf_library.h"
 
+#include <dlfcn.h>
 #include <unordered_set>
 #include <vector>
 #include "boost/algorithm/string/case_conv.hpp"
@@ -24,6 +25,7 @@
 
 #include "codegen/type_ir_builder.h"
 #include "plan/plan_api.h"
+#include "udf/udf_plugin.h"
 #include "udf/udf_registry.h"
 #include "vm/jit_wrapper.h"
 
@@ -238,6 +240,45 @@ Status UdfLibrary::RegisterFromFile(const std::string& path_str) {
     return Status::OK();
 }
 
+Status UdfLibrary::LoadPlugin(const std::string& path) {
+    CHECK_TRUE(plugins_.find(path) == plugins_.end(), kCodegenError,
+               "Udf plugin already loaded: ", path);
+    // symbols of different plugins do not clash with RTLD_LOCAL, the
+    // undefined hybridse symbols of the plugin are still resolved from the
+    // process, see udf/udf_plugin.h
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+        const char* err = dlerror();
+        return Status(kCodegenError, "Fail to load udf plugin " + path + ": " +
+                                         (err == nullptr ? "" : err));
+    }
+    auto abi_version = reinterpret_cast<HybridSeUdfPluginAbiVersion>(
+        dlsym(handle, HYBRIDSE_UDF_PLUGIN_ABI_SYMBOL));
+    auto init = reinterpret_cast<HybridSeUdfPluginInit>(
+        dlsym(handle, HYBRIDSE_UDF_PLUGIN_INIT_SYMBOL));
+    if (abi_version == nullptr || init == nullptr) {
+        dlclose(handle);
+        return Status(kCodegenError,
+                      "Not an udf plugin, " HYBRIDSE_UDF_PLUGIN_INIT_SYMBOL
+                      " is not found: " + path);
+    }
+    if (abi_version() != HYBRIDSE_UDF_PLUGIN_ABI_VERSION) {
+        int32_t version = abi_version();
+        dlclose(handle);
+        return Status(kCodegenError,
+                      "Udf plugin " + path + " is built with abi version " +
+                          std::to_string(version) + ", but " +
+                          std::to_string(HYBRIDSE_UDF_PLUGIN_ABI_VERSION) +
+                          " is required");
+    }
+    // registered functions may point into the plugin, so keep it loaded
+    // even if the init fails halfway
+    plugins_.insert({path, handle});
+    CHECK_TRUE(init(this), kCodegenError, "Fail to init udf plugin ", path);
+    LOG(INFO) << "Udf plugin loaded: " << path;
+    return Status::OK();
+}
+
 Status UdfLibrary::Transform(const std::string& name,
                              const std::vector<node::ExprNode*>& args,
                              node::NodeManager* node_manager,
@@ -111,6 +111,10 @@ class UdfLibrary {
     Status RegisterAlias(const std::string& alias, const std::string& name);
     Status RegisterFromFile(const std::string& path);
 
+    /// Load a native udf plugin, see udf/udf_plugin.h. It should be called at
+    /// startup, before any sql is compiled with the library.
+    Status LoadPlugin(const std::string& path);
+
     template <template <typename> class FTemplate>
     auto RegisterExternalTemplate(const std::string& name) {
         return ExternalTemplateFuncRegistryHelper<FTemplate>(name, this);
@@ -153,6 +157,9 @@ class UdfLibrary {
     // external symbols
     std::unordered_map<std::string, void*> external_symbols_;
 
+    // path -> handle of loaded plugins
+    std::unordered_map<std::string, void*> plugins_;
+
     node::NodeManager nm_;
 
     const bool case_sensitive_ = false;
@@ -16,9 +16,14 @@
 
 #include "udf/udf_library.h"
 #include <gtest/gtest.h>
+#include <memory>
 #include <unordered_set>
 #include <vector>
+#include "case/case_data_mock.h"
+#include "llvm/Support/TargetSelect.h"
+#include "testing/test_base.h"
 #include "udf/udf_registry.h"
+#include "vm/engine.h"
 
 namespace hybridse {
 namespace udf {
@@ -61,11 +66,74 @@ TEST_F(UdfLibraryTest, test_check_list_arg) {
     ASSERT_TRUE(!library.IsListReturn("f2"));
 }
 
+TEST_F(UdfLibraryTest, test_load_plugin_fail) {
+    auto status = library.LoadPlugin("/path/not/exist/libudf.so");
+    ASSERT_FALSE(status.isOK());
+
+    // a shared library without the plugin entry
+    status = library.LoadPlugin("libm.so.6");
+    ASSERT_FALSE(status.isOK());
+    ASSERT_TRUE(status.msg.find("Not an udf plugin") != std::string::npos)
+        << status.msg;
+}
+
+#ifdef HYBRIDSE_TEST_UDF_PLUGIN
+// run `sql` on t1 of rows built by CaseDataMock, return the int64 values
+// of the first output column
+static std::vector<int64_t> RunOnT1(const std::string& sql) {
+    type::TableDef table_def;
+    std::vector<codec::Row> rows;
+    sqlcase::CaseDataMock::BuildTableAndData(table_def, rows, 10);
+    type::Database db;
+    db.set_name("db");
+    vm::AddTable(db, table_def);
+    auto catalog = vm::BuildSimpleCatalog(db);
+    catalog->InsertRows("db", "t1", rows);
+
+    vm::Engine engine(catalog);
+    vm::BatchRunSession session;
+    base::Status status;
+    std::vector<int64_t> result;
+    if (!engine.Get(sql, "db", session, status)) {
+        ADD_FAILURE() << "fail to compile " << sql << ": " << status;
+        return result;
+    }
+    std::vector<codec::Row> output;
+    EXPECT_EQ(0, session.Run(output));
+    codec::RowView row_view(session.GetSchema());
+    for (auto& row : output) {
+        row_view.Reset(row.buf(), row.size());
+        result.push_back(row_view.GetInt64Unsafe(0));
+    }
+    return result;
+}
+
+TEST_F(UdfLibraryTest, test_load_plugin) {
+    // load into the library of engines, as the tablet does
+    auto status = vm::Engine::LoadUdfPlugin(HYBRIDSE_TEST_UDF_PLUGIN);
+    ASSERT_TRUE(status.isOK()) << status;
+    status = vm::Engine::LoadUdfPlugin(HYBRIDSE_TEST_UDF_PLUGIN);
+    ASSERT_FALSE(status.isOK());
+
+    // col5 of the i-th row is 1576571615000 - i
+    auto result = RunOnT1("select test_plugin_add(col5, 1) from t1;");
+    ASSERT_EQ(10u, result.size());
+    for (int64_t i = 0; i < 10; ++i) {
+        ASSERT_EQ(1576571615001 - i, result[i]);
+    }
+    result = RunOnT1(
+        "select test_plugin_sum_square(1576571615000 - col5) from t1;");
+    ASSERT_EQ(std::vector<int64_t>({285}), result);
+}
+#endif
+
 }  // namespace udf
 }  // namespace hybridse
 
 int main(int argc, char** argv) {
     ::testing::GTEST_FLAG(color) = "yes";
     ::testing::InitGoogleTest(&argc, argv);
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
     return RUN_ALL_TESTS();
 }
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_UDF_UDF_PLUGIN_H_
+#define SRC_UDF_UDF_PLUGIN_H_
+
+#include <cstdint>
+
+#include "udf/udf_library.h"
+#include "udf/udf_registry.h"
+
+/**
+ * Native udf plugins are shared libraries which register functions into the
+ * udf library at startup, with the same registry helpers as the builtin
+ * functions, e.g.
+ *
+ * @code
+ *     #include "udf/udf_plugin.h"
+ *
+ *     static int64_t my_add(int64_t x, int64_t y) { return x + y; }
+ *
+ *     HYBRIDSE_UDF_PLUGIN(library) {
+ *         library->RegisterExternal("my_add")
+ *             .args<int64_t, int64_t>(my_add)
+ *             .doc("@brief Add two int64");
+ *         return true;
+ *     }
+ * @endcode
+ *
+ * Udafs register init, update, output and optionally merge functions with
+ * `RegisterUdaf(name).templates<...>()`. Function pointers passed to the
+ * helpers are added to the jit symbols of every compiled sql, so they are
+ * called natively.
+ *
+ * A plugin must be built with the same version of the headers, which is
+ * checked by `HYBRIDSE_UDF_PLUGIN_ABI_VERSION`. It is never unloaded.
+ *
+ * The registry helpers call into hybridse, e.g. `UdfLibrary` and
+ * `NodeManager`, so these symbols must come from the process:
+ *  - do not link the plugin with hybridse_core, leave them undefined, since
+ *    a second copy would register into its own static state;
+ *  - the host binary must export its symbols, i.e. link with -rdynamic or
+ *    load hybridse as a shared library. The tablet and the tests do.
+ *
+ * The plugin is opened with RTLD_LOCAL, so its own symbols do not resolve
+ * the undefined symbols of other plugins and may have the same names. Only
+ * the init function is looked up, and the functions are called through the
+ * pointers given to the registry helpers.
+ */
+
+// bump on incompatible changes of the registry helpers or node types
+#define HYBRIDSE_UDF_PLUGIN_ABI_VERSION 1
+
+#define HYBRIDSE_UDF_PLUGIN_INIT_SYMBOL "hybridse_udf_plugin_init"
+#define HYBRIDSE_UDF_PLUGIN_ABI_SYMBOL "hybridse_udf_plugin_abi_version"
+
+typedef bool (*HybridSeUdfPluginInit)(hybridse::udf::UdfLibrary*);
+typedef int32_t (*HybridSeUdfPluginAbiVersion)();
+
+#define HYBRIDSE_UDF_PLUGIN(library)                                         \
+    static bool HybridSeUdfPluginRegister(hybridse::udf::UdfLibrary*);       \
+    extern "C" int32_t hybridse_udf_plugin_abi_version() {                   \
+        return HYBRIDSE_UDF_PLUGIN_ABI_VERSION;                              \
+    }                                                                        \
+    extern "C" bool hybridse_udf_plugin_init(                                \
+        hybridse::udf::UdfLibrary* library) {                                \
+        return HybridSeUdfPluginRegister(library);                           \
+    }                                                                        \
+    static bool HybridSeUdfPluginRegister(hybridse::udf::UdfLibrary* library)
+
+#endif  // SRC_UDF_UDF_PLUGIN_H_
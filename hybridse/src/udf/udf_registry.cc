@@ -169,8 +169,22 @@ Status UdafRegistry::ResolveFunction(UdfResolveContext* ctx,
             udaf_gen_.output_gen->ResolveFunction(&output_ctx, &output_func),
             "Resolve output function of ", name(), " failed");
     }
-    *result = nm->MakeUdafDefNode(name(), list_types, init_expr, update_func,
-                                  merge_func, output_func);
+    auto udaf = nm->MakeUdafDefNode(name(), list_types, init_expr,
+                                    update_func, merge_func, output_func);
+
+    // the native list function reads elements without null flags
+    if (udaf_gen_.list_gen != nullptr) {
+        bool elem_nullable = false;
+        for (auto list_type : list_types) {
+            elem_nullable |= list_type->IsGenericNullable(0);
+        }
+        node::FnDefNode* list_func = nullptr;
+        if (!elem_nullable &&
+            udaf_gen_.list_gen->ResolveFunction(ctx, &list_func).isOK()) {
+            udaf->set_list_func(list_func);
+        }
+    }
+    *result = udaf;
     return Status::OK();
 }
 
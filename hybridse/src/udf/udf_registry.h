@@ -1451,6 +1451,8 @@ struct UdafDefGen {
     std::shared_ptr<UdfRegistry> update_gen = nullptr;
     std::shared_ptr<UdfRegistry> merge_gen = nullptr;
     std::shared_ptr<UdfRegistry> output_gen = nullptr;
+    // native function over whole input lists, if any
+    std::shared_ptr<UdfRegistry> list_gen = nullptr;
     node::TypeNode* state_type = nullptr;
     bool state_nullable = false;
 };
@@ -1712,6 +1714,31 @@ class UdafRegistryHelperImpl : UdfRegistryHelper<UdafRegistry> {
         return *this;
     }
 
+    /**
+     * Specify a native function over the whole input lists, which is called
+     * instead of the init, update and output loop if no input element is
+     * nullable. Its signature is `OUT fn(ListRef<IN>*...)`, or
+     * `void fn(ListRef<IN>*..., OUT*, bool*)` if `return_nullable` is set.
+     */
+    UdafRegistryHelperImpl& list_fn(const std::string& fname, void* fn_ptr,
+                                    bool return_nullable = false) {
+        std::vector<const node::TypeNode*> list_tys;
+        std::vector<int> list_nullable;
+        for (auto elem_ty : elem_tys_) {
+            list_tys.push_back(library()->node_manager()->MakeTypeNode(
+                node::kList, elem_ty));
+            list_nullable.push_back(false);
+        }
+        auto fn = dynamic_cast<node::ExternalFnDefNode*>(
+            library()->node_manager()->MakeExternalFnDefNode(
+                fname, fn_ptr, output_ty_, return_nullable, list_tys,
+                list_nullable, -1, return_nullable));
+        auto registry = std::make_shared<ExternalFuncRegistry>(fname, fn);
+        udaf_gen_.list_gen = registry;
+        library()->AddExternalFunction(fname, fn_ptr);
+        return *this;
+    }
+
     UdafRegistryHelperImpl& output(const std::string& fname) {
         auto registry = library()->Find(fname, {state_ty_});
         if (registry != nullptr) {
@@ -16,6 +16,7 @@
 
 #ifndef SRC_VM_CATALOG_WRAPPER_H_
 #define SRC_VM_CATALOG_WRAPPER_H_
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -30,6 +31,11 @@ class ProjectFun {
 class PredicateFun {
  public:
     virtual bool operator()(const Row& row, const Row& parameter) const = 0;
+    /// Return `true` and set the closed range of keys out of which no row of
+    /// a descending segment passes the predicate.
+    virtual bool GetKeyRange(uint64_t* start, uint64_t* end) const {
+        return false;
+    }
 };
 class IteratorProjectWrapper : public RowIterator {
  public:
@@ -55,38 +61,61 @@ class IteratorProjectWrapper : public RowIterator {
 };
 class IteratorFilterWrapper : public RowIterator {
  public:
+    // `seek_key_range` is only allowed on iterators in descending key order,
+    // which seek to the end of the predicate key range and stop at its start
     IteratorFilterWrapper(std::unique_ptr<RowIterator> iter,
                           const Row& parameter,
-                          const PredicateFun* fun)
-        : RowIterator(), iter_(std::move(iter)), parameter_(parameter), predicate_(fun) {}
+                          const PredicateFun* fun,
+                          bool seek_key_range = false)
+        : RowIterator(),
+          iter_(std::move(iter)),
+          parameter_(parameter),
+          predicate_(fun),
+          key_start_(0),
+          key_end_(UINT64_MAX),
+          has_key_range_(seek_key_range &&
+                         fun->GetKeyRange(&key_start_, &key_end_)) {}
     virtual ~IteratorFilterWrapper() {}
     bool Valid() const override {
-        return iter_->Valid() && predicate_->operator()(iter_->GetValue(), parameter_);
+        return iter_->Valid() && InKeyRange() &&
+               predicate_->operator()(iter_->GetValue(), parameter_);
     }
     void Next() override {
         iter_->Next();
-        while (iter_->Valid() && !predicate_->operator()(iter_->GetValue(), parameter_)) {
-            iter_->Next();
-        }
+        SkipUnmatched();
     }
     const uint64_t& GetKey() const override { return iter_->GetKey(); }
     const Row& GetValue() override { return iter_->GetValue(); }
     void Seek(const uint64_t& k) override {
-        iter_->Seek(k);
-        while (iter_->Valid() && !predicate_->operator()(iter_->GetValue(), parameter_)) {
-            iter_->Next();
-        }
+        iter_->Seek(has_key_range_ ? std::min(k, key_end_) : k);
+        SkipUnmatched();
     }
     void SeekToFirst() override {
-        iter_->SeekToFirst();
-        while (iter_->Valid() && !predicate_->operator()(iter_->GetValue(), parameter_)) {
-            iter_->Next();
+        if (has_key_range_) {
+            iter_->Seek(key_end_);
+        } else {
+            iter_->SeekToFirst();
         }
+        SkipUnmatched();
     }
     bool IsSeekable() const override { return iter_->IsSeekable(); }
     std::unique_ptr<RowIterator> iter_;
     const Row& parameter_;
     const PredicateFun* predicate_;
+    uint64_t key_start_;
+    uint64_t key_end_;
+    const bool has_key_range_;
+
+ private:
+    bool InKeyRange() const {
+        return !has_key_range_ || iter_->GetKey() >= key_start_;
+    }
+    void SkipUnmatched() {
+        while (iter_->Valid() && InKeyRange() &&
+               !predicate_->operator()(iter_->GetValue(), parameter_)) {
+            iter_->Next();
+        }
+    }
 };
 
 class WindowIteratorProjectWrapper : public WindowIterator {
@@ -127,8 +156,13 @@ class WindowIteratorFilterWrapper : public WindowIterator {
  public:
     WindowIteratorFilterWrapper(std::unique_ptr<WindowIterator> iter,
                                 const Row& parameter,
-                                const PredicateFun* fun)
-        : WindowIterator(), iter_(std::move(iter)), parameter_(parameter), fun_(fun) {}
+                                const PredicateFun* fun,
+                                bool seek_key_range = false)
+        : WindowIterator(),
+          iter_(std::move(iter)),
+          parameter_(parameter),
+          fun_(fun),
+          seek_key_range_(seek_key_range) {}
     virtual ~WindowIteratorFilterWrapper() {}
     std::unique_ptr<RowIterator> GetValue() override {
         auto iter = iter_->GetValue();
@@ -136,7 +170,8 @@ class WindowIteratorFilterWrapper : public WindowIterator {
             return std::unique_ptr<RowIterator>();
         } else {
             return std::unique_ptr<RowIterator>(
-                new IteratorFilterWrapper(std::move(iter), parameter_, fun_));
+                new IteratorFilterWrapper(std::move(iter), parameter_, fun_,
+                                          seek_key_range_));
         }
     }
     RowIterator* GetRawValue() override {
@@ -144,7 +179,8 @@ class WindowIteratorFilterWrapper : public WindowIterator {
         if (!iter) {
             return nullptr;
         } else {
-            return new IteratorFilterWrapper(std::move(iter), parameter_, fun_);
+            return new IteratorFilterWrapper(std::move(iter), parameter_, fun_,
+                                             seek_key_range_);
         }
     }
     void Seek(const std::string& key) override { iter_->Seek(key); }
@@ -155,6 +191,7 @@ class WindowIteratorFilterWrapper : public WindowIterator {
     std::unique_ptr<WindowIterator> iter_;
     const Row& parameter_;
     const PredicateFun* fun_;
+    const bool seek_key_range_;
 };
 
 class TableProjectWrapper;
@@ -239,7 +276,9 @@ class PartitionFilterWrapper : public PartitionHandler {
             return std::unique_ptr<WindowIterator>();
         } else {
             return std::unique_ptr<WindowIterator>(
-                new WindowIteratorFilterWrapper(std::move(iter), parameter_, fun_));
+                new WindowIteratorFilterWrapper(
+                    std::move(iter), parameter_, fun_,
+                    kDescOrder == partition_handler_->GetOrderType()));
         }
     }
     const Types& GetTypes() override { return partition_handler_->GetTypes(); }
@@ -348,8 +387,9 @@ class TableFilterWrapper : public TableHandler {
         if (!iter) {
             return std::unique_ptr<RowIterator>();
         } else {
-            return std::unique_ptr<RowIterator>(
-                new IteratorFilterWrapper(std::move(iter), parameter_, fun_));
+            return std::unique_ptr<RowIterator>(new IteratorFilterWrapper(
+                std::move(iter), parameter_, fun_,
+                kDescOrder == table_hander_->GetOrderType()));
         }
     }
     const Types& GetTypes() override { return table_hander_->GetTypes(); }
@@ -374,7 +414,7 @@ class TableFilterWrapper : public TableHandler {
             static_cast<std::unique_ptr<RowIterator>>(
                 table_hander_->GetRawIterator()),
             parameter_,
-            fun_);
+            fun_, kDescOrder == table_hander_->GetOrderType());
     }
     virtual std::shared_ptr<PartitionHandler> GetPartition(
         const std::string& index_name);
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/compile_pool.h"
+#include "glog/logging.h"
+
+namespace hybridse {
+namespace vm {
+
+CompilePool::CompilePool(uint32_t thread_num, uint32_t max_pending)
+    : max_pending_(max_pending), stopped_(false) {
+    for (uint32_t i = 0; i < thread_num; i++) {
+        threads_.emplace_back(&CompilePool::Run, this);
+    }
+}
+
+CompilePool::~CompilePool() { Stop(); }
+
+bool CompilePool::AddTask(const std::string& key,
+                          const std::function<void()>& task) {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (stopped_ || threads_.empty()) {
+            return false;
+        }
+        if (tasks_.size() >= max_pending_) {
+            DLOG(INFO) << "compile pool is full, drop task " << key;
+            return false;
+        }
+        if (!pending_keys_.insert(key).second) {
+            return false;
+        }
+        tasks_.emplace_back(key, task);
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void CompilePool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (stopped_) {
+            return;
+        }
+        stopped_ = true;
+        tasks_.clear();
+        pending_keys_.clear();
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+size_t CompilePool::GetPendingSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return tasks_.size();
+}
+
+void CompilePool::Run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            cv_.wait(lock, [this] { return stopped_ || !tasks_.empty(); });
+            if (stopped_) {
+                return;
+            }
+            task = std::move(tasks_.front().second);
+            pending_keys_.erase(tasks_.front().first);
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+}  // namespace vm
+}  // namespace hybridse
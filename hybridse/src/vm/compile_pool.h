@@ -0,0 +1,64 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_VM_COMPILE_POOL_H_
+#define SRC_VM_COMPILE_POOL_H_
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace hybridse {
+namespace vm {
+
+/// Fixed number of threads compiling sql in background.
+///
+/// Tasks are identified by a key, a task is dropped if a task of the same
+/// key is pending or the queue is full. Pending tasks are dropped once the
+/// pool is stopped.
+class CompilePool {
+ public:
+    CompilePool(uint32_t thread_num, uint32_t max_pending);
+    ~CompilePool();
+
+    bool AddTask(const std::string& key, const std::function<void()>& task);
+
+    /// Stop accepting tasks and wait for running tasks
+    void Stop();
+
+    size_t GetPendingSize();
+
+ private:
+    void Run();
+
+    const uint32_t max_pending_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::pair<std::string, std::function<void()>>> tasks_;
+    std::set<std::string> pending_keys_;
+    bool stopped_;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // SRC_VM_COMPILE_POOL_H_
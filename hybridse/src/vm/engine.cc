@@ -15,6 +15,7 @@
  */
 
 #include "vm/engine.h"
+#include <chrono>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,6 +28,10 @@
 #include "codegen/buf_ir_builder.h"
 #include "gflags/gflags.h"
 #include "llvm-c/Target.h"
+#include "udf/default_udf_library.h"
+#include "vm/compile_pool.h"
+#include "vm/jit_runtime.h"
+#include "vm/literal_normalizer.h"
 #include "vm/local_tablet_handler.h"
 #include "vm/mem_catalog.h"
 #include "vm/sql_compiler.h"
@@ -50,7 +55,13 @@ EngineOptions::EngineOptions()
       enable_expr_optimize_(true),
       enable_batch_window_parallelization_(false),
       max_sql_cache_size_(50),
-      enable_spark_unsaferow_format_(false) {
+      enable_spark_unsaferow_format_(false),
+      max_batch_memory_bytes_(0),
+      spill_dir_("/tmp"),
+      enable_tiered_compile_(false),
+      tiered_compile_threads_(1),
+      enable_literal_normalize_(false),
+      interpret_max_rows_(0) {
     // TODO(chendihao): Pass the parameter to avoid global gflag
     FLAGS_enable_spark_unsaferow_format = enable_spark_unsaferow_format_;
 }
@@ -61,10 +72,37 @@ EngineOptions* EngineOptions::set_enable_spark_unsaferow_format(bool flag) {
     return this;
 }
 
-Engine::Engine(const std::shared_ptr<Catalog>& catalog) : cl_(catalog), options_(), mu_(), lru_cache_() {}
+Engine::Engine(const std::shared_ptr<Catalog>& catalog)
+    : cl_(catalog),
+      options_(),
+      mu_(),
+      lru_cache_(),
+      cache_hit_(0),
+      cache_miss_(0),
+      normalized_hit_(0),
+      compile_fail_(0),
+      compile_time_us_(0) {}
 Engine::Engine(const std::shared_ptr<Catalog>& catalog, const EngineOptions& options)
-    : cl_(catalog), options_(options), mu_(), lru_cache_() {}
-Engine::~Engine() {}
+    : cl_(catalog),
+      options_(options),
+      mu_(),
+      lru_cache_(),
+      cache_hit_(0),
+      cache_miss_(0),
+      normalized_hit_(0),
+      compile_fail_(0),
+      compile_time_us_(0) {
+    if (options_.is_enable_tiered_compile() || options_.interpret_max_rows() > 0) {
+        compile_pool_.reset(
+            new CompilePool(options_.tiered_compile_threads(), options_.max_sql_cache_size()));
+    }
+}
+Engine::~Engine() {
+    // background tasks refer to the engine
+    if (compile_pool_) {
+        compile_pool_->Stop();
+    }
+}
 void Engine::InitializeGlobalLLVM() {
     if (LLVM_IS_INITIALIZED) return;
     LLVMInitializeNativeTarget();
@@ -72,6 +110,10 @@ void Engine::InitializeGlobalLLVM() {
     LLVM_IS_INITIALIZED = true;
 }
 
+base::Status Engine::LoadUdfPlugin(const std::string& path) {
+    return udf::DefaultUdfLibrary::get()->LoadPlugin(path);
+}
+
 bool Engine::GetDependentTables(const std::string& sql, const std::string& db, EngineMode engine_mode,
                                 std::set<std::string>* tables, base::Status& status) {
     auto info = std::make_shared<hybridse::vm::SqlCompileInfo>();
@@ -180,11 +222,65 @@ bool Engine::IsCompatibleCache(RunSession& session,  // NOLINT
 
 bool Engine::Get(const std::string& sql, const std::string& db, RunSession& session,
                  base::Status& status) {  // NOLINT (runtime/references)
-    std::shared_ptr<CompileInfo> cached_info = GetCacheLocked(db, sql, session.engine_mode());
+    if (!options_.is_enable_literal_normalize() || session.engine_mode() != kBatchMode) {
+        return Get(sql, sql, db, session, status);
+    }
+    auto batch_sess = dynamic_cast<BatchRunSession*>(&session);
+    // the session may be reused for another sql
+    batch_sess->ResetLiteralParameters();
+    // sql which fails to compile once normalized is cached as it is
+    if (!batch_sess->GetParameterSchema().empty() || GetCacheLocked(db, sql, kBatchMode)) {
+        return Get(sql, sql, db, session, status);
+    }
+    std::string normalized_sql;
+    codec::Schema literal_types;
+    Row literal_row;
+    if (!LiteralNormalizer::Normalize(sql, &normalized_sql, &literal_types, &literal_row)) {
+        return Get(sql, sql, db, session, status);
+    }
+    batch_sess->BindLiteralParameters(literal_types, literal_row);
+    std::string cache_key = normalized_sql + "|" + LiteralNormalizer::TypeSignature(literal_types);
+    uint64_t hit = cache_hit_.load(std::memory_order_relaxed);
+    if (Get(normalized_sql, cache_key, db, session, status)) {
+        if (cache_hit_.load(std::memory_order_relaxed) != hit) {
+            normalized_hit_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    DLOG(INFO) << "fail to compile normalized sql, fallback to " << sql << ": " << status;
+    batch_sess->ResetLiteralParameters();
+    status = base::Status::OK();
+    return Get(sql, sql, db, session, status);
+}
+
+bool Engine::Get(const std::string& sql, const std::string& cache_key, const std::string& db,
+                 RunSession& session, base::Status& status) {  // NOLINT (runtime/references)
+    std::shared_ptr<CompileInfo> cached_info = GetCacheLocked(db, cache_key, session.engine_mode());
+    if (cached_info) {
+        auto optimized = SqlCompileInfo::CastFrom(cached_info.get())->GetOptimized();
+        if (optimized) {
+            // sessions never get the fast compiled code again, free it once
+            // no session pins it
+            SqlCompileInfo::CastFrom(cached_info.get())->TryReleaseJit();
+            cached_info = optimized;
+        }
+    }
     if (cached_info && IsCompatibleCache(session, cached_info, status)) {
-        session.SetCompileInfo(cached_info);
+        auto sql_info = SqlCompileInfo::CastFrom(cached_info.get());
+        auto& cached_ctx = sql_info->get_sql_context();
+        if (cached_ctx.is_interpreted) {
+            // jit compile as soon as runs of the plan project enough rows in
+            // total, executions only pace retries after a failed compile
+            sql_info->AddExecution();
+            if (cached_ctx.interpreted_rows->load(std::memory_order_relaxed) > cached_ctx.interpret_max_rows) {
+                TierUp(cached_info);
+            }
+        }
+        session.SetCompileInfo(PinJit(cached_info));
+        cache_hit_.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
+    cache_miss_.fetch_add(1, std::memory_order_relaxed);
     // TODO(baoxinqi): IsCompatibleCache fail, return false, or reset status.
     if (!status.isOK()) {
         LOG(WARNING) << status;
@@ -201,6 +297,8 @@ bool Engine::Get(const std::string& sql, const std::string& db, RunSession& sess
     sql_context.is_cluster_optimized = options_.is_cluster_optimzied();
     sql_context.is_batch_request_optimized = options_.is_batch_request_optimized();
     sql_context.enable_batch_window_parallelization = options_.is_enable_batch_window_parallelization();
+    sql_context.max_batch_memory_bytes = options_.max_batch_memory_bytes();
+    sql_context.spill_dir = options_.spill_dir();
     sql_context.enable_expr_optimize = options_.is_enable_expr_optimize();
     sql_context.jit_options = options_.jit_options();
     if (session.engine_mode() == kBatchMode) {
@@ -210,22 +308,32 @@ bool Engine::Get(const std::string& sql, const std::string& db, RunSession& sess
         sql_context.batch_request_info.common_column_indices = batch_req_sess->common_column_indices();
     }
 
-    SqlCompiler compiler(std::atomic_load_explicit(&cl_, std::memory_order_acquire), options_.is_keep_ir(), false,
-                         options_.is_plan_only());
-    bool ok = compiler.Compile(info->get_sql_context(), status);
-    if (!ok || 0 != status.code) {
+    // serve ad-hoc batch queries with fast compiled code, and optimize it later
+    bool tiered = options_.is_enable_tiered_compile() && session.engine_mode() == kBatchMode &&
+                  !options_.is_plan_only() && !options_.is_keep_ir();
+    if (tiered) {
+        sql_context.jit_options.set_enable_fast_compile(true);
+    }
+    if (session.engine_mode() == kBatchMode && !options_.is_plan_only() && !options_.is_keep_ir()) {
+        sql_context.interpret_max_rows = options_.interpret_max_rows();
+    }
+    auto start = std::chrono::steady_clock::now();
+    bool ok = Compile(info, status);
+    compile_time_us_.fetch_add(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(),
+        std::memory_order_relaxed);
+    if (!ok) {
+        compile_fail_.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
-    if (!options_.is_compile_only()) {
-        ok = compiler.BuildClusterJob(info->get_sql_context(), status);
-        if (!ok || 0 != status.code) {
-            LOG(WARNING) << "fail to build cluster job: " << status.msg;
-            return false;
-        }
-    }
 
-    SetCacheLocked(db, sql, session.engine_mode(), info);
-    session.SetCompileInfo(info);
+    SetCacheLocked(db, cache_key, session.engine_mode(), info);
+    session.SetCompileInfo(PinJit(info));
+    if (sql_context.is_interpreted) {
+        info->AddExecution();
+    } else if (tiered && sql_context.jit_options.is_enable_fast_compile()) {
+        TierUp(info);
+    }
     if (session.is_debug_) {
         std::ostringstream plan_oss;
         if (nullptr != sql_context.physical_plan) {
@@ -239,6 +347,110 @@ bool Engine::Get(const std::string& sql, const std::string& db, RunSession& sess
     return true;
 }
 
+EngineCompileStats Engine::GetCompileStats() const {
+    EngineCompileStats stats;
+    stats.cache_hit = cache_hit_.load(std::memory_order_relaxed);
+    stats.cache_miss = cache_miss_.load(std::memory_order_relaxed);
+    stats.normalized_hit = normalized_hit_.load(std::memory_order_relaxed);
+    stats.compile_fail = compile_fail_.load(std::memory_order_relaxed);
+    stats.compile_time_us = compile_time_us_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+JitMemoryStats Engine::GetJitMemoryStats() { return HybridSeJitWrapper::GetTotalMemoryStats(); }
+
+size_t Engine::GetRunStepPeakBytes() { return JitRuntime::GetPeakStepBytes(); }
+
+bool Engine::Compile(std::shared_ptr<CompileInfo> info, base::Status& status) {  // NOLINT
+    auto& sql_context = std::dynamic_pointer_cast<SqlCompileInfo>(info)->get_sql_context();
+    SqlCompiler compiler(std::atomic_load_explicit(&cl_, std::memory_order_acquire), options_.is_keep_ir(), false,
+                         options_.is_plan_only());
+    bool ok = compiler.Compile(sql_context, status);
+    if (!ok || 0 != status.code) {
+        return false;
+    }
+    if (!options_.is_compile_only()) {
+        ok = compiler.BuildClusterJob(sql_context, status);
+        if (!ok || 0 != status.code) {
+            LOG(WARNING) << "fail to build cluster job: " << status.msg;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<CompileInfo> Engine::PinJit(const std::shared_ptr<CompileInfo>& info) {
+    auto sql_info = SqlCompileInfo::CastFrom(info.get());
+    if (!sql_info->get_sql_context().jit_options.is_enable_fast_compile()) {
+        // only fast compiled code is released
+        return info;
+    }
+    if (!sql_info->PinJit()) {
+        // released only after the optimized one is ready
+        return sql_info->GetOptimized();
+    }
+    // the session and its copies share the pin
+    return std::shared_ptr<CompileInfo>(info.get(), [info](CompileInfo*) {
+        SqlCompileInfo::CastFrom(info.get())->UnpinJit();
+    });
+}
+
+void Engine::TierUp(std::shared_ptr<CompileInfo> fast_info) {
+    auto fast_sql_info = std::dynamic_pointer_cast<SqlCompileInfo>(fast_info);
+    if (!compile_pool_ || !fast_sql_info->BeginTierUp()) {
+        return;
+    }
+    auto& fast_ctx = fast_sql_info->get_sql_context();
+    // normalized sql of different literal types are different cache entries
+    std::string key = EngineModeName(fast_ctx.engine_mode) + "|" + fast_ctx.db + "|" + fast_ctx.sql + "|" +
+                      LiteralNormalizer::TypeSignature(fast_ctx.parameter_types);
+    // the fast compiled info may be evicted before its turn
+    std::weak_ptr<CompileInfo> weak_info = fast_info;
+    bool added = compile_pool_->AddTask(key, [this, weak_info]() {
+        auto fast_info = weak_info.lock();
+        if (!fast_info) {
+            return;
+        }
+        auto& fast_ctx = std::dynamic_pointer_cast<SqlCompileInfo>(fast_info)->get_sql_context();
+        std::shared_ptr<SqlCompileInfo> info = std::make_shared<SqlCompileInfo>();
+        auto& sql_context = info->get_sql_context();
+        sql_context.sql = fast_ctx.sql;
+        sql_context.db = fast_ctx.db;
+        sql_context.engine_mode = fast_ctx.engine_mode;
+        sql_context.is_performance_sensitive = fast_ctx.is_performance_sensitive;
+        sql_context.is_cluster_optimized = fast_ctx.is_cluster_optimized;
+        sql_context.is_batch_request_optimized = fast_ctx.is_batch_request_optimized;
+        sql_context.enable_batch_window_parallelization = fast_ctx.enable_batch_window_parallelization;
+        sql_context.max_batch_memory_bytes = fast_ctx.max_batch_memory_bytes;
+        sql_context.spill_dir = fast_ctx.spill_dir;
+        sql_context.enable_expr_optimize = fast_ctx.enable_expr_optimize;
+        sql_context.jit_options = fast_ctx.jit_options;
+        sql_context.jit_options.set_enable_fast_compile(false);
+        sql_context.interpret_max_rows = 0;
+        sql_context.parameter_types = fast_ctx.parameter_types;
+        sql_context.batch_request_info.common_column_indices = fast_ctx.batch_request_info.common_column_indices;
+        base::Status status;
+        if (!Compile(info, status)) {
+            LOG(WARNING) << "fail to optimize sql in background: " << status;
+            std::dynamic_pointer_cast<SqlCompileInfo>(fast_info)->EndTierUp(true);
+            return;
+        }
+        // the catalog may be updated since the fast compiling
+        if (sql_context.encoded_schema != fast_ctx.encoded_schema) {
+            LOG(WARNING) << "drop optimized sql with a different output schema: " << fast_ctx.sql;
+            std::dynamic_pointer_cast<SqlCompileInfo>(fast_info)->EndTierUp(true);
+            return;
+        }
+        std::dynamic_pointer_cast<SqlCompileInfo>(fast_info)->SetOptimized(info);
+        DLOG(INFO) << "optimize sql in background done: " << fast_ctx.sql;
+    });
+    if (!added) {
+        // the pool is full or busy with the same sql, try again on the next
+        // execution without backoff
+        fast_sql_info->EndTierUp(false);
+    }
+}
+
 bool Engine::Explain(const std::string& sql, const std::string& db, EngineMode engine_mode,
                      const codec::Schema& parameter_schema,
                      const std::set<size_t>& common_column_indices, ExplainOutput* explain_output,
@@ -288,6 +500,9 @@ bool Engine::Explain(const std::string& sql, const std::string& db, EngineMode e
         if (!tables.empty()) {
             explain_output->router.SetMainTable(*tables.begin());
         }
+        if (tables.size() == 1) {
+            explain_output->router.ParseScatter(ctx.physical_plan);
+        }
     } else {
         explain_output->router.SetMainTable(ctx.request_name);
         explain_output->router.Parse(ctx.physical_plan);
@@ -398,6 +613,7 @@ int32_t RequestRunSession::Run(const uint32_t task_id, const Row& in_row, Row* o
     DLOG(INFO) << "Request Row Run with task_id " << task_id;
     RunnerContext ctx(&std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context().cluster_job, in_row,
                       sp_name_, is_debug_);
+    ctx.SetScanFilter(scan_filter_);
     auto output = task->RunWithCache(ctx);
     if (!output) {
         LOG(WARNING) << "run request plan output is null";
@@ -418,6 +634,7 @@ int32_t BatchRequestRunSession::Run(const uint32_t id, const std::vector<Row>& r
                                     std::vector<Row>& output) {
     RunnerContext ctx(&std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context().cluster_job,
                       request_batch, sp_name_, is_debug_);
+    ctx.SetScanFilter(scan_filter_);
     auto task =
         std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context().cluster_job.GetTask(id).GetRoot();
     if (nullptr == task) {
@@ -441,7 +658,13 @@ int32_t BatchRunSession::Run(std::vector<Row>& rows, uint64_t limit) {
 }
 int32_t BatchRunSession::Run(const Row& parameter_row, std::vector<Row>& rows, uint64_t limit) {
     auto& sql_ctx = std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context();
-    RunnerContext ctx(&sql_ctx.cluster_job, parameter_row, is_debug_);
+    RunnerContext ctx(&sql_ctx.cluster_job,
+                      literal_normalized_ && parameter_row.empty() ? literal_row_ : parameter_row, is_debug_);
+    if (sql_ctx.max_batch_memory_bytes > 0) {
+        ctx.SetSpillContext(std::make_shared<SpillContext>(
+            sql_ctx.max_batch_memory_bytes, sql_ctx.spill_dir));
+    }
+    ctx.SetScanFilter(scan_filter_);
     auto output = sql_ctx.cluster_job.GetTask(0).GetRoot()->RunWithCache(ctx);
     if (!output) {
         LOG(WARNING) << "run batch plan output is null";
@@ -14,10 +14,14 @@
  * limitations under the License.
  */
 
+#include <chrono>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
 #include "case/case_data_mock.h"
 #include "gtest/gtest.h"
 #include "gtest/internal/gtest-param-util.h"
 #include "testing/engine_test_base.h"
+#include "vm/sql_compiler.h"
 
 using namespace llvm;       // NOLINT (build/namespaces)
 using namespace llvm::orc;  // NOLINT (build/namespaces)
@@ -82,6 +86,166 @@ TEST_F(EngineCompileTest, EngineLRUCacheTest) {
     }
 }
 
+TEST_F(EngineCompileTest, EngineTieredCompileTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.set_enable_tiered_compile(true);
+    Engine engine(catalog, options);
+
+    std::string sql = "select col1, col2 + 1 as c2 from t1;";
+    base::Status get_status;
+    auto bsession1 = std::make_shared<BatchRunSession>();
+    ASSERT_TRUE(engine.Get(sql, "simple_db", *bsession1, get_status)) << get_status;
+    auto fast_info = SqlCompileInfo::CastFrom(bsession1->GetCompileInfo().get());
+    ASSERT_TRUE(fast_info->get_sql_context().jit_options.is_enable_fast_compile());
+
+    // wait for the background optimization
+    for (int i = 0; i < 100 && !fast_info->GetOptimized(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    ASSERT_TRUE(fast_info->GetOptimized() != nullptr);
+
+    BatchRunSession bsession2;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", bsession2, get_status)) << get_status;
+    ASSERT_EQ(fast_info->GetOptimized().get(), bsession2.GetCompileInfo().get());
+    auto info = SqlCompileInfo::CastFrom(bsession2.GetCompileInfo().get());
+    ASSERT_FALSE(info->get_sql_context().jit_options.is_enable_fast_compile());
+    ASSERT_EQ(fast_info->GetEncodedSchema(), info->GetEncodedSchema());
+
+    // the first session may still run the fast compiled code
+    ASSERT_TRUE(fast_info->GetJit() != nullptr);
+    bsession1.reset();
+    BatchRunSession bsession3;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", bsession3, get_status)) << get_status;
+    ASSERT_EQ(fast_info->GetOptimized().get(), bsession3.GetCompileInfo().get());
+    ASSERT_TRUE(fast_info->GetJit() == nullptr);
+}
+
+TEST_F(EngineCompileTest, EngineLiteralNormalizeTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.set_compile_only(true);
+    options.set_enable_literal_normalize(true);
+    Engine engine(catalog, options);
+
+    base::Status get_status;
+    BatchRunSession bsession1;
+    ASSERT_TRUE(engine.Get("select col1 from t1 where col1 > 10;", "simple_db", bsession1, get_status))
+        << get_status;
+    ASSERT_TRUE(bsession1.IsLiteralNormalized());
+    ASSERT_EQ(1, bsession1.GetParameterSchema().size());
+
+    BatchRunSession bsession2;
+    ASSERT_TRUE(engine.Get("select col1 from t1 where col1 > 20;", "simple_db", bsession2, get_status))
+        << get_status;
+    ASSERT_EQ(bsession1.GetCompileInfo().get(), bsession2.GetCompileInfo().get());
+
+    // literals of other types compile another plan
+    BatchRunSession bsession3;
+    ASSERT_TRUE(engine.Get("select col1 from t1 where col1 > 20.5;", "simple_db", bsession3, get_status))
+        << get_status;
+    ASSERT_NE(bsession1.GetCompileInfo().get(), bsession3.GetCompileInfo().get());
+
+    // reuse the session for sql without literals
+    ASSERT_TRUE(engine.Get("select col1 from t1;", "simple_db", bsession3, get_status)) << get_status;
+    ASSERT_FALSE(bsession3.IsLiteralNormalized());
+    ASSERT_EQ(0, bsession3.GetParameterSchema().size());
+
+    auto stats = engine.GetCompileStats();
+    ASSERT_EQ(1u, stats.cache_hit);
+    ASSERT_EQ(1u, stats.normalized_hit);
+    ASSERT_EQ(3u, stats.cache_miss);
+    ASSERT_EQ(0u, stats.compile_fail);
+}
+
+TEST_F(EngineCompileTest, EngineTieredCompileLiteralTypesTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.set_enable_tiered_compile(true);
+    options.set_enable_literal_normalize(true);
+    Engine engine(catalog, options);
+
+    // the same normalized sql with literals of different types are optimized
+    // separately, even when both are pending in the compile pool
+    base::Status get_status;
+    BatchRunSession bsession1;
+    ASSERT_TRUE(engine.Get("select col1 from t1 where col1 > 10;", "simple_db", bsession1, get_status))
+        << get_status;
+    BatchRunSession bsession2;
+    ASSERT_TRUE(engine.Get("select col1 from t1 where col1 > 10.5;", "simple_db", bsession2, get_status))
+        << get_status;
+    auto fast_info1 = SqlCompileInfo::CastFrom(bsession1.GetCompileInfo().get());
+    auto fast_info2 = SqlCompileInfo::CastFrom(bsession2.GetCompileInfo().get());
+    ASSERT_NE(fast_info1, fast_info2);
+    for (int i = 0; i < 100 && !(fast_info1->GetOptimized() && fast_info2->GetOptimized()); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    ASSERT_TRUE(fast_info1->GetOptimized() != nullptr);
+    ASSERT_TRUE(fast_info2->GetOptimized() != nullptr);
+}
+
+TEST_F(EngineCompileTest, EngineInterpretTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.set_compile_only(true);
+    options.set_interpret_max_rows(100);
+    Engine engine(catalog, options);
+
+    base::Status get_status;
+    BatchRunSession bsession1;
+    ASSERT_TRUE(engine.Get("select col1 + 1, col2 * 2.0 as c from t1 where col1 > 10 and col0 = 'a' limit 3;",
+                           "simple_db", bsession1, get_status))
+        << get_status;
+    auto info1 = std::dynamic_pointer_cast<SqlCompileInfo>(bsession1.GetCompileInfo());
+    ASSERT_TRUE(info1->get_sql_context().is_interpreted);
+    ASSERT_TRUE(nullptr == info1->GetJit());
+
+    // udf calls are left to the jit
+    BatchRunSession bsession2;
+    ASSERT_TRUE(engine.Get("select substr(col0, 1, 2) from t1;", "simple_db", bsession2, get_status))
+        << get_status;
+    auto info2 = std::dynamic_pointer_cast<SqlCompileInfo>(bsession2.GetCompileInfo());
+    ASSERT_FALSE(info2->get_sql_context().is_interpreted);
+
+    // request mode is always compiled
+    RequestRunSession rsession;
+    ASSERT_TRUE(engine.Get("select col1 + 1 from t1;", "simple_db", rsession, get_status)) << get_status;
+    auto info3 = std::dynamic_pointer_cast<SqlCompileInfo>(rsession.GetCompileInfo());
+    ASSERT_FALSE(info3->get_sql_context().is_interpreted);
+}
+
 TEST_F(EngineCompileTest, EngineWithParameterizedLRUCacheTest) {
     // Build Simple Catalog
     auto catalog = BuildSimpleCatalog();
@@ -357,6 +521,90 @@ TEST_F(EngineCompileTest, RouterTest) {
     }
 }
 
+TEST_F(EngineCompileTest, ScatterRouterTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    ::hybridse::type::IndexDef* index = table_def.add_indexes();
+    index->set_name("index2");
+    index->add_first_keys("col2");
+    index->set_second_key("col5");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.set_compile_only(true);
+    Engine engine(catalog, options);
+    std::vector<std::pair<std::string, bool>> cases = {
+        {"select col1, col2 + 1 from t1;", true},
+        {"select col1 from t1 where col1 > 10;", true},
+        {"select * from t1;", true},
+        {"select sum(col1) from t1;", true},
+        {"select avg(col1) from t1;", false},
+        {"select col1 from t1 limit 10;", false},
+        {"select col2, sum(col1) over w1 from t1 window w1 as (partition by col2 "
+         "order by col5 rows between 3 preceding and current row);",
+         false},
+    };
+    for (auto& pair : cases) {
+        ExplainOutput explain_output;
+        base::Status status;
+        ASSERT_TRUE(engine.Explain(pair.first, "simple_db", kBatchMode,
+                                   &explain_output, &status))
+            << status;
+        ASSERT_EQ(pair.second, explain_output.router.IsScatterable())
+            << pair.first;
+    }
+}
+
+TEST_F(EngineCompileTest, PartialAggregationRouterTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    ::hybridse::type::IndexDef* index = table_def.add_indexes();
+    index->set_name("index2");
+    index->add_first_keys("col2");
+    index->set_second_key("col5");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+
+    EngineOptions options;
+    options.set_compile_only(true);
+    Engine engine(catalog, options);
+    std::vector<std::pair<std::string, std::vector<PartialAggMerge>>> cases = {
+        {"select col1, col2 from t1;", {}},
+        {"select sum(col1), min(col1), max(col5) from t1;",
+         {kMergeBySum, kMergeByMin, kMergeByMax}},
+        {"select col2, count(*), sum(col1) from t1 group by col2;",
+         {kMergeByKey, kMergeBySum, kMergeBySum}},
+        {"select col2, avg(col1) from t1 group by col2;", {}},
+        {"select col2, sum(col1) + 1 from t1 group by col2;", {}},
+        // groups are merged by the keys in the output
+        {"select count(*) from t1 group by col2;", {}},
+        {"select col2, count(*) from t1 group by col2, col6;", {}},
+        {"select col6, col2, count(*) from t1 group by col2, col6;",
+         {kMergeByKey, kMergeByKey, kMergeBySum}},
+    };
+    for (auto& pair : cases) {
+        ExplainOutput explain_output;
+        base::Status status;
+        ASSERT_TRUE(engine.Explain(pair.first, "simple_db", kBatchMode,
+                                   &explain_output, &status))
+            << status;
+        ASSERT_EQ(!pair.second.empty(),
+                  explain_output.router.IsPartialAggregation())
+            << pair.first;
+        ASSERT_EQ(pair.second, explain_output.router.GetPartialAggMerges())
+            << pair.first;
+    }
+}
+
 TEST_F(EngineCompileTest, ExplainBatchRequestTest) {
     // Build Simple Catalog
     auto catalog = BuildSimpleCatalog();
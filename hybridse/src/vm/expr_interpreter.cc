@@ -0,0 +1,649 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/expr_interpreter.h"
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include "codegen/ir_base_builder.h"
+#include "glog/logging.h"
+
+namespace hybridse {
+namespace vm {
+
+static bool IsFloating(type::Type type) {
+    return type == type::kFloat || type == type::kDouble;
+}
+static bool IsInteger(type::Type type) {
+    return type == type::kInt16 || type == type::kInt32 ||
+           type == type::kInt64;
+}
+static bool IsNumber(type::Type type) {
+    return IsInteger(type) || IsFloating(type);
+}
+
+// values of the same group are comparable
+static int CompareGroup(type::Type type) {
+    switch (type) {
+        case type::kNull:
+            return 0;
+        case type::kVarchar:
+            return 1;
+        case type::kDate:
+            return 2;
+        case type::kBool:
+        case type::kInt16:
+        case type::kInt32:
+        case type::kInt64:
+        case type::kTimestamp:
+        case type::kFloat:
+        case type::kDouble:
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+std::shared_ptr<ExprInterpreter> ExprInterpreter::Create(
+    const FnInfo& fn_info, const codec::Schema& parameter_types,
+    const std::shared_ptr<std::atomic<uint64_t>>& rows) {
+    auto fn_def = fn_info.fn_def();
+    if (fn_def == nullptr || fn_info.schemas_ctx() == nullptr ||
+        fn_def->body() == nullptr ||
+        fn_def->body()->GetExprType() != node::kExprList) {
+        return nullptr;
+    }
+    auto body = fn_def->body();
+    if (body->GetChildNum() != static_cast<size_t>(fn_info.fn_schema()->size())) {
+        return nullptr;
+    }
+    std::shared_ptr<ExprInterpreter> interpreter(
+        new ExprInterpreter(fn_info, parameter_types, rows));
+    auto schemas_ctx = fn_info.schemas_ctx();
+    for (size_t i = 0; i < schemas_ctx->GetSchemaSourceSize(); ++i) {
+        interpreter->row_views_.push_back(
+            codec::RowView(*schemas_ctx->GetSchema(i)));
+    }
+    for (size_t i = 0; i < body->GetChildNum(); ++i) {
+        auto expr = body->GetChild(i);
+        if (!interpreter->Resolve(expr)) {
+            DLOG(INFO) << "can not interpret " << expr->GetExprString();
+            return nullptr;
+        }
+        interpreter->outputs_.push_back(expr);
+    }
+    return interpreter;
+}
+
+bool ExprInterpreter::ResolveColumn(const node::ExprNode* expr,
+                                    const SchemasContext* ctx,
+                                    size_t schema_idx, size_t col_idx) {
+    // columns are read from the input row of the function
+    if (ctx != schemas_ctx_ || schema_idx >= row_views_.size()) {
+        return false;
+    }
+    auto schema = schemas_ctx_->GetSchema(schema_idx);
+    if (col_idx >= static_cast<size_t>(schema->size())) {
+        return false;
+    }
+    type::Type type = schema->Get(col_idx).type();
+    if (CompareGroup(type) < 0) {
+        return false;
+    }
+    columns_[expr] = {schema_idx, col_idx};
+    types_[expr] = type;
+    return true;
+}
+
+bool ExprInterpreter::Resolve(const node::ExprNode* expr) {
+    if (expr == nullptr) {
+        return false;
+    }
+    if (expr->GetExprType() == node::kExprPrimary &&
+        dynamic_cast<const node::ConstNode*>(expr)->IsNull()) {
+        types_[expr] = type::kNull;
+        return true;
+    }
+    type::Type type;
+    if (expr->GetOutputType() == nullptr ||
+        !codegen::DataType2SchemaType(*expr->GetOutputType(), &type) ||
+        CompareGroup(type) < 0) {
+        return false;
+    }
+    types_[expr] = type;
+    switch (expr->GetExprType()) {
+        case node::kExprPrimary: {
+            auto data_type =
+                dynamic_cast<const node::ConstNode*>(expr)->GetDataType();
+            return data_type == node::kBool || data_type == node::kInt16 ||
+                   data_type == node::kInt32 || data_type == node::kInt64 ||
+                   data_type == node::kFloat || data_type == node::kDouble ||
+                   data_type == node::kVarchar;
+        }
+        case node::kExprParameter: {
+            auto position =
+                dynamic_cast<const node::ParameterExpr*>(expr)->position();
+            return position > 0 && position <= parameter_types_.size() &&
+                   parameter_types_.Get(position - 1).type() == type;
+        }
+        case node::kExprGetField: {
+            auto get_field = dynamic_cast<const node::GetFieldExpr*>(expr);
+            auto row = get_field->GetRow();
+            if (row == nullptr || row->GetOutputType() == nullptr ||
+                row->GetOutputType()->base() != node::kRow) {
+                return false;
+            }
+            auto row_type =
+                dynamic_cast<const node::RowTypeNode*>(row->GetOutputType());
+            size_t schema_idx;
+            size_t col_idx;
+            if (row_type == nullptr ||
+                !row_type->schemas_ctx()
+                     ->ResolveColumnIndexByID(get_field->GetColumnID(),
+                                              &schema_idx, &col_idx)
+                     .isOK()) {
+                return false;
+            }
+            return ResolveColumn(expr, row_type->schemas_ctx(), schema_idx,
+                                 col_idx);
+        }
+        case node::kExprColumnRef: {
+            size_t schema_idx;
+            size_t col_idx;
+            if (!schemas_ctx_
+                     ->ResolveColumnRefIndex(
+                         dynamic_cast<const node::ColumnRefNode*>(expr),
+                         &schema_idx, &col_idx)
+                     .isOK()) {
+                return false;
+            }
+            return ResolveColumn(expr, schemas_ctx_, schema_idx, col_idx);
+        }
+        case node::kExprUnary: {
+            auto unary = dynamic_cast<const node::UnaryExpr*>(expr);
+            if (unary->GetChildNum() != 1 || !Resolve(unary->GetChild(0))) {
+                return false;
+            }
+            type::Type child_type = types_[unary->GetChild(0)];
+            switch (unary->GetOp()) {
+                case node::kFnOpBracket:
+                case node::kFnOpIsNull:
+                    return true;
+                case node::kFnOpNot:
+                    return child_type == type::kNull ||
+                           CompareGroup(child_type) == 3;
+                case node::kFnOpMinus:
+                    return child_type == type::kNull ||
+                           child_type == type::kBool || IsNumber(child_type);
+                default:
+                    return false;
+            }
+        }
+        case node::kExprBinary: {
+            auto binary = dynamic_cast<const node::BinaryExpr*>(expr);
+            if (binary->GetChildNum() != 2 || !Resolve(binary->GetChild(0)) ||
+                !Resolve(binary->GetChild(1))) {
+                return false;
+            }
+            type::Type lhs = types_[binary->GetChild(0)];
+            type::Type rhs = types_[binary->GetChild(1)];
+            switch (binary->GetOp()) {
+                case node::kFnOpAdd:
+                case node::kFnOpMinus:
+                case node::kFnOpMulti:
+                case node::kFnOpFDiv:
+                case node::kFnOpDiv:
+                case node::kFnOpMod:
+                    return (lhs == type::kNull || IsNumber(lhs)) &&
+                           (rhs == type::kNull || IsNumber(rhs)) &&
+                           IsNumber(type);
+                case node::kFnOpEq:
+                case node::kFnOpNeq:
+                case node::kFnOpLt:
+                case node::kFnOpLe:
+                case node::kFnOpGt:
+                case node::kFnOpGe:
+                    return lhs == type::kNull || rhs == type::kNull ||
+                           CompareGroup(lhs) == CompareGroup(rhs);
+                case node::kFnOpAnd:
+                case node::kFnOpOr:
+                case node::kFnOpXor:
+                    return (lhs == type::kNull || CompareGroup(lhs) == 3) &&
+                           (rhs == type::kNull || CompareGroup(rhs) == 3);
+                default:
+                    return false;
+            }
+        }
+        case node::kExprCast: {
+            auto cast = dynamic_cast<const node::CastExprNode*>(expr);
+            if (!Resolve(cast->expr())) {
+                return false;
+            }
+            // string and date conversions are left to the jit
+            type::Type from = types_[cast->expr()];
+            return (from == type::kNull || CompareGroup(from) == 3) &&
+                   CompareGroup(type) == 3;
+        }
+        default:
+            return false;
+    }
+}
+
+codec::Row ExprInterpreter::RowProject(const codec::Row& row,
+                                       const codec::Row& parameter) const {
+    if (rows_) {
+        rows_->fetch_add(1, std::memory_order_relaxed);
+    }
+    EvalContext ctx;
+    ctx.row = &row;
+    ctx.parameter = &parameter;
+
+    std::vector<Value> values;
+    uint32_t str_length = 0;
+    for (auto expr : outputs_) {
+        values.push_back(Eval(expr, &ctx));
+        if (!values.back().is_null) {
+            str_length += values.back().s.size();
+        }
+    }
+    codec::RowBuilder builder(output_schema_);
+    uint32_t total_size = builder.CalTotalLength(str_length);
+    int8_t* buf = static_cast<int8_t*>(malloc(total_size));
+    builder.SetBuffer(buf, total_size);
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (!AppendValue(values[i], output_schema_.Get(i).type(), &builder)) {
+            LOG(WARNING) << "fail to append interpreted value of "
+                         << outputs_[i]->GetExprString();
+            free(buf);
+            return codec::Row();
+        }
+    }
+    return codec::Row(base::RefCountedSlice::CreateManaged(buf, total_size));
+}
+
+ExprInterpreter::Value ExprInterpreter::Eval(const node::ExprNode* expr,
+                                             EvalContext* ctx) const {
+    Value value;
+    switch (expr->GetExprType()) {
+        case node::kExprPrimary: {
+            auto const_node = dynamic_cast<const node::ConstNode*>(expr);
+            if (const_node->IsNull()) {
+                return value;
+            }
+            value.is_null = false;
+            switch (const_node->GetDataType()) {
+                case node::kBool:
+                    value.type = type::kBool;
+                    value.i = const_node->GetBool();
+                    break;
+                case node::kInt16:
+                    value.type = type::kInt16;
+                    value.i = const_node->GetSmallInt();
+                    break;
+                case node::kInt32:
+                    value.type = type::kInt32;
+                    value.i = const_node->GetInt();
+                    break;
+                case node::kInt64:
+                    value.type = type::kInt64;
+                    value.i = const_node->GetLong();
+                    break;
+                case node::kFloat:
+                    value.type = type::kFloat;
+                    value.d = const_node->GetFloat();
+                    break;
+                case node::kDouble:
+                    value.type = type::kDouble;
+                    value.d = const_node->GetDouble();
+                    break;
+                default:
+                    value.type = type::kVarchar;
+                    value.s = const_node->GetStr();
+                    break;
+            }
+            return value;
+        }
+        case node::kExprParameter:
+            return EvalParameter(dynamic_cast<const node::ParameterExpr*>(expr),
+                                 ctx);
+        case node::kExprGetField:
+        case node::kExprColumnRef:
+            return EvalColumn(expr, ctx);
+        case node::kExprUnary:
+            return EvalUnary(dynamic_cast<const node::UnaryExpr*>(expr), ctx);
+        case node::kExprBinary:
+            return EvalBinary(dynamic_cast<const node::BinaryExpr*>(expr),
+                              ctx);
+        case node::kExprCast:
+            return EvalCast(dynamic_cast<const node::CastExprNode*>(expr),
+                            ctx);
+        default:
+            return value;
+    }
+}
+
+ExprInterpreter::Value ExprInterpreter::EvalColumn(const node::ExprNode* expr,
+                                                   EvalContext* ctx) const {
+    auto slot = columns_.at(expr);
+    if (ctx->row->empty() ||
+        static_cast<int32_t>(slot.schema_idx) >= ctx->row->GetRowPtrCnt()) {
+        return Value();
+    }
+    return ReadValue(row_views_[slot.schema_idx],
+                     ctx->row->buf(slot.schema_idx), slot.col_idx,
+                     types_.at(expr));
+}
+
+ExprInterpreter::Value ExprInterpreter::EvalParameter(
+    const node::ParameterExpr* expr, EvalContext* ctx) const {
+    if (ctx->parameter->empty()) {
+        return Value();
+    }
+    return ReadValue(parameter_view_, ctx->parameter->buf(),
+                     expr->position() - 1, types_.at(expr));
+}
+
+double ExprInterpreter::ToDouble(const Value& value) {
+    return IsFloating(value.type) ? value.d : static_cast<double>(value.i);
+}
+bool ExprInterpreter::ToBool(const Value& value) {
+    return IsFloating(value.type) ? value.d != 0 : value.i != 0;
+}
+
+ExprInterpreter::Value ExprInterpreter::EvalUnary(const node::UnaryExpr* expr,
+                                                  EvalContext* ctx) const {
+    Value child = Eval(expr->GetChild(0), ctx);
+    Value value;
+    value.type = types_.at(expr);
+    switch (expr->GetOp()) {
+        case node::kFnOpBracket:
+            return child;
+        case node::kFnOpIsNull:
+            value.is_null = false;
+            value.i = child.is_null;
+            return value;
+        case node::kFnOpNot:
+            if (child.is_null) {
+                return value;
+            }
+            value.is_null = false;
+            value.i = !ToBool(child);
+            return value;
+        case node::kFnOpMinus:
+            if (child.is_null) {
+                return value;
+            }
+            if (value.type == type::kBool) {
+                return child;
+            }
+            value.is_null = false;
+            if (IsFloating(value.type)) {
+                value.d = -ToDouble(child);
+            } else {
+                value.i = -child.i;
+            }
+            return value;
+        default:
+            return value;
+    }
+}
+
+// truncate integers as the jit code does
+static int64_t TruncateInteger(int64_t value, type::Type type) {
+    switch (type) {
+        case type::kBool:
+            return value != 0;
+        case type::kInt16:
+            return static_cast<int16_t>(value);
+        case type::kInt32:
+        case type::kDate:
+            return static_cast<int32_t>(value);
+        default:
+            return value;
+    }
+}
+
+ExprInterpreter::Value ExprInterpreter::EvalBinary(
+    const node::BinaryExpr* expr, EvalContext* ctx) const {
+    Value lhs = Eval(expr->GetChild(0), ctx);
+    Value rhs = Eval(expr->GetChild(1), ctx);
+    Value value;
+    value.type = types_.at(expr);
+    auto op = expr->GetOp();
+    if (op == node::kFnOpAnd || op == node::kFnOpOr) {
+        // three-valued logic
+        bool l = !lhs.is_null && ToBool(lhs);
+        bool r = !rhs.is_null && ToBool(rhs);
+        if (op == node::kFnOpAnd) {
+            if ((!lhs.is_null && !l) || (!rhs.is_null && !r)) {
+                value.is_null = false;
+                value.i = 0;
+            } else if (!lhs.is_null && !rhs.is_null) {
+                value.is_null = false;
+                value.i = 1;
+            }
+        } else {
+            if (l || r) {
+                value.is_null = false;
+                value.i = 1;
+            } else if (!lhs.is_null && !rhs.is_null) {
+                value.is_null = false;
+                value.i = 0;
+            }
+        }
+        return value;
+    }
+    if (lhs.is_null || rhs.is_null) {
+        return value;
+    }
+    value.is_null = false;
+    switch (op) {
+        case node::kFnOpXor:
+            value.i = ToBool(lhs) != ToBool(rhs);
+            return value;
+        case node::kFnOpEq:
+        case node::kFnOpNeq:
+        case node::kFnOpLt:
+        case node::kFnOpLe:
+        case node::kFnOpGt:
+        case node::kFnOpGe: {
+            int cmp;
+            if (lhs.type == type::kVarchar) {
+                cmp = lhs.s.compare(rhs.s);
+            } else if (IsFloating(lhs.type) || IsFloating(rhs.type)) {
+                double l = ToDouble(lhs);
+                double r = ToDouble(rhs);
+                cmp = l < r ? -1 : (l > r ? 1 : 0);
+            } else {
+                cmp = lhs.i < rhs.i ? -1 : (lhs.i > rhs.i ? 1 : 0);
+            }
+            value.i = (op == node::kFnOpEq && cmp == 0) ||
+                      (op == node::kFnOpNeq && cmp != 0) ||
+                      (op == node::kFnOpLt && cmp < 0) ||
+                      (op == node::kFnOpLe && cmp <= 0) ||
+                      (op == node::kFnOpGt && cmp > 0) ||
+                      (op == node::kFnOpGe && cmp >= 0);
+            return value;
+        }
+        default:
+            break;
+    }
+    if (IsFloating(value.type)) {
+        double l = ToDouble(lhs);
+        double r = ToDouble(rhs);
+        switch (op) {
+            case node::kFnOpAdd:
+                value.d = l + r;
+                break;
+            case node::kFnOpMinus:
+                value.d = l - r;
+                break;
+            case node::kFnOpMulti:
+                value.d = l * r;
+                break;
+            case node::kFnOpMod:
+                value.d = std::fmod(l, r);
+                break;
+            default:
+                value.d = l / r;
+                break;
+        }
+        if (value.type == type::kFloat) {
+            value.d = static_cast<float>(value.d);
+        }
+        return value;
+    }
+    // wrap around as the jit code does
+    uint64_t l = static_cast<uint64_t>(lhs.i);
+    uint64_t r = static_cast<uint64_t>(rhs.i);
+    switch (op) {
+        case node::kFnOpAdd:
+            value.i = static_cast<int64_t>(l + r);
+            break;
+        case node::kFnOpMinus:
+            value.i = static_cast<int64_t>(l - r);
+            break;
+        case node::kFnOpMulti:
+            value.i = static_cast<int64_t>(l * r);
+            break;
+        case node::kFnOpMod:
+            value.i = rhs.i == 0 || rhs.i == -1 ? 0 : lhs.i % rhs.i;
+            break;
+        default:
+            // division by zero results in zero
+            value.i = rhs.i == 0 ? 0
+                                 : (rhs.i == -1 ? static_cast<int64_t>(0 - l)
+                                                : lhs.i / rhs.i);
+            break;
+    }
+    value.i = TruncateInteger(value.i, value.type);
+    return value;
+}
+
+ExprInterpreter::Value ExprInterpreter::EvalCast(const node::CastExprNode* expr,
+                                                 EvalContext* ctx) const {
+    Value child = Eval(expr->expr(), ctx);
+    if (child.is_null) {
+        return child;
+    }
+    Value value;
+    value.is_null = false;
+    value.type = types_.at(expr);
+    if (IsFloating(value.type)) {
+        value.d = ToDouble(child);
+        if (value.type == type::kFloat) {
+            value.d = static_cast<float>(value.d);
+        }
+    } else if (value.type == type::kBool) {
+        value.i = ToBool(child);
+    } else {
+        value.i = TruncateInteger(
+            IsFloating(child.type) ? static_cast<int64_t>(child.d) : child.i,
+            value.type);
+    }
+    return value;
+}
+
+// read with the views shared by all calls, views are never reset to rows
+ExprInterpreter::Value ExprInterpreter::ReadValue(const codec::RowView& view,
+                                                  const int8_t* buf, size_t idx,
+                                                  type::Type type) {
+    Value value;
+    value.type = type;
+    int32_t ret = 0;
+    switch (type) {
+        case type::kBool: {
+            bool v = false;
+            ret = view.GetValue(buf, idx, type, &v);
+            value.i = v;
+            break;
+        }
+        case type::kInt16: {
+            int16_t v = 0;
+            ret = view.GetValue(buf, idx, type, &v);
+            value.i = v;
+            break;
+        }
+        case type::kInt32:
+        case type::kDate: {
+            int32_t v = 0;
+            ret = view.GetValue(buf, idx, type, &v);
+            value.i = v;
+            break;
+        }
+        case type::kInt64:
+        case type::kTimestamp:
+            ret = view.GetValue(buf, idx, type, &value.i);
+            break;
+        case type::kFloat: {
+            float v = 0;
+            ret = view.GetValue(buf, idx, type, &v);
+            value.d = v;
+            break;
+        }
+        case type::kDouble:
+            ret = view.GetValue(buf, idx, type, &value.d);
+            break;
+        case type::kVarchar: {
+            const char* v = nullptr;
+            uint32_t size = 0;
+            ret = view.GetValue(buf, idx, &v, &size);
+            if (ret == 0) {
+                value.s.assign(v, size);
+            }
+            break;
+        }
+        default:
+            ret = -1;
+    }
+    value.is_null = ret != 0;
+    return value;
+}
+
+bool ExprInterpreter::AppendValue(const Value& value, type::Type type,
+                                  codec::RowBuilder* builder) {
+    if (value.is_null) {
+        return builder->AppendNULL();
+    }
+    int64_t i = IsFloating(value.type) ? static_cast<int64_t>(value.d) : value.i;
+    switch (type) {
+        case type::kBool:
+            return builder->AppendBool(ToBool(value));
+        case type::kInt16:
+            return builder->AppendInt16(static_cast<int16_t>(i));
+        case type::kInt32:
+            return builder->AppendInt32(static_cast<int32_t>(i));
+        case type::kInt64:
+            return builder->AppendInt64(i);
+        case type::kTimestamp:
+            return builder->AppendTimestamp(i);
+        case type::kDate:
+            return builder->AppendDate(1900 + (i >> 16), 1 + ((i >> 8) & 0xFF),
+                                       i & 0xFF);
+        case type::kFloat:
+            return builder->AppendFloat(static_cast<float>(ToDouble(value)));
+        case type::kDouble:
+            return builder->AppendDouble(ToDouble(value));
+        case type::kVarchar:
+            return builder->AppendString(value.s.data(), value.s.size());
+        default:
+            return false;
+    }
+}
+
+}  // namespace vm
+}  // namespace hybridse
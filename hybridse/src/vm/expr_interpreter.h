@@ -0,0 +1,113 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_VM_EXPR_INTERPRETER_H_
+#define SRC_VM_EXPR_INTERPRETER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "codec/fe_row_codec.h"
+#include "node/sql_node.h"
+#include "vm/physical_op.h"
+
+namespace hybridse {
+namespace vm {
+
+/// Tree-walking interpreter of a row function, an alternative of the jit
+/// function of `FnInfo` for queries which only touch a few rows.
+///
+/// Only column references, parameters, constants, arithmetic, comparison,
+/// logical operators and numeric casts are supported. Everything else,
+/// e.g. udf calls and aggregations, is left to the jit.
+class ExprInterpreter {
+ public:
+    /// Return `nullptr` if any output expression of `fn_info` can not be
+    /// interpreted. `rows`, if not null, counts the rows projected.
+    static std::shared_ptr<ExprInterpreter> Create(
+        const FnInfo& fn_info, const codec::Schema& parameter_types,
+        const std::shared_ptr<std::atomic<uint64_t>>& rows = nullptr);
+
+    /// Same as `CoreAPI::RowProject` with the jit function. `row` is empty
+    /// for constant projections.
+    codec::Row RowProject(const codec::Row& row,
+                          const codec::Row& parameter) const;
+
+ private:
+    struct Value {
+        bool is_null = true;
+        type::Type type = type::kNull;
+        // bool, int16, int32, int64, timestamp and date
+        int64_t i = 0;
+        // float and double
+        double d = 0;
+        std::string s;
+    };
+    struct EvalContext {
+        const codec::Row* row;
+        const codec::Row* parameter;
+    };
+
+    ExprInterpreter(const FnInfo& fn_info, const codec::Schema& parameter_types,
+                    const std::shared_ptr<std::atomic<uint64_t>>& rows)
+        : output_schema_(*fn_info.fn_schema()),
+          schemas_ctx_(fn_info.schemas_ctx()),
+          parameter_types_(parameter_types),
+          parameter_view_(parameter_types_),
+          rows_(rows) {}
+
+    bool Resolve(const node::ExprNode* expr);
+    bool ResolveColumn(const node::ExprNode* expr, const SchemasContext* ctx,
+                       size_t schema_idx, size_t col_idx);
+
+    Value Eval(const node::ExprNode* expr, EvalContext* ctx) const;
+    Value EvalColumn(const node::ExprNode* expr, EvalContext* ctx) const;
+    Value EvalParameter(const node::ParameterExpr* expr,
+                        EvalContext* ctx) const;
+    Value EvalBinary(const node::BinaryExpr* expr, EvalContext* ctx) const;
+    Value EvalUnary(const node::UnaryExpr* expr, EvalContext* ctx) const;
+    Value EvalCast(const node::CastExprNode* expr, EvalContext* ctx) const;
+
+    static double ToDouble(const Value& value);
+    static bool ToBool(const Value& value);
+    static Value ReadValue(const codec::RowView& view, const int8_t* buf,
+                           size_t idx, type::Type type);
+    static bool AppendValue(const Value& value, type::Type type,
+                            codec::RowBuilder* builder);
+
+    const codec::Schema output_schema_;
+    const SchemasContext* schemas_ctx_;
+    const codec::Schema parameter_types_;
+    const codec::RowView parameter_view_;
+    std::shared_ptr<std::atomic<uint64_t>> rows_;
+    std::vector<const node::ExprNode*> outputs_;
+    // resolved type of each expression
+    std::unordered_map<const node::ExprNode*, type::Type> types_;
+    struct ColumnSlot {
+        size_t schema_idx;
+        size_t col_idx;
+    };
+    std::unordered_map<const node::ExprNode*, ColumnSlot> columns_;
+    // views of input schemas, only read rows through the const interface
+    std::vector<codec::RowView> row_views_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // SRC_VM_EXPR_INTERPRETER_H_
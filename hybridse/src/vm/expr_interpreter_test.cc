@@ -0,0 +1,238 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/expr_interpreter.h"
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "case/case_data_mock.h"
+#include "gtest/gtest.h"
+#include "llvm/Support/TargetSelect.h"
+#include "testing/engine_test_base.h"
+#include "vm/sql_compiler.h"
+
+namespace hybridse {
+namespace vm {
+
+class ExprInterpreterTest : public ::testing::Test {
+ public:
+    ExprInterpreterTest() {}
+    ~ExprInterpreterTest() {}
+
+    void SetUp() override {
+        catalog_ = BuildSimpleCatalog();
+        hybridse::type::Database db;
+        db.set_name("simple_db");
+        sqlcase::CaseSchemaMock::BuildTableDef(table_def_);
+        table_def_.set_name("t1");
+        AddTable(db, table_def_);
+        catalog_->AddDatabase(db);
+
+        // values of col0 ~ col6, nullptr is NULL
+        std::vector<std::vector<const char*>> values = {
+            {"a", "1", "1", "1.5", "2.5", "10", "b"},
+            {"b", "2", "0", "-2.5", "0", "0", "b"},
+            {"c", "0", "3", "3.75", "-7.25", "-7", "a"},
+            {nullptr, nullptr, "5", nullptr, "1", "3", "c"},
+            {"", "-3", nullptr, "0", nullptr, nullptr, nullptr},
+            {"ab", "7", "-2", "100.5", "9", "-9", ""},
+        };
+        std::vector<Row> rows;
+        for (auto& row : values) {
+            rows.push_back(BuildRow(row));
+        }
+        ASSERT_TRUE(catalog_->InsertRows("simple_db", "t1", rows));
+    }
+
+    Row BuildRow(const std::vector<const char*>& values) {
+        codec::RowBuilder builder(table_def_.columns());
+        uint32_t str_length = 0;
+        for (int i = 0; i < table_def_.columns_size(); i++) {
+            if (values[i] != nullptr &&
+                table_def_.columns(i).type() == type::kVarchar) {
+                str_length += strlen(values[i]);
+            }
+        }
+        uint32_t total_size = builder.CalTotalLength(str_length);
+        int8_t* buf = static_cast<int8_t*>(malloc(total_size));
+        builder.SetBuffer(buf, total_size);
+        for (int i = 0; i < table_def_.columns_size(); i++) {
+            if (values[i] == nullptr) {
+                builder.AppendNULL();
+                continue;
+            }
+            switch (table_def_.columns(i).type()) {
+                case type::kVarchar:
+                    builder.AppendString(values[i], strlen(values[i]));
+                    break;
+                case type::kInt16:
+                    builder.AppendInt16(std::stoi(values[i]));
+                    break;
+                case type::kInt32:
+                    builder.AppendInt32(std::stoi(values[i]));
+                    break;
+                case type::kInt64:
+                    builder.AppendInt64(std::stoll(values[i]));
+                    break;
+                case type::kFloat:
+                    builder.AppendFloat(std::stof(values[i]));
+                    break;
+                case type::kDouble:
+                    builder.AppendDouble(std::stod(values[i]));
+                    break;
+                default:
+                    break;
+            }
+        }
+        return Row(base::RefCountedSlice::CreateManaged(buf, total_size));
+    }
+
+    // run `sql` on an engine, return output rows as strings
+    std::vector<std::string> Run(const std::string& sql,
+                                 uint64_t interpret_max_rows) {
+        EngineOptions options;
+        options.set_interpret_max_rows(interpret_max_rows);
+        Engine engine(catalog_, options);
+        base::Status status;
+        BatchRunSession session;
+        std::vector<std::string> result;
+        if (!engine.Get(sql, "simple_db", session, status)) {
+            ADD_FAILURE() << "fail to compile " << sql << ": " << status;
+            return result;
+        }
+        auto info =
+            std::dynamic_pointer_cast<SqlCompileInfo>(session.GetCompileInfo());
+        EXPECT_EQ(interpret_max_rows > 0,
+                  info->get_sql_context().is_interpreted)
+            << sql;
+        std::vector<Row> output;
+        EXPECT_EQ(0, session.Run(output));
+        codec::RowView row_view(session.GetSchema());
+        for (auto& row : output) {
+            row_view.Reset(row.buf(), row.size());
+            result.push_back(row_view.GetRowString());
+        }
+        return result;
+    }
+
+    void CheckSameAsJit(const std::string& sql) {
+        auto jit_result = Run(sql, 0);
+        auto interpreted_result = Run(sql, 1000);
+        ASSERT_FALSE(jit_result.empty()) << sql;
+        ASSERT_EQ(jit_result, interpreted_result) << sql;
+    }
+
+ protected:
+    hybridse::type::TableDef table_def_;
+    std::shared_ptr<SimpleCatalog> catalog_;
+};
+
+TEST_F(ExprInterpreterTest, NullLogicTest) {
+    CheckSameAsJit(
+        "select col1 > 1 and col5 < 10 as a1, col1 > 1 or col5 < 10 as a2, "
+        "not (col1 > 1) as a3, col1 = col2 as a4, col1 is null as a5, "
+        "col1 + col2 as a6, -col5 as a7, null and col1 > 0 as a8, "
+        "null or col1 > 0 as a9 from t1;");
+}
+
+TEST_F(ExprInterpreterTest, CastTest) {
+    CheckSameAsJit(
+        "select cast(col3 as bigint) as c1, cast(col4 as int) as c2, "
+        "cast(col1 as double) as c3, cast(col5 as float) as c4, "
+        "cast(col2 as bigint) as c5, cast(col1 as bool) as c6, "
+        "cast(col4 as smallint) as c7, col2 * col3 as c8 from t1;");
+}
+
+TEST_F(ExprInterpreterTest, StringCompareTest) {
+    CheckSameAsJit(
+        "select col0 = col6 as s1, col0 < col6 as s2, col0 >= 'b' as s3, "
+        "col0 != 'a' as s4, col6 <= col0 as s5, col0 > '' as s6 from t1;");
+}
+
+TEST_F(ExprInterpreterTest, DivideByZeroTest) {
+    CheckSameAsJit(
+        "select col1 / 0 as d1, col1 % 0 as d2, col5 / col2 as d3, "
+        "col5 % col2 as d4, col4 / 0.0 as d5, col1 DIV 0 as d6, "
+        "col5 DIV col2 as d7, col4 % 0.0 as d8 from t1;");
+}
+
+TEST_F(ExprInterpreterTest, FilterTest) {
+    CheckSameAsJit(
+        "select col0, col1 from t1 where col1 > 0 and col0 < 'c' "
+        "or col2 = 5;");
+}
+
+TEST_F(ExprInterpreterTest, CountEstimateTest) {
+    // t1 holds 6 rows, which is known at compile time
+    EngineOptions options;
+    options.set_interpret_max_rows(5);
+    Engine engine(catalog_, options);
+    base::Status status;
+    BatchRunSession session;
+    ASSERT_TRUE(engine.Get("select col0 from t1;", "simple_db", session,
+                           status))
+        << status;
+    auto info =
+        std::dynamic_pointer_cast<SqlCompileInfo>(session.GetCompileInfo());
+    ASSERT_FALSE(info->get_sql_context().is_interpreted);
+}
+
+TEST_F(ExprInterpreterTest, TierUpTest) {
+    EngineOptions options;
+    options.set_interpret_max_rows(10);
+    Engine engine(catalog_, options);
+    std::string sql = "select col0, col1 + 1 from t1;";
+    base::Status status;
+    std::shared_ptr<SqlCompileInfo> interpreted_info;
+    // two runs project 12 rows, the third execution tiers up at once
+    for (int i = 0; i < 3; i++) {
+        BatchRunSession session;
+        ASSERT_TRUE(engine.Get(sql, "simple_db", session, status)) << status;
+        if (0 == i) {
+            interpreted_info = std::dynamic_pointer_cast<SqlCompileInfo>(
+                session.GetCompileInfo());
+            ASSERT_TRUE(interpreted_info->get_sql_context().is_interpreted);
+        }
+        std::vector<Row> output;
+        ASSERT_EQ(0, session.Run(output));
+        ASSERT_EQ(6u, output.size());
+    }
+    for (int i = 0; i < 100 && !interpreted_info->GetOptimized(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    ASSERT_TRUE(interpreted_info->GetOptimized() != nullptr);
+
+    BatchRunSession session;
+    ASSERT_TRUE(engine.Get(sql, "simple_db", session, status)) << status;
+    auto info = SqlCompileInfo::CastFrom(session.GetCompileInfo().get());
+    ASSERT_FALSE(info->get_sql_context().is_interpreted);
+    std::vector<Row> output;
+    ASSERT_EQ(0, session.Run(output));
+    ASSERT_EQ(6u, output.size());
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    return RUN_ALL_TESTS();
+}
@@ -48,6 +48,67 @@ namespace hybridse {
 namespace vm {
 using ::llvm::orc::LLJIT;
 
+static JitMemoryCounter total_memory_counter;
+
+static JitMemoryStats ToMemoryStats(const JitMemoryCounter& counter) {
+    JitMemoryStats stats;
+    stats.code_bytes = counter.code_bytes.load(std::memory_order_relaxed);
+    stats.data_bytes = counter.data_bytes.load(std::memory_order_relaxed);
+    stats.object_cnt = counter.object_cnt.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Count sections of one object into the counter of its jit and the total
+// counter, and uncount them once the object is unloaded with the jit.
+class CountingMemoryManager : public ::llvm::SectionMemoryManager {
+ public:
+    explicit CountingMemoryManager(std::shared_ptr<JitMemoryCounter> counter)
+        : counter_(counter), code_bytes_(0), data_bytes_(0) {
+        counter_->object_cnt.fetch_add(1, std::memory_order_relaxed);
+        total_memory_counter.object_cnt.fetch_add(1,
+                                                  std::memory_order_relaxed);
+    }
+    ~CountingMemoryManager() override {
+        counter_->code_bytes.fetch_sub(code_bytes_, std::memory_order_relaxed);
+        counter_->data_bytes.fetch_sub(data_bytes_, std::memory_order_relaxed);
+        counter_->object_cnt.fetch_sub(1, std::memory_order_relaxed);
+        total_memory_counter.code_bytes.fetch_sub(code_bytes_,
+                                                  std::memory_order_relaxed);
+        total_memory_counter.data_bytes.fetch_sub(data_bytes_,
+                                                  std::memory_order_relaxed);
+        total_memory_counter.object_cnt.fetch_sub(1,
+                                                  std::memory_order_relaxed);
+    }
+
+    uint8_t* allocateCodeSection(uintptr_t size, unsigned alignment,
+                                 unsigned section_id,
+                                 ::llvm::StringRef section_name) override {
+        code_bytes_ += size;
+        counter_->code_bytes.fetch_add(size, std::memory_order_relaxed);
+        total_memory_counter.code_bytes.fetch_add(size,
+                                                  std::memory_order_relaxed);
+        return SectionMemoryManager::allocateCodeSection(
+            size, alignment, section_id, section_name);
+    }
+
+    uint8_t* allocateDataSection(uintptr_t size, unsigned alignment,
+                                 unsigned section_id,
+                                 ::llvm::StringRef section_name,
+                                 bool is_read_only) override {
+        data_bytes_ += size;
+        counter_->data_bytes.fetch_add(size, std::memory_order_relaxed);
+        total_memory_counter.data_bytes.fetch_add(size,
+                                                  std::memory_order_relaxed);
+        return SectionMemoryManager::allocateDataSection(
+            size, alignment, section_id, section_name, is_read_only);
+    }
+
+ private:
+    std::shared_ptr<JitMemoryCounter> counter_;
+    uint64_t code_bytes_;
+    uint64_t data_bytes_;
+};
+
 HybridSeJit::HybridSeJit(::llvm::orc::LLJITBuilderState& s, ::llvm::Error& e)
     : LLJIT(s, e) {}
 HybridSeJit::~HybridSeJit() {}
@@ -66,6 +127,15 @@ static void RunDefaultOptPasses(::llvm::Module* m) {
     }
 }
 
+static void RunFastOptPasses(::llvm::Module* m) {
+    ::llvm::legacy::FunctionPassManager fpm(m);
+    fpm.add(::llvm::createPromoteMemoryToRegisterPass());
+    fpm.doInitialization();
+    for (auto it = m->begin(); it != m->end(); ++it) {
+        fpm.run(*it);
+    }
+}
+
 ::llvm::Error HybridSeJit::AddIRModule(::llvm::orc::JITDylib& jd,  // NOLINT
                                        ::llvm::orc::ThreadSafeModule tsm,
                                        ::llvm::orc::VModuleKey key) {
@@ -88,6 +158,14 @@ bool HybridSeJit::OptModule(::llvm::Module* m) {
     return true;
 }
 
+bool HybridSeJit::FastOptModule(::llvm::Module* m) {
+    if (auto err = applyDataLayout(*m)) {
+        return false;
+    }
+    RunFastOptPasses(m);
+    return true;
+}
+
 ::llvm::orc::VModuleKey HybridSeJit::CreateVModule() {
     ::llvm::orc::VModuleKey key = ES->allocateVModule();
     DLOG(INFO) << "allocate a new module key " << key;
@@ -150,8 +228,28 @@ bool HybridSeJit::AddSymbol(::llvm::orc::JITDylib& jd,
 
 bool HybridSeLlvmJitWrapper::Init() {
     DLOG(INFO) << "Start to initialize hybridse jit";
-    auto jit = ::llvm::Expected<std::unique_ptr<HybridSeJit>>(
-        HybridSeJitBuilder().create());
+    HybridSeJitBuilder builder;
+    if (jit_options_.is_enable_fast_compile()) {
+        auto jtmb = ::llvm::orc::JITTargetMachineBuilder::detectHost();
+        if (!jtmb) {
+            LOG(WARNING) << "fail to detect host target: "
+                         << LlvmToString(jtmb.takeError());
+            return false;
+        }
+        jtmb->setCodeGenOptLevel(::llvm::CodeGenOpt::None);
+        builder.setJITTargetMachineBuilder(std::move(*jtmb));
+    }
+    auto counter = memory_counter_;
+    builder.setObjectLinkingLayerCreator(
+        [counter](::llvm::orc::ExecutionSession& es) {
+            auto get_memory_manager = [counter]() {
+                return ::llvm::make_unique<CountingMemoryManager>(counter);
+            };
+            return std::unique_ptr<::llvm::orc::ObjectLayer>(
+                new ::llvm::orc::RTDyldObjectLinkingLayer(
+                    es, std::move(get_memory_manager)));
+        });
+    auto jit = ::llvm::Expected<std::unique_ptr<HybridSeJit>>(builder.create());
     {
         ::llvm::Error e = jit.takeError();
         if (e) {
@@ -169,6 +267,9 @@ bool HybridSeLlvmJitWrapper::Init() {
 }
 
 bool HybridSeLlvmJitWrapper::OptModule(::llvm::Module* module) {
+    if (jit_options_.is_enable_fast_compile()) {
+        return jit_->FastOptModule(module);
+    }
     return jit_->OptModule(module);
 }
 
@@ -184,6 +285,53 @@ bool HybridSeLlvmJitWrapper::AddModule(
     return true;
 }
 
+bool HybridSeLlvmJitWrapper::CompileModule(
+    std::unique_ptr<llvm::Module> module,
+    std::unique_ptr<llvm::LLVMContext> llvm_ctx, std::string* object) {
+    if (object == nullptr) {
+        return AddModule(std::move(module), std::move(llvm_ctx));
+    }
+    auto jtmb = ::llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!jtmb) {
+        LOG(WARNING) << "fail to detect host target: "
+                     << LlvmToString(jtmb.takeError());
+        return false;
+    }
+    auto tm = jtmb->createTargetMachine();
+    if (!tm) {
+        LOG(WARNING) << "fail to create target machine: "
+                     << LlvmToString(tm.takeError());
+        return false;
+    }
+    // the same compiler as the compile layer of LLJIT
+    ::llvm::orc::SimpleCompiler compiler(**tm);
+    auto buffer = compiler(*module);
+    // note: destruct module before ctx
+    module = nullptr;
+    llvm_ctx = nullptr;
+    if (!buffer) {
+        LOG(WARNING) << "fail to compile ir module into object";
+        return false;
+    }
+    object->assign(buffer->getBufferStart(), buffer->getBufferSize());
+    ::llvm::Error e = jit_->addObjectFile(std::move(buffer));
+    if (e) {
+        LOG(WARNING) << "fail to add object: " << LlvmToString(e);
+        return false;
+    }
+    return true;
+}
+
+bool HybridSeLlvmJitWrapper::AddObject(const std::string& object) {
+    ::llvm::Error e = jit_->addObjectFile(
+        ::llvm::MemoryBuffer::getMemBufferCopy(object, "sql"));
+    if (e) {
+        LOG(WARNING) << "fail to add object: " << LlvmToString(e);
+        return false;
+    }
+    return true;
+}
+
 RawPtrHandle HybridSeLlvmJitWrapper::FindFunction(const std::string& funcname) {
     if (funcname == "") {
         return 0;
@@ -198,6 +346,14 @@ RawPtrHandle HybridSeLlvmJitWrapper::FindFunction(const std::string& funcname) {
     return reinterpret_cast<const int8_t*>(symbol->getAddress());
 }
 
+JitMemoryStats HybridSeLlvmJitWrapper::GetMemoryStats() const {
+    return ToMemoryStats(*memory_counter_);
+}
+
+JitMemoryStats HybridSeJitWrapper::GetTotalMemoryStats() {
+    return ToMemoryStats(total_memory_counter);
+}
+
 bool HybridSeLlvmJitWrapper::AddExternalFunction(const std::string& name,
                                                void* addr) {
     return hybridse::vm::HybridSeJit::AddSymbol(jit_->getMainJITDylib(), *mi_,
@@ -17,6 +17,7 @@
 #ifndef SRC_VM_JIT_H_
 #define SRC_VM_JIT_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -50,6 +51,9 @@ class HybridSeJit : public ::llvm::orc::LLJIT {
 
     bool OptModule(::llvm::Module* m);
 
+    // only promote allocas to registers, which most codegen relies on
+    bool FastOptModule(::llvm::Module* m);
+
     ::llvm::orc::VModuleKey CreateVModule();
 
     void ReleaseVModule(::llvm::orc::VModuleKey key);
@@ -85,9 +89,20 @@ std::string LlvmToString(const T& value) {
     return str;
 }
 
+// sections allocated by object code of a jit
+struct JitMemoryCounter {
+    std::atomic<uint64_t> code_bytes{0};
+    std::atomic<uint64_t> data_bytes{0};
+    std::atomic<uint64_t> object_cnt{0};
+};
+
 class HybridSeLlvmJitWrapper : public HybridSeJitWrapper {
  public:
-    HybridSeLlvmJitWrapper() {}
+    HybridSeLlvmJitWrapper()
+        : jit_options_(), memory_counter_(std::make_shared<JitMemoryCounter>()) {}
+    explicit HybridSeLlvmJitWrapper(const JitOptions& jit_options)
+        : jit_options_(jit_options),
+          memory_counter_(std::make_shared<JitMemoryCounter>()) {}
     ~HybridSeLlvmJitWrapper() {}
 
     bool Init() override;
@@ -99,10 +114,21 @@ class HybridSeLlvmJitWrapper : public HybridSeJitWrapper {
 
     bool AddExternalFunction(const std::string& name, void* addr) override;
 
+    bool CompileModule(std::unique_ptr<llvm::Module> module,
+                       std::unique_ptr<llvm::LLVMContext> llvm_ctx,
+                       std::string* object) override;
+
+    bool AddObject(const std::string& object) override;
+
     hybridse::vm::RawPtrHandle FindFunction(
         const std::string& funcname) override;
 
+    JitMemoryStats GetMemoryStats() const override;
+
  private:
+    const JitOptions jit_options_;
+    // shared with memory managers owned by the jit
+    std::shared_ptr<JitMemoryCounter> memory_counter_;
     std::unique_ptr<HybridSeJit> jit_;
     std::unique_ptr<::llvm::orc::MangleAndInterner> mi_;
 };
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/jit_object_cache.h"
+#include <unistd.h>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "base/fe_hash.h"
+#include "boost/filesystem.hpp"
+#include "glog/logging.h"
+#include "hybridse_version.h"  //NOLINT
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Host.h"
+
+namespace hybridse {
+namespace vm {
+
+// bump it once the layout of cache entries changes
+static const uint32_t JIT_OBJECT_CACHE_MAGIC = 0x4a4f4301;
+static const uint32_t JIT_OBJECT_NAME_SEED = 0xe17;
+static const uint32_t JIT_OBJECT_CHECK_SEED = 0x5eed;
+
+JitObjectCache::Key JitObjectCache::MakeKey(const std::string& ir) {
+    std::string material;
+    material.append(std::to_string(HYBRIDSE_VERSION_MAJOR))
+        .append(".")
+        .append(std::to_string(HYBRIDSE_VERSION_MINOR))
+        .append(".")
+        .append(std::to_string(HYBRIDSE_VERSION_BUG))
+        .append("|")
+        .append(LLVM_VERSION_STRING)
+        .append("|")
+        .append(::llvm::sys::getProcessTriple())
+        .append("|")
+        .append(::llvm::sys::getHostCPUName().str())
+        .append("|")
+        .append(ir);
+    uint64_t name = base::MurmurHash64A(material.data(), material.size(),
+                                        JIT_OBJECT_NAME_SEED);
+    char name_buf[17];
+    snprintf(name_buf, sizeof(name_buf), "%016" PRIx64, name);
+    Key key;
+    key.name = name_buf;
+    key.check = base::MurmurHash64A(material.data(), material.size(),
+                                    JIT_OBJECT_CHECK_SEED);
+    return key;
+}
+
+std::string JitObjectCache::GetPath(const Key& key) const {
+    return dir_ + "/" + key.name + ".o";
+}
+
+bool JitObjectCache::Get(const Key& key, std::string* object) const {
+    if (object == nullptr || dir_.empty()) {
+        return false;
+    }
+    std::ifstream in(GetPath(key), std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    uint32_t magic = 0;
+    uint64_t check = 0;
+    uint64_t size = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char*>(&check), sizeof(check));
+    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!in.good() || magic != JIT_OBJECT_CACHE_MAGIC || check != key.check) {
+        LOG(WARNING) << "ignore mismatched jit object " << GetPath(key);
+        return false;
+    }
+    object->resize(size);
+    in.read(&(*object)[0], size);
+    if (static_cast<uint64_t>(in.gcount()) != size ||
+        in.peek() != std::ifstream::traits_type::eof()) {
+        LOG(WARNING) << "ignore broken jit object " << GetPath(key);
+        object->clear();
+        return false;
+    }
+    return true;
+}
+
+bool JitObjectCache::Put(const Key& key, const std::string& object) const {
+    if (dir_.empty() || object.empty()) {
+        return false;
+    }
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(dir_, ec);
+    if (ec) {
+        LOG(WARNING) << "fail to create jit object cache dir " << dir_ << ": "
+                     << ec.message();
+        return false;
+    }
+    std::string path = GetPath(key);
+    std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(tmp_path, std::ios::out | std::ios::binary |
+                                        std::ios::trunc);
+        if (!out.is_open()) {
+            LOG(WARNING) << "fail to open " << tmp_path;
+            return false;
+        }
+        uint32_t magic = JIT_OBJECT_CACHE_MAGIC;
+        uint64_t size = object.size();
+        out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        out.write(reinterpret_cast<const char*>(&key.check), sizeof(key.check));
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(object.data(), object.size());
+        out.flush();
+        if (!out.good()) {
+            LOG(WARNING) << "fail to write " << tmp_path;
+            out.close();
+            boost::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+    }
+    boost::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        LOG(WARNING) << "fail to rename " << tmp_path << " to " << path << ": "
+                     << ec.message();
+        boost::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+void JitObjectCache::Remove(const Key& key) const {
+    boost::system::error_code ec;
+    boost::filesystem::remove(GetPath(key), ec);
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_VM_JIT_OBJECT_CACHE_H_
+#define SRC_VM_JIT_OBJECT_CACHE_H_
+
+#include <cstdint>
+#include <string>
+
+namespace hybridse {
+namespace vm {
+
+/// Content addressed cache of object code on local disk.
+///
+/// An entry is addressed by the digest of the unoptimized ir module of a
+/// sql. The module is generated from the sql, the schemas in the catalog
+/// and the engine options, so an entry can never be hit once any of them
+/// changes. The digest also covers the library version, the llvm version
+/// and the host cpu the object code is emitted for.
+///
+/// Each entry is a file `<dir>/<digest>.o` of
+/// [magic][check digest][object size][object]
+class JitObjectCache {
+ public:
+    struct Key {
+        std::string name;
+        uint64_t check = 0;
+    };
+
+    explicit JitObjectCache(const std::string& dir) : dir_(dir) {}
+    ~JitObjectCache() {}
+
+    static Key MakeKey(const std::string& ir);
+
+    /// Load the object code of `key`, return `false` on a miss or if the
+    /// entry is broken.
+    bool Get(const Key& key, std::string* object) const;
+
+    /// Store the object code of `key`. The entry is written to a temporary
+    /// file and renamed, so concurrent readers never see a partial entry.
+    bool Put(const Key& key, const std::string& object) const;
+
+    /// Remove the entry of `key`, e.g. when its object fails to load.
+    void Remove(const Key& key) const;
+
+    const std::string& dir() const { return dir_; }
+
+ private:
+    std::string GetPath(const Key& key) const;
+
+    const std::string dir_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // SRC_VM_JIT_OBJECT_CACHE_H_
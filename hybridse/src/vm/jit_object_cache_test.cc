@@ -0,0 +1,100 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/jit_object_cache.h"
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include "boost/filesystem.hpp"
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+
+class JitObjectCacheTest : public ::testing::Test {
+ public:
+    JitObjectCacheTest()
+        : dir_("/tmp/jit_object_cache_test_" + std::to_string(getpid())) {}
+    ~JitObjectCacheTest() { boost::filesystem::remove_all(dir_); }
+
+ protected:
+    std::string dir_;
+};
+
+TEST_F(JitObjectCacheTest, key_test) {
+    auto key1 = JitObjectCache::MakeKey("define i32 @f()");
+    auto key2 = JitObjectCache::MakeKey("define i32 @f()");
+    auto key3 = JitObjectCache::MakeKey("define i32 @g()");
+    ASSERT_EQ(key1.name, key2.name);
+    ASSERT_EQ(key1.check, key2.check);
+    ASSERT_EQ(16u, key1.name.size());
+    ASSERT_NE(key1.name, key3.name);
+}
+
+TEST_F(JitObjectCacheTest, put_get_test) {
+    JitObjectCache cache(dir_);
+    auto key = JitObjectCache::MakeKey("define i32 @f()");
+    std::string object;
+    ASSERT_FALSE(cache.Get(key, &object));
+
+    std::string expect("\x7f" "ELF\0object", 11);
+    ASSERT_TRUE(cache.Put(key, expect));
+    ASSERT_TRUE(cache.Get(key, &object));
+    ASSERT_EQ(expect, object);
+
+    // another sql never hits the entry
+    auto other = JitObjectCache::MakeKey("define i32 @g()");
+    ASSERT_FALSE(cache.Get(other, &object));
+
+    // same name with different check digest
+    auto mismatch = key;
+    mismatch.check += 1;
+    ASSERT_FALSE(cache.Get(mismatch, &object));
+
+    cache.Remove(key);
+    ASSERT_FALSE(cache.Get(key, &object));
+}
+
+TEST_F(JitObjectCacheTest, broken_entry_test) {
+    JitObjectCache cache(dir_);
+    auto key = JitObjectCache::MakeKey("define i32 @f()");
+    ASSERT_TRUE(cache.Put(key, "object code"));
+
+    // truncate the entry
+    std::string path = dir_ + "/" + key.name + ".o";
+    auto size = boost::filesystem::file_size(path);
+    boost::filesystem::resize_file(path, size - 2);
+    std::string object;
+    ASSERT_FALSE(cache.Get(key, &object));
+    ASSERT_TRUE(object.empty());
+
+    // trailing bytes
+    ASSERT_TRUE(cache.Put(key, "object code"));
+    {
+        std::ofstream out(path, std::ios::app | std::ios::binary);
+        out << "tail";
+    }
+    ASSERT_FALSE(cache.Get(key, &object));
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::GTEST_FLAG(color) = "yes";
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
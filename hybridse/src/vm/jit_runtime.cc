@@ -19,29 +19,32 @@ namespace hybridse {
 namespace vm {
 
 thread_local JitRuntime JitRuntime::tls_runtime_inst_;
+std::atomic<size_t> JitRuntime::peak_step_bytes_(0);
 
 JitRuntime* JitRuntime::get() { return &tls_runtime_inst_; }
 
 int8_t* JitRuntime::AllocManaged(size_t bytes) {
-    return reinterpret_cast<int8_t*>(mem_pool_.Alloc(bytes));
+    return reinterpret_cast<int8_t*>(arena_.Alloc(bytes));
 }
 
 void JitRuntime::AddManagedObject(base::FeBaseObject* obj) {
     if (obj != nullptr) {
-        allocated_obj_pool_.push_back(obj);
+        arena_.AddDestructor(
+            [](void* ptr) { delete static_cast<base::FeBaseObject*>(ptr); },
+            obj);
     }
 }
 
 void JitRuntime::InitRunStep() {}
 
 void JitRuntime::ReleaseRunStep() {
-    mem_pool_.Reset();
-    for (base::FeBaseObject* obj : allocated_obj_pool_) {
-        if (obj != nullptr) {
-            delete obj;
-        }
+    last_step_bytes_ = arena_.allocated_bytes();
+    arena_.Reset();
+    size_t peak = peak_step_bytes_.load(std::memory_order_relaxed);
+    while (last_step_bytes_ > peak &&
+           !peak_step_bytes_.compare_exchange_weak(
+               peak, last_step_bytes_, std::memory_order_relaxed)) {
     }
-    allocated_obj_pool_.clear();
 }
 
 }  // namespace vm
@@ -16,7 +16,8 @@
 #ifndef SRC_VM_JIT_RUNTIME_H_
 #define SRC_VM_JIT_RUNTIME_H_
 
-#include <list>
+#include <atomic>
+#include <utility>
 
 #include "base/fe_object.h"
 #include "base/mem_pool.h"
@@ -26,7 +27,7 @@ namespace vm {
 
 class JitRuntime {
  public:
-    JitRuntime() {}
+    JitRuntime() : last_step_bytes_(0) {}
 
     /**
      * Get TLS JIT runtime instance.
@@ -41,8 +42,17 @@ class JitRuntime {
     int8_t* AllocManaged(size_t bytes);
 
     /**
-     * Register object to be managed by runtime.
-     * All managed objects will be released by `ReleaseRunStep()`.
+     * Construct object in the runtime arena.
+     * The object is destructed by `ReleaseRunStep()`.
+     */
+    template <typename T, typename... Args>
+    T* NewManagedObject(Args&&... args) {
+        return arena_.New<T>(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Register heap object to be managed by runtime.
+     * All managed objects will be deleted by `ReleaseRunStep()`.
      */
     void AddManagedObject(base::FeBaseObject* obj);
 
@@ -56,9 +66,37 @@ class JitRuntime {
      */
     void ReleaseRunStep();
 
+    /**
+     * Bytes held by this runtime between run steps
+     */
+    size_t reserved_bytes() const { return arena_.reserved_bytes(); }
+
+    /**
+     * Bytes allocated by the last released run step of this runtime
+     */
+    size_t last_step_bytes() const { return last_step_bytes_; }
+
+    /**
+     * Max bytes allocated in one run step of this runtime
+     */
+    size_t peak_bytes() const { return arena_.peak_bytes(); }
+
+    /**
+     * Max bytes allocated in one run step of all runtimes of the process
+     */
+    static size_t GetPeakStepBytes() {
+        return peak_step_bytes_.load(std::memory_order_relaxed);
+    }
+
  private:
-    base::ByteMemoryPool mem_pool_;
-    std::list<base::FeBaseObject*> allocated_obj_pool_;
+    // up to 1MB of chunks are kept for the next run steps, trimmed to the
+    // peak bytes of recent steps
+    base::ArenaMemoryPool arena_;
+    size_t last_step_bytes_;
+
+    // only written when a run step exceeds it, so steady steps do no atomic
+    // read-modify-write
+    static std::atomic<size_t> peak_step_bytes_;
 
     static thread_local JitRuntime tls_runtime_inst_;
 };
@@ -143,6 +143,44 @@ TEST_F(JITTest, test_udf_invoke_module) {
     }
 }
 
+static std::unique_ptr<Module> BuildAdd1Module(LLVMContext *ctx) {
+    auto m = make_unique<Module>("add1_module", *ctx);
+    Function *add1 = Function::Create(
+        FunctionType::get(Type::getInt32Ty(*ctx), {Type::getInt32Ty(*ctx)},
+                          false),
+        Function::ExternalLinkage, "add1", m.get());
+    BasicBlock *bb = BasicBlock::Create(*ctx, "EntryBlock", add1);
+    IRBuilder<> builder(bb);
+    Value *add = builder.CreateAdd(builder.getInt32(1), &*add1->arg_begin());
+    builder.CreateRet(add);
+    return m;
+}
+
+TEST_F(JITTest, test_compile_and_add_object) {
+    std::string object;
+    {
+        HybridSeLlvmJitWrapper jit;
+        ASSERT_TRUE(jit.Init());
+        auto ctx = llvm::make_unique<LLVMContext>();
+        auto m = BuildAdd1Module(ctx.get());
+        ASSERT_TRUE(jit.OptModule(m.get()));
+        ASSERT_TRUE(jit.CompileModule(std::move(m), std::move(ctx), &object));
+        ASSERT_FALSE(object.empty());
+        auto add1 = reinterpret_cast<int32_t (*)(int32_t)>(
+            const_cast<int8_t *>(jit.FindFunction("add1")));
+        ASSERT_TRUE(add1 != nullptr);
+        ASSERT_EQ(3, add1(2));
+    }
+    // load the object into another jit without ir
+    HybridSeLlvmJitWrapper jit;
+    ASSERT_TRUE(jit.Init());
+    ASSERT_TRUE(jit.AddObject(object));
+    auto add1 = reinterpret_cast<int32_t (*)(int32_t)>(
+        const_cast<int8_t *>(jit.FindFunction("add1")));
+    ASSERT_TRUE(add1 != nullptr);
+    ASSERT_EQ(5, add1(4));
+}
+
 }  // namespace vm
 }  // namespace hybridse
 
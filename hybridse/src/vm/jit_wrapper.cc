@@ -59,6 +59,15 @@ bool HybridSeJitWrapper::AddModuleFromBuffer(const base::RawBuffer& buf) {
     return this->AddModule(std::move(llvm_module), std::move(llvm_ctx));
 }
 
+bool HybridSeJitWrapper::CompileModule(
+    std::unique_ptr<llvm::Module> module,
+    std::unique_ptr<llvm::LLVMContext> llvm_ctx, std::string* object) {
+    if (object != nullptr) {
+        object->clear();
+    }
+    return this->AddModule(std::move(module), std::move(llvm_ctx));
+}
+
 bool HybridSeJitWrapper::InitJitSymbols(HybridSeJitWrapper* jit) {
     InitBuiltinJitSymbols(jit);
     udf::DefaultUdfLibrary::get()->InitJITSymbols(jit);
@@ -76,14 +85,14 @@ HybridSeJitWrapper* HybridSeJitWrapper::Create(const JitOptions& jit_options) {
         return new HybridSeMcJitWrapper(jit_options);
 #else
         LOG(WARNING) << "McJit support is not enabled";
-        return new HybridSeLlvmJitWrapper();
+        return new HybridSeLlvmJitWrapper(jit_options);
 #endif
     } else {
         if (jit_options.is_enable_vtune() || jit_options.is_enable_perf() ||
             jit_options.is_enable_gdb()) {
             LOG(WARNING) << "LLJIT do not support jit events";
         }
-        return new HybridSeLlvmJitWrapper();
+        return new HybridSeLlvmJitWrapper(jit_options);
     }
 }
 
@@ -48,9 +48,25 @@ class HybridSeJitWrapper {
 
     bool AddModuleFromBuffer(const base::RawBuffer&);
 
+    // Add an optimized module and output its object code, `object` is left
+    // empty if the jit can not emit object code.
+    virtual bool CompileModule(std::unique_ptr<llvm::Module> module,
+                               std::unique_ptr<llvm::LLVMContext> llvm_ctx,
+                               std::string* object);
+
+    // Add object code output by CompileModule
+    virtual bool AddObject(const std::string& object) { return false; }
+
     virtual hybridse::vm::RawPtrHandle FindFunction(
         const std::string& funcname) = 0;
 
+    // Return code and data sections allocated by this jit, which are freed
+    // with the jit
+    virtual JitMemoryStats GetMemoryStats() const { return JitMemoryStats(); }
+
+    // Return code and data sections allocated by all alive jits
+    static JitMemoryStats GetTotalMemoryStats();
+
     static HybridSeJitWrapper* Create(const JitOptions& jit_options);
     static HybridSeJitWrapper* Create();
     static void DeleteJit(HybridSeJitWrapper* jit);
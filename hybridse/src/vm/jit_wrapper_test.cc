@@ -19,6 +19,7 @@
 #include "gtest/gtest.h"
 #include "udf/udf.h"
 #include "vm/engine.h"
+#include "vm/jit_runtime.h"
 #include "vm/simple_catalog.h"
 #include "vm/sql_compiler.h"
 
@@ -105,6 +106,83 @@ TEST_F(JitWrapperTest, test) {
     simple_test(options);
 }
 
+TEST_F(JitWrapperTest, test_memory_stats) {
+    EngineOptions options;
+    options.set_keep_ir(true);
+    auto catalog = GetTestCatalog();
+    auto compile_info = Compile("select col_1, col_2 + 1 from t1;", options, catalog);
+    std::string ir_str = compile_info->get_sql_context().ir;
+    ASSERT_FALSE(ir_str.empty());
+
+    auto before = HybridSeJitWrapper::GetTotalMemoryStats();
+    HybridSeJitWrapper *jit = HybridSeJitWrapper::Create();
+    ASSERT_TRUE(jit->Init());
+    HybridSeJitWrapper::InitJitSymbols(jit);
+    base::RawBuffer ir_buf(const_cast<char *>(ir_str.data()), ir_str.size());
+    ASSERT_TRUE(jit->AddModuleFromBuffer(ir_buf));
+    // code is emitted lazily on the first lookup
+    auto fn_name = compile_info->get_sql_context().physical_plan->GetFnInfos()[0]->fn_name();
+    ASSERT_TRUE(jit->FindFunction(fn_name) != nullptr);
+
+    auto stats = jit->GetMemoryStats();
+    ASSERT_GT(stats.code_bytes, 0u);
+    ASSERT_EQ(1u, stats.object_cnt);
+    auto total = HybridSeJitWrapper::GetTotalMemoryStats();
+    ASSERT_EQ(before.code_bytes + stats.code_bytes, total.code_bytes);
+    ASSERT_EQ(before.data_bytes + stats.data_bytes, total.data_bytes);
+
+    // freed with the jit
+    delete jit;
+    total = HybridSeJitWrapper::GetTotalMemoryStats();
+    ASSERT_EQ(before.code_bytes, total.code_bytes);
+    ASSERT_EQ(before.object_cnt, total.object_cnt);
+}
+
+TEST_F(JitWrapperTest, test_run_step_peak_bytes) {
+    EngineOptions options;
+    options.set_keep_ir(true);
+    auto catalog = GetTestCatalog();
+    // timestamp to string allocates the output in the jit runtime
+    auto compile_info = Compile("select string(timestamp(col_2)) as s from t1;",
+                                options, catalog);
+    std::string ir_str = compile_info->get_sql_context().ir;
+    ASSERT_FALSE(ir_str.empty());
+    HybridSeJitWrapper *jit = HybridSeJitWrapper::Create();
+    ASSERT_TRUE(jit->Init());
+    HybridSeJitWrapper::InitJitSymbols(jit);
+    base::RawBuffer ir_buf(const_cast<char *>(ir_str.data()), ir_str.size());
+    ASSERT_TRUE(jit->AddModuleFromBuffer(ir_buf));
+    auto fn_name = compile_info->get_sql_context()
+                       .physical_plan->GetFnInfos()[0]
+                       ->fn_name();
+    auto fn = jit->FindFunction(fn_name);
+    ASSERT_TRUE(fn != nullptr);
+
+    int8_t buf[1024];
+    auto schema = catalog->GetTable("db", "t1")->GetSchema();
+    codec::RowBuilder row_builder(*schema);
+    row_builder.SetBuffer(buf, 1024);
+    row_builder.AppendDouble(3.14);
+    row_builder.AppendInt64(1590115420000L);
+    hybridse::codec::Row empty_parameter;
+    hybridse::codec::Row row(base::RefCountedSlice::Create(buf, 1024));
+    ASSERT_FALSE(CoreAPI::RowProject(fn, row, empty_parameter).empty());
+
+    // the step is released by the run, its bytes are kept as peak stats
+    auto runtime = JitRuntime::get();
+    ASSERT_GT(runtime->last_step_bytes(), 0u);
+    ASSERT_GE(runtime->peak_bytes(), runtime->last_step_bytes());
+    ASSERT_GE(Engine::GetRunStepPeakBytes(), runtime->peak_bytes());
+
+    // a smaller step does not lower the peak
+    size_t peak = Engine::GetRunStepPeakBytes();
+    runtime->InitRunStep();
+    runtime->ReleaseRunStep();
+    ASSERT_EQ(0u, runtime->last_step_bytes());
+    ASSERT_EQ(peak, Engine::GetRunStepPeakBytes());
+    delete jit;
+}
+
 #ifdef LLVM_EXT_ENABLE
 TEST_F(JitWrapperTest, test_mcjit) {
     EngineOptions options;
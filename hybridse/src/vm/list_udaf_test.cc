@@ -0,0 +1,187 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "llvm/Support/TargetSelect.h"
+#include "testing/engine_test_base.h"
+#include "vm/engine.h"
+
+namespace hybridse {
+namespace vm {
+
+// Builtin udafs over NOT NULL window columns are computed by their list
+// functions, compare them with the same udafs over expressions, which are
+// computed row by row.
+class ListUdafTest : public ::testing::Test {
+ public:
+    ListUdafTest() {}
+    ~ListUdafTest() {}
+
+    void SetUp() override {
+        catalog_ = BuildSimpleCatalog();
+        hybridse::type::Database db;
+        db.set_name("simple_db");
+        table_def_.set_name("t1");
+        AddColumn("key", type::kVarchar, true);
+        AddColumn("ts", type::kInt64, true);
+        AddColumn("a", type::kInt32, true);
+        AddColumn("b", type::kDouble, true);
+        AddColumn("f", type::kBool, true);
+        AddColumn("na", type::kInt32, false);
+        AddColumn("nb", type::kDouble, false);
+        AddColumn("nf", type::kBool, false);
+        auto index = table_def_.add_indexes();
+        index->set_name("index1");
+        index->add_first_keys("key");
+        index->set_second_key("ts");
+        AddTable(db, table_def_);
+        catalog_->AddDatabase(db);
+
+        // key, ts, a, b, f, na, nb, nf, nullptr is NULL
+        std::vector<std::vector<const char*>> values = {
+            {"k1", "1", "3", "1.5", "1", "3", "1.5", "1"},
+            {"k1", "2", "-2", "0.25", "0", nullptr, nullptr, "1"},
+            {"k1", "3", "7", "-4.5", "1", "7", "-4.5", nullptr},
+            {"k1", "4", "0", "2", "1", nullptr, nullptr, nullptr},
+            {"k1", "5", "5", "8.75", "0", "5", "8.75", "0"},
+            {"k1", "6", "-1", "0.5", "1", "-1", "0.5", "1"},
+            {"k2", "1", "1", "1", "1", nullptr, nullptr, "1"},
+            {"k2", "2", "9", "-1", "1", nullptr, nullptr, "0"},
+            {"k2", "3", "4", "3", "0", nullptr, "3", "1"},
+        };
+        std::vector<Row> rows;
+        for (auto& row : values) {
+            rows.push_back(BuildRow(row));
+        }
+        ASSERT_TRUE(catalog_->InsertRows("simple_db", "t1", rows));
+    }
+
+    void AddColumn(const std::string& name, type::Type type,
+                   bool is_not_null) {
+        auto column = table_def_.add_columns();
+        column->set_name(name);
+        column->set_type(type);
+        column->set_is_not_null(is_not_null);
+    }
+
+    Row BuildRow(const std::vector<const char*>& values) {
+        codec::RowBuilder builder(table_def_.columns());
+        uint32_t str_length = strlen(values[0]);
+        uint32_t total_size = builder.CalTotalLength(str_length);
+        int8_t* buf = static_cast<int8_t*>(malloc(total_size));
+        builder.SetBuffer(buf, total_size);
+        for (int i = 0; i < table_def_.columns_size(); i++) {
+            if (values[i] == nullptr) {
+                builder.AppendNULL();
+                continue;
+            }
+            switch (table_def_.columns(i).type()) {
+                case type::kVarchar:
+                    builder.AppendString(values[i], strlen(values[i]));
+                    break;
+                case type::kInt32:
+                    builder.AppendInt32(std::stoi(values[i]));
+                    break;
+                case type::kInt64:
+                    builder.AppendInt64(std::stoll(values[i]));
+                    break;
+                case type::kDouble:
+                    builder.AppendDouble(std::stod(values[i]));
+                    break;
+                case type::kBool:
+                    builder.AppendBool(std::stoi(values[i]) == 1);
+                    break;
+                default:
+                    break;
+            }
+        }
+        return Row(base::RefCountedSlice::CreateManaged(buf, total_size));
+    }
+
+    // run the window projects on t1, return output rows as strings
+    std::vector<std::string> Run(const std::string& projects) {
+        std::string sql = "select key, ts, " + projects +
+                          " from t1 window w as (partition by key order by "
+                          "ts rows between 2 preceding and current row);";
+        EngineOptions options;
+        Engine engine(catalog_, options);
+        base::Status status;
+        BatchRunSession session;
+        std::vector<std::string> result;
+        if (!engine.Get(sql, "simple_db", session, status)) {
+            ADD_FAILURE() << "fail to compile " << sql << ": " << status;
+            return result;
+        }
+        std::vector<Row> output;
+        EXPECT_EQ(0, session.Run(output));
+        codec::RowView row_view(session.GetSchema());
+        for (auto& row : output) {
+            row_view.Reset(row.buf(), row.size());
+            result.push_back(row_view.GetRowString());
+        }
+        return result;
+    }
+
+    void CheckSameAsRowByRow(const std::string& list_projects,
+                             const std::string& row_projects) {
+        auto list_result = Run(list_projects);
+        auto row_result = Run(row_projects);
+        ASSERT_EQ(9u, list_result.size());
+        ASSERT_EQ(row_result, list_result);
+    }
+
+ protected:
+    hybridse::type::TableDef table_def_;
+    std::shared_ptr<SimpleCatalog> catalog_;
+};
+
+TEST_F(ListUdafTest, NotNullColumnTest) {
+    CheckSameAsRowByRow(
+        "sum(a) over w, avg(a) over w, min(a) over w, max(a) over w, "
+        "sum(b) over w, avg(b) over w, min(b) over w, max(b) over w, "
+        "count_where(a, f) over w, count_where(b, f) over w",
+        "sum(a + 0) over w, avg(a + 0) over w, min(a + 0) over w, "
+        "max(a + 0) over w, sum(b + 0.0) over w, avg(b + 0.0) over w, "
+        "min(b + 0.0) over w, max(b + 0.0) over w, "
+        "count_where(a + 0, f) over w, count_where(b + 0.0, f) over w");
+}
+
+TEST_F(ListUdafTest, NullableColumnTest) {
+    // windows of k2 have only NULL values in na
+    CheckSameAsRowByRow(
+        "sum(na) over w, avg(na) over w, min(na) over w, max(na) over w, "
+        "sum(nb) over w, min(nb) over w, max(nb) over w, "
+        "count_where(na, nf) over w, count_where(na, f) over w, "
+        "count_where(a, nf) over w",
+        "sum(na + 0) over w, avg(na + 0) over w, min(na + 0) over w, "
+        "max(na + 0) over w, sum(nb + 0.0) over w, min(nb + 0.0) over w, "
+        "max(nb + 0.0) over w, count_where(na + 0, nf) over w, "
+        "count_where(na + 0, f) over w, count_where(a + 0, nf) over w");
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    return RUN_ALL_TESTS();
+}
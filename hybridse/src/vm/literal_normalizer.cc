@@ -0,0 +1,252 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/literal_normalizer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "glog/logging.h"
+#include "node/node_manager.h"
+#include "planv2/ast_node_converter.h"
+#include "zetasql/parser/parser.h"
+
+namespace hybridse {
+namespace vm {
+
+struct LiftedLiteral {
+    // byte range of the literal in the sql
+    size_t begin;
+    size_t end;
+    const node::ConstNode* value;
+};
+
+static bool IsCompareOp(zetasql::ASTBinaryExpression::Op op) {
+    switch (op) {
+        case zetasql::ASTBinaryExpression::Op::EQ:
+        case zetasql::ASTBinaryExpression::Op::NE:
+        case zetasql::ASTBinaryExpression::Op::NE2:
+        case zetasql::ASTBinaryExpression::Op::GT:
+        case zetasql::ASTBinaryExpression::Op::LT:
+        case zetasql::ASTBinaryExpression::Op::GE:
+        case zetasql::ASTBinaryExpression::Op::LE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool IsLiteral(const zetasql::ASTExpression* expr) {
+    switch (expr->node_kind()) {
+        case zetasql::AST_INT_LITERAL:
+        case zetasql::AST_FLOAT_LITERAL:
+        case zetasql::AST_STRING_LITERAL:
+            return true;
+        case zetasql::AST_UNARY_EXPRESSION: {
+            // negative numbers
+            auto unary = expr->GetAsOrDie<zetasql::ASTUnaryExpression>();
+            return zetasql::ASTUnaryExpression::Op::MINUS == unary->op() &&
+                   (zetasql::AST_INT_LITERAL ==
+                        unary->operand()->node_kind() ||
+                    zetasql::AST_FLOAT_LITERAL ==
+                        unary->operand()->node_kind());
+        }
+        default:
+            return false;
+    }
+}
+
+static bool ToParameterType(node::DataType data_type, type::Type* type) {
+    switch (data_type) {
+        case node::kInt32:
+            *type = type::kInt32;
+            return true;
+        case node::kInt64:
+            *type = type::kInt64;
+            return true;
+        case node::kFloat:
+            *type = type::kFloat;
+            return true;
+        case node::kDouble:
+            *type = type::kDouble;
+            return true;
+        case node::kVarchar:
+            *type = type::kVarchar;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// lift the operand if it is a literal, with the value the planner gives it
+static void LiftOperand(const zetasql::ASTExpression* operand,
+                        node::NodeManager* nm,
+                        std::vector<LiftedLiteral>* lifted) {
+    if (!IsLiteral(operand)) {
+        return;
+    }
+    node::ExprNode* expr = nullptr;
+    // e.g. hex and overflowed integers are rejected by the planner, the sql
+    // fails to compile whether or not they are lifted
+    if (!plan::ConvertExprNode(operand, nm, &expr).isOK() ||
+        node::kExprPrimary != expr->GetExprType()) {
+        return;
+    }
+    auto value = dynamic_cast<const node::ConstNode*>(expr);
+    type::Type type;
+    if (nullptr == value || value->IsNull() ||
+        !ToParameterType(value->GetDataType(), &type)) {
+        return;
+    }
+    auto& range = operand->GetParseLocationRange();
+    lifted->push_back({static_cast<size_t>(range.start().GetByteOffset()),
+                       static_cast<size_t>(range.end().GetByteOffset()),
+                       value});
+}
+
+// collect literals compared in where clauses under `node`, return false if
+// the sql has parameters already
+static bool CollectLiterals(const zetasql::ASTNode* node, bool in_where,
+                            node::NodeManager* nm,
+                            std::vector<LiftedLiteral>* lifted) {
+    if (zetasql::AST_PARAMETER_EXPR == node->node_kind()) {
+        return false;
+    }
+    if (zetasql::AST_WHERE_CLAUSE == node->node_kind()) {
+        in_where = true;
+    } else if (zetasql::AST_QUERY == node->node_kind()) {
+        // a sub query has its own where clause, limit and windows
+        in_where = false;
+    }
+    if (in_where && zetasql::AST_BINARY_EXPRESSION == node->node_kind()) {
+        auto binary = node->GetAsOrDie<zetasql::ASTBinaryExpression>();
+        if (!binary->is_not() && IsCompareOp(binary->op())) {
+            LiftOperand(binary->lhs(), nm, lifted);
+            LiftOperand(binary->rhs(), nm, lifted);
+        }
+    }
+    for (int i = 0; i < node->num_children(); i++) {
+        if (!CollectLiterals(node->child(i), in_where, nm, lifted)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool AppendValue(const node::ConstNode* value, type::Type type,
+                        codec::RowBuilder* builder) {
+    switch (type) {
+        case type::kInt32:
+            return builder->AppendInt32(value->GetInt());
+        case type::kInt64:
+            return builder->AppendInt64(value->GetLong());
+        case type::kFloat:
+            return builder->AppendFloat(value->GetFloat());
+        case type::kDouble:
+            return builder->AppendDouble(value->GetDouble());
+        case type::kVarchar:
+            return builder->AppendString(value->GetStr(),
+                                         strlen(value->GetStr()));
+        default:
+            return false;
+    }
+}
+
+bool LiteralNormalizer::Normalize(const std::string& sql,
+                                  std::string* normalized_sql,
+                                  codec::Schema* parameter_types,
+                                  codec::Row* parameter_row) {
+    if (normalized_sql == nullptr || parameter_types == nullptr ||
+        parameter_row == nullptr) {
+        return false;
+    }
+    std::unique_ptr<zetasql::ParserOutput> parser_output;
+    auto zetasql_status = zetasql::ParseScript(
+        sql, zetasql::ParserOptions(),
+        zetasql::ERROR_MESSAGE_MULTI_LINE_WITH_CARET, &parser_output);
+    if (!zetasql_status.ok()) {
+        // the compile reports the syntax error
+        return false;
+    }
+    auto script = parser_output->script();
+    if (script->statement_list().size() != 1 ||
+        zetasql::AST_QUERY_STATEMENT !=
+            script->statement_list()[0]->node_kind()) {
+        return false;
+    }
+    node::NodeManager nm;
+    std::vector<LiftedLiteral> lifted;
+    if (!CollectLiterals(script->statement_list()[0], false, &nm, &lifted) ||
+        lifted.empty()) {
+        return false;
+    }
+    std::sort(lifted.begin(), lifted.end(),
+              [](const LiftedLiteral& l, const LiftedLiteral& r) {
+                  return l.begin < r.begin;
+              });
+
+    codec::Schema types;
+    uint32_t str_length = 0;
+    std::string normalized;
+    size_t last = 0;
+    for (auto& literal : lifted) {
+        type::Type type;
+        ToParameterType(literal.value->GetDataType(), &type);
+        types.Add()->set_type(type);
+        if (type::kVarchar == type) {
+            str_length += strlen(literal.value->GetStr());
+        }
+        normalized.append(sql, last, literal.begin - last).append("?");
+        last = literal.end;
+    }
+    normalized.append(sql, last, std::string::npos);
+
+    codec::RowBuilder builder(types);
+    uint32_t total_size = builder.CalTotalLength(str_length);
+    int8_t* buf = static_cast<int8_t*>(malloc(total_size));
+    builder.SetBuffer(buf, total_size);
+    for (int i = 0; i < types.size(); i++) {
+        if (!AppendValue(lifted[i].value, types.Get(i).type(), &builder)) {
+            LOG(WARNING) << "fail to bind literal "
+                         << sql.substr(lifted[i].begin,
+                                       lifted[i].end - lifted[i].begin);
+            free(buf);
+            return false;
+        }
+    }
+    *normalized_sql = normalized;
+    *parameter_types = types;
+    *parameter_row =
+        codec::Row(base::RefCountedSlice::CreateManaged(buf, total_size));
+    return true;
+}
+
+std::string LiteralNormalizer::TypeSignature(
+    const codec::Schema& parameter_types) {
+    std::string signature;
+    for (int i = 0; i < parameter_types.size(); i++) {
+        if (i > 0) {
+            signature.append(",");
+        }
+        signature.append(type::Type_Name(parameter_types.Get(i).type()));
+    }
+    return signature;
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_VM_LITERAL_NORMALIZER_H_
+#define SRC_VM_LITERAL_NORMALIZER_H_
+
+#include <string>
+#include "codec/fe_row_codec.h"
+
+namespace hybridse {
+namespace vm {
+
+/// Lift literals of a batch sql into query parameters, so queries of the
+/// same shape share one compiled plan.
+///
+/// Only literals compared in where clauses are lifted, e.g.
+///   select col1 from t1 where col2 > 10 and col0 = 'a';
+/// is normalized to
+///   select col1 from t1 where col2 > ? and col0 = ?;
+/// with parameter types (int32, string) and parameter row (10, "a").
+/// Literals are found on the parsed sql and typed the way the planner types
+/// them, so quoting, escapes and negative numbers follow the parser. Literals
+/// elsewhere (projections, limits, window frames, function arguments) may
+/// decide the output schema or the plan, and are kept as they are.
+class LiteralNormalizer {
+ public:
+    /// Return `false` if nothing is lifted or the sql already has
+    /// parameters, in which case outputs are left untouched.
+    static bool Normalize(const std::string& sql, std::string* normalized_sql,
+                          codec::Schema* parameter_types,
+                          codec::Row* parameter_row);
+
+    /// Signature of parameter types, e.g. "kInt32,kVarchar"
+    static std::string TypeSignature(const codec::Schema& parameter_types);
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // SRC_VM_LITERAL_NORMALIZER_H_
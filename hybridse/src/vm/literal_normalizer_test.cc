@@ -0,0 +1,150 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/literal_normalizer.h"
+#include <string>
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace vm {
+
+class LiteralNormalizerTest : public ::testing::Test {};
+
+TEST_F(LiteralNormalizerTest, normalize_test) {
+    std::string normalized;
+    codec::Schema types;
+    codec::Row row;
+    ASSERT_TRUE(LiteralNormalizer::Normalize(
+        "select col1 from t1 where col2 > 10 and col0 = 'abc' and 3000000000 <= col5 and col3 != 1.5f "
+        "and col4 = 2.5 and col5 = 7L;",
+        &normalized, &types, &row));
+    ASSERT_EQ(
+        "select col1 from t1 where col2 > ? and col0 = ? and ? <= col5 and col3 != ? and col4 = ? and col5 = ?;",
+        normalized);
+    ASSERT_EQ(6, types.size());
+    ASSERT_EQ(type::kInt32, types.Get(0).type());
+    ASSERT_EQ(type::kVarchar, types.Get(1).type());
+    ASSERT_EQ(type::kInt64, types.Get(2).type());
+    ASSERT_EQ(type::kFloat, types.Get(3).type());
+    ASSERT_EQ(type::kDouble, types.Get(4).type());
+    ASSERT_EQ(type::kInt64, types.Get(5).type());
+    ASSERT_EQ("kInt32,kVarchar,kInt64,kFloat,kDouble,kInt64", LiteralNormalizer::TypeSignature(types));
+
+    codec::RowView row_view(types, row.buf(), row.size());
+    int32_t i32 = 0;
+    int64_t i64 = 0;
+    float f = 0;
+    double d = 0;
+    const char* str = nullptr;
+    uint32_t str_size = 0;
+    ASSERT_EQ(0, row_view.GetInt32(0, &i32));
+    ASSERT_EQ(10, i32);
+    ASSERT_EQ(0, row_view.GetString(1, &str, &str_size));
+    ASSERT_EQ("abc", std::string(str, str_size));
+    ASSERT_EQ(0, row_view.GetInt64(2, &i64));
+    ASSERT_EQ(3000000000L, i64);
+    ASSERT_EQ(0, row_view.GetFloat(3, &f));
+    ASSERT_FLOAT_EQ(1.5f, f);
+    ASSERT_EQ(0, row_view.GetDouble(4, &d));
+    ASSERT_DOUBLE_EQ(2.5, d);
+    ASSERT_EQ(0, row_view.GetInt64(5, &i64));
+    ASSERT_EQ(7L, i64);
+}
+
+TEST_F(LiteralNormalizerTest, keep_literal_test) {
+    std::string normalized;
+    codec::Schema types;
+    codec::Row row;
+    // literals out of where clauses
+    ASSERT_FALSE(LiteralNormalizer::Normalize(
+        "select col1 + 1, substr(col0, 1, 2) from t1 where substr(col0, 1, 2) = col3 limit 10;", &normalized,
+        &types, &row));
+    ASSERT_FALSE(LiteralNormalizer::Normalize(
+        "select sum(col1) over w1 from t1 window w1 as (partition by col0 order by col5 rows_range between 3d "
+        "preceding and current row);",
+        &normalized, &types, &row));
+    // parameterized already
+    ASSERT_FALSE(LiteralNormalizer::Normalize("select col1 from t1 where col2 > ? and col3 = 1;", &normalized,
+                                              &types, &row));
+    // prefixed, typed and hex literals
+    ASSERT_FALSE(LiteralNormalizer::Normalize(
+        "select col1 from t1 where col0 = b'ab' or col5 > timestamp '2021-01-01' or col2 > 0x1f;", &normalized,
+        &types, &row));
+    ASSERT_TRUE(normalized.empty());
+    ASSERT_EQ(0, types.size());
+    // literals in comments
+    ASSERT_FALSE(LiteralNormalizer::Normalize("select col1 from t1 -- where col2 > 1\n;", &normalized, &types,
+                                              &row));
+    // overflowed integer
+    ASSERT_FALSE(LiteralNormalizer::Normalize("select col1 from t1 where col2 > 99999999999999999999;",
+                                              &normalized, &types, &row));
+    // unclosed string
+    ASSERT_FALSE(LiteralNormalizer::Normalize("select col1 from t1 where col0 = 'abc;", &normalized, &types,
+                                              &row));
+}
+
+TEST_F(LiteralNormalizerTest, parsed_literal_test) {
+    std::string normalized;
+    codec::Schema types;
+    codec::Row row;
+    // escapes and negative numbers follow the parser, binary minus is kept
+    ASSERT_TRUE(LiteralNormalizer::Normalize(
+        "select col1 from t1 where col0 = 'a\\'b' and col2 > -3 and col2 - 3 > col1 limit 10;", &normalized,
+        &types, &row));
+    ASSERT_EQ("select col1 from t1 where col0 = ? and col2 > ? and col2 - 3 > col1 limit 10;", normalized);
+    ASSERT_EQ(2, types.size());
+    codec::RowView row_view(types, row.buf(), row.size());
+    const char* str = nullptr;
+    uint32_t str_size = 0;
+    int32_t i32 = 0;
+    ASSERT_EQ(0, row_view.GetString(0, &str, &str_size));
+    ASSERT_EQ("a'b", std::string(str, str_size));
+    ASSERT_EQ(0, row_view.GetInt32(1, &i32));
+    ASSERT_EQ(-3, i32);
+
+    // frame bounds and limits of sub queries are kept
+    ASSERT_TRUE(LiteralNormalizer::Normalize(
+        "select col1, sum(col2) over w1 from (select * from t1 where col2 > 1 limit 5) as t "
+        "window w1 as (partition by col0 order by col5 rows between 3 preceding and current row);",
+        &normalized, &types, &row));
+    ASSERT_EQ(
+        "select col1, sum(col2) over w1 from (select * from t1 where col2 > ? limit 5) as t "
+        "window w1 as (partition by col0 order by col5 rows between 3 preceding and current row);",
+        normalized);
+    ASSERT_EQ(1, types.size());
+}
+
+TEST_F(LiteralNormalizerTest, sub_query_test) {
+    std::string normalized;
+    codec::Schema types;
+    codec::Row row;
+    ASSERT_TRUE(LiteralNormalizer::Normalize(
+        "select * from (select col1, col2 + 1 as c from t1 where (col2 = 1 or col2 < 5)) as t where c > 3 "
+        "order by c;",
+        &normalized, &types, &row));
+    ASSERT_EQ("select * from (select col1, col2 + 1 as c from t1 where (col2 = ? or col2 < ?)) as t where c > ? "
+              "order by c;",
+              normalized);
+    ASSERT_EQ(3, types.size());
+}
+
+}  // namespace vm
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -341,6 +341,43 @@ int PhysicalSimpleProjectNode::GetSelectSourceIndex() const {
     return cur_schema_idx;
 }
 
+bool PhysicalSimpleProjectNode::GetSelectColumnIndexes(
+    std::vector<size_t>* column_idxs) const {
+    auto input_schemas_ctx = GetProducer(0)->schemas_ctx();
+    if (input_schemas_ctx->GetSchemaSourceSize() != 1) {
+        return false;
+    }
+    column_idxs->clear();
+    for (size_t i = 0; i < project_.size(); ++i) {
+        Status status;
+        size_t schema_idx;
+        size_t col_idx;
+        auto expr = project_.GetExpr(i);
+        switch (expr->GetExprType()) {
+            case node::kExprColumnId: {
+                status = input_schemas_ctx->ResolveColumnIndexByID(
+                    dynamic_cast<const node::ColumnIdNode*>(expr)
+                        ->GetColumnID(),
+                    &schema_idx, &col_idx);
+                break;
+            }
+            case node::kExprColumnRef: {
+                status = input_schemas_ctx->ResolveColumnRefIndex(
+                    dynamic_cast<const node::ColumnRefNode*>(expr), &schema_idx,
+                    &col_idx);
+                break;
+            }
+            default:
+                return false;
+        }
+        if (!status.isOK()) {
+            return false;
+        }
+        column_idxs->push_back(col_idx);
+    }
+    return !column_idxs->empty();
+}
+
 Status PhysicalSimpleProjectNode::InitSchema(PhysicalPlanContext* ctx) {
     auto input_schemas_ctx = GetProducer(0)->schemas_ctx();
     // init project fn
@@ -584,6 +621,9 @@ Status Filter::ReplaceExpr(const passes::ExprReplacer& replacer,
     CHECK_STATUS(left_key_.ReplaceExpr(replacer, nm, &out->left_key_));
     CHECK_STATUS(right_key_.ReplaceExpr(replacer, nm, &out->right_key_));
     CHECK_STATUS(index_key_.ReplaceExpr(replacer, nm, &out->index_key_));
+    out->has_ts_range_ = has_ts_range_;
+    out->ts_start_ = ts_start_;
+    out->ts_end_ = ts_end_;
     return Status::OK();
 }
 
@@ -604,6 +644,7 @@ Status Join::ReplaceExpr(const passes::ExprReplacer& replacer,
                          node::NodeManager* nm, Join* out) const {
     CHECK_STATUS(this->Filter::ReplaceExpr(replacer, nm, out));
     out->join_type_ = join_type_;
+    out->hash_join_ = hash_join_;
     CHECK_STATUS(right_sort_.ReplaceExpr(replacer, nm, &out->right_sort_));
     return Status::OK();
 }
@@ -14,7 +14,10 @@
  * limitations under the License.
  */
 
+#include "vm/physical_op.h"
 #include "gtest/gtest.h"
+#include "node/node_manager.h"
+#include "passes/expression/expr_pass.h"
 namespace hybridse {
 namespace vm {
 class PhysicalOpTest : public ::testing::Test {
@@ -23,6 +26,27 @@ class PhysicalOpTest : public ::testing::Test {
     ~PhysicalOpTest() {}
 };
 TEST_F(PhysicalOpTest, test) {}
+
+TEST_F(PhysicalOpTest, filter_replace_expr_keeps_ts_range) {
+    node::NodeManager nm;
+    auto condition = nm.MakeBinaryExprNode(
+        nm.MakeColumnRefNode("col5", "t1"),
+        nm.MakeConstNode(static_cast<int64_t>(100)), node::kFnOpGe);
+    Filter filter(condition);
+    filter.set_ts_range(100, INT64_MAX);
+
+    passes::ExprReplacer replacer;
+    replacer.AddReplacement("t1", "col5", nm.MakeColumnRefNode("col5", "t2"));
+    Filter out(nullptr);
+    ASSERT_TRUE(filter.ReplaceExpr(replacer, &nm, &out).isOK());
+    auto col = dynamic_cast<const node::ColumnRefNode*>(
+        out.condition().condition()->GetChild(0));
+    ASSERT_TRUE(col != nullptr);
+    ASSERT_EQ("t2", col->GetRelationName());
+    ASSERT_TRUE(out.has_ts_range());
+    ASSERT_EQ(100, out.ts_start());
+    ASSERT_EQ(INT64_MAX, out.ts_end());
+}
 }  // namespace vm
 }  // namespace hybridse
 int main(int argc, char** argv) {
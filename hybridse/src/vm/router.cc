@@ -15,6 +15,7 @@
  */
 
 #include "vm/router.h"
+#include <algorithm>
 #include "glog/logging.h"
 #include "node/sql_node.h"
 namespace hybridse {
@@ -72,5 +73,143 @@ int Router::Parse(const PhysicalOpNode* physical_plan) {
     return 1;
 }
 
+void Router::ParseScatter(const PhysicalOpNode* physical_plan) {
+    partial_agg_merges_.clear();
+    scatterable_ = physical_plan != nullptr &&
+                   (IsRowWiseScan(physical_plan) ||
+                    ParsePartialAggregation(physical_plan));
+}
+
+static bool GetPartialAggMerge(const node::ExprNode* expr,
+                               const node::ExprListNode* keys,
+                               PartialAggMerge* merge) {
+    if (expr->GetExprType() == node::kExprCall) {
+        auto call = dynamic_cast<const node::CallExprNode*>(expr);
+        if (call->GetOver() != nullptr || call->GetChildNum() != 1) {
+            return false;
+        }
+        std::string fname = call->GetFnDef()->GetName();
+        std::transform(fname.begin(), fname.end(), fname.begin(), ::tolower);
+        if (fname == "count" || fname == "sum") {
+            *merge = kMergeBySum;
+        } else if (fname == "min") {
+            *merge = kMergeByMin;
+        } else if (fname == "max") {
+            *merge = kMergeByMax;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    if (keys == nullptr || expr->GetExprType() != node::kExprColumnRef) {
+        return false;
+    }
+    auto column = dynamic_cast<const node::ColumnRefNode*>(expr);
+    for (size_t i = 0; i < keys->GetChildNum(); ++i) {
+        auto key = keys->GetChild(i);
+        if (key->GetExprType() == node::kExprColumnRef &&
+            dynamic_cast<const node::ColumnRefNode*>(key)->GetColumnName() ==
+                column->GetColumnName()) {
+            *merge = kMergeByKey;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Router::ParsePartialAggregation(const PhysicalOpNode* physical_node) {
+    if (physical_node->GetOpType() != kPhysicalOpProject) {
+        return false;
+    }
+    auto project_node = dynamic_cast<const PhysicalProjectNode*>(physical_node);
+    auto input = physical_node->GetProducer(0);
+    const node::ExprListNode* keys = nullptr;
+    if (project_node->project_type_ == kAggregation) {
+        if (!IsRowWiseScan(input)) {
+            return false;
+        }
+    } else if (project_node->project_type_ == kGroupAggregation) {
+        keys = dynamic_cast<const PhysicalGroupAggrerationNode*>(project_node)
+                   ->group_.keys();
+        if (input->GetOpType() == kPhysicalOpGroupBy) {
+            input = input->GetProducer(0);
+        }
+        // groups on an index are read from all keys of the partitions
+        auto provider_node = dynamic_cast<const PhysicalDataProviderNode*>(input);
+        bool is_partition_scan =
+            provider_node != nullptr &&
+            provider_node->provider_type_ == kProviderTypePartition &&
+            provider_node->GetName() == main_table_;
+        if (!is_partition_scan && !IsRowWiseScan(input)) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    std::vector<PartialAggMerge> merges;
+    auto& projects = project_node->project();
+    for (size_t i = 0; i < projects.size(); ++i) {
+        PartialAggMerge merge;
+        if (!GetPartialAggMerge(projects.GetExpr(i), keys, &merge)) {
+            return false;
+        }
+        merges.push_back(merge);
+    }
+    // the partial rows are merged by the output keys, so groups that differ
+    // only in a key not in the output would be merged into one
+    for (size_t i = 0; keys != nullptr && i < keys->GetChildNum(); ++i) {
+        auto key = keys->GetChild(i);
+        if (key->GetExprType() != node::kExprColumnRef) {
+            return false;
+        }
+        std::string name =
+            dynamic_cast<const node::ColumnRefNode*>(key)->GetColumnName();
+        bool in_output = false;
+        for (size_t j = 0; j < projects.size() && !in_output; ++j) {
+            auto expr = projects.GetExpr(j);
+            in_output = merges[j] == kMergeByKey &&
+                        expr->GetExprType() == node::kExprColumnRef &&
+                        dynamic_cast<const node::ColumnRefNode*>(expr)
+                                ->GetColumnName() == name;
+        }
+        if (!in_output) {
+            return false;
+        }
+    }
+    partial_agg_merges_ = merges;
+    return !partial_agg_merges_.empty();
+}
+
+bool Router::IsRowWiseScan(const PhysicalOpNode* physical_node) {
+    switch (physical_node->GetOpType()) {
+        case kPhysicalOpDataProvider: {
+            // partition providers seek keys, which are not local to a tablet
+            auto provider_node =
+                dynamic_cast<const PhysicalDataProviderNode*>(physical_node);
+            return provider_node != nullptr &&
+                   provider_node->provider_type_ == kProviderTypeTable &&
+                   provider_node->GetName() == main_table_;
+        }
+        case kPhysicalOpProject: {
+            auto project_node =
+                dynamic_cast<const PhysicalProjectNode*>(physical_node);
+            if (project_node == nullptr ||
+                (project_node->project_type_ != kTableProject &&
+                 project_node->project_type_ != kRowProject)) {
+                return false;
+            }
+            break;
+        }
+        case kPhysicalOpSimpleProject:
+        case kPhysicalOpFilter:
+        case kPhysicalOpRename:
+            break;
+        default:
+            return false;
+    }
+    return physical_node->GetProducerCnt() == 1 &&
+           IsRowWiseScan(physical_node->GetProducer(0));
+}
+
 }  // namespace vm
 }  // namespace hybridse
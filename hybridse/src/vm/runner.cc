@@ -15,6 +15,7 @@
  */
 
 #include "vm/runner.h"
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -32,6 +33,42 @@ namespace vm {
 #define MAX_DEBUG_LINES_CNT 20
 #define MAX_DEBUG_COLUMN_MAX 20
 
+// true if a segment read under `node` may be cut by a count ttl, which counts
+// the rows from where the scan seeks to instead of the latest row of the key
+static bool HasCountTtl(PhysicalOpNode* node) {
+    if (nullptr == node) {
+        return false;
+    }
+    if (kPhysicalOpDataProvider == node->GetOpType()) {
+        auto op = dynamic_cast<const PhysicalDataProviderNode*>(node);
+        if (kProviderTypeRequest == op->provider_type_ || !op->table_handler_) {
+            return false;
+        }
+        std::string index_name;
+        if (kProviderTypePartition == op->provider_type_) {
+            index_name =
+                dynamic_cast<const PhysicalPartitionProviderNode*>(node)
+                    ->index_name_;
+        }
+        for (auto& index : op->table_handler_->GetIndex()) {
+            if (!index_name.empty() && index_name != index.first) {
+                continue;
+            }
+            if (type::kTTLTimeLive != index.second.ttl_type &&
+                type::kTTLNone != index.second.ttl_type) {
+                return true;
+            }
+        }
+        return false;
+    }
+    for (auto producer : node->producers()) {
+        if (HasCountTtl(producer)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Build Runner for each physical node
 // return cluster task of given runner
 //
@@ -148,6 +185,10 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                 CreateRunner<SimpleProjectRunner>(
                     &runner, id_++, node->schemas_ctx(), op->GetLimitCnt(),
                     op->project().fn_info());
+                std::vector<size_t> select_columns;
+                if (op->GetSelectColumnIndexes(&select_columns)) {
+                    runner->set_select_columns(select_columns);
+                }
                 return RegisterTask(node,
                                     UnaryInheritTask(cluster_task, runner));
             }
@@ -302,9 +343,11 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                 op->window().range_, op->exclude_current_time(),
                 op->output_request_row());
             Key index_key;
+            bool share_segment_scan = true;
             if (!op->instance_not_in_window()) {
                 runner->AddWindowUnion(op->window_, right);
                 index_key = op->window_.index_key_;
+                share_segment_scan = !HasCountTtl(node->producers().at(1));
             }
             if (!op->window_unions_.Empty()) {
                 for (auto window_union : op->window_unions_.window_unions_) {
@@ -314,6 +357,8 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                         return RegisterTask(node, fail);
                     }
                     runner->AddWindowUnion(window_union.second, union_table);
+                    share_segment_scan = share_segment_scan &&
+                                         !HasCountTtl(window_union.first);
                     if (!index_key.ValidKey()) {
                         index_key = window_union.second.index_key_;
                         right_task = union_task;
@@ -325,9 +370,20 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                     }
                 }
             }
-            return RegisterTask(
-                node, BinaryInherit(left_task, right_task, runner, index_key,
-                                    kRightBias));
+            runner->set_share_segment_scan(share_segment_scan);
+            auto task = BinaryInherit(left_task, right_task, runner, index_key,
+                                      kRightBias);
+            // take window rows from the shared window instead of the segment
+            if (nullptr != op->shared_window() && !support_cluster_optimized_ &&
+                task.IsValid()) {
+                auto shared_task = Build(op->shared_window(), status);
+                if (shared_task.IsValid() && !shared_task.IsClusterTask()) {
+                    runner->AddProducer(shared_task.GetRoot());
+                    runner->set_shared_window_with_request_row(
+                        op->shared_window()->output_request_row());
+                }
+            }
+            return RegisterTask(node, task);
         }
         case kPhysicalOpRequestJoin: {
             auto left_task =  // NOLINT
@@ -1060,7 +1116,23 @@ std::shared_ptr<DataHandler> Runner::RunWithCache(RunnerContext& ctx) {
 std::shared_ptr<DataHandler> DataRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {
-    return data_handler_;
+    return GetDataHandler(ctx);
+}
+std::shared_ptr<DataHandler> DataRunner::GetDataHandler(RunnerContext& ctx) {
+    auto scan_filter = ctx.scan_filter();
+    if (!scan_filter || !data_handler_) {
+        return data_handler_;
+    }
+    switch (data_handler_->GetHanlderType()) {
+        case kTableHandler:
+            return scan_filter->Filter(
+                std::dynamic_pointer_cast<TableHandler>(data_handler_));
+        case kPartitionHandler:
+            return scan_filter->FilterPartition(
+                std::dynamic_pointer_cast<PartitionHandler>(data_handler_));
+        default:
+            return data_handler_;
+    }
 }
 std::shared_ptr<DataHandlerList> DataRunner::BatchRequestRun(
     RunnerContext& ctx) {
@@ -1072,7 +1144,7 @@ std::shared_ptr<DataHandlerList> DataRunner::BatchRequestRun(
         }
     }
     auto res = std::shared_ptr<DataHandlerList>(
-        new DataHandlerRepeater(data_handler_, ctx.GetRequestSize()));
+        new DataHandlerRepeater(GetDataHandler(ctx), ctx.GetRequestSize()));
 
     if (ctx.is_debug()) {
         std::ostringstream oss;
@@ -1138,7 +1210,8 @@ std::shared_ptr<DataHandler> GroupRunner::Run(
         LOG(WARNING) << "input is empty";
         return fail_ptr;
     }
-    return partition_gen_.Partition(input, ctx.GetParameterRow());
+    return partition_gen_.Partition(input, ctx.GetParameterRow(),
+                                    ctx.spill_ctx());
 }
 std::shared_ptr<DataHandler> SortRunner::Run(
     RunnerContext& ctx,
@@ -1223,6 +1296,14 @@ std::shared_ptr<DataHandler> SimpleProjectRunner::Run(
         return fail_ptr;
     }
 
+    // storage reads only selected columns instead of the whole rows
+    if (!select_columns_.empty() && kRowHandler != input->GetHanlderType()) {
+        auto projected = std::dynamic_pointer_cast<TableHandler>(input)
+                             ->ProjectColumns(select_columns_);
+        if (projected) {
+            return projected;
+        }
+    }
     auto& parameter = ctx.GetParameterRow();
     switch (input->GetHanlderType()) {
         case kTableHandler: {
@@ -1309,7 +1390,8 @@ std::shared_ptr<DataHandler> WindowAggRunner::Run(
     auto& parameter = ctx.GetParameterRow();
     // Partition Instance Table
     auto instance_partition =
-        instance_window_gen_.partition_gen_.Partition(input, parameter);
+        instance_window_gen_.partition_gen_.Partition(input, parameter,
+                                                      ctx.spill_ctx());
     if (!instance_partition) {
         LOG(WARNING) << "Window Aggregation Fail: input partition is empty";
         return fail_ptr;
@@ -1324,16 +1406,29 @@ std::shared_ptr<DataHandler> WindowAggRunner::Run(
 
     // Partition Union Table
     auto union_inpus = windows_union_gen_.RunInputs(ctx);
-    auto union_partitions = windows_union_gen_.PartitionEach(union_inpus, parameter);
+    auto union_partitions = windows_union_gen_.PartitionEach(
+        union_inpus, parameter, ctx.spill_ctx());
     // Prepare Join Tables
     auto join_right_tables = windows_join_gen_.RunInputs(ctx);
 
     // Compute output
     std::shared_ptr<MemTableHandler> output_table =
         std::shared_ptr<MemTableHandler>(new MemTableHandler());
+    // segments of a spilled partition are merged from disk by the iterator
+    // already, take them from it instead of merging them again by key
+    auto spill_iter =
+        dynamic_cast<SpillWindowIterator*>(instance_partition_iter.get());
     while (instance_partition_iter->Valid()) {
         auto key = instance_partition_iter->GetKey().ToString();
-        RunWindowAggOnKey(parameter, instance_partition, union_partitions,
+        std::shared_ptr<TableHandler> instance_segment;
+        if (nullptr != spill_iter) {
+            auto segment = spill_iter->GetSegment();
+            segment->SetOrderType(instance_partition->GetOrderType());
+            instance_segment = segment;
+        } else {
+            instance_segment = instance_partition->GetSegment(key);
+        }
+        RunWindowAggOnKey(parameter, instance_segment, union_partitions,
                           join_right_tables, key, output_table);
         instance_partition_iter->Next();
     }
@@ -1342,13 +1437,11 @@ std::shared_ptr<DataHandler> WindowAggRunner::Run(
 
 // Run Window Aggeregation on given key
 void WindowAggRunner::RunWindowAggOnKey(
-    const Row& parameter,
-    std::shared_ptr<PartitionHandler> instance_partition,
+    const Row& parameter, std::shared_ptr<TableHandler> instance_segment,
     std::vector<std::shared_ptr<PartitionHandler>> union_partitions,
     std::vector<std::shared_ptr<DataHandler>> join_right_tables,
     const std::string& key, std::shared_ptr<MemTableHandler> output_table) {
     // Prepare Instance Segment
-    auto instance_segment = instance_partition->GetSegment(key);
     instance_segment = instance_window_gen_.sort_gen_.Sort(instance_segment);
     if (!instance_segment) {
         LOG(WARNING) << "Instance Segment is Empty";
@@ -1493,9 +1586,12 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(
     }
     auto &parameter = ctx.GetParameterRow();
 
+    // build right table once and probe it with every left row
+    bool hash_join =
+        join_gen_.hash_join_ && kTableHandler == right->GetHanlderType();
     switch (left->GetHanlderType()) {
         case kTableHandler: {
-            if (join_gen_.right_group_gen_.Valid()) {
+            if (!hash_join && join_gen_.right_group_gen_.Valid()) {
                 right = join_gen_.right_group_gen_.Partition(right, parameter);
             }
             if (!right) {
@@ -1508,7 +1604,14 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(
             auto output_table =
                 std::shared_ptr<MemTimeTableHandler>(new MemTimeTableHandler());
             output_table->SetOrderType(left_table->GetOrderType());
-            if (kPartitionHandler == right->GetHanlderType()) {
+            if (hash_join) {
+                if (!join_gen_.TableHashJoin(
+                        left_table,
+                        std::dynamic_pointer_cast<TableHandler>(right),
+                        parameter, output_table)) {
+                    return fail_ptr;
+                }
+            } else if (kPartitionHandler == right->GetHanlderType()) {
                 if (!join_gen_.TableJoin(
                         left_table,
                         std::dynamic_pointer_cast<PartitionHandler>(right),
@@ -1528,7 +1631,7 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(
             return output_table;
         }
         case kPartitionHandler: {
-            if (join_gen_.right_group_gen_.Valid()) {
+            if (!hash_join && join_gen_.right_group_gen_.Valid()) {
                 right = join_gen_.right_group_gen_.Partition(right, parameter);
             }
             if (!right) {
@@ -1541,7 +1644,14 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(
             auto left_partition =
                 std::dynamic_pointer_cast<PartitionHandler>(left);
             output_partition->SetOrderType(left_partition->GetOrderType());
-            if (kPartitionHandler == right->GetHanlderType()) {
+            if (hash_join) {
+                if (!join_gen_.PartitionHashJoin(
+                        left_partition,
+                        std::dynamic_pointer_cast<TableHandler>(right),
+                        parameter, output_partition)) {
+                    return fail_ptr;
+                }
+            } else if (kPartitionHandler == right->GetHanlderType()) {
                 if (!join_gen_.PartitionJoin(
                         left_partition,
                         std::dynamic_pointer_cast<PartitionHandler>(right),
@@ -1572,14 +1682,17 @@ std::shared_ptr<DataHandler> LastJoinRunner::Run(
 }
 
 std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
-    std::shared_ptr<DataHandler> input, const Row& parameter) {
+    std::shared_ptr<DataHandler> input, const Row& parameter,
+    std::shared_ptr<SpillContext> spill_ctx) {
     switch (input->GetHanlderType()) {
         case kPartitionHandler: {
             return Partition(
-                std::dynamic_pointer_cast<PartitionHandler>(input), parameter);
+                std::dynamic_pointer_cast<PartitionHandler>(input), parameter,
+                spill_ctx);
         }
         case kTableHandler: {
-            return Partition(std::dynamic_pointer_cast<TableHandler>(input), parameter);
+            return Partition(std::dynamic_pointer_cast<TableHandler>(input),
+                             parameter, spill_ctx);
         }
         default: {
             LOG(WARNING) << "Partition Fail: input isn't partition or table";
@@ -1588,15 +1701,15 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
     }
 }
 std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
-    std::shared_ptr<PartitionHandler> table, const Row& parameter) {
+    std::shared_ptr<PartitionHandler> table, const Row& parameter,
+    std::shared_ptr<SpillContext> spill_ctx) {
     if (!key_gen_.Valid()) {
         return table;
     }
     if (!table) {
         return std::shared_ptr<PartitionHandler>();
     }
-    auto output_partitions = std::shared_ptr<MemPartitionHandler>(
-        new MemPartitionHandler(table->GetSchema()));
+    SpillPartitionBuilder builder(table->GetSchema(), spill_ctx);
     auto partitions = std::dynamic_pointer_cast<PartitionHandler>(table);
     auto iter = partitions->GetWindowIterator();
     if (!iter) {
@@ -1604,7 +1717,6 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
         return std::shared_ptr<PartitionHandler>();
     }
     iter->SeekToFirst();
-    output_partitions->SetOrderType(table->GetOrderType());
     while (iter->Valid()) {
         auto segment_iter = iter->GetValue();
         if (!segment_iter) {
@@ -1615,17 +1727,21 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
         segment_iter->SeekToFirst();
         while (segment_iter->Valid()) {
             std::string keys = key_gen_.Gen(segment_iter->GetValue(), parameter);
-            output_partitions->AddRow(segment_key + "|" + keys,
-                                      segment_iter->GetKey(),
-                                      segment_iter->GetValue());
+            if (!builder.AddRow(segment_key + "|" + keys,
+                                segment_iter->GetKey(),
+                                segment_iter->GetValue())) {
+                LOG(WARNING) << "Partition Fail: fail to spill partition";
+                return std::shared_ptr<PartitionHandler>();
+            }
             segment_iter->Next();
         }
         iter->Next();
     }
-    return output_partitions;
+    return builder.Finish(table->GetOrderType());
 }
 std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
-    std::shared_ptr<TableHandler> table, const Row& parameter) {
+    std::shared_ptr<TableHandler> table, const Row& parameter,
+    std::shared_ptr<SpillContext> spill_ctx) {
     auto fail_ptr = std::shared_ptr<PartitionHandler>();
     if (!key_gen_.Valid()) {
         return fail_ptr;
@@ -1637,8 +1753,7 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
         return fail_ptr;
     }
 
-    auto output_partitions = std::shared_ptr<MemPartitionHandler>(
-        new MemPartitionHandler(table->GetSchema()));
+    SpillPartitionBuilder builder(table->GetSchema(), spill_ctx);
 
     auto iter = std::dynamic_pointer_cast<TableHandler>(table)->GetIterator();
     if (!iter) {
@@ -1648,11 +1763,13 @@ std::shared_ptr<PartitionHandler> PartitionGenerator::Partition(
     iter->SeekToFirst();
     while (iter->Valid()) {
         std::string keys = key_gen_.Gen(iter->GetValue(), parameter);
-        output_partitions->AddRow(keys, iter->GetKey(), iter->GetValue());
+        if (!builder.AddRow(keys, iter->GetKey(), iter->GetValue())) {
+            LOG(WARNING) << "Fail to group table: fail to spill partition";
+            return fail_ptr;
+        }
         iter->Next();
     }
-    output_partitions->SetOrderType(table->GetOrderType());
-    return output_partitions;
+    return builder.Finish(table->GetOrderType());
 }
 std::shared_ptr<DataHandler> SortGenerator::Sort(
     std::shared_ptr<DataHandler> input, const bool reverse) {
@@ -1687,6 +1804,24 @@ std::shared_ptr<PartitionHandler> SortGenerator::Sort(
         DLOG(INFO) << "match the order redirect the table";
         return partition;
     }
+    auto spill_partition =
+        std::dynamic_pointer_cast<SpillPartitionHandler>(partition);
+    if (spill_partition && order_gen_.Valid()) {
+        // spilled segments are sorted one by one when merged from disk
+        OrderGenerator order_gen = order_gen_;
+        return spill_partition->OrderSegments(
+            [order_gen, is_asc](MemTimeTable* rows) mutable {
+                for (auto& pair : *rows) {
+                    pair.first = static_cast<uint64_t>(order_gen.Gen(pair.second));
+                }
+                if (is_asc) {
+                    std::sort(rows->begin(), rows->end(), AscComparor());
+                } else {
+                    std::sort(rows->begin(), rows->end(), DescComparor());
+                }
+            },
+            is_asc ? kAscOrder : kDescOrder);
+    }
 
     DLOG(INFO) << "mismatch the order and sort it";
     auto output =
@@ -2008,6 +2143,139 @@ bool JoinGenerator::PartitionJoin(std::shared_ptr<PartitionHandler> left,
     }
     return true;
 }
+bool JoinGenerator::BuildHashJoinTable(std::shared_ptr<TableHandler> right,
+                                       const Row& parameter,
+                                       HashJoinTable* hash_table) {
+    if (!right_group_gen_.Valid()) {
+        LOG(WARNING) << "can't build hash join table when right keys is empty";
+        return false;
+    }
+    auto right_iter = right->GetIterator();
+    if (!right_iter) {
+        // empty right table, every left row joins with null
+        return true;
+    }
+    right_iter->SeekToFirst();
+    while (right_iter->Valid()) {
+        const Row& right_row = right_iter->GetValue();
+        uint64_t order_key = right_iter->GetKey();
+        if (right_sort_gen_.Valid() && right_sort_gen_.order_gen().Valid()) {
+            order_key = static_cast<uint64_t>(
+                right_sort_gen_.order_gen().Gen(right_row));
+        }
+        (*hash_table)[right_group_gen_.GetKey(right_row, parameter)].push_back(
+            std::make_pair(order_key, right_row));
+        right_iter->Next();
+    }
+
+    // same order as SortGenerator::Sort(table, true) on each bucket
+    bool sort_bucket = right_sort_gen_.Valid();
+    bool is_asc = !right_sort_gen_.is_asc();
+    bool reverse_bucket = false;
+    if (sort_bucket && !right_sort_gen_.order_gen().Valid()) {
+        sort_bucket = false;
+        reverse_bucket =
+            is_asc != (kAscOrder == right->GetOrderType());
+    }
+    for (auto& bucket : *hash_table) {
+        auto& rows = bucket.second;
+        if (sort_bucket) {
+            if (is_asc) {
+                std::stable_sort(rows.begin(), rows.end(), AscComparor());
+            } else {
+                std::stable_sort(rows.begin(), rows.end(), DescComparor());
+            }
+        } else if (reverse_bucket) {
+            std::reverse(rows.begin(), rows.end());
+        }
+        // without residual condition, only the first row can be joined
+        if (!condition_gen_.Valid() && rows.size() > 1) {
+            rows.resize(1);
+        }
+    }
+    return true;
+}
+
+Row JoinGenerator::RowHashLastJoin(const Row& left_row,
+                                   const HashJoinTable& hash_table,
+                                   const Row& parameter) {
+    auto bucket = hash_table.find(left_key_gen_.Gen(left_row, parameter));
+    if (bucket == hash_table.cend()) {
+        return Row(left_slices_, left_row, right_slices_, Row());
+    }
+    for (auto& right : bucket->second) {
+        Row joined_row(left_slices_, left_row, right_slices_, right.second);
+        if (!condition_gen_.Valid() ||
+            condition_gen_.Gen(joined_row, parameter)) {
+            return joined_row;
+        }
+    }
+    return Row(left_slices_, left_row, right_slices_, Row());
+}
+
+bool JoinGenerator::TableHashJoin(std::shared_ptr<TableHandler> left,
+                                  std::shared_ptr<TableHandler> right,
+                                  const Row& parameter,
+                                  std::shared_ptr<MemTimeTableHandler> output) {
+    if (!left_key_gen_.Valid()) {
+        LOG(WARNING) << "can't run hash join when left keys is empty";
+        return false;
+    }
+    auto left_iter = left->GetIterator();
+    if (!left_iter) {
+        LOG(WARNING) << "fail to run hash join: left input empty";
+        return false;
+    }
+    HashJoinTable hash_table;
+    if (!BuildHashJoinTable(right, parameter, &hash_table)) {
+        return false;
+    }
+    left_iter->SeekToFirst();
+    while (left_iter->Valid()) {
+        output->AddRow(left_iter->GetKey(),
+                       RowHashLastJoin(left_iter->GetValue(), hash_table,
+                                       parameter));
+        left_iter->Next();
+    }
+    return true;
+}
+
+bool JoinGenerator::PartitionHashJoin(
+    std::shared_ptr<PartitionHandler> left, std::shared_ptr<TableHandler> right,
+    const Row& parameter, std::shared_ptr<MemPartitionHandler> output) {
+    if (!left_key_gen_.Valid()) {
+        LOG(WARNING) << "can't run hash join when left keys is empty";
+        return false;
+    }
+    auto left_partition_iter = left->GetWindowIterator();
+    if (!left_partition_iter) {
+        LOG(WARNING) << "fail to run hash join: left input empty";
+        return false;
+    }
+    HashJoinTable hash_table;
+    if (!BuildHashJoinTable(right, parameter, &hash_table)) {
+        return false;
+    }
+    left_partition_iter->SeekToFirst();
+    while (left_partition_iter->Valid()) {
+        auto left_iter = left_partition_iter->GetValue();
+        if (!left_iter) {
+            left_partition_iter->Next();
+            continue;
+        }
+        auto left_key_str = left_partition_iter->GetKey().ToString();
+        left_iter->SeekToFirst();
+        while (left_iter->Valid()) {
+            output->AddRow(left_key_str, left_iter->GetKey(),
+                           RowHashLastJoin(left_iter->GetValue(), hash_table,
+                                           parameter));
+            left_iter->Next();
+        }
+        left_partition_iter->Next();
+    }
+    return true;
+}
+
 const Row Runner::RowLastJoinTable(size_t left_slices, const Row& left_row,
                                    size_t right_slices,
                                    std::shared_ptr<TableHandler> right_table,
@@ -2491,6 +2759,209 @@ std::shared_ptr<DataHandler> GroupAggRunner::Run(
     }
     return output_table;
 }
+// Rows of a segment read once for the windows of several requests, in
+// descending order of ts. A view of the rows starts at the window end of one
+// request, so the request neither seeks the segment nor skips rows again.
+class SharedSegmentRows : public MemTimeTableHandler {
+ public:
+    SharedSegmentRows() : MemTimeTableHandler(), rows_(), pos_(0) {}
+    SharedSegmentRows(std::shared_ptr<SharedSegmentRows> rows, size_t pos)
+        : MemTimeTableHandler(), rows_(rows), pos_(pos) {}
+    ~SharedSegmentRows() {}
+    std::unique_ptr<RowIterator> GetIterator() override {
+        return std::unique_ptr<RowIterator>(GetRawIterator());
+    }
+    RowIterator* GetRawIterator() override {
+        return new MemTimeTableIterator(Rows(), schema_, pos_, Rows()->size());
+    }
+    const uint64_t GetCount() override { return Rows()->size() - pos_; }
+    Row At(uint64_t pos) override {
+        return pos < GetCount() ? Rows()->at(pos_ + pos).second : Row();
+    }
+    // position of the first row with ts not greater than `end`
+    size_t LowerBound(uint64_t end) const {
+        auto iter = std::partition_point(
+            table_.cbegin(), table_.cend(),
+            [end](const std::pair<uint64_t, Row>& row) {
+                return row.first > end;
+            });
+        return iter - table_.cbegin();
+    }
+
+ private:
+    const MemTimeTable* Rows() const {
+        return rows_ ? &rows_->table_ : &table_;
+    }
+    std::shared_ptr<SharedSegmentRows> rows_;
+    size_t pos_;
+};
+
+static void GetWindowBound(int64_t ts_gen, const WindowRange& window_range,
+                           const bool exclude_current_time, uint64_t* start,
+                           uint64_t* end) {
+    *start = (ts_gen + window_range.start_offset_) < 0
+                 ? 0
+                 : (ts_gen + window_range.start_offset_);
+    if (exclude_current_time && 0 == window_range.end_offset_) {
+        *end = (ts_gen - 1) < 0 ? 0 : (ts_gen - 1);
+    } else {
+        *end = (ts_gen + window_range.end_offset_) < 0
+                   ? 0
+                   : (ts_gen + window_range.end_offset_);
+    }
+}
+
+std::shared_ptr<DataHandlerList> RequestUnionRunner::BatchRequestRun(
+    RunnerContext& ctx) {
+    // the window shared with another union, the third input, is taken row by
+    // row, so are the segments with a count ttl
+    if (producers_.size() != 2u || !share_segment_scan_ ||
+        !range_gen_.Valid() || !windows_union_gen_.Valid() ||
+        need_batch_cache_ || ctx.GetRequestSize() < 2u) {
+        return Runner::BatchRequestRun(ctx);
+    }
+    if (need_cache_) {
+        auto cached = ctx.GetBatchCache(id_);
+        if (cached != nullptr) {
+            DLOG(INFO) << "RUNNER ID " << id_ << " HIT CACHE!";
+            return cached;
+        }
+    }
+    auto right_inputs = producers_[1]->BatchRequestRun(ctx);
+    auto left_inputs = producers_[0]->BatchRequestRun(ctx);
+
+    size_t request_size = ctx.GetRequestSize();
+    std::vector<std::shared_ptr<DataHandler>> results(request_size);
+    std::vector<Row> requests(request_size);
+    std::vector<int64_t> request_ts(request_size, -1);
+    // rows with the same window keys get the same union segments
+    std::unordered_map<std::string, std::vector<size_t>> groups;
+    for (size_t idx = 0; idx < request_size; idx++) {
+        auto left = left_inputs->Get(idx);
+        if (left && right_inputs->Get(idx) &&
+            kRowHandler == left->GetHanlderType()) {
+            requests[idx] =
+                std::dynamic_pointer_cast<RowHandler>(left)->GetValue();
+            request_ts[idx] = range_gen_.ts_gen_.Gen(requests[idx]);
+        }
+        if (request_ts[idx] < 0 || requests[idx].empty()) {
+            results[idx] = Run(ctx, {left, right_inputs->Get(idx)});
+            continue;
+        }
+        groups[windows_union_gen_.GetWindowsKey(requests[idx],
+                                                ctx.GetParameterRow())]
+            .push_back(idx);
+    }
+    std::vector<std::shared_ptr<DataHandler>> union_inputs;
+    if (!groups.empty()) {
+        union_inputs = windows_union_gen_.RunInputs(ctx);
+    }
+    for (auto& group : groups) {
+        auto& indexes = group.second;
+        if (indexes.size() < 2u) {
+            results[indexes[0]] = Run(ctx, {left_inputs->Get(indexes[0]),
+                                            right_inputs->Get(indexes[0])});
+            continue;
+        }
+        std::vector<int64_t> group_ts;
+        for (auto idx : indexes) {
+            group_ts.push_back(request_ts[idx]);
+        }
+        auto union_segments = windows_union_gen_.GetRequestWindows(
+            requests[indexes[0]], ctx.GetParameterRow(), union_inputs);
+        std::vector<std::vector<std::shared_ptr<TableHandler>>> views;
+        for (auto& segment : union_segments) {
+            views.push_back(SharedSegmentViews(segment, group_ts,
+                                               range_gen_.window_range_,
+                                               exclude_current_time_));
+        }
+        for (size_t i = 0; i < indexes.size(); i++) {
+            std::vector<std::shared_ptr<TableHandler>> segments;
+            for (auto& union_views : views) {
+                segments.push_back(union_views[i]);
+            }
+            results[indexes[i]] = RequestUnionWindow(
+                requests[indexes[i]], segments, group_ts[i],
+                range_gen_.window_range_, output_request_row_,
+                exclude_current_time_);
+        }
+    }
+
+    std::shared_ptr<DataHandlerVector> outputs =
+        std::make_shared<DataHandlerVector>();
+    for (auto& res : results) {
+        outputs->Add(res);
+    }
+    if (ctx.is_debug()) {
+        std::ostringstream oss;
+        oss << "RUNNER TYPE: " << RunnerTypeName(type_) << ", ID: " << id_
+            << "\n";
+        for (size_t idx = 0; idx < outputs->GetSize(); idx++) {
+            if (idx >= MAX_DEBUG_BATCH_SiZE) {
+                oss << ">= MAX_DEBUG_BATCH_SiZE...\n";
+                break;
+            }
+            Runner::PrintData(oss, output_schemas_, outputs->Get(idx));
+        }
+        LOG(INFO) << oss.str();
+    }
+    if (need_cache_) {
+        ctx.SetBatchCache(id_, outputs);
+    }
+    return outputs;
+}
+
+std::vector<std::shared_ptr<TableHandler>>
+RequestUnionRunner::SharedSegmentViews(std::shared_ptr<TableHandler> segment,
+                                       const std::vector<int64_t>& request_ts,
+                                       const WindowRange& window_range,
+                                       const bool exclude_current_time) {
+    std::vector<std::shared_ptr<TableHandler>> views(request_ts.size());
+    if (!segment || request_ts.empty()) {
+        return views;
+    }
+    std::vector<uint64_t> ends(request_ts.size());
+    uint64_t min_start = UINT64_MAX;
+    uint64_t min_end = UINT64_MAX;
+    uint64_t max_end = 0;
+    for (size_t i = 0; i < request_ts.size(); i++) {
+        uint64_t start = 0;
+        GetWindowBound(request_ts[i], window_range, exclude_current_time,
+                       &start, &ends[i]);
+        min_start = std::min(min_start, start);
+        min_end = std::min(min_end, ends[i]);
+        max_end = std::max(max_end, ends[i]);
+    }
+    // a window takes at most start_row_ + 1 rows not after its end in rows
+    // frames and the rows from its start in range frames, so the scan stops
+    // once the window with the earliest bounds is covered
+    bool by_rows = Window::kFrameRowsRange != window_range.frame_type_;
+    bool by_range = Window::kFrameRows != window_range.frame_type_;
+    auto rows = std::make_shared<SharedSegmentRows>();
+    auto iter = segment->GetIterator();
+    if (iter) {
+        iter->Seek(max_end);
+        uint64_t cnt = 0;
+        while (iter->Valid()) {
+            uint64_t key = iter->GetKey();
+            if ((!by_rows || cnt > window_range.start_row_) &&
+                (!by_range || key < min_start)) {
+                break;
+            }
+            rows->AddRow(key, iter->GetValue());
+            if (key <= min_end) {
+                cnt++;
+            }
+            iter->Next();
+        }
+    }
+    for (size_t i = 0; i < request_ts.size(); i++) {
+        views[i] =
+            std::make_shared<SharedSegmentRows>(rows, rows->LowerBound(ends[i]));
+    }
+    return views;
+}
+
 std::shared_ptr<DataHandler> RequestUnionRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {
@@ -2512,6 +2983,17 @@ std::shared_ptr<DataHandler> RequestUnionRunner::Run(
 
     int64_t ts_gen = range_gen_.Valid() ? range_gen_.ts_gen_.Gen(request) : -1;
 
+    if (inputs.size() > 2u && inputs[2]) {
+        // rows of a window covering this one, see CommonWindowSharing
+        auto shared_window = std::dynamic_pointer_cast<TableHandler>(inputs[2]);
+        if (shared_window) {
+            return SharedWindow(request, shared_window,
+                                shared_window_with_request_row_, ts_gen,
+                                range_gen_.window_range_, output_request_row_,
+                                exclude_current_time_);
+        }
+    }
+
     // Prepare Union Window
     auto union_inputs = windows_union_gen_.RunInputs(ctx);
     auto union_segments =
@@ -2531,16 +3013,8 @@ std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
     uint64_t rows_start_preceding = 0;
     uint64_t max_size = 0;
     if (ts_gen >= 0) {
-        start = (ts_gen + window_range.start_offset_) < 0
-                    ? 0
-                    : (ts_gen + window_range.start_offset_);
-        if (exclude_current_time && 0 == window_range.end_offset_) {
-            end = (ts_gen - 1) < 0 ? 0 : (ts_gen - 1);
-        } else {
-            end = (ts_gen + window_range.end_offset_) < 0
-                      ? 0
-                      : (ts_gen + window_range.end_offset_);
-        }
+        GetWindowBound(ts_gen, window_range, exclude_current_time, &start,
+                       &end);
         rows_start_preceding = window_range.start_row_;
         max_size = window_range.max_size_;
     }
@@ -2620,6 +3094,49 @@ std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
     return window_table;
 }
 
+std::shared_ptr<TableHandler> RequestUnionRunner::SharedWindow(
+    const Row& request, std::shared_ptr<TableHandler> shared_window,
+    const bool shared_window_with_request_row, int64_t ts_gen,
+    const WindowRange& window_range, const bool output_request_row,
+    const bool exclude_current_time) {
+    auto iter = shared_window->GetIterator();
+    if (!iter) {
+        return RequestUnionWindow(request, {}, ts_gen, window_range,
+                                  output_request_row, exclude_current_time);
+    }
+    iter->SeekToFirst();
+    if (shared_window_with_request_row && iter->Valid()) {
+        iter->Next();
+    }
+    // rows of the shared window are a prefix of the segment, copy them into
+    // a segment and build this window with the same rules as the storage
+    // segment, only rows in this window are visited
+    uint64_t end = UINT64_MAX;
+    uint64_t start = 0;
+    if (ts_gen >= 0) {
+        GetWindowBound(ts_gen, window_range, exclude_current_time, &start,
+                       &end);
+    }
+    bool rows_window = Window::kFrameRows == window_range.frame_type_;
+    uint64_t max_rows = window_range.start_row_ + 1;
+    auto segment = std::make_shared<MemTimeTableHandler>();
+    while (iter->Valid()) {
+        uint64_t key = iter->GetKey();
+        if (key <= end) {
+            if (!rows_window && key < start) {
+                break;
+            }
+            segment->AddRow(key, iter->GetValue());
+            if (rows_window && segment->GetCount() >= max_rows) {
+                break;
+            }
+        }
+        iter->Next();
+    }
+    return RequestUnionWindow(request, {segment}, ts_gen, window_range,
+                              output_request_row, exclude_current_time);
+}
+
 std::shared_ptr<DataHandler> PostRequestUnionRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {
@@ -3053,7 +3570,7 @@ std::shared_ptr<TableHandler> ProxyRequestRunner::RunWithRowsInput(
  * @return
  */
 const std::string KeyGenerator::GenConst(const Row& parameter) {
-    Row key_row = CoreAPI::RowConstProject(fn_, parameter, true);
+    Row key_row = RowConstProject(parameter, true);
     RowView row_view(row_view_);
     if (!row_view.Reset(key_row.buf())) {
         LOG(WARNING) << "fail to gen key: row view reset fail";
@@ -3082,7 +3599,7 @@ const std::string KeyGenerator::Gen(const Row& row, const Row& parameter) {
     if (row.size() == 0) {
         return codec::NONETOKEN;
     }
-    Row key_row = CoreAPI::RowProject(fn_, row, parameter, true);
+    Row key_row = RowProject(row, parameter, true);
     std::string keys = "";
     for (auto pos : idxs_) {
         if (!keys.empty()) {
@@ -3153,20 +3670,43 @@ const std::string KeyGenerator::Gen(const Row& row, const Row& parameter) {
 }
 
 const int64_t OrderGenerator::Gen(const Row& row) {
-    Row order_row = CoreAPI::RowProject(fn_, row, Row(), true);
+    Row order_row = RowProject(row, Row(), true);
     return Runner::GetColumnInt64(order_row.buf(), &row_view_, idxs_[0],
                                   fn_schema_.Get(idxs_[0]).type());
 }
 
+const Row FnGenerator::RowProject(const Row& row, const Row& parameter,
+                                  const bool need_free) const {
+    if (nullptr == fn_ && nullptr != interpreter_) {
+        return row.empty() ? Row() : interpreter_->RowProject(row, parameter);
+    }
+    return CoreAPI::RowProject(fn_, row, parameter, need_free);
+}
+const Row FnGenerator::RowConstProject(const Row& parameter,
+                                       const bool need_free) const {
+    if (nullptr == fn_ && nullptr != interpreter_) {
+        return interpreter_->RowProject(Row(), parameter);
+    }
+    return CoreAPI::RowConstProject(fn_, parameter, need_free);
+}
+
 const bool ConditionGenerator::Gen(const Row& row, const Row& parameter) const {
+    if (nullptr == fn_ && nullptr != interpreter_) {
+        Row cond_row = RowProject(row, parameter, true);
+        if (cond_row.empty()) {
+            return false;
+        }
+        return Runner::GetColumnBool(cond_row.buf(), &row_view_, idxs_[0],
+                                     fn_schema_.Get(idxs_[0]).type());
+    }
     return CoreAPI::ComputeCondition(fn_, row, parameter, &row_view_, idxs_[0]);
 }
 const Row ProjectGenerator::Gen(const Row& row, const Row& parameter) {
-    return CoreAPI::RowProject(fn_, row, parameter, false);
+    return RowProject(row, parameter, false);
 }
 
 const Row ConstProjectGenerator::Gen(const Row& parameter) {
-    return CoreAPI::RowConstProject(fn_, parameter, false);
+    return RowConstProject(parameter, false);
 }
 
 const Row AggGenerator::Gen(const codec::Row& parameter_row, std::shared_ptr<TableHandler> table) {
@@ -3227,13 +3767,13 @@ std::vector<std::shared_ptr<DataHandler>> InputsGenerator::RunInputs(
 std::vector<std::shared_ptr<PartitionHandler>>
 WindowUnionGenerator::PartitionEach(
     std::vector<std::shared_ptr<DataHandler>> union_inputs,
-    const Row& parameter) {
+    const Row& parameter, std::shared_ptr<SpillContext> spill_ctx) {
     std::vector<std::shared_ptr<PartitionHandler>> union_partitions;
     if (!windows_gen_.empty()) {
         union_partitions.reserve(windows_gen_.size());
         for (size_t i = 0; i < inputs_cnt_; i++) {
-            union_partitions.push_back(
-                windows_gen_[i].partition_gen_.Partition(union_inputs[i], parameter));
+            union_partitions.push_back(windows_gen_[i].partition_gen_.Partition(
+                union_inputs[i], parameter, spill_ctx));
         }
     }
     return union_partitions;
@@ -3365,8 +3905,34 @@ std::shared_ptr<TableHandler> IndexSeekGenerator::SegmentOfKey(
 
 std::shared_ptr<TableHandler> FilterGenerator::Filter(
     std::shared_ptr<PartitionHandler> table, const Row& parameter) {
+    if (!index_seek_gen_.Valid()) {
+        // filter every segment, e.g. the input of a window
+        if (!table) {
+            LOG(WARNING) << "fail to filter partition: input is empty";
+            return std::shared_ptr<TableHandler>();
+        }
+        if (!condition_gen_.Valid()) {
+            return table;
+        }
+        return std::shared_ptr<TableHandler>(
+            new PartitionFilterWrapper(table, parameter, this));
+    }
     return Filter(index_seek_gen_.SegmnetOfConstKey(parameter, table), parameter);
 }
+bool FilterGenerator::GetKeyRange(uint64_t* start, uint64_t* end) const {
+    if (!has_ts_range_ || nullptr == start || nullptr == end) {
+        return false;
+    }
+    if (ts_end_ < 0 || ts_start_ > ts_end_) {
+        // no row passes the condition
+        *start = 1;
+        *end = 0;
+        return true;
+    }
+    *start = static_cast<uint64_t>(std::max(ts_start_, static_cast<int64_t>(0)));
+    *end = static_cast<uint64_t>(ts_end_);
+    return true;
+}
 std::shared_ptr<TableHandler> FilterGenerator::Filter(
     std::shared_ptr<TableHandler> table,
     const Row& parameter) {
@@ -30,8 +30,10 @@
 #include "vm/catalog.h"
 #include "vm/catalog_wrapper.h"
 #include "vm/core_api.h"
+#include "vm/expr_interpreter.h"
 #include "vm/mem_catalog.h"
 #include "vm/physical_op.h"
+#include "vm/spill_partition_handler.h"
 namespace hybridse {
 namespace vm {
 
@@ -50,6 +52,7 @@ class FnGenerator {
  public:
     explicit FnGenerator(const FnInfo& info)
         : fn_(info.fn_ptr()),
+          interpreter_(info.interpreter()),
           fn_schema_(*info.fn_schema()),
           row_view_(fn_schema_) {
         for (int32_t idx = 0; idx < fn_schema_.size(); idx++) {
@@ -57,8 +60,15 @@ class FnGenerator {
         }
     }
     virtual ~FnGenerator() {}
-    inline const bool Valid() const { return nullptr != fn_; }
+    inline const bool Valid() const {
+        return nullptr != fn_ || nullptr != interpreter_;
+    }
+    // run the jit function, or the interpreter if the function is not compiled
+    const Row RowProject(const Row& row, const Row& parameter,
+                         const bool need_free) const;
+    const Row RowConstProject(const Row& parameter, const bool need_free) const;
     const int8_t* fn_;
+    const std::shared_ptr<ExprInterpreter> interpreter_;
     const Schema fn_schema_;
     const RowView row_view_;
     std::vector<int32_t> idxs_;
@@ -67,17 +77,25 @@ class FnGenerator {
 class RowProjectFun : public ProjectFun {
  public:
     explicit RowProjectFun(const int8_t* fn) : ProjectFun(), fn_(fn) {}
+    RowProjectFun(const int8_t* fn,
+                  const std::shared_ptr<ExprInterpreter>& interpreter)
+        : ProjectFun(), fn_(fn), interpreter_(interpreter) {}
     ~RowProjectFun() {}
     Row operator()(const Row& row, const Row& parameter) const override {
+        if (nullptr == fn_ && nullptr != interpreter_) {
+            return row.empty() ? Row()
+                               : interpreter_->RowProject(row, parameter);
+        }
         return CoreAPI::RowProject(fn_, row, parameter, false);
     }
     const int8_t* fn_;
+    const std::shared_ptr<ExprInterpreter> interpreter_;
 };
 
 class ProjectGenerator : public FnGenerator {
  public:
     explicit ProjectGenerator(const FnInfo& info)
-        : FnGenerator(info), fun_(info.fn_ptr()) {}
+        : FnGenerator(info), fun_(info.fn_ptr(), info.interpreter()) {}
     virtual ~ProjectGenerator() {}
     const Row Gen(const Row& row, const Row& parameter);
     RowProjectFun fun_;
@@ -199,12 +217,17 @@ class PartitionGenerator {
     virtual ~PartitionGenerator() {}
 
     const bool Valid() const { return key_gen_.Valid(); }
+    // rows are buffered under the budget of `spill_ctx` if given, and
+    // spilled to disk beyond it
     std::shared_ptr<PartitionHandler> Partition(
-        std::shared_ptr<DataHandler> input, const Row& parameter);
+        std::shared_ptr<DataHandler> input, const Row& parameter,
+        std::shared_ptr<SpillContext> spill_ctx = nullptr);
     std::shared_ptr<PartitionHandler> Partition(
-        std::shared_ptr<PartitionHandler> table, const Row& parameter);
+        std::shared_ptr<PartitionHandler> table, const Row& parameter,
+        std::shared_ptr<SpillContext> spill_ctx = nullptr);
     std::shared_ptr<PartitionHandler> Partition(
-        std::shared_ptr<TableHandler> table, const Row& parameter);
+        std::shared_ptr<TableHandler> table, const Row& parameter,
+        std::shared_ptr<SpillContext> spill_ctx = nullptr);
     const std::string GetKey(const Row& row, const Row& parameter) { return key_gen_.Gen(row, parameter); }
 
  private:
@@ -228,6 +251,7 @@ class SortGenerator {
     std::shared_ptr<TableHandler> Sort(std::shared_ptr<TableHandler> table,
                                        const bool reverse = false);
     const OrderGenerator& order_gen() const { return order_gen_; }
+    const bool is_asc() const { return is_asc_; }
 
  private:
     bool is_valid_;
@@ -246,6 +270,9 @@ class IndexSeekGenerator {
     std::shared_ptr<TableHandler> SegmentOfKey(
         const Row& row, const Row& parameter, std::shared_ptr<DataHandler> input);
     const bool Valid() const { return index_key_gen_.Valid(); }
+    const std::string GetKey(const Row& row, const Row& parameter) {
+        return index_key_gen_.Valid() ? index_key_gen_.Gen(row, parameter) : "";
+    }
 
  private:
     KeyGenerator index_key_gen_;
@@ -255,7 +282,10 @@ class FilterGenerator : public PredicateFun {
  public:
     explicit FilterGenerator(const Filter& filter)
         : condition_gen_(filter.condition_.fn_info()),
-          index_seek_gen_(filter.index_key_) {}
+          index_seek_gen_(filter.index_key_),
+          has_ts_range_(filter.has_ts_range()),
+          ts_start_(filter.ts_start()),
+          ts_end_(filter.ts_end()) {}
 
     const bool Valid() const {
         return index_seek_gen_.Valid() || condition_gen_.Valid();
@@ -270,10 +300,14 @@ class FilterGenerator : public PredicateFun {
         }
         return condition_gen_.Gen(row, parameter);
     }
+    bool GetKeyRange(uint64_t* start, uint64_t* end) const override;
 
  private:
     ConditionGenerator condition_gen_;
     IndexSeekGenerator index_seek_gen_;
+    const bool has_ts_range_;
+    const int64_t ts_start_;
+    const int64_t ts_end_;
 };
 class WindowGenerator {
  public:
@@ -314,6 +348,12 @@ class RequestWindowGenertor {
         }
         return segment;
     }
+    // rows with the same window key get the same window segment
+    const std::string GetWindowKey(const Row& row, const Row& parameter) {
+        auto index_key = index_seek_gen_.GetKey(row, parameter);
+        auto filter_key = filter_gen_.GetKey(row, parameter);
+        return std::to_string(index_key.size()) + ":" + index_key + filter_key;
+    }
     RequestWindowOp window_op_;
     FilterKeyGenerator filter_gen_;
     SortGenerator sort_gen_;
@@ -587,7 +627,8 @@ class WindowUnionGenerator : public InputsGenerator {
     virtual ~WindowUnionGenerator() {}
     std::vector<std::shared_ptr<PartitionHandler>> PartitionEach(
         std::vector<std::shared_ptr<DataHandler>> union_inputs,
-        const Row& parameter);
+        const Row& parameter,
+        std::shared_ptr<SpillContext> spill_ctx = nullptr);
     void AddWindowUnion(const WindowOp& window_op, Runner* runner) {
         windows_gen_.push_back(WindowGenerator(window_op));
         AddInput(runner);
@@ -618,6 +659,17 @@ class RequestWindowUnionGenerator : public InputsGenerator {
         }
         return union_segments;
     }
+    // rows with the same key get the same segments from GetRequestWindows
+    const std::string GetWindowsKey(const Row& row, const Row& parameter) {
+        std::string key;
+        for (auto& window_gen : windows_gen_) {
+            auto window_key = window_gen.GetWindowKey(row, parameter);
+            key.append(std::to_string(window_key.size()))
+                .append(1, ':')
+                .append(window_key);
+        }
+        return key;
+    }
     std::vector<RequestWindowGenertor> windows_gen_;
 };
 class JoinGenerator {
@@ -629,6 +681,7 @@ class JoinGenerator {
           right_group_gen_(join.right_key_),
           index_key_gen_(join.index_key_.fn_info()),
           right_sort_gen_(join.right_sort_),
+          hash_join_(join.hash_join()),
           left_slices_(left_slices),
           right_slices_(right_slices) {}
     virtual ~JoinGenerator() {}
@@ -646,6 +699,14 @@ class JoinGenerator {
                        std::shared_ptr<PartitionHandler> right,
                        const Row& parameter,
                        std::shared_ptr<MemPartitionHandler>);  // NOLINT
+    bool TableHashJoin(std::shared_ptr<TableHandler> left,
+                       std::shared_ptr<TableHandler> right,
+                       const Row& parameter,
+                       std::shared_ptr<MemTimeTableHandler> output);  // NOLINT
+    bool PartitionHashJoin(std::shared_ptr<PartitionHandler> left,
+                           std::shared_ptr<TableHandler> right,
+                           const Row& parameter,
+                           std::shared_ptr<MemPartitionHandler> output);  // NOLINT
 
     Row RowLastJoin(const Row& left_row, std::shared_ptr<DataHandler> right, const Row& parameter);
     Row RowLastJoinDropLeftSlices(const Row& left_row, std::shared_ptr<DataHandler> right, const Row& parameter);
@@ -654,8 +715,17 @@ class JoinGenerator {
     PartitionGenerator right_group_gen_;
     KeyGenerator index_key_gen_;
     SortGenerator right_sort_gen_;
+    bool hash_join_;
 
  private:
+    // right rows bucketed by right keys, each bucket is ordered so that
+    // the last row under right sort comes first
+    typedef std::unordered_map<std::string, MemTimeTable> HashJoinTable;
+    bool BuildHashJoinTable(std::shared_ptr<TableHandler> right,
+                            const Row& parameter,
+                            HashJoinTable* hash_table);  // NOLINT
+    Row RowHashLastJoin(const Row& left_row, const HashJoinTable& hash_table,
+                        const Row& parameter);
     Row RowLastJoinPartition(
         const Row& left_row,
         std::shared_ptr<PartitionHandler> partition,
@@ -697,6 +767,10 @@ class DataRunner : public Runner {
     std::shared_ptr<DataHandlerList> BatchRequestRun(
         RunnerContext& ctx) override;  // NOLINT
     const std::shared_ptr<DataHandler> data_handler_;
+
+ private:
+    // the data handler with the scan filter of `ctx` applied
+    std::shared_ptr<DataHandler> GetDataHandler(RunnerContext& ctx);  // NOLINT
 };
 
 class RequestRunner : public Runner {
@@ -811,7 +885,18 @@ class SimpleProjectRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+
+    // Let storage project the input when the projects just select columns
+    void set_select_columns(const std::vector<size_t>& column_idxs) {
+        select_columns_ = column_idxs;
+    }
+    const std::vector<size_t>& select_columns() const {
+        return select_columns_;
+    }
     ProjectGenerator project_gen_;
+
+ private:
+    std::vector<size_t> select_columns_;
 };
 
 class SelectSliceRunner : public Runner {
@@ -893,8 +978,7 @@ class WindowAggRunner : public Runner {
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
     void RunWindowAggOnKey(
-        const Row& parameter,
-        std::shared_ptr<PartitionHandler> instance_partition,
+        const Row& parameter, std::shared_ptr<TableHandler> instance_segment,
         std::vector<std::shared_ptr<PartitionHandler>> union_partitions,
         std::vector<std::shared_ptr<DataHandler>> joins, const std::string& key,
         std::shared_ptr<MemTableHandler> output_table);
@@ -917,24 +1001,50 @@ class RequestUnionRunner : public Runner {
         : Runner(id, kRunnerRequestUnion, schema, limit_cnt),
           range_gen_(range),
           exclude_current_time_(exclude_current_time),
-          output_request_row_(output_request_row) {}
+          output_request_row_(output_request_row),
+          shared_window_with_request_row_(false),
+          share_segment_scan_(false) {}
 
     std::shared_ptr<DataHandler> Run(
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    // rows of the batch with the same window keys share one scan of each
+    // union segment
+    std::shared_ptr<DataHandlerList> BatchRequestRun(
+        RunnerContext& ctx) override;  // NOLINT
     static std::shared_ptr<TableHandler> RequestUnionWindow(
         const Row& request,
         std::vector<std::shared_ptr<TableHandler>> union_segments,
         int64_t request_ts, const WindowRange& window_range,
         const bool output_request_row, const bool exclude_current_time);
+    // build window from output of a window covering it, the third input
+    static std::shared_ptr<TableHandler> SharedWindow(
+        const Row& request, std::shared_ptr<TableHandler> shared_window,
+        const bool shared_window_with_request_row, int64_t request_ts,
+        const WindowRange& window_range, const bool output_request_row,
+        const bool exclude_current_time);
+    // read `segment` once for windows of all `request_ts` on it, return views
+    // of the rows read, one for each request starting at its window end
+    static std::vector<std::shared_ptr<TableHandler>> SharedSegmentViews(
+        std::shared_ptr<TableHandler> segment,
+        const std::vector<int64_t>& request_ts,
+        const WindowRange& window_range, const bool exclude_current_time);
     void AddWindowUnion(const RequestWindowOp& window, Runner* runner) {
         windows_union_gen_.AddWindowUnion(window, runner);
     }
+    void set_shared_window_with_request_row(bool flag) {
+        shared_window_with_request_row_ = flag;
+    }
+    void set_share_segment_scan(bool flag) { share_segment_scan_ = flag; }
     RequestWindowUnionGenerator windows_union_gen_;
     RangeGenerator range_gen_;
     bool exclude_current_time_;
     bool output_request_row_;
+    bool shared_window_with_request_row_;
+    // the union segments may be scanned once for the rows of a batch, see
+    // BatchRequestRun
+    bool share_segment_scan_;
 };
 
 class PostRequestUnionRunner : public Runner {
@@ -1478,6 +1588,14 @@ class RunnerContext {
     void ClearCache() { cache_.clear(); }
     std::shared_ptr<DataHandlerList> GetBatchCache(int64_t id) const;
     void SetBatchCache(int64_t id, std::shared_ptr<DataHandlerList> data);
+    std::shared_ptr<SpillContext> spill_ctx() const { return spill_ctx_; }
+    void SetSpillContext(std::shared_ptr<SpillContext> spill_ctx) {
+        spill_ctx_ = spill_ctx;
+    }
+    std::shared_ptr<ScanFilter> scan_filter() const { return scan_filter_; }
+    void SetScanFilter(std::shared_ptr<ScanFilter> scan_filter) {
+        scan_filter_ = scan_filter;
+    }
 
  private:
     hybridse::vm::ClusterJob* cluster_job_;
@@ -1490,6 +1608,10 @@ class RunnerContext {
     // TODO(chenjing): optimize
     std::map<int64_t, std::shared_ptr<DataHandler>> cache_;
     std::map<int64_t, std::shared_ptr<DataHandlerList>> batch_cache_;
+    // memory budget of partition buffers, null if unlimited
+    std::shared_ptr<SpillContext> spill_ctx_;
+    // restriction of the tables scanned by the run, null if unrestricted
+    std::shared_ptr<ScanFilter> scan_filter_;
 };
 }  // namespace vm
 }  // namespace hybridse
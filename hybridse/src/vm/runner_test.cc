@@ -410,6 +410,161 @@ TEST_F(RunnerTest, RunnerPrintDataMemTimeTableTest) {
         LOG(INFO) << oss.str();
     }
 }
+
+TEST_F(RunnerTest, HashLastJoinTest) {
+    std::string sqlstr =
+        "select t1.col1, t2.col5 from t1 last join t2 order by t2.col5 "
+        "on t1.col0 = t2.col0;";
+    hybridse::type::TableDef table_def;
+    BuildTableDef(table_def);
+    table_def.set_name("t1");
+    hybridse::type::TableDef table_def2;
+    BuildTableDef(table_def2);
+    table_def2.set_name("t2");
+    ::hybridse::type::IndexDef* index = table_def2.add_indexes();
+    index->set_name("index1");
+    index->add_first_keys("col1");
+    index->set_second_key("col5");
+    hybridse::type::Database db;
+    db.set_name("db");
+    AddTable(db, table_def);
+    AddTable(db, table_def2);
+    auto catalog = BuildSimpleCatalog(db);
+
+    SqlCompiler sql_compiler(catalog);
+    SqlContext sql_context;
+    sql_context.sql = sqlstr;
+    sql_context.db = "db";
+    sql_context.engine_mode = kBatchMode;
+    sql_context.is_performance_sensitive = false;
+    base::Status compile_status;
+    ASSERT_TRUE(sql_compiler.Compile(sql_context, compile_status));
+    ASSERT_TRUE(sql_compiler.BuildClusterJob(sql_context, compile_status));
+
+    // t2 has no index on col0, right table is built into hash buckets
+    auto last_join_runner = dynamic_cast<LastJoinRunner*>(GetFirstRunnerOfType(
+        sql_context.cluster_job.GetTask(0).GetRoot(), kRunnerLastJoin));
+    ASSERT_TRUE(last_join_runner != nullptr);
+    ASSERT_TRUE(last_join_runner->join_gen_.hash_join_);
+
+    std::vector<Row> rows;
+    hybridse::type::TableDef temp_table;
+    BuildRows(temp_table, rows);
+    auto left = std::make_shared<MemTimeTableHandler>();
+    auto right = std::make_shared<MemTimeTableHandler>();
+    uint64_t ts = 1000;
+    for (auto row : rows) {
+        left->AddRow(ts, row);
+        right->AddRow(ts, row);
+        ts++;
+    }
+    auto output = std::make_shared<MemTimeTableHandler>();
+    Row empty_parameter;
+    ASSERT_TRUE(last_join_runner->join_gen_.TableHashJoin(
+        left, right, empty_parameter, output));
+    ASSERT_EQ(rows.size(), output->GetCount());
+
+    // last row of each col0 bucket ordered by col5
+    std::vector<int64_t> exp_col5 = {2, 2, 2, 2, 3};
+    codec::RowView row_view(table_def2.columns());
+    for (size_t i = 0; i < exp_col5.size(); i++) {
+        auto right_slice = output->At(i).GetSlice(1);
+        ASSERT_TRUE(row_view.Reset(right_slice.buf(), right_slice.size()));
+        ASSERT_EQ(exp_col5[i], row_view.GetInt64Unsafe(5));
+    }
+}
+
+TEST_F(RunnerTest, SharedSegmentViewsTest) {
+    std::vector<Row> rows;
+    hybridse::type::TableDef temp_table;
+    BuildRows(temp_table, rows);
+    // rows of the segment in descending order of ts, with duplicate ts
+    auto segment = std::make_shared<MemTimeTableHandler>();
+    for (uint64_t ts = 100; ts > 0; ts -= 2) {
+        segment->AddRow(ts, rows[ts % rows.size()]);
+        segment->AddRow(ts, rows[(ts + 1) % rows.size()]);
+    }
+    std::vector<int64_t> request_ts = {95, 40, 60, 101, 3, 60};
+    std::vector<WindowRange> window_ranges = {
+        WindowRange::CreateRowsWindow(3),
+        WindowRange::CreateRowsRangeWindow(-10, 0),
+        WindowRange::CreateRowsRangeWindow(-20, -5, 3),
+        WindowRange::CreateRowsMergeRowsRangeWindow(-5, 6)};
+    for (auto& window_range : window_ranges) {
+        for (bool exclude_current_time : {false, true}) {
+            auto views = RequestUnionRunner::SharedSegmentViews(
+                segment, request_ts, window_range, exclude_current_time);
+            ASSERT_EQ(request_ts.size(), views.size());
+            for (size_t i = 0; i < request_ts.size(); i++) {
+                // windows on the views are the same as windows on the segment
+                auto exp = RequestUnionRunner::RequestUnionWindow(
+                    rows[0], {segment}, request_ts[i], window_range, true,
+                    exclude_current_time);
+                auto window = RequestUnionRunner::RequestUnionWindow(
+                    rows[0], {views[i]}, request_ts[i], window_range, true,
+                    exclude_current_time);
+                ASSERT_EQ(exp->GetCount(), window->GetCount());
+                auto exp_iter = exp->GetIterator();
+                auto iter = window->GetIterator();
+                exp_iter->SeekToFirst();
+                iter->SeekToFirst();
+                while (exp_iter->Valid()) {
+                    ASSERT_TRUE(iter->Valid());
+                    ASSERT_EQ(exp_iter->GetKey(), iter->GetKey());
+                    ASSERT_EQ(exp_iter->GetValue().buf(), iter->GetValue().buf());
+                    exp_iter->Next();
+                    iter->Next();
+                }
+            }
+        }
+    }
+}
+
+TEST_F(RunnerTest, SharedSegmentScanTtlTest) {
+    std::string sqlstr =
+        "select col1, sum(col2) over w1 from t1 window w1 as (partition by "
+        "col1 order by col5 rows between 2 preceding and current row);";
+    // a count ttl counts the rows from where the scan seeks to, segments of
+    // such indexes are scanned row by row
+    std::vector<std::pair<type::TTLType, bool>> cases = {
+        {type::kTTLTimeLive, true},
+        {type::kTTLNone, true},
+        {type::kTTLCountLive, false},
+        {type::kTTLTimeLiveAndCountLive, false},
+        {type::kTTLTimeLiveOrCountLive, false}};
+    for (auto& ttl_case : cases) {
+        hybridse::type::TableDef table_def;
+        BuildTableDef(table_def);
+        table_def.set_name("t1");
+        ::hybridse::type::IndexDef* index = table_def.add_indexes();
+        index->set_name("index1");
+        index->add_first_keys("col1");
+        index->set_second_key("col5");
+        index->set_ttl_type(ttl_case.first);
+        hybridse::type::Database db;
+        db.set_name("db");
+        AddTable(db, table_def);
+        auto catalog = BuildSimpleCatalog(db);
+
+        SqlCompiler sql_compiler(catalog);
+        SqlContext sql_context;
+        sql_context.sql = sqlstr;
+        sql_context.db = "db";
+        sql_context.engine_mode = kRequestMode;
+        sql_context.is_performance_sensitive = false;
+        base::Status compile_status;
+        ASSERT_TRUE(sql_compiler.Compile(sql_context, compile_status))
+            << compile_status;
+        ASSERT_TRUE(sql_compiler.BuildClusterJob(sql_context, compile_status));
+        auto union_runner =
+            dynamic_cast<RequestUnionRunner*>(GetFirstRunnerOfType(
+                sql_context.cluster_job.GetTask(0).GetRoot(),
+                kRunnerRequestUnion));
+        ASSERT_TRUE(union_runner != nullptr);
+        ASSERT_EQ(ttl_case.second, union_runner->share_segment_scan_)
+            << type::TTLType_Name(ttl_case.first);
+    }
+}
 }  // namespace vm
 }  // namespace hybridse
 
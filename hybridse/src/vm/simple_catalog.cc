@@ -92,6 +92,7 @@ SimpleCatalogTableHandler::SimpleCatalogTableHandler(
             DLOG(INFO) << "init table with empty second key";
         }
         index_st.name = index_def.name();
+        index_st.ttl_type = index_def.ttl_type();
         for (int32_t j = 0; j < index_def.first_keys_size(); j++) {
             const std::string &key = index_def.first_keys(j);
             auto it = types_dict_.find(key);
@@ -138,6 +139,10 @@ std::unique_ptr<WindowIterator> SimpleCatalogTableHandler::GetWindowIterator(
 
 const uint64_t SimpleCatalogTableHandler::GetCount() { return 0; }
 
+int64_t SimpleCatalogTableHandler::GetCountEstimate() {
+    return full_table_storage_->GetCount();
+}
+
 hybridse::codec::Row SimpleCatalogTableHandler::At(uint64_t pos) {
     LOG(ERROR) << "Unsupported operation: At()";
     return hybridse::codec::Row();
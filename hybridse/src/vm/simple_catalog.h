@@ -50,6 +50,8 @@ class SimpleCatalogTableHandler : public TableHandler {
 
     const uint64_t GetCount() override;
 
+    int64_t GetCountEstimate() override;
+
     hybridse::codec::Row At(uint64_t pos) override;
 
     std::shared_ptr<PartitionHandler> GetPartition(
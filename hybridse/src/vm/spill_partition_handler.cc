@@ -0,0 +1,443 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/spill_partition_handler.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <utility>
+#include "glog/logging.h"
+
+namespace hybridse {
+namespace vm {
+
+// rough per row overhead of MemSegmentMap entries besides row slices
+static const uint64_t SPILL_ROW_OVERHEAD = 32;
+static const size_t SPILL_IO_BUFFER_SIZE = 1 << 20;
+
+static uint64_t RowBytes(const std::string& key, const Row& row) {
+    uint64_t bytes = SPILL_ROW_OVERHEAD + key.size();
+    for (int32_t i = 0; i < row.GetRowPtrCnt(); i++) {
+        bytes += row.size(i);
+    }
+    return bytes;
+}
+
+bool SpillContext::Reserve(uint64_t bytes) {
+    if (0 == max_memory_bytes_) {
+        // no budget
+        used_bytes_.fetch_add(bytes);
+        return true;
+    }
+    uint64_t used = used_bytes_.fetch_add(bytes) + bytes;
+    if (used > max_memory_bytes_) {
+        used_bytes_.fetch_sub(bytes);
+        return false;
+    }
+    return true;
+}
+
+SpillRun::~SpillRun() {
+    if (0 != unlink(path_.c_str())) {
+        LOG(WARNING) << "fail to remove spill run " << path_;
+    }
+}
+
+std::shared_ptr<SpillRun> SpillRun::Write(const std::string& spill_dir,
+                                          const MemSegmentMap& partitions,
+                                          uint64_t* bytes) {
+    std::string path = spill_dir + "/hybridse_spill_XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        LOG(WARNING) << "fail to create spill run under " << spill_dir;
+        return std::shared_ptr<SpillRun>();
+    }
+    // the run owns the file from now on, remove it on any failure
+    auto run = std::make_shared<SpillRun>(path);
+    FILE* file = fdopen(fd, "wb");
+    if (nullptr == file) {
+        close(fd);
+        LOG(WARNING) << "fail to open spill run " << path;
+        return std::shared_ptr<SpillRun>();
+    }
+    setvbuf(file, nullptr, _IOFBF, SPILL_IO_BUFFER_SIZE);
+    bool ok = true;
+    uint64_t written = 0;
+    for (auto& segment : partitions) {
+        const std::string& key = segment.first;
+        uint32_t key_size = key.size();
+        for (auto& pair : segment.second) {
+            const Row& row = pair.second;
+            uint32_t slices = row.GetRowPtrCnt();
+            ok = ok && 1 == fwrite(&key_size, sizeof(key_size), 1, file);
+            ok = ok && (0 == key_size ||
+                        1 == fwrite(key.data(), key_size, 1, file));
+            ok = ok && 1 == fwrite(&pair.first, sizeof(pair.first), 1, file);
+            ok = ok && 1 == fwrite(&slices, sizeof(slices), 1, file);
+            written += sizeof(key_size) + key_size + sizeof(pair.first) +
+                       sizeof(slices);
+            for (uint32_t i = 0; i < slices && ok; i++) {
+                uint32_t size = row.size(i);
+                ok = ok && 1 == fwrite(&size, sizeof(size), 1, file);
+                ok = ok && (0 == size || 1 == fwrite(row.buf(i), size, 1, file));
+                written += sizeof(size) + size;
+            }
+        }
+        if (!ok) {
+            break;
+        }
+    }
+    ok = (0 == fclose(file)) && ok;
+    if (!ok) {
+        LOG(WARNING) << "fail to write spill run " << path;
+        return std::shared_ptr<SpillRun>();
+    }
+    *bytes = written;
+    return run;
+}
+
+// read records of a spill run one by one
+class SpillRunSource : public SpillRowSource {
+ public:
+    explicit SpillRunSource(std::shared_ptr<SpillRun> run)
+        : run_(run), file_(nullptr), valid_(false), key_(), ts_(0), row_() {
+        file_ = fopen(run_->path().c_str(), "rb");
+        if (nullptr == file_) {
+            LOG(WARNING) << "fail to open spill run " << run_->path();
+            return;
+        }
+        setvbuf(file_, nullptr, _IOFBF, SPILL_IO_BUFFER_SIZE);
+        Next();
+    }
+    ~SpillRunSource() {
+        if (nullptr != file_) {
+            fclose(file_);
+        }
+    }
+    bool Valid() const override { return valid_; }
+    void Next() override { valid_ = nullptr != file_ && Read(); }
+    const std::string& GetKey() const override { return key_; }
+    const uint64_t GetTs() const override { return ts_; }
+    const Row& GetValue() const override { return row_; }
+
+ private:
+    bool Read() {
+        uint32_t key_size = 0;
+        if (1 != fread(&key_size, sizeof(key_size), 1, file_)) {
+            // end of run
+            return false;
+        }
+        key_.resize(key_size);
+        uint32_t slices = 0;
+        if ((key_size > 0 && 1 != fread(&key_[0], key_size, 1, file_)) ||
+            1 != fread(&ts_, sizeof(ts_), 1, file_) ||
+            1 != fread(&slices, sizeof(slices), 1, file_)) {
+            LOG(WARNING) << "broken spill run " << run_->path();
+            return false;
+        }
+        row_ = Row();
+        for (uint32_t i = 0; i < slices; i++) {
+            uint32_t size = 0;
+            if (1 != fread(&size, sizeof(size), 1, file_)) {
+                LOG(WARNING) << "broken spill run " << run_->path();
+                return false;
+            }
+            int8_t* buf = nullptr;
+            if (size > 0) {
+                buf = static_cast<int8_t*>(malloc(size));
+                if (1 != fread(buf, size, 1, file_)) {
+                    free(buf);
+                    LOG(WARNING) << "broken spill run " << run_->path();
+                    return false;
+                }
+            }
+            auto slice = base::RefCountedSlice::CreateManaged(buf, size);
+            if (0 == i) {
+                row_ = Row(slice);
+            } else {
+                row_.Append(slice);
+            }
+        }
+        return true;
+    }
+
+    std::shared_ptr<SpillRun> run_;
+    FILE* file_;
+    bool valid_;
+    std::string key_;
+    uint64_t ts_;
+    Row row_;
+};
+
+SpillWindowIterator::SpillWindowIterator(
+    const std::vector<std::shared_ptr<SpillRun>>* runs,
+    const SegmentOrderFun* segment_order, const Schema* schema)
+    : WindowIterator(),
+      runs_(runs),
+      segment_order_(segment_order),
+      schema_(schema),
+      sources_(),
+      valid_(false),
+      key_(),
+      segment_() {}
+
+void SpillWindowIterator::SeekToFirst() {
+    sources_.clear();
+    for (auto& run : *runs_) {
+        sources_.emplace_back(new SpillRunSource(run));
+    }
+    MergeNextKey();
+}
+
+void SpillWindowIterator::Seek(const std::string& key) {
+    if (!SeekSegment(key)) {
+        valid_ = false;
+    }
+}
+
+bool SpillWindowIterator::SeekSegment(const std::string& key) {
+    std::greater<std::string> before;
+    // key_ stays at the last merged key once sources are exhausted, so a
+    // miss after the end doesn't rescan the runs
+    if (sources_.empty() || before(key, key_) || (!valid_ && key == key_)) {
+        SeekToFirst();
+    }
+    while (valid_ && before(key_, key)) {
+        MergeNextKey();
+    }
+    return valid_ && key_ == key;
+}
+
+void SpillWindowIterator::Next() { MergeNextKey(); }
+
+void SpillWindowIterator::MergeNextKey() {
+    std::greater<std::string> before;
+    valid_ = false;
+    for (auto& source : sources_) {
+        if (source->Valid() &&
+            (!valid_ || before(source->GetKey(), key_))) {
+            key_ = source->GetKey();
+            valid_ = true;
+        }
+    }
+    if (!valid_) {
+        segment_.reset();
+        return;
+    }
+    // runs are written in insertion order, so concatenating the key's rows
+    // run by run keeps the original row order inside the segment
+    MemTimeTable rows;
+    for (auto& source : sources_) {
+        while (source->Valid() && source->GetKey() == key_) {
+            rows.push_back(std::make_pair(source->GetTs(), source->GetValue()));
+            source->Next();
+        }
+    }
+    if (nullptr != segment_order_ && *segment_order_) {
+        (*segment_order_)(&rows);
+    }
+    segment_ = std::make_shared<MemTimeTableHandler>(schema_);
+    for (auto& pair : rows) {
+        segment_->AddRow(pair.first, pair.second);
+    }
+}
+
+// iterator over a merged segment, keeping the segment alive after the
+// window iterator moves to the next key
+class SpillSegmentIterator : public RowIterator {
+ public:
+    explicit SpillSegmentIterator(std::shared_ptr<MemTimeTableHandler> segment)
+        : segment_(segment), iter_(segment->GetIterator()) {}
+    ~SpillSegmentIterator() {}
+    bool Valid() const override { return iter_->Valid(); }
+    void Next() override { iter_->Next(); }
+    const uint64_t& GetKey() const override { return iter_->GetKey(); }
+    const Row& GetValue() override { return iter_->GetValue(); }
+    bool IsSeekable() const override { return iter_->IsSeekable(); }
+    void Seek(const uint64_t& key) override { iter_->Seek(key); }
+    void SeekToFirst() override { iter_->SeekToFirst(); }
+
+ private:
+    std::shared_ptr<MemTimeTableHandler> segment_;
+    std::unique_ptr<RowIterator> iter_;
+};
+
+std::unique_ptr<RowIterator> SpillWindowIterator::GetValue() {
+    return std::unique_ptr<RowIterator>(GetRawValue());
+}
+
+RowIterator* SpillWindowIterator::GetRawValue() {
+    return segment_ ? new SpillSegmentIterator(segment_) : nullptr;
+}
+
+SpillPartitionHandler::SpillPartitionHandler(
+    const Schema* schema, std::vector<std::shared_ptr<SpillRun>> runs,
+    OrderType order_type)
+    : PartitionHandler(),
+      table_name_(""),
+      db_(""),
+      schema_(schema),
+      types_(),
+      index_hint_(),
+      runs_(runs),
+      order_type_(order_type),
+      segment_order_(),
+      cursor_mu_(),
+      cursor_() {}
+
+std::unique_ptr<WindowIterator> SpillPartitionHandler::GetWindowIterator() {
+    return std::unique_ptr<WindowIterator>(
+        new SpillWindowIterator(&runs_, &segment_order_, schema_));
+}
+
+std::shared_ptr<TableHandler> SpillPartitionHandler::GetSegment(
+    const std::string& key) {
+    std::lock_guard<std::mutex> lock(cursor_mu_);
+    if (!cursor_) {
+        cursor_ = std::unique_ptr<SpillWindowIterator>(
+            new SpillWindowIterator(&runs_, &segment_order_, schema_));
+    }
+    // runners visit keys in partition order, so the cursor only moves
+    // forward unless an earlier key is asked for again
+    if (!cursor_->SeekSegment(key)) {
+        auto empty = std::make_shared<MemTimeTableHandler>(schema_);
+        empty->SetOrderType(order_type_);
+        return empty;
+    }
+    auto segment = cursor_->GetSegment();
+    segment->SetOrderType(order_type_);
+    return segment;
+}
+
+const uint64_t SpillPartitionHandler::GetCount() {
+    uint64_t cnt = 0;
+    auto iter = GetWindowIterator();
+    iter->SeekToFirst();
+    while (iter->Valid()) {
+        cnt++;
+        iter->Next();
+    }
+    return cnt;
+}
+
+std::shared_ptr<SpillPartitionHandler> SpillPartitionHandler::OrderSegments(
+    const SegmentOrderFun& segment_order, OrderType order_type) {
+    auto output =
+        std::make_shared<SpillPartitionHandler>(schema_, runs_, order_type);
+    output->segment_order_ = segment_order;
+    return output;
+}
+
+// partition kept in memory under the budget, the reservation of its rows
+// is released with it
+class ReservedMemPartitionHandler : public MemPartitionHandler {
+ public:
+    ReservedMemPartitionHandler(const Schema* schema,
+                                std::shared_ptr<SpillContext> spill_ctx,
+                                uint64_t bytes)
+        : MemPartitionHandler(schema), spill_ctx_(spill_ctx), bytes_(bytes) {}
+    ~ReservedMemPartitionHandler() { spill_ctx_->Release(bytes_); }
+
+ private:
+    std::shared_ptr<SpillContext> spill_ctx_;
+    uint64_t bytes_;
+};
+
+SpillPartitionBuilder::SpillPartitionBuilder(
+    const Schema* schema, std::shared_ptr<SpillContext> spill_ctx)
+    : schema_(schema),
+      spill_ctx_(spill_ctx),
+      memory_run_(),
+      memory_bytes_(0),
+      runs_(),
+      output_() {
+    if (!spill_ctx_) {
+        output_ = std::make_shared<MemPartitionHandler>(schema_);
+    }
+}
+
+SpillPartitionBuilder::~SpillPartitionBuilder() {
+    if (spill_ctx_) {
+        spill_ctx_->Release(memory_bytes_);
+    }
+}
+
+bool SpillPartitionBuilder::AddRow(const std::string& key, uint64_t ts,
+                                   const Row& row) {
+    if (output_) {
+        // unlimited, buffer rows into the output directly
+        return output_->AddRow(key, ts, row);
+    }
+    uint64_t bytes = RowBytes(key, row);
+    if (!spill_ctx_->Reserve(bytes)) {
+        if (!Flush()) {
+            return false;
+        }
+        // a row is kept even if it alone exceeds the budget
+        if (!spill_ctx_->Reserve(bytes)) {
+            spill_ctx_->ForceReserve(bytes);
+        }
+    }
+    memory_bytes_ += bytes;
+    memory_run_[key].push_back(std::make_pair(ts, row));
+    return true;
+}
+
+bool SpillPartitionBuilder::Flush() {
+    if (memory_run_.empty()) {
+        return true;
+    }
+    uint64_t bytes = 0;
+    auto run = SpillRun::Write(spill_ctx_->spill_dir(), memory_run_, &bytes);
+    if (!run) {
+        return false;
+    }
+    DLOG(INFO) << "spill " << bytes << " bytes to " << run->path();
+    runs_.push_back(run);
+    spill_ctx_->AddSpilledBytes(bytes);
+    spill_ctx_->Release(memory_bytes_);
+    memory_bytes_ = 0;
+    memory_run_.clear();
+    return true;
+}
+
+std::shared_ptr<PartitionHandler> SpillPartitionBuilder::Finish(
+    OrderType order_type) {
+    if (output_) {
+        output_->SetOrderType(order_type);
+        return output_;
+    }
+    if (runs_.empty()) {
+        // rows stay in memory, so does their reservation
+        auto output = std::make_shared<ReservedMemPartitionHandler>(
+            schema_, spill_ctx_, memory_bytes_);
+        memory_bytes_ = 0;
+        for (auto& segment : memory_run_) {
+            for (auto& pair : segment.second) {
+                output->AddRow(segment.first, pair.first, pair.second);
+            }
+        }
+        memory_run_.clear();
+        output->SetOrderType(order_type);
+        return output;
+    }
+    if (!Flush()) {
+        return std::shared_ptr<PartitionHandler>();
+    }
+    return std::make_shared<SpillPartitionHandler>(schema_, runs_, order_type);
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_VM_SPILL_PARTITION_HANDLER_H_
+#define SRC_VM_SPILL_PARTITION_HANDLER_H_
+
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "vm/mem_catalog.h"
+
+namespace hybridse {
+namespace vm {
+
+/// Memory budget shared by all spillable buffers of one batch query.
+///
+/// A buffer reserves bytes before it keeps rows in memory, and writes its
+/// rows to a temporary sorted run once the reservation fails.
+class SpillContext {
+ public:
+    SpillContext(uint64_t max_memory_bytes, const std::string& spill_dir)
+        : max_memory_bytes_(max_memory_bytes),
+          spill_dir_(spill_dir),
+          used_bytes_(0),
+          spilled_bytes_(0) {}
+    ~SpillContext() {}
+
+    bool Reserve(uint64_t bytes);
+    void ForceReserve(uint64_t bytes) { used_bytes_.fetch_add(bytes); }
+    void Release(uint64_t bytes) { used_bytes_.fetch_sub(bytes); }
+    void AddSpilledBytes(uint64_t bytes) { spilled_bytes_.fetch_add(bytes); }
+
+    const uint64_t max_memory_bytes() const { return max_memory_bytes_; }
+    const std::string& spill_dir() const { return spill_dir_; }
+    const uint64_t used_bytes() const { return used_bytes_.load(); }
+    const uint64_t spilled_bytes() const { return spilled_bytes_.load(); }
+
+ private:
+    const uint64_t max_memory_bytes_;
+    const std::string spill_dir_;
+    std::atomic<uint64_t> used_bytes_;
+    std::atomic<uint64_t> spilled_bytes_;
+};
+
+/// A sorted run of partitioned rows written to a local temporary file.
+///
+/// Records are ordered by partition key (the same order as MemSegmentMap)
+/// and keep insertion order inside a key. Each record is stored as
+/// [key size][key][ts][slice count]([slice size][encoded row slice])*
+/// The file is removed once the last reader releases the run.
+class SpillRun {
+ public:
+    explicit SpillRun(const std::string& path) : path_(path) {}
+    ~SpillRun();
+    const std::string& path() const { return path_; }
+
+    static std::shared_ptr<SpillRun> Write(const std::string& spill_dir,
+                                           const MemSegmentMap& partitions,
+                                           uint64_t* bytes);
+
+ private:
+    const std::string path_;
+};
+
+/// Stream of (key, ts, row) records in MemSegmentMap order
+class SpillRowSource {
+ public:
+    SpillRowSource() {}
+    virtual ~SpillRowSource() {}
+    virtual bool Valid() const = 0;
+    virtual void Next() = 0;
+    virtual const std::string& GetKey() const = 0;
+    virtual const uint64_t GetTs() const = 0;
+    virtual const Row& GetValue() const = 0;
+};
+
+typedef std::function<void(MemTimeTable*)> SegmentOrderFun;
+
+class SpillWindowIterator : public WindowIterator {
+ public:
+    SpillWindowIterator(const std::vector<std::shared_ptr<SpillRun>>* runs,
+                        const SegmentOrderFun* segment_order,
+                        const Schema* schema);
+    ~SpillWindowIterator() {}
+
+    void Seek(const std::string& key) override;
+    void SeekToFirst() override;
+    void Next() override;
+    bool Valid() override { return valid_; }
+    std::unique_ptr<RowIterator> GetValue() override;
+    RowIterator* GetRawValue() override;
+    const Row GetKey() override { return Row(key_); }
+
+    const std::string& key() const { return key_; }
+    /// Move forward to the first key not before `key` and return `true`
+    /// if it equals to `key`. Unlike Seek, the position is kept on a miss.
+    bool SeekSegment(const std::string& key);
+    std::shared_ptr<MemTimeTableHandler> GetSegment() { return segment_; }
+
+ private:
+    // merge rows of the next key from every source into segment_
+    void MergeNextKey();
+
+    const std::vector<std::shared_ptr<SpillRun>>* runs_;
+    const SegmentOrderFun* segment_order_;
+    const Schema* schema_;
+    std::vector<std::unique_ptr<SpillRowSource>> sources_;
+    bool valid_;
+    std::string key_;
+    std::shared_ptr<MemTimeTableHandler> segment_;
+};
+
+/// Partition dataset whose rows were spilled to sorted runs on disk.
+///
+/// Segments are merged from every run on demand, so only the current
+/// segment has to fit in memory. GetSegment is cheap when keys are visited
+/// in partition order, which is how batch runners consume partitions. It
+/// may be called from several threads, which share one cursor under a lock.
+class SpillPartitionHandler : public PartitionHandler {
+ public:
+    SpillPartitionHandler(const Schema* schema,
+                          std::vector<std::shared_ptr<SpillRun>> runs,
+                          OrderType order_type);
+    ~SpillPartitionHandler() {}
+
+    const Types& GetTypes() override { return types_; }
+    const IndexHint& GetIndex() override { return index_hint_; }
+    const Schema* GetSchema() override { return schema_; }
+    const std::string& GetName() override { return table_name_; }
+    const std::string& GetDatabase() override { return db_; }
+    std::unique_ptr<WindowIterator> GetWindowIterator() override;
+    std::shared_ptr<TableHandler> GetSegment(const std::string& key) override;
+    const uint64_t GetCount() override;
+    const OrderType GetOrderType() const { return order_type_; }
+    const std::string GetHandlerTypeName() override {
+        return "SpillPartitionHandler";
+    }
+
+    /// Return a handler sharing the same runs whose segments are ordered
+    /// by `segment_order` when they are merged.
+    std::shared_ptr<SpillPartitionHandler> OrderSegments(
+        const SegmentOrderFun& segment_order, OrderType order_type);
+
+ private:
+    std::string table_name_;
+    std::string db_;
+    const Schema* schema_;
+    Types types_;
+    IndexHint index_hint_;
+    std::vector<std::shared_ptr<SpillRun>> runs_;
+    OrderType order_type_;
+    SegmentOrderFun segment_order_;
+    // guards cursor_ shared by GetSegment callers
+    std::mutex cursor_mu_;
+    std::unique_ptr<SpillWindowIterator> cursor_;
+};
+
+/// Build a partition dataset under the memory budget of SpillContext.
+///
+/// Without a budget, or when rows fit in the budget, the output is a plain
+/// MemPartitionHandler. Otherwise every buffered row ends up in a sorted run
+/// and the output is a SpillPartitionHandler merging those runs.
+class SpillPartitionBuilder {
+ public:
+    SpillPartitionBuilder(const Schema* schema,
+                          std::shared_ptr<SpillContext> spill_ctx);
+    ~SpillPartitionBuilder();
+    bool AddRow(const std::string& key, uint64_t ts, const Row& row);
+    std::shared_ptr<PartitionHandler> Finish(OrderType order_type);
+
+ private:
+    bool Flush();
+
+    const Schema* schema_;
+    std::shared_ptr<SpillContext> spill_ctx_;
+    MemSegmentMap memory_run_;
+    uint64_t memory_bytes_;
+    std::vector<std::shared_ptr<SpillRun>> runs_;
+    // output of the unlimited builder
+    std::shared_ptr<MemPartitionHandler> output_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // SRC_VM_SPILL_PARTITION_HANDLER_H_
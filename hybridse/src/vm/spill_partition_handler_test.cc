@@ -0,0 +1,235 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/spill_partition_handler.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "testing/test_base.h"
+
+namespace hybridse {
+namespace vm {
+using hybridse::codec::Row;
+class SpillPartitionHandlerTest : public ::testing::Test {
+ public:
+    SpillPartitionHandlerTest() {}
+    ~SpillPartitionHandlerTest() {}
+};
+
+static std::shared_ptr<PartitionHandler> BuildPartition(
+    const Schema* schema, const std::vector<Row>& rows,
+    std::shared_ptr<SpillContext> spill_ctx) {
+    SpillPartitionBuilder builder(schema, spill_ctx);
+    for (size_t i = 0; i < rows.size(); i++) {
+        EXPECT_TRUE(builder.AddRow(std::to_string(i % 3), i, rows[i]));
+    }
+    return builder.Finish(kNoneOrder);
+}
+
+static void AssertPartitionEq(std::shared_ptr<PartitionHandler> expect,
+                              std::shared_ptr<PartitionHandler> actual) {
+    ASSERT_EQ(expect->GetCount(), actual->GetCount());
+    auto expect_iter = expect->GetWindowIterator();
+    auto actual_iter = actual->GetWindowIterator();
+    expect_iter->SeekToFirst();
+    actual_iter->SeekToFirst();
+    while (expect_iter->Valid()) {
+        ASSERT_TRUE(actual_iter->Valid());
+        ASSERT_EQ(expect_iter->GetKey().ToString(),
+                  actual_iter->GetKey().ToString());
+        auto expect_segment = expect_iter->GetValue();
+        auto actual_segment = actual_iter->GetValue();
+        expect_segment->SeekToFirst();
+        actual_segment->SeekToFirst();
+        while (expect_segment->Valid()) {
+            ASSERT_TRUE(actual_segment->Valid());
+            ASSERT_EQ(expect_segment->GetKey(), actual_segment->GetKey());
+            ASSERT_EQ(0, expect_segment->GetValue().compare(
+                             actual_segment->GetValue()));
+            expect_segment->Next();
+            actual_segment->Next();
+        }
+        ASSERT_FALSE(actual_segment->Valid());
+        expect_iter->Next();
+        actual_iter->Next();
+    }
+    ASSERT_FALSE(actual_iter->Valid());
+}
+
+TEST_F(SpillPartitionHandlerTest, no_spill_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    auto spill_ctx = std::make_shared<SpillContext>(1 << 20, "/tmp");
+    auto partition = BuildPartition(&table.columns(), rows, spill_ctx);
+    ASSERT_EQ("MemPartitionHandler", partition->GetHandlerTypeName());
+    ASSERT_EQ(0u, spill_ctx->spilled_bytes());
+    AssertPartitionEq(BuildPartition(&table.columns(), rows, nullptr),
+                      partition);
+    // rows in memory are counted against the budget until released
+    ASSERT_LT(0u, spill_ctx->used_bytes());
+    partition.reset();
+    ASSERT_EQ(0u, spill_ctx->used_bytes());
+}
+
+TEST_F(SpillPartitionHandlerTest, spill_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    // a tiny budget spills every row into its own run
+    auto spill_ctx = std::make_shared<SpillContext>(1, "/tmp");
+    auto partition = BuildPartition(&table.columns(), rows, spill_ctx);
+    ASSERT_EQ("SpillPartitionHandler", partition->GetHandlerTypeName());
+    ASSERT_LT(0u, spill_ctx->spilled_bytes());
+    ASSERT_EQ(0u, spill_ctx->used_bytes());
+    AssertPartitionEq(BuildPartition(&table.columns(), rows, nullptr),
+                      partition);
+}
+
+TEST_F(SpillPartitionHandlerTest, spill_segment_iterator_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    auto spill_ctx = std::make_shared<SpillContext>(1, "/tmp");
+    auto partition = BuildPartition(&table.columns(), rows, spill_ctx);
+    auto expect = BuildPartition(&table.columns(), rows, nullptr);
+
+    // iterators of segments stay valid after the window iterator moves on
+    auto window_iter = partition->GetWindowIterator();
+    window_iter->SeekToFirst();
+    std::vector<std::string> keys;
+    std::vector<std::unique_ptr<RowIterator>> segment_iters;
+    while (window_iter->Valid()) {
+        keys.push_back(window_iter->GetKey().ToString());
+        segment_iters.push_back(window_iter->GetValue());
+        window_iter->Next();
+    }
+    ASSERT_EQ(3u, keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        auto expect_iter = expect->GetSegment(keys[i])->GetIterator();
+        auto& actual_iter = segment_iters[i];
+        expect_iter->SeekToFirst();
+        actual_iter->SeekToFirst();
+        while (expect_iter->Valid()) {
+            ASSERT_TRUE(actual_iter->Valid());
+            ASSERT_EQ(expect_iter->GetKey(), actual_iter->GetKey());
+            ASSERT_EQ(0,
+                      expect_iter->GetValue().compare(actual_iter->GetValue()));
+            expect_iter->Next();
+            actual_iter->Next();
+        }
+        ASSERT_FALSE(actual_iter->Valid());
+    }
+}
+
+TEST_F(SpillPartitionHandlerTest, spill_get_segment_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    auto spill_ctx = std::make_shared<SpillContext>(1, "/tmp");
+    auto partition = BuildPartition(&table.columns(), rows, spill_ctx);
+    auto expect = BuildPartition(&table.columns(), rows, nullptr);
+
+    // keys visited in partition order, then an earlier key and a missing key
+    for (auto key : {"2", "1", "0", "1", "x", "2", "0"}) {
+        auto expect_segment = expect->GetSegment(key);
+        auto actual_segment = partition->GetSegment(key);
+        ASSERT_TRUE(actual_segment != nullptr);
+        ASSERT_EQ(expect_segment->GetCount(), actual_segment->GetCount())
+            << key;
+        auto expect_iter = expect_segment->GetIterator();
+        auto actual_iter = actual_segment->GetIterator();
+        expect_iter->SeekToFirst();
+        actual_iter->SeekToFirst();
+        while (expect_iter->Valid()) {
+            ASSERT_TRUE(actual_iter->Valid());
+            ASSERT_EQ(0,
+                      expect_iter->GetValue().compare(actual_iter->GetValue()));
+            expect_iter->Next();
+            actual_iter->Next();
+        }
+    }
+}
+
+TEST_F(SpillPartitionHandlerTest, spill_concurrent_get_segment_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    auto spill_ctx = std::make_shared<SpillContext>(1, "/tmp");
+    auto partition = BuildPartition(&table.columns(), rows, spill_ctx);
+    auto expect = BuildPartition(&table.columns(), rows, nullptr);
+
+    // threads moving the shared cursor back and forth
+    std::vector<std::thread> threads;
+    std::vector<int> errors(4, 0);
+    for (size_t t = 0; t < errors.size(); t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 100; i++) {
+                std::string key = std::to_string((i + t) % 3);
+                if (expect->GetSegment(key)->GetCount() !=
+                    partition->GetSegment(key)->GetCount()) {
+                    errors[t]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto error : errors) {
+        ASSERT_EQ(0, error);
+    }
+}
+
+TEST_F(SpillPartitionHandlerTest, spill_order_segments_test) {
+    std::vector<Row> rows;
+    ::hybridse::type::TableDef table;
+    BuildRows(table, rows);
+    auto spill_ctx = std::make_shared<SpillContext>(1, "/tmp");
+    auto partition = std::dynamic_pointer_cast<SpillPartitionHandler>(
+        BuildPartition(&table.columns(), rows, spill_ctx));
+    ASSERT_TRUE(partition != nullptr);
+    auto ordered = partition->OrderSegments(
+        [](MemTimeTable* segment) {
+            std::sort(segment->begin(), segment->end(), DescComparor());
+        },
+        kDescOrder);
+    ASSERT_EQ(kDescOrder, ordered->GetOrderType());
+    auto iter = ordered->GetWindowIterator();
+    iter->SeekToFirst();
+    while (iter->Valid()) {
+        auto segment_iter = iter->GetValue();
+        segment_iter->SeekToFirst();
+        uint64_t last = UINT64_MAX;
+        while (segment_iter->Valid()) {
+            ASSERT_GE(last, segment_iter->GetKey());
+            last = segment_iter->GetKey();
+            segment_iter->Next();
+        }
+        iter->Next();
+    }
+}
+
+}  // namespace vm
+}  // namespace hybridse
+int main(int argc, char** argv) {
+    ::testing::GTEST_FLAG(color) = "yes";
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
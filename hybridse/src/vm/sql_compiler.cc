@@ -30,6 +30,8 @@
 #include "llvm/Support/raw_ostream.h"
 #include "plan/plan_api.h"
 #include "udf/default_udf_library.h"
+#include "vm/expr_interpreter.h"
+#include "vm/jit_object_cache.h"
 #include "vm/runner.h"
 #include "vm/transform.h"
 
@@ -106,6 +108,11 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
     if (plan_only_) {
         return true;
     }
+    if (ctx.interpret_max_rows > 0 && !keep_ir_ &&
+        kBatchMode == ctx.engine_mode && BuildInterpreters(&ctx)) {
+        DLOG(INFO) << "interpret sql " << ctx.sql;
+        return true;
+    }
     if (llvm::verifyModule(*(m.get()), &llvm::errs(), nullptr)) {
         LOG(WARNING) << "fail to verify codegen module";
         status.msg = "fail to verify codegen module";
@@ -114,26 +121,64 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
         return false;
     }
     // ::llvm::errs() << *(m.get());
-    auto jit = std::shared_ptr<HybridSeJitWrapper>(
-        HybridSeJitWrapper::Create(ctx.jit_options));
-    if (jit == nullptr || !jit->Init()) {
-        status.msg = "fail to init jit let";
-        status.code = common::kJitError;
-        LOG(WARNING) << status;
-        return false;
-    }
-    InitBuiltinJitSymbols(jit.get());
-    ctx.udf_library->InitJITSymbols(jit.get());
-    if (!jit->OptModule(m.get())) {
-        LOG(WARNING) << "fail to opt ir module for sql " << ctx.sql;
+    auto jit = CreateJit(ctx, status);
+    if (jit == nullptr) {
         return false;
     }
-    if (keep_ir_) {
-        KeepIR(ctx, m.get());
+    std::unique_ptr<JitObjectCache> object_cache;
+    JitObjectCache::Key object_key;
+    if (!keep_ir_ && !ctx.jit_options.object_cache_dir().empty()) {
+        object_cache.reset(
+            new JitObjectCache(ctx.jit_options.object_cache_dir()));
+        std::string ir;
+        llvm::raw_string_ostream ss(ir);
+        ss << *m;
+        ss.flush();
+        object_key = JitObjectCache::MakeKey(ir);
+        std::string object;
+        if (object_cache->Get(object_key, &object)) {
+            if (jit->AddObject(object)) {
+                DLOG(INFO) << "load jit object " << object_key.name
+                           << " for sql " << ctx.sql;
+                m = nullptr;
+                llvm_ctx = nullptr;
+                // cached objects are always fully optimized
+                ctx.jit_options.set_enable_fast_compile(false);
+            } else {
+                LOG(WARNING) << "fail to add jit object " << object_key.name
+                             << ", recompile sql " << ctx.sql;
+                object_cache->Remove(object_key);
+                jit = CreateJit(ctx, status);
+                if (jit == nullptr) {
+                    return false;
+                }
+            }
+        }
     }
-    if (!jit->AddModule(std::move(m), std::move(llvm_ctx))) {
-        LOG(WARNING) << "fail to add ir module  for sql " << ctx.sql;
-        return false;
+    if (m != nullptr) {
+        if (!jit->OptModule(m.get())) {
+            LOG(WARNING) << "fail to opt ir module for sql " << ctx.sql;
+            return false;
+        }
+        if (keep_ir_) {
+            KeepIR(ctx, m.get());
+        }
+        if (object_cache && !ctx.jit_options.is_enable_fast_compile()) {
+            std::string object;
+            if (!jit->CompileModule(std::move(m), std::move(llvm_ctx),
+                                    &object)) {
+                LOG(WARNING) << "fail to compile ir module for sql "
+                             << ctx.sql;
+                return false;
+            }
+            if (!object.empty() && !object_cache->Put(object_key, object)) {
+                LOG(WARNING) << "fail to cache jit object for sql "
+                             << ctx.sql;
+            }
+        } else if (!jit->AddModule(std::move(m), std::move(llvm_ctx))) {
+            LOG(WARNING) << "fail to add ir module  for sql " << ctx.sql;
+            return false;
+        }
     }
     if (!ResolvePlanFnAddress(ctx.physical_plan, jit, status)) {
         return false;
@@ -143,6 +188,112 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
     return true;
 }
 
+// sum of the row estimates of the tables scanned by the plan, tables of
+// unknown size are not counted
+static uint64_t EstimateScanRows(PhysicalOpNode* node) {
+    if (kPhysicalOpDataProvider == node->GetOpType()) {
+        auto& table = dynamic_cast<PhysicalDataProviderNode*>(node)->table_handler_;
+        int64_t cnt = table ? table->GetCountEstimate() : -1;
+        return cnt > 0 ? static_cast<uint64_t>(cnt) : 0;
+    }
+    uint64_t rows = 0;
+    for (auto producer : node->producers()) {
+        rows += EstimateScanRows(producer);
+    }
+    return rows;
+}
+
+bool SqlCompiler::BuildInterpreters(SqlContext* ctx) {
+    std::vector<const FnInfo*> fn_infos;
+    if (!CollectInterpretFnInfos(ctx->physical_plan, &fn_infos)) {
+        return false;
+    }
+    // tables known to be large from their metadata are jit compiled at
+    // once, other plans are jit compiled by the engine once their runs have
+    // projected enough rows
+    uint64_t estimated_rows = EstimateScanRows(ctx->physical_plan);
+    if (estimated_rows > ctx->interpret_max_rows) {
+        DLOG(INFO) << "skip interpreting sql scanning about " << estimated_rows
+                   << " rows";
+        return false;
+    }
+    auto rows = std::make_shared<std::atomic<uint64_t>>(0);
+    std::vector<std::shared_ptr<ExprInterpreter>> interpreters;
+    for (auto fn_info : fn_infos) {
+        auto interpreter =
+            ExprInterpreter::Create(*fn_info, ctx->parameter_types, rows);
+        if (!interpreter) {
+            DLOG(INFO) << "fail to interpret " << fn_info->fn_name();
+            return false;
+        }
+        interpreters.push_back(interpreter);
+    }
+    for (size_t i = 0; i < fn_infos.size(); ++i) {
+        const_cast<FnInfo*>(fn_infos[i])->SetInterpreter(interpreters[i]);
+    }
+    ctx->interpreted_rows = rows;
+    ctx->is_interpreted = true;
+    return true;
+}
+
+bool SqlCompiler::CollectInterpretFnInfos(
+    PhysicalOpNode* node, std::vector<const FnInfo*>* fn_infos) {
+    if (nullptr == node) {
+        return false;
+    }
+    switch (node->GetOpType()) {
+        case kPhysicalOpDataProvider: {
+            if (kProviderTypeRequest ==
+                dynamic_cast<PhysicalDataProviderNode*>(node)->provider_type_) {
+                return false;
+            }
+            break;
+        }
+        case kPhysicalOpProject: {
+            auto project_type =
+                dynamic_cast<PhysicalProjectNode*>(node)->project_type_;
+            if (kTableProject != project_type && kRowProject != project_type) {
+                return false;
+            }
+            break;
+        }
+        case kPhysicalOpFilter:
+        case kPhysicalOpSimpleProject:
+        case kPhysicalOpConstProject:
+        case kPhysicalOpLimit:
+        case kPhysicalOpRename:
+            break;
+        default:
+            return false;
+    }
+    for (auto fn_info : node->GetFnInfos()) {
+        if (!fn_info->fn_name().empty()) {
+            fn_infos->push_back(fn_info);
+        }
+    }
+    for (auto producer : node->producers()) {
+        if (!CollectInterpretFnInfos(producer, fn_infos)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<HybridSeJitWrapper> SqlCompiler::CreateJit(
+    SqlContext& ctx, Status& status) {  // NOLINT
+    auto jit = std::shared_ptr<HybridSeJitWrapper>(
+        HybridSeJitWrapper::Create(ctx.jit_options));
+    if (jit == nullptr || !jit->Init()) {
+        status.msg = "fail to init jit let";
+        status.code = common::kJitError;
+        LOG(WARNING) << status;
+        return nullptr;
+    }
+    InitBuiltinJitSymbols(jit.get());
+    ctx.udf_library->InitJITSymbols(jit.get());
+    return jit;
+}
+
 std::string EngineModeName(EngineMode mode) {
     switch (mode) {
         case kBatchMode:
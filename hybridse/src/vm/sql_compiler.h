@@ -17,6 +17,8 @@
 #ifndef SRC_VM_SQL_COMPILER_H_
 #define SRC_VM_SQL_COMPILER_H_
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -44,6 +46,16 @@ struct SqlContext {
     bool is_batch_request_optimized = false;
     bool enable_expr_optimize = false;
     bool enable_batch_window_parallelization = false;
+    // memory budget of batch partition buffers, 0 means unlimited
+    uint64_t max_batch_memory_bytes = 0;
+    std::string spill_dir;
+    // interpret simple batch queries scanning at most this many rows
+    // instead of jit compiling them, 0 means never interpret
+    uint64_t interpret_max_rows = 0;
+    // whether row functions of the plan are interpreted
+    bool is_interpreted = false;
+    // rows projected by the interpreters of the plan in all runs
+    std::shared_ptr<std::atomic<uint64_t>> interpreted_rows;
 
     // the sql content
     std::string sql;
@@ -130,12 +142,96 @@ class SqlCompileInfo : public CompileInfo {
     virtual void DumpClusterJob(std::ostream& output, const std::string& tab) {
         sql_ctx.cluster_job.Print(output, tab);
     }
+    bool HasSubQuery() const override {
+        return sql_ctx.cluster_job.GetTaskSize() > 1;
+    }
+    JitMemoryStats GetJitMemoryStats() const override {
+        auto jit = GetJit();
+        return jit ? jit->GetMemoryStats() : JitMemoryStats();
+    }
+    /// Return the jit, `nullptr` once released.
+    std::shared_ptr<HybridSeJitWrapper> GetJit() const {
+        return std::atomic_load_explicit(&sql_ctx.jit,
+                                         std::memory_order_acquire);
+    }
+    /// Pin the jit for a session running the compile result, return false
+    /// if the jit is released already.
+    bool PinJit() {
+        int32_t pins = jit_pins_.load(std::memory_order_relaxed);
+        while (pins >= 0) {
+            if (jit_pins_.compare_exchange_weak(pins, pins + 1,
+                                                std::memory_order_acquire)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    void UnpinJit() { jit_pins_.fetch_sub(1, std::memory_order_release); }
+    /// Free code and data of the jit if no session pins it, the compile
+    /// result can neither be pinned nor run anymore once released.
+    bool TryReleaseJit() {
+        int32_t pins = 0;
+        if (!jit_pins_.compare_exchange_strong(pins, -1,
+                                               std::memory_order_acq_rel)) {
+            return false;
+        }
+        std::atomic_store_explicit(&sql_ctx.jit,
+                                   std::shared_ptr<HybridSeJitWrapper>(),
+                                   std::memory_order_release);
+        return true;
+    }
     static SqlCompileInfo* CastFrom(CompileInfo* node) {
         return dynamic_cast<SqlCompileInfo*>(node);
     }
 
+    /// Return the fully optimized compile result of the same sql once this
+    /// one is compiled in fast mode and re-optimized in background.
+    std::shared_ptr<CompileInfo> GetOptimized() const {
+        return std::atomic_load_explicit(&optimized_,
+                                         std::memory_order_acquire);
+    }
+    void SetOptimized(std::shared_ptr<CompileInfo> info) {
+        std::atomic_store_explicit(&optimized_, info,
+                                   std::memory_order_release);
+    }
+
+    /// Count one more run of the compile result, return the total count.
+    uint64_t AddExecution() {
+        return executions_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    /// Return true if the caller should re-optimize the compile result in
+    /// background, only one caller gets true until `EndTierUp()`.
+    bool BeginTierUp() {
+        if (executions_.load(std::memory_order_relaxed) <
+            tier_up_retry_at_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        return !tier_up_running_.exchange(true, std::memory_order_acq_rel);
+    }
+    /// Finish re-optimizing. After a failed compile, the next try waits for
+    /// exponentially more executions.
+    void EndTierUp(bool compile_failed) {
+        if (compile_failed) {
+            uint32_t failures = std::min<uint32_t>(++tier_up_failures_, 20);
+            tier_up_retry_at_.store(
+                executions_.load(std::memory_order_relaxed) +
+                    (uint64_t(1) << failures),
+                std::memory_order_relaxed);
+        }
+        tier_up_running_.store(false, std::memory_order_release);
+    }
+
  private:
     hybridse::vm::SqlContext sql_ctx;
+    std::shared_ptr<CompileInfo> optimized_;
+    std::atomic<uint64_t> executions_{0};
+    // re-optimizing in background, and backoff of failed compiles
+    std::atomic<bool> tier_up_running_{false};
+    uint32_t tier_up_failures_ = 0;
+    std::atomic<uint64_t> tier_up_retry_at_{0};
+    // sessions running the jit code, -1 once the jit is released
+    std::atomic<int32_t> jit_pins_{0};
 };
 
 class SqlCompiler {
@@ -154,6 +250,16 @@ class SqlCompiler {
  private:
     void KeepIR(SqlContext& ctx, llvm::Module* m);  // NOLINT
 
+    // bind interpreters to row functions of the plan, return false and
+    // bind nothing if any part of the plan needs the jit
+    bool BuildInterpreters(SqlContext* ctx);
+    bool CollectInterpretFnInfos(PhysicalOpNode* node,
+                                 std::vector<const FnInfo*>* fn_infos);
+
+    // create a jit with builtin and udf symbols
+    std::shared_ptr<HybridSeJitWrapper> CreateJit(SqlContext& ctx,  // NOLINT
+                                                  Status& status);  // NOLINT
+
     bool ResolvePlanFnAddress(
         PhysicalOpNode* node,
         std::shared_ptr<HybridSeJitWrapper>& jit,  // NOLINT
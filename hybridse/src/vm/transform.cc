@@ -30,8 +30,10 @@
 #include "passes/lambdafy_projects.h"
 #include "passes/physical/batch_request_optimize.h"
 #include "passes/physical/cluster_optimized.h"
+#include "passes/physical/common_window_sharing.h"
 #include "passes/physical/condition_optimized.h"
 #include "passes/physical/group_and_sort_optimized.h"
+#include "passes/physical/hash_join_optimized.h"
 #include "passes/physical/left_join_optimized.h"
 #include "passes/physical/limit_optimized.h"
 #include "passes/physical/simple_project_optimized.h"
@@ -48,8 +50,10 @@ namespace vm {
 using hybridse::passes::CheckExprDependOnChildOnly;
 using hybridse::passes::ClusterOptimized;
 using hybridse::passes::CommonColumnOptimize;
+using hybridse::passes::CommonWindowSharing;
 using hybridse::passes::ConditionOptimized;
 using hybridse::passes::GroupAndSortOptimized;
+using hybridse::passes::HashJoinOptimized;
 using hybridse::passes::LeftJoinOptimized;
 using hybridse::passes::LimitOptimized;
 using hybridse::passes::PhysicalPlanPassType;
@@ -955,6 +959,7 @@ bool BatchModeTransformer::AddDefaultPasses() {
     AddPass(PhysicalPlanPassType::kPassFilterOptimized);
     AddPass(PhysicalPlanPassType::kPassLeftJoinOptimized);
     AddPass(PhysicalPlanPassType::kPassGroupAndSortOptimized);
+    AddPass(PhysicalPlanPassType::kPassHashJoinOptimized);
     AddPass(PhysicalPlanPassType::kPassLimitOptimized);
     AddPass(PhysicalPlanPassType::kPassClusterOptimized);
     return false;
@@ -1186,6 +1191,14 @@ void BatchModeTransformer::ApplyPasses(PhysicalOpNode* node,
                 }
                 break;
             }
+            case PhysicalPlanPassType::kPassHashJoinOptimized: {
+                // cluster mode runs last join as request join per left row
+                if (!cluster_optimized_mode_) {
+                    HashJoinOptimized pass(&plan_ctx_);
+                    transformed = pass.Apply(cur_op, &new_op);
+                }
+                break;
+            }
             case PhysicalPlanPassType::kPassLimitOptimized: {
                 LimitOptimized pass(&plan_ctx_);
                 transformed = pass.Apply(cur_op, &new_op);
@@ -1977,29 +1990,41 @@ void RequestModeTransformer::ApplyPasses(PhysicalOpNode* node,
         DLOG(WARNING) << "Final optimized result is null";
         return;
     }
-    if (!enable_batch_request_opt_ ||
-        batch_request_info_.common_column_indices.empty()) {
-        *output = optimized;
-        return;
-    }
-    LOG(INFO) << "Before batch request optimization:\n" << *optimized;
-    PhysicalOpNode* batch_request_plan = nullptr;
-    CommonColumnOptimize batch_request_optimizer(
-        batch_request_info_.common_column_indices);
-    Status status = batch_request_optimizer.Apply(
-        this->GetPlanContext(), optimized, &batch_request_plan);
+    if (enable_batch_request_opt_ &&
+        !batch_request_info_.common_column_indices.empty()) {
+        LOG(INFO) << "Before batch request optimization:\n" << *optimized;
+        PhysicalOpNode* batch_request_plan = nullptr;
+        CommonColumnOptimize batch_request_optimizer(
+            batch_request_info_.common_column_indices);
+        Status status = batch_request_optimizer.Apply(
+            this->GetPlanContext(), optimized, &batch_request_plan);
+        if (!status.isOK()) {
+            LOG(WARNING) << "Fail to perform batch request optimization: "
+                         << status;
+            *output = optimized;
+            return;
+        }
+        LOG(INFO) << "After batch request optimization:\n"
+                  << *batch_request_plan;
+        batch_request_optimizer.ExtractCommonNodeSet(
+            &batch_request_info_.common_node_set);
+        batch_request_info_.output_common_column_indices =
+            batch_request_optimizer.GetOutputCommonColumnIndices();
+        optimized = batch_request_plan;
+    }
+    *output = optimized;
+
+    // share windows on the final plan, the marks are lost if nodes are
+    // recreated by passes above
+    CommonWindowSharing window_sharing;
+    PhysicalOpNode* shared_plan = nullptr;
+    Status status =
+        window_sharing.Apply(this->GetPlanContext(), optimized, &shared_plan);
     if (!status.isOK()) {
-        LOG(WARNING) << "Fail to perform batch request optimization: "
-                     << status;
-        *output = optimized;
+        LOG(WARNING) << "Fail to share common windows: " << status;
         return;
     }
-    LOG(INFO) << "After batch request optimization:\n" << *batch_request_plan;
-    batch_request_optimizer.ExtractCommonNodeSet(
-        &batch_request_info_.common_node_set);
-    batch_request_info_.output_common_column_indices =
-        batch_request_optimizer.GetOutputCommonColumnIndices();
-    *output = batch_request_plan;
+    *output = shared_plan;
     return;
 }
 
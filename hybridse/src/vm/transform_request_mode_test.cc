@@ -37,6 +37,7 @@
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
 #include "node/node_manager.h"
+#include "passes/physical/common_window_sharing.h"
 #include "plan/plan_api.h"
 #include "testing/test_base.h"
 #include "udf/default_udf_library.h"
@@ -448,6 +449,70 @@ TEST_P(TransformRequestModePassOptimizedTest, pass_pass_optimized_test) {
     PhysicalPlanCheck(catalog, in_out.first, in_out.second);
 }
 
+static void CollectRequestUnions(PhysicalOpNode* node, std::vector<PhysicalRequestUnionNode*>* output) {
+    if (nullptr == node) {
+        return;
+    }
+    if (kPhysicalOpRequestUnion == node->GetOpType()) {
+        auto union_op = dynamic_cast<PhysicalRequestUnionNode*>(node);
+        if (std::find(output->begin(), output->end(), union_op) == output->end()) {
+            output->push_back(union_op);
+        }
+    }
+    for (auto producer : node->GetProducers()) {
+        CollectRequestUnions(producer, output);
+    }
+}
+
+TEST_F(TransformRequestModeTest, common_window_sharing_test) {
+    hybridse::type::TableDef table_def;
+    BuildTableDef(table_def);
+    table_def.set_name("t1");
+    {
+        ::hybridse::type::IndexDef* index = table_def.add_indexes();
+        index->set_name("index1");
+        index->add_first_keys("col1");
+        index->set_second_key("col5");
+    }
+    hybridse::type::Database db;
+    db.set_name("db");
+    AddTable(db, table_def);
+    auto catalog = BuildSimpleCatalog(db);
+
+    // windows with different EXCLUDE CURRENT_TIME aren't merged by planner
+    std::string sql =
+        "SELECT col1, sum(col3) OVER w1 as w1_col3_sum, sum(col3) OVER w2 as w2_col3_sum FROM t1 "
+        "WINDOW w1 AS (PARTITION BY col1 ORDER BY col5 ROWS_RANGE BETWEEN 3 PRECEDING AND CURRENT ROW "
+        "EXCLUDE CURRENT_TIME), "
+        "w2 AS (PARTITION BY col1 ORDER BY col5 ROWS_RANGE BETWEEN 30 PRECEDING AND CURRENT ROW);";
+    boost::to_lower(sql);
+    ::hybridse::node::PlanNodeList plan_trees;
+    ::hybridse::base::Status base_status;
+    ASSERT_TRUE(plan::PlanAPI::CreatePlanTreeFromScript(sql, plan_trees, &manager, base_status, false))
+        << base_status;
+    auto ctx = llvm::make_unique<LLVMContext>();
+    auto m = make_unique<Module>("test_op_generator", *ctx);
+    auto lib = ::hybridse::udf::DefaultUdfLibrary::get();
+    RequestModeTransformer transform(&manager, "db", catalog, nullptr, m.get(), lib, {}, false, false, false, false);
+    transform.AddDefaultPasses();
+    PhysicalOpNode* physical_plan = nullptr;
+    ASSERT_TRUE(transform.TransformPhysicalPlan(plan_trees, &physical_plan).isOK());
+
+    std::vector<PhysicalRequestUnionNode*> unions;
+    CollectRequestUnions(physical_plan, &unions);
+    ASSERT_EQ(2u, unions.size());
+    PhysicalRequestUnionNode* w1 = unions[0];
+    PhysicalRequestUnionNode* w2 = unions[1];
+    if (!w1->exclude_current_time()) {
+        std::swap(w1, w2);
+    }
+    // w1 is evaluated over rows of w2
+    ASSERT_EQ(w2, w1->shared_window());
+    ASSERT_EQ(nullptr, w2->shared_window());
+    ASSERT_TRUE(passes::CommonWindowSharing::CoverWindow(w2, w1));
+    ASSERT_FALSE(passes::CommonWindowSharing::CoverWindow(w1, w2));
+}
+
 }  // namespace vm
 }  // namespace hybridse
 int main(int argc, char** argv) {
@@ -446,6 +446,45 @@ TEST_F(TransformTest, TransformEqualExprPairTest) {
     }
 }
 
+TEST_F(TransformTest, ExtractColumnRangeTest) {
+    vm::SchemasContext schemas_ctx;
+    type::TableDef t1;
+    BuildTableDef(t1);
+    schemas_ctx.BuildTrivial({&t1});
+    // col5 is the 6th column of t1
+    const size_t col_idx = 5;
+
+    struct RangeCase {
+        std::string sql;
+        bool ok;
+        int64_t start;
+        int64_t end;
+    };
+    std::vector<RangeCase> cases = {
+        {"select col5 >= 100 and 200 > col5 from t1;", true, 100, 199},
+        {"select col5 > 100 from t1;", true, 101, INT64_MAX},
+        {"select 50 >= col5 and col1 > 3 from t1;", true, 0, 50},
+        {"select col5 = 7 from t1;", true, 7, 7},
+        {"select col5 < 0 from t1;", true, 0, -1},
+        {"select col1 > 100 from t1;", false, 0, INT64_MAX},
+        {"select col5 > 1 or col5 < 0 from t1;", false, 0, INT64_MAX},
+    };
+    for (auto& range_case : cases) {
+        std::string sql = range_case.sql;
+        node::ExprNode* condition;
+        boost::to_lower(sql);
+        ExtractExprFromSimpleSql(&manager, sql, &condition);
+        int64_t start = 0;
+        int64_t end = INT64_MAX;
+        ASSERT_EQ(range_case.ok,
+                  ConditionOptimized::ExtractColumnRange(
+                      &schemas_ctx, col_idx, condition, &start, &end))
+            << sql;
+        ASSERT_EQ(range_case.start, start) << sql;
+        ASSERT_EQ(range_case.end, end) << sql;
+    }
+}
+
 TEST_P(TransformTest, window_merge_opt_test) {
     auto& sql_case = GetParam();
     std::string sqlstr = sql_case.sql_str();
@@ -19,6 +19,7 @@ package com._4paradigm.openmldb.jdbc;
 import com._4paradigm.openmldb.DataType;
 import com._4paradigm.openmldb.QueryFuture;
 import com._4paradigm.openmldb.Schema;
+import com._4paradigm.openmldb.Status;
 
 import java.io.InputStream;
 import java.io.Reader;
@@ -95,9 +96,13 @@ public class SQLResultSet implements ResultSet {
         if (this.resultSet.Next()) {
             this.rowNum++;
             return true;
-        } else {
-            return false;
         }
+        // the rest of the rows may fail to be fetched from the server
+        Status status = this.resultSet.GetStatus();
+        if (status.getCode() != 0) {
+            throw new SQLException("fail to read the next row: " + status.getMsg());
+        }
+        return false;
     }
 
     @Override
@@ -262,7 +262,9 @@ enum ReturnCode {
     kDatabaseNotEmpty = 803,
 
     kSQLCompileError = 1000,
-    kSQLRunError = 1001
+    kSQLRunError = 1001,
+    kQueryCursorNotFound = 1002,
+    kTooManyQueryCursors = 1003
 };
 
 }  // namespace base
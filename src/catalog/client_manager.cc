@@ -362,6 +362,22 @@ std::shared_ptr<TabletAccessor> PartitionClientManager::GetFollower() {
     return std::shared_ptr<TabletAccessor>();
 }
 
+std::shared_ptr<TabletAccessor> PartitionClientManager::GetReplica(const std::set<std::string>& readable_followers) {
+    std::vector<std::shared_ptr<TabletAccessor>> replicas;
+    if (leader_) {
+        replicas.push_back(leader_);
+    }
+    for (const auto& follower : followers_) {
+        if (readable_followers.find(follower->GetName()) != readable_followers.end()) {
+            replicas.push_back(follower);
+        }
+    }
+    if (replicas.empty()) {
+        return std::shared_ptr<TabletAccessor>();
+    }
+    return replicas[rand_.Next() % replicas.size()];
+}
+
 TableClientManager::TableClientManager(const TablePartitions& partitions, const ClientManager& client_manager) {
     for (const auto& table_partition : partitions) {
         uint32_t pid = table_partition.pid();
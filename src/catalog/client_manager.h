@@ -218,6 +218,12 @@ class PartitionClientManager {
 
     std::shared_ptr<TabletAccessor> GetFollower();
 
+    inline const std::vector<std::shared_ptr<TabletAccessor>>& GetFollowers() const { return followers_; }
+
+    // pick the leader or one of the followers in `readable_followers` at
+    // random, so the reads are balanced across the replicas
+    std::shared_ptr<TabletAccessor> GetReplica(const std::set<std::string>& readable_followers);
+
  private:
     uint32_t pid_;
     std::shared_ptr<TabletAccessor> leader_;
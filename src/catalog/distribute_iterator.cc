@@ -16,13 +16,18 @@
 
 #include "catalog/distribute_iterator.h"
 
+#include "storage/key_version.h"
+
 namespace openmldb {
 namespace catalog {
 
-FullTableIterator::FullTableIterator(std::shared_ptr<Tables> tables)
-    : tables_(tables), cur_pid_(0), it_(), key_(0), value_() {}
+FullTableIterator::FullTableIterator(std::shared_ptr<Tables> tables, ::openmldb::storage::KeyReadRecorder* recorder)
+    : tables_(tables), cur_pid_(0), it_(), key_(0), value_(), recorder_(recorder) {}
 
 void FullTableIterator::SeekToFirst() {
+    if (recorder_ != nullptr) {
+        recorder_->MarkUntracked();
+    }
     it_.reset();
     for (const auto& kv : *tables_) {
         it_.reset(kv.second->NewTraverseIterator(0));
@@ -64,8 +69,9 @@ const ::hybridse::codec::Row& FullTableIterator::GetValue() {
     return value_;
 }
 
-DistributeWindowIterator::DistributeWindowIterator(std::shared_ptr<Tables> tables, uint32_t index)
-    : tables_(tables), index_(index), cur_pid_(0), pid_num_(1), it_() {
+DistributeWindowIterator::DistributeWindowIterator(std::shared_ptr<Tables> tables, uint32_t index,
+                                                   ::openmldb::storage::KeyReadRecorder* recorder)
+    : tables_(tables), index_(index), cur_pid_(0), pid_num_(1), it_(), recorder_(recorder) {
     if (tables && !tables->empty()) {
         pid_num_ = tables->begin()->second->GetTableMeta()->table_partition_size();
     }
@@ -83,11 +89,14 @@ void DistributeWindowIterator::Seek(const std::string& key) {
     }
     auto iter = tables_->find(cur_pid_);
     if (iter != tables_->end()) {
-        it_.reset(iter->second->NewWindowIterator(index_));
+        it_.reset(iter->second->NewWindowIterator(index_, recorder_));
         it_->Seek(key);
         if (it_->Valid()) {
             return;
         }
+    } else if (recorder_ != nullptr) {
+        // the partition of the key may be loaded later
+        recorder_->MarkUntracked();
     }
     for (const auto& kv : *tables_) {
         if (kv.first <= cur_pid_) {
@@ -104,6 +113,9 @@ void DistributeWindowIterator::Seek(const std::string& key) {
 
 void DistributeWindowIterator::SeekToFirst() {
     DLOG(INFO) << "seek to first";
+    if (recorder_ != nullptr) {
+        recorder_->MarkUntracked();
+    }
     it_.reset();
     if (!tables_) {
         return;
@@ -144,5 +156,29 @@ std::unique_ptr<::hybridse::codec::RowIterator> DistributeWindowIterator::GetVal
 
 const ::hybridse::codec::Row DistributeWindowIterator::GetKey() { return it_->GetKey(); }
 
+const ::hybridse::codec::Row& ProjectRowIterator::GetValue() {
+    if (!projected_) {
+        value_ = projector_->Project(it_->GetValue());
+        projected_ = true;
+    }
+    return value_;
+}
+
+std::unique_ptr<::hybridse::codec::RowIterator> ProjectWindowIterator::GetValue() {
+    auto it = it_->GetValue();
+    if (!it) {
+        return std::unique_ptr<::hybridse::codec::RowIterator>();
+    }
+    return std::unique_ptr<::hybridse::codec::RowIterator>(new ProjectRowIterator(std::move(it), projector_));
+}
+
+::hybridse::codec::RowIterator* ProjectWindowIterator::GetRawValue() {
+    auto it = it_->GetValue();
+    if (!it) {
+        return nullptr;
+    }
+    return new ProjectRowIterator(std::move(it), projector_);
+}
+
 }  // namespace catalog
 }  // namespace openmldb
@@ -20,8 +20,10 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "base/hash.h"
+#include "codec/fe_row_selector.h"
 #include "storage/table.h"
 #include "vm/catalog.h"
 
@@ -32,7 +34,9 @@ using Tables = std::map<uint32_t, std::shared_ptr<::openmldb::storage::Table>>;
 
 class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hybridse::codec::Row> {
  public:
-    explicit FullTableIterator(std::shared_ptr<Tables> tables);
+    // a full scan makes `recorder` untracked, if it is not null
+    explicit FullTableIterator(std::shared_ptr<Tables> tables,
+                               ::openmldb::storage::KeyReadRecorder* recorder = nullptr);
     void Seek(const uint64_t& ts) override {}
     void SeekToFirst() override;
     bool Valid() const override;
@@ -48,11 +52,14 @@ class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hy
     std::unique_ptr<::openmldb::storage::TableIterator> it_;
     uint64_t key_;
     ::hybridse::codec::Row value_;
+    ::openmldb::storage::KeyReadRecorder* recorder_;
 };
 
 class DistributeWindowIterator : public ::hybridse::codec::WindowIterator {
  public:
-    DistributeWindowIterator(std::shared_ptr<Tables> tables, uint32_t index);
+    // the seeked keys are recorded into `recorder`, if it is not null
+    DistributeWindowIterator(std::shared_ptr<Tables> tables, uint32_t index,
+                             ::openmldb::storage::KeyReadRecorder* recorder = nullptr);
     void Seek(const std::string& key) override;
     void SeekToFirst() override;
     void Next() override;
@@ -67,6 +74,56 @@ class DistributeWindowIterator : public ::hybridse::codec::WindowIterator {
     uint32_t cur_pid_;
     uint32_t pid_num_;
     std::unique_ptr<::hybridse::codec::WindowIterator> it_;
+    ::openmldb::storage::KeyReadRecorder* recorder_;
+};
+
+// return rows which only keep the columns selected by projector
+class ProjectRowIterator : public ::hybridse::codec::RowIterator {
+ public:
+    ProjectRowIterator(std::unique_ptr<::hybridse::codec::RowIterator> it,
+                       std::shared_ptr<const ::hybridse::codec::RowProjector> projector)
+        : it_(std::move(it)), projector_(projector), value_(), projected_(false) {}
+    void Seek(const uint64_t& key) override {
+        projected_ = false;
+        it_->Seek(key);
+    }
+    void SeekToFirst() override {
+        projected_ = false;
+        it_->SeekToFirst();
+    }
+    bool Valid() const override { return it_->Valid(); }
+    void Next() override {
+        projected_ = false;
+        it_->Next();
+    }
+    const ::hybridse::codec::Row& GetValue() override;
+    bool IsSeekable() const override { return it_->IsSeekable(); }
+    const uint64_t& GetKey() const override { return it_->GetKey(); }
+
+ private:
+    std::unique_ptr<::hybridse::codec::RowIterator> it_;
+    std::shared_ptr<const ::hybridse::codec::RowProjector> projector_;
+    ::hybridse::codec::Row value_;
+    // value_ is the projection of the current row
+    bool projected_;
+};
+
+class ProjectWindowIterator : public ::hybridse::codec::WindowIterator {
+ public:
+    ProjectWindowIterator(std::unique_ptr<::hybridse::codec::WindowIterator> it,
+                          std::shared_ptr<const ::hybridse::codec::RowProjector> projector)
+        : it_(std::move(it)), projector_(projector) {}
+    void Seek(const std::string& key) override { it_->Seek(key); }
+    void SeekToFirst() override { it_->SeekToFirst(); }
+    void Next() override { it_->Next(); }
+    bool Valid() override { return it_->Valid(); }
+    std::unique_ptr<::hybridse::codec::RowIterator> GetValue() override;
+    ::hybridse::codec::RowIterator* GetRawValue() override;
+    const ::hybridse::codec::Row GetKey() override { return it_->GetKey(); }
+
+ private:
+    std::unique_ptr<::hybridse::codec::WindowIterator> it_;
+    std::shared_ptr<const ::hybridse::codec::RowProjector> projector_;
 };
 
 }  // namespace catalog
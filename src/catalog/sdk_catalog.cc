@@ -72,6 +72,7 @@ bool SDKTableHandler::Init() {
             index_st.ts_pos = pos;
         }
         index_st.name = index_def.name();
+        index_st.ttl_type = index_def.ttl_type();
         for (int32_t j = 0; j < index_def.first_keys_size(); j++) {
             const std::string& key = index_def.first_keys(j);
             auto it = types_.find(key);
@@ -74,6 +74,10 @@ class SDKTableHandler : public ::hybridse::vm::TableHandler {
 
     std::shared_ptr<TabletAccessor> GetTablet(uint32_t pid);
 
+    std::shared_ptr<PartitionClientManager> GetPartitionClientManager(uint32_t pid) {
+        return table_client_manager_->GetPartitionClientManager(pid);
+    }
+
     bool GetTablet(std::vector<std::shared_ptr<TabletAccessor>>* tablets);
 
     inline uint32_t GetTid() const { return meta_.tid(); }
@@ -28,9 +28,46 @@
 #include "glog/logging.h"
 DECLARE_bool(enable_distsql);
 DECLARE_bool(enable_localtablet);
+
 namespace openmldb {
 namespace catalog {
 
+// bound the projectors kept for ad-hoc queries
+constexpr size_t MAX_PROJECTOR_NUM = 256;
+
+std::shared_ptr<::hybridse::vm::TableHandler> ScanPartitionFilter::Filter(
+    std::shared_ptr<::hybridse::vm::TableHandler> table) {
+    auto tablet_table = std::dynamic_pointer_cast<TabletTableHandler>(table);
+    if (!tablet_table || tablet_table->GetTid() != static_cast<int32_t>(tid_)) {
+        return table;
+    }
+    return tablet_table->ScanPartitions(pids_);
+}
+
+std::shared_ptr<::hybridse::vm::TableHandler> KeyReadFilter::Filter(
+    std::shared_ptr<::hybridse::vm::TableHandler> table) {
+    auto tablet_table = std::dynamic_pointer_cast<TabletTableHandler>(table);
+    if (!tablet_table) {
+        // reads of other tables can not be tracked
+        recorder_.MarkUntracked();
+        return table;
+    }
+    return tablet_table->RecordReads(&recorder_);
+}
+
+std::shared_ptr<::hybridse::vm::PartitionHandler> KeyReadFilter::FilterPartition(
+    std::shared_ptr<::hybridse::vm::PartitionHandler> partition) {
+    auto tablet_partition = std::dynamic_pointer_cast<TabletPartitionHandler>(partition);
+    auto tablet_table =
+        tablet_partition ? std::dynamic_pointer_cast<TabletTableHandler>(tablet_partition->GetTableHandler()) : nullptr;
+    if (!tablet_table) {
+        recorder_.MarkUntracked();
+        return partition;
+    }
+    return std::make_shared<TabletPartitionHandler>(tablet_table->RecordReads(&recorder_),
+                                                    tablet_partition->GetIndexName());
+}
+
 TabletTableHandler::TabletTableHandler(const ::openmldb::api::TableMeta& meta,
                                        std::shared_ptr<hybridse::vm::Tablet> local_tablet)
     : schema_(),
@@ -91,6 +128,7 @@ bool TabletTableHandler::Init(const ClientManager& client_manager) {
             index_st.ts_pos = pos;
         }
         index_st.name = index_def.name();
+        index_st.ttl_type = index_def.ttl_type();
         for (int32_t j = 0; j < index_def.first_keys_size(); j++) {
             const std::string& key = index_def.first_keys(j);
             auto it = types_.find(key);
@@ -107,6 +145,26 @@ bool TabletTableHandler::Init(const ClientManager& client_manager) {
     return true;
 }
 
+std::shared_ptr<::hybridse::vm::TableHandler> TabletTableHandler::ScanPartitions(const std::set<uint32_t>& pids) {
+    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    auto scan_tables = std::make_shared<Tables>();
+    for (uint32_t pid : pids) {
+        auto it = tables->find(pid);
+        if (it != tables->end()) {
+            scan_tables->emplace(pid, it->second);
+        }
+    }
+    return std::make_shared<TabletScanTableHandler>(
+        std::static_pointer_cast<TabletTableHandler>(shared_from_this()), scan_tables);
+}
+
+std::shared_ptr<::hybridse::vm::TableHandler> TabletTableHandler::RecordReads(
+    ::openmldb::storage::KeyReadRecorder* recorder) {
+    return std::make_shared<TabletScanTableHandler>(
+        std::static_pointer_cast<TabletTableHandler>(shared_from_this()),
+        std::atomic_load_explicit(&tables_, std::memory_order_acquire), recorder);
+}
+
 std::unique_ptr<::hybridse::codec::RowIterator> TabletTableHandler::GetIterator() {
     auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
     if (!tables->empty()) {
@@ -157,6 +215,15 @@ const uint64_t TabletTableHandler::GetCount() {
     return cnt;
 }
 
+int64_t TabletTableHandler::GetCountEstimate() {
+    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    int64_t cnt = 0;
+    for (const auto& kv : *tables) {
+        cnt += kv.second->GetRecordCnt();
+    }
+    return cnt;
+}
+
 ::hybridse::codec::Row TabletTableHandler::At(uint64_t pos) {
     auto iter = GetIterator();
     while (pos-- > 0 && iter->Valid()) {
@@ -249,6 +316,205 @@ std::shared_ptr<::hybridse::vm::Tablet> TabletTableHandler::GetTablet(const std:
     return tablets_accessor;
 }
 
+std::shared_ptr<::hybridse::vm::TableHandler> TabletTableHandler::ProjectColumns(
+    const std::vector<size_t>& column_idxs) {
+    if (!HasLocalTable()) {
+        return std::shared_ptr<::hybridse::vm::TableHandler>();
+    }
+    auto projector = GetProjector(column_idxs);
+    if (!projector) {
+        return std::shared_ptr<::hybridse::vm::TableHandler>();
+    }
+    return std::make_shared<TabletProjectTableHandler>(shared_from_this(), projector);
+}
+
+std::shared_ptr<const ::hybridse::codec::RowProjector> TabletTableHandler::GetProjector(
+    const std::vector<size_t>& column_idxs) {
+    std::shared_ptr<const ::hybridse::codec::RowProjector> projector;
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> spin_lock(projector_mu_);
+        auto iter = projectors_.find(column_idxs);
+        if (iter != projectors_.end()) {
+            projector = iter->second;
+        }
+    }
+    if (!projector) {
+        auto new_projector = std::make_shared<::hybridse::codec::RowProjector>(schema_, column_idxs);
+        if (!new_projector->IsValid()) {
+            return std::shared_ptr<const ::hybridse::codec::RowProjector>();
+        }
+        projector = new_projector;
+        std::lock_guard<::openmldb::base::SpinMutex> spin_lock(projector_mu_);
+        if (projectors_.size() < MAX_PROJECTOR_NUM) {
+            projectors_.emplace(column_idxs, projector);
+        }
+    }
+    return projector;
+}
+
+TabletProjectTableHandler::TabletProjectTableHandler(
+    std::shared_ptr<::hybridse::vm::TableHandler> table_handler,
+    std::shared_ptr<const ::hybridse::codec::RowProjector> projector)
+    : table_handler_(table_handler), projector_(projector), types_(), index_hint_() {
+    auto schema = projector_->GetOutputSchema();
+    for (int32_t i = 0; i < schema->size(); i++) {
+        const ::hybridse::type::ColumnDef& column = schema->Get(i);
+        ::hybridse::vm::ColInfo col_info;
+        col_info.type = column.type();
+        col_info.idx = i;
+        col_info.name = column.name();
+        types_.insert(std::make_pair(column.name(), col_info));
+    }
+    // source column position -> projected position
+    std::map<uint32_t, uint32_t> positions;
+    const auto& indices = projector_->indices();
+    for (size_t i = 0; i < indices.size(); i++) {
+        positions.emplace(indices[i], i);
+    }
+    for (const auto& kv : table_handler_->GetIndex()) {
+        ::hybridse::vm::IndexSt index_st = kv.second;
+        bool projected = true;
+        for (auto& key : index_st.keys) {
+            auto it = positions.find(key.idx);
+            if (it == positions.end()) {
+                projected = false;
+                break;
+            }
+            key.idx = it->second;
+        }
+        if (projected && ::hybridse::vm::INVALID_POS != index_st.ts_pos) {
+            auto it = positions.find(index_st.ts_pos);
+            if (it == positions.end()) {
+                projected = false;
+            } else {
+                index_st.ts_pos = it->second;
+            }
+        }
+        if (projected) {
+            index_hint_.emplace(kv.first, index_st);
+        }
+    }
+}
+
+std::unique_ptr<::hybridse::codec::RowIterator> TabletProjectTableHandler::GetIterator() {
+    auto iter = table_handler_->GetIterator();
+    if (!iter) {
+        return std::unique_ptr<::hybridse::codec::RowIterator>();
+    }
+    return std::unique_ptr<::hybridse::codec::RowIterator>(new ProjectRowIterator(std::move(iter), projector_));
+}
+
+::hybridse::codec::RowIterator* TabletProjectTableHandler::GetRawIterator() {
+    auto iter = table_handler_->GetIterator();
+    if (!iter) {
+        return nullptr;
+    }
+    return new ProjectRowIterator(std::move(iter), projector_);
+}
+
+std::unique_ptr<::hybridse::codec::WindowIterator> TabletProjectTableHandler::GetWindowIterator(
+    const std::string& idx_name) {
+    auto iter = table_handler_->GetWindowIterator(idx_name);
+    if (!iter) {
+        return std::unique_ptr<::hybridse::codec::WindowIterator>();
+    }
+    return std::unique_ptr<::hybridse::codec::WindowIterator>(new ProjectWindowIterator(std::move(iter), projector_));
+}
+
+std::shared_ptr<::hybridse::vm::PartitionHandler> TabletProjectTableHandler::GetPartition(
+    const std::string& index_name) {
+    if (GetIndex().find(index_name) == GetIndex().cend()) {
+        LOG(WARNING) << "fail to get partition for tablet project table handler, index name " << index_name;
+        return std::shared_ptr<::hybridse::vm::PartitionHandler>();
+    }
+    return std::make_shared<TabletPartitionHandler>(shared_from_this(), index_name);
+}
+
+std::unique_ptr<::hybridse::codec::RowIterator> TabletScanTableHandler::GetIterator() {
+    if (!tables_->empty()) {
+        return std::unique_ptr<catalog::FullTableIterator>(new catalog::FullTableIterator(tables_, recorder_));
+    }
+    return std::unique_ptr<::hybridse::codec::RowIterator>();
+}
+
+::hybridse::codec::RowIterator* TabletScanTableHandler::GetRawIterator() {
+    if (!tables_->empty()) {
+        return new catalog::FullTableIterator(tables_, recorder_);
+    }
+    return nullptr;
+}
+
+std::unique_ptr<::hybridse::codec::WindowIterator> TabletScanTableHandler::GetWindowIterator(
+    const std::string& idx_name) {
+    auto iter = GetIndex().find(idx_name);
+    if (iter == GetIndex().end()) {
+        LOG(WARNING) << "index name " << idx_name << " not exist";
+        return std::unique_ptr<::hybridse::codec::WindowIterator>();
+    }
+    if (!tables_->empty()) {
+        return std::unique_ptr<::hybridse::codec::WindowIterator>(
+            new DistributeWindowIterator(tables_, iter->second.index, recorder_));
+    }
+    if (recorder_ != nullptr) {
+        // the partitions may be loaded later
+        recorder_->MarkUntracked();
+    }
+    return std::unique_ptr<::hybridse::codec::WindowIterator>();
+}
+
+const uint64_t TabletScanTableHandler::GetCount() {
+    uint64_t cnt = 0;
+    auto iter = GetIterator();
+    if (!iter) {
+        return cnt;
+    }
+    while (iter->Valid()) {
+        iter->Next();
+        cnt++;
+    }
+    return cnt;
+}
+
+int64_t TabletScanTableHandler::GetCountEstimate() {
+    int64_t cnt = 0;
+    for (const auto& kv : *tables_) {
+        cnt += kv.second->GetRecordCnt();
+    }
+    return cnt;
+}
+
+::hybridse::codec::Row TabletScanTableHandler::At(uint64_t pos) {
+    auto iter = GetIterator();
+    if (!iter) {
+        return ::hybridse::codec::Row();
+    }
+    while (pos-- > 0 && iter->Valid()) {
+        iter->Next();
+    }
+    return iter->Valid() ? iter->GetValue() : ::hybridse::codec::Row();
+}
+
+std::shared_ptr<::hybridse::vm::PartitionHandler> TabletScanTableHandler::GetPartition(
+    const std::string& index_name) {
+    if (GetIndex().find(index_name) == GetIndex().cend()) {
+        LOG(WARNING) << "fail to get partition for tablet scan table handler, index name " << index_name;
+        return std::shared_ptr<::hybridse::vm::PartitionHandler>();
+    }
+    return std::make_shared<TabletPartitionHandler>(shared_from_this(), index_name);
+}
+
+std::shared_ptr<::hybridse::vm::TableHandler> TabletScanTableHandler::ProjectColumns(
+    const std::vector<size_t>& column_idxs) {
+    if (tables_->empty()) {
+        return std::shared_ptr<::hybridse::vm::TableHandler>();
+    }
+    auto projector = table_handler_->GetProjector(column_idxs);
+    if (!projector) {
+        return std::shared_ptr<::hybridse::vm::TableHandler>();
+    }
+    return std::make_shared<TabletProjectTableHandler>(shared_from_this(), projector);
+}
+
 TabletCatalog::TabletCatalog()
     : mu_(), tables_(), db_(), db_sp_map_(), client_manager_(), version_(1), local_tablet_() {}
 
@@ -19,6 +19,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,7 +28,9 @@
 #include "catalog/client_manager.h"
 #include "catalog/distribute_iterator.h"
 #include "client/tablet_client.h"
+#include "codec/fe_row_selector.h"
 #include "codec/row.h"
+#include "storage/key_version.h"
 #include "storage/schema.h"
 #include "storage/table.h"
 
@@ -38,6 +41,37 @@ class TabletPartitionHandler;
 class TabletTableHandler;
 class TabletSegmentHandler;
 
+// Restrict the scans of table `tid` in a run to its local partitions `pids`,
+// so that a batch query scattered to several tablets reads every partition
+// exactly once, even if followers are local.
+class ScanPartitionFilter : public ::hybridse::vm::ScanFilter {
+ public:
+    ScanPartitionFilter(uint32_t tid, const std::set<uint32_t>& pids) : tid_(tid), pids_(pids) {}
+
+    std::shared_ptr<::hybridse::vm::TableHandler> Filter(std::shared_ptr<::hybridse::vm::TableHandler> table) override;
+
+ private:
+    uint32_t tid_;
+    std::set<uint32_t> pids_;
+};
+
+// Record the keys read by a run of a request mode query, so that its output
+// can be cached, see `KeyReadRecorder`.
+class KeyReadFilter : public ::hybridse::vm::ScanFilter {
+ public:
+    KeyReadFilter() : recorder_() {}
+
+    std::shared_ptr<::hybridse::vm::TableHandler> Filter(std::shared_ptr<::hybridse::vm::TableHandler> table) override;
+
+    std::shared_ptr<::hybridse::vm::PartitionHandler> FilterPartition(
+        std::shared_ptr<::hybridse::vm::PartitionHandler> partition) override;
+
+    const ::openmldb::storage::KeyReadRecorder &GetRecorder() const { return recorder_; }
+
+ private:
+    ::openmldb::storage::KeyReadRecorder recorder_;
+};
+
 class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
  public:
     TabletSegmentHandler(std::shared_ptr<::hybridse::vm::PartitionHandler> partition_handler, const std::string &key)
@@ -157,6 +191,19 @@ class TabletPartitionHandler : public ::hybridse::vm::PartitionHandler,
     }
     const std::string GetHandlerTypeName() override { return "TabletPartitionHandler"; }
 
+    std::shared_ptr<::hybridse::vm::TableHandler> ProjectColumns(const std::vector<size_t> &column_idxs) override {
+        auto table = table_handler_->ProjectColumns(column_idxs);
+        if (!table) {
+            return std::shared_ptr<::hybridse::vm::TableHandler>();
+        }
+        return table->GetPartition(index_name_);
+    }
+
+ private:
+    std::shared_ptr<::hybridse::vm::TableHandler> GetTableHandler() const { return table_handler_; }
+
+    const std::string &GetIndexName() const { return index_name_; }
+
  private:
     std::shared_ptr<::hybridse::vm::TableHandler> table_handler_;
     std::string index_name_;
@@ -193,6 +240,9 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
 
     const uint64_t GetCount() override;
 
+    // sum of the record counts of local partitions
+    int64_t GetCountEstimate() override;
+
     ::hybridse::codec::Row At(uint64_t pos) override;
 
     std::shared_ptr<::hybridse::vm::PartitionHandler> GetPartition(const std::string &index_name) override;
@@ -202,6 +252,17 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
     std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name,
                                                       const std::vector<std::string> &pks) override;
 
+    std::shared_ptr<::hybridse::vm::TableHandler> ProjectColumns(const std::vector<size_t> &column_idxs) override;
+
+    // return nullptr if the columns can not be projected
+    std::shared_ptr<const ::hybridse::codec::RowProjector> GetProjector(const std::vector<size_t> &column_idxs);
+
+    // the local partitions `pids` of the table, see `ScanPartitionFilter`
+    std::shared_ptr<::hybridse::vm::TableHandler> ScanPartitions(const std::set<uint32_t> &pids);
+
+    // the table whose reads are recorded into `recorder`, see `KeyReadFilter`
+    std::shared_ptr<::hybridse::vm::TableHandler> RecordReads(::openmldb::storage::KeyReadRecorder *recorder);
+
     inline int32_t GetTid() { return table_st_.GetTid(); }
 
     void AddTable(std::shared_ptr<::openmldb::storage::Table> table);
@@ -230,6 +291,111 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
     ::hybridse::vm::IndexHint index_hint_;
     std::shared_ptr<TableClientManager> table_client_manager_;
     std::shared_ptr<hybridse::vm::Tablet> local_tablet_;
+    // projectors are shared by queries selecting the same columns
+    ::openmldb::base::SpinMutex projector_mu_;
+    std::map<std::vector<size_t>, std::shared_ptr<const ::hybridse::codec::RowProjector>> projectors_;
+};
+
+// Local table whose rows only keep the projected columns.
+//
+// Rows are re-encoded right after they are read from storage, so the
+// operators above never touch the bytes of the other columns.
+class TabletProjectTableHandler : public ::hybridse::vm::TableHandler,
+                                  public std::enable_shared_from_this<hybridse::vm::TableHandler> {
+ public:
+    TabletProjectTableHandler(std::shared_ptr<::hybridse::vm::TableHandler> table_handler,
+                              std::shared_ptr<const ::hybridse::codec::RowProjector> projector);
+
+    const ::hybridse::vm::Schema *GetSchema() override { return projector_->GetOutputSchema(); }
+
+    const std::string &GetName() override { return table_handler_->GetName(); }
+
+    const std::string &GetDatabase() override { return table_handler_->GetDatabase(); }
+
+    const ::hybridse::vm::Types &GetTypes() override { return types_; }
+
+    // indexes of the source whose key and ts columns are all projected, at
+    // the positions of the projected schema
+    const ::hybridse::vm::IndexHint &GetIndex() override { return index_hint_; }
+
+    std::unique_ptr<::hybridse::codec::RowIterator> GetIterator() override;
+
+    ::hybridse::codec::RowIterator *GetRawIterator() override;
+
+    std::unique_ptr<::hybridse::codec::WindowIterator> GetWindowIterator(const std::string &idx_name) override;
+
+    const uint64_t GetCount() override { return table_handler_->GetCount(); }
+
+    int64_t GetCountEstimate() override { return table_handler_->GetCountEstimate(); }
+
+    ::hybridse::codec::Row At(uint64_t pos) override { return projector_->Project(table_handler_->At(pos)); }
+
+    std::shared_ptr<::hybridse::vm::PartitionHandler> GetPartition(const std::string &index_name) override;
+    const std::string GetHandlerTypeName() override { return "TabletProjectTableHandler"; }
+
+    std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name, const std::string &pk) override {
+        return table_handler_->GetTablet(index_name, pk);
+    }
+    std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name,
+                                                      const std::vector<std::string> &pks) override {
+        return table_handler_->GetTablet(index_name, pks);
+    }
+
+ private:
+    std::shared_ptr<::hybridse::vm::TableHandler> table_handler_;
+    std::shared_ptr<const ::hybridse::codec::RowProjector> projector_;
+    ::hybridse::vm::Types types_;
+    ::hybridse::vm::IndexHint index_hint_;
+};
+
+// Local table of a single run, whose scans only read some of its partitions,
+// and record the keys read into `recorder` if it is not null.
+class TabletScanTableHandler : public ::hybridse::vm::TableHandler,
+                               public std::enable_shared_from_this<hybridse::vm::TableHandler> {
+ public:
+    TabletScanTableHandler(std::shared_ptr<TabletTableHandler> table_handler, std::shared_ptr<Tables> tables,
+                           ::openmldb::storage::KeyReadRecorder *recorder = nullptr)
+        : table_handler_(table_handler), tables_(tables), recorder_(recorder) {}
+
+    const ::hybridse::vm::Schema *GetSchema() override { return table_handler_->GetSchema(); }
+
+    const std::string &GetName() override { return table_handler_->GetName(); }
+
+    const std::string &GetDatabase() override { return table_handler_->GetDatabase(); }
+
+    const ::hybridse::vm::Types &GetTypes() override { return table_handler_->GetTypes(); }
+
+    const ::hybridse::vm::IndexHint &GetIndex() override { return table_handler_->GetIndex(); }
+
+    std::unique_ptr<::hybridse::codec::RowIterator> GetIterator() override;
+
+    ::hybridse::codec::RowIterator *GetRawIterator() override;
+
+    std::unique_ptr<::hybridse::codec::WindowIterator> GetWindowIterator(const std::string &idx_name) override;
+
+    const uint64_t GetCount() override;
+
+    int64_t GetCountEstimate() override;
+
+    ::hybridse::codec::Row At(uint64_t pos) override;
+
+    std::shared_ptr<::hybridse::vm::PartitionHandler> GetPartition(const std::string &index_name) override;
+    const std::string GetHandlerTypeName() override { return "TabletScanTableHandler"; }
+
+    std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name, const std::string &pk) override {
+        return table_handler_->GetTablet(index_name, pk);
+    }
+    std::shared_ptr<::hybridse::vm::Tablet> GetTablet(const std::string &index_name,
+                                                      const std::vector<std::string> &pks) override {
+        return table_handler_->GetTablet(index_name, pks);
+    }
+
+    std::shared_ptr<::hybridse::vm::TableHandler> ProjectColumns(const std::vector<size_t> &column_idxs) override;
+
+ private:
+    std::shared_ptr<TabletTableHandler> table_handler_;
+    std::shared_ptr<Tables> tables_;
+    ::openmldb::storage::KeyReadRecorder *recorder_;
 };
 
 typedef std::map<std::string, std::map<std::string, std::shared_ptr<TabletTableHandler>>> TabletTables;
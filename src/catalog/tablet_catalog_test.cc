@@ -16,6 +16,7 @@
 
 #include "catalog/tablet_catalog.h"
 
+#include <set>
 #include <vector>
 
 #include "base/fe_status.h"
@@ -421,6 +422,149 @@ TEST_F(TabletCatalogTest, iterator_test) {
     }
     ASSERT_EQ(record_num, 500);
 }
+TEST_F(TabletCatalogTest, project_columns_test) {
+    std::shared_ptr<TabletCatalog> catalog(new TabletCatalog());
+    ASSERT_TRUE(catalog->Init());
+    uint32_t pid_num = 8;
+    TestArgs *args = PrepareMultiPartitionTable("t1", pid_num);
+    for (uint32_t pid = 0; pid < pid_num; pid++) {
+        ASSERT_TRUE(catalog->AddTable(args->meta[pid], args->tables[pid]));
+    }
+    auto handler = catalog->GetTable("db1", "t1");
+    // select col2, col1
+    auto project = handler->ProjectColumns({1, 0});
+    ASSERT_TRUE(project);
+    ASSERT_EQ(2, project->GetSchema()->size());
+    ASSERT_EQ("col2", project->GetSchema()->Get(0).name());
+    ASSERT_EQ("col1", project->GetSchema()->Get(1).name());
+    // index positions follow the projected schema
+    auto index_it = project->GetIndex().find("index0");
+    ASSERT_TRUE(index_it != project->GetIndex().end());
+    ASSERT_EQ(1u, index_it->second.keys.size());
+    ASSERT_EQ(1u, index_it->second.keys[0].idx);
+    ASSERT_EQ(0u, index_it->second.ts_pos);
+    // an index whose ts column is projected away is dropped
+    auto no_ts_project = handler->ProjectColumns({0});
+    ASSERT_TRUE(no_ts_project);
+    ASSERT_TRUE(no_ts_project->GetIndex().empty());
+    ASSERT_FALSE(no_ts_project->GetPartition("index0"));
+    ::hybridse::codec::RowView row_view(*project->GetSchema());
+
+    auto full_iterator = project->GetIterator();
+    full_iterator->SeekToFirst();
+    int record_num = 0;
+    while (full_iterator->Valid()) {
+        auto &row = full_iterator->GetValue();
+        // the projection is kept until the iterator moves
+        ASSERT_EQ(row.buf(), full_iterator->GetValue().buf());
+        ASSERT_TRUE(row_view.Reset(row.buf(), row.size()));
+        ASSERT_EQ(static_cast<int64_t>(full_iterator->GetKey()), row_view.GetInt64Unsafe(0));
+        ASSERT_EQ("pk", row_view.GetStringUnsafe(1).substr(0, 2));
+        record_num++;
+        full_iterator->Next();
+    }
+    ASSERT_EQ(500, record_num);
+
+    auto iterator = project->GetWindowIterator("index0");
+    iterator->SeekToFirst();
+    int pk_cnt = 0;
+    record_num = 0;
+    while (iterator->Valid()) {
+        pk_cnt++;
+        auto pk = iterator->GetKey().ToString();
+        auto row_iterator = iterator->GetValue();
+        row_iterator->SeekToFirst();
+        while (row_iterator->Valid()) {
+            auto &row = row_iterator->GetValue();
+            ASSERT_TRUE(row_view.Reset(row.buf(), row.size()));
+            ASSERT_EQ(static_cast<int64_t>(row_iterator->GetKey()), row_view.GetInt64Unsafe(0));
+            ASSERT_EQ(pk, row_view.GetStringUnsafe(1));
+            record_num++;
+            row_iterator->Next();
+        }
+        iterator->Next();
+    }
+    ASSERT_EQ(100, pk_cnt);
+    ASSERT_EQ(500, record_num);
+    delete args;
+}
+
+TEST_F(TabletCatalogTest, scan_partition_filter_test) {
+    std::shared_ptr<TabletCatalog> catalog(new TabletCatalog());
+    ASSERT_TRUE(catalog->Init());
+    uint32_t pid_num = 8;
+    TestArgs *args = PrepareMultiPartitionTable("t1", pid_num);
+    for (uint32_t pid = 0; pid < pid_num; pid++) {
+        ASSERT_TRUE(catalog->AddTable(args->meta[pid], args->tables[pid]));
+    }
+    auto handler = catalog->GetTable("db1", "t1");
+    auto count_rows = [](std::shared_ptr<::hybridse::vm::TableHandler> table) {
+        auto full_iterator = table->GetIterator();
+        int record_num = 0;
+        if (!full_iterator) {
+            return record_num;
+        }
+        full_iterator->SeekToFirst();
+        while (full_iterator->Valid()) {
+            record_num++;
+            full_iterator->Next();
+        }
+        return record_num;
+    };
+    std::set<uint32_t> even_pids = {0, 2, 4, 6};
+    std::set<uint32_t> odd_pids = {1, 3, 5, 7};
+    auto even_table = ScanPartitionFilter(1, even_pids).Filter(handler);
+    auto odd_table = ScanPartitionFilter(1, odd_pids).Filter(handler);
+    // filters of other tables do not matter
+    ASSERT_EQ(handler, ScanPartitionFilter(2, odd_pids).Filter(handler));
+    int even_num = count_rows(even_table);
+    int odd_num = count_rows(odd_table);
+    ASSERT_GT(even_num, 0);
+    ASSERT_GT(odd_num, 0);
+    ASSERT_EQ(500, even_num + odd_num);
+    ASSERT_EQ(500, count_rows(handler));
+    ASSERT_EQ(static_cast<uint64_t>(even_num), even_table->GetCount());
+
+    // projections keep the restriction
+    auto projected = even_table->ProjectColumns({0});
+    ASSERT_TRUE(projected);
+    ASSERT_EQ(even_num, count_rows(projected));
+}
+
+TEST_F(TabletCatalogTest, key_read_filter_test) {
+    std::shared_ptr<TabletCatalog> catalog(new TabletCatalog());
+    ASSERT_TRUE(catalog->Init());
+    uint32_t pid_num = 8;
+    TestArgs *args = PrepareMultiPartitionTable("t1", pid_num);
+    for (uint32_t pid = 0; pid < pid_num; pid++) {
+        ASSERT_TRUE(catalog->AddTable(args->meta[pid], args->tables[pid]));
+    }
+    auto handler = catalog->GetTable("db1", "t1");
+    auto partition = handler->GetPartition(args->idx_name);
+    ASSERT_TRUE(partition);
+
+    // seeks of keys are recorded
+    KeyReadFilter filter;
+    for (const std::string key : {"pk100", "pk101", "pk100"}) {
+        auto iter = filter.FilterPartition(partition)->GetSegment(key)->GetIterator();
+        ASSERT_TRUE(iter);
+        iter->SeekToFirst();
+        ASSERT_TRUE(iter->Valid());
+    }
+    ASSERT_TRUE(filter.GetRecorder().IsTracked());
+    ASSERT_FALSE(filter.GetRecorder().GetVersions().empty());
+    ASSERT_LE(filter.GetRecorder().GetVersions().size(), 2u);
+
+    // a full scan makes the reads untracked, other runs are not affected
+    KeyReadFilter other_filter;
+    auto iter = filter.Filter(handler)->GetIterator();
+    ASSERT_TRUE(iter);
+    iter->SeekToFirst();
+    ASSERT_FALSE(filter.GetRecorder().IsTracked());
+    ASSERT_TRUE(other_filter.GetRecorder().IsTracked());
+    delete args;
+}
+
 TEST_F(TabletCatalogTest, window_iterator_seek_test_discontinuous) {
     std::vector<std::shared_ptr<TabletCatalog>> catalog_vec;
     for (int i = 0; i < 2; i++) {
@@ -72,13 +72,15 @@ bool TabletClient::Query(const std::string& db, const std::string& sql, const st
 bool TabletClient::Query(const std::string& db, const std::string& sql,
                          const std::vector<openmldb::type::DataType>& parameter_types,
                          const std::string& parameter_row,
-                         brpc::Controller* cntl, ::openmldb::api::QueryResponse* response, const bool is_debug) {
+                         brpc::Controller* cntl, ::openmldb::api::QueryResponse* response, const bool is_debug,
+                         const bool enable_cursor) {
     if (cntl == NULL || response == NULL) return false;
     ::openmldb::api::QueryRequest request;
     request.set_sql(sql);
     request.set_db(db);
     request.set_is_batch(true);
     request.set_is_debug(is_debug);
+    request.set_enable_cursor(enable_cursor);
     request.set_parameter_row_size(parameter_row.size());
     request.set_parameter_row_slices(1);
     for (auto& type : parameter_types) {
@@ -98,6 +100,28 @@ bool TabletClient::Query(const std::string& db, const std::string& sql,
     return true;
 }
 
+bool TabletClient::FetchQuery(uint64_t cursor_id, brpc::Controller* cntl, ::openmldb::api::QueryResponse* response) {
+    if (cntl == NULL || response == NULL) return false;
+    ::openmldb::api::FetchQueryRequest request;
+    request.set_cursor_id(cursor_id);
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::FetchQuery, cntl, &request, response);
+    if (!ok || response->code() != 0) {
+        LOG(WARNING) << "fail to fetch query cursor " << cursor_id << ": " << response->msg();
+        return false;
+    }
+    return true;
+}
+
+bool TabletClient::CloseQueryCursor(uint64_t cursor_id) {
+    ::openmldb::api::FetchQueryRequest request;
+    request.set_cursor_id(cursor_id);
+    request.set_close(true);
+    ::openmldb::api::QueryResponse response;
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::FetchQuery, &request, &response,
+                                  FLAGS_request_timeout_ms, 1);
+    return ok && response.code() == 0;
+}
+
 /**
  * Utility function to encode row batch data into rpc attachment buffer
  */
@@ -1267,7 +1291,7 @@ bool TabletClient::Scan(const ::openmldb::api::ScanRequest& request, brpc::Contr
 
 bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row,
                                  brpc::Controller* cntl, openmldb::api::QueryResponse* response, bool is_debug,
-                                 uint64_t timeout_ms) {
+                                 uint64_t timeout_ms, bool enable_result_cache) {
     if (cntl == NULL || response == NULL) return false;
     ::openmldb::api::QueryRequest request;
     request.set_sp_name(sp_name);
@@ -1275,6 +1299,7 @@ bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_na
     request.set_is_debug(is_debug);
     request.set_is_batch(false);
     request.set_is_procedure(true);
+    request.set_enable_result_cache(enable_result_cache);
     request.set_row_size(row.size());
     request.set_row_slices(1);
     cntl->set_timeout_ms(timeout_ms);
@@ -1299,6 +1324,37 @@ bool TabletClient::SubQuery(const ::openmldb::api::QueryRequest& request,
     return client_.SendRequest(&::openmldb::api::TabletServer_Stub::SubQuery, callback->GetController().get(), &request,
                                callback->GetResponse().get(), callback);
 }
+bool TabletClient::ScatterQuery(const std::string& db, const std::string& sql,
+                                const std::vector<openmldb::type::DataType>& parameter_types,
+                                const std::string& parameter_row, uint32_t tid, const std::vector<uint32_t>& pids,
+                                bool is_debug, openmldb::RpcCallback<openmldb::api::QueryResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    ::openmldb::api::QueryRequest request;
+    request.set_sql(sql);
+    request.set_db(db);
+    request.set_is_batch(true);
+    request.set_is_debug(is_debug);
+    request.set_enable_cursor(true);
+    request.set_scan_tid(tid);
+    for (auto pid : pids) {
+        request.add_scan_pids(pid);
+    }
+    request.set_parameter_row_size(parameter_row.size());
+    request.set_parameter_row_slices(1);
+    for (auto& type : parameter_types) {
+        request.add_parameter_types(type);
+    }
+    auto& io_buf = callback->GetController()->request_attachment();
+    if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(parameter_row.data()), parameter_row.size(), &io_buf)) {
+        LOG(WARNING) << "Encode parameter buffer failed";
+        return false;
+    }
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::Query, callback->GetController().get(), &request,
+                               callback->GetResponse().get(), callback);
+}
+
 bool TabletClient::SubBatchRequestQuery(const ::openmldb::api::SQLBatchRequestQueryRequest& request,
                                         openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>* callback) {
     if (callback == nullptr) {
@@ -1350,7 +1406,7 @@ bool TabletClient::DropProcedure(const std::string& db_name, const std::string&
 }
 
 bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row,
-                                 uint64_t timeout_ms, bool is_debug,
+                                 uint64_t timeout_ms, bool is_debug, bool enable_result_cache,
                                  openmldb::RpcCallback<openmldb::api::QueryResponse>* callback) {
     if (callback == nullptr) {
         return false;
@@ -1361,6 +1417,7 @@ bool TabletClient::CallProcedure(const std::string& db, const std::string& sp_na
     request.set_is_debug(is_debug);
     request.set_is_batch(false);
     request.set_is_procedure(true);
+    request.set_enable_result_cache(enable_result_cache);
     request.set_row_size(row.size());
     request.set_row_slices(1);
     auto& io_buf = callback->GetController()->request_attachment();
@@ -1395,5 +1452,85 @@ bool TabletClient::CallSQLBatchRequestProcedure(
                                callback->GetController().get(), &request, callback->GetResponse().get(), callback);
 }
 
+bool TabletClient::Query(const std::string& db, const std::string& sql, const std::string& row, uint64_t timeout_ms,
+                         bool is_debug, openmldb::RpcCallback<openmldb::api::QueryResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    ::openmldb::api::QueryRequest request;
+    request.set_sql(sql);
+    request.set_db(db);
+    request.set_is_batch(false);
+    request.set_is_debug(is_debug);
+    request.set_row_size(row.size());
+    request.set_row_slices(1);
+    auto& io_buf = callback->GetController()->request_attachment();
+    if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(row.data()), row.size(), &io_buf)) {
+        LOG(WARNING) << "Encode row buffer failed";
+        return false;
+    }
+    callback->GetController()->set_timeout_ms(timeout_ms);
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::Query, callback->GetController().get(), &request,
+                               callback->GetResponse().get(), callback);
+}
+
+bool TabletClient::Query(const std::string& db, const std::string& sql,
+                         const std::vector<openmldb::type::DataType>& parameter_types,
+                         const std::string& parameter_row, uint64_t timeout_ms, bool is_debug, bool enable_cursor,
+                         openmldb::RpcCallback<openmldb::api::QueryResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    ::openmldb::api::QueryRequest request;
+    request.set_sql(sql);
+    request.set_db(db);
+    request.set_is_batch(true);
+    request.set_is_debug(is_debug);
+    request.set_enable_cursor(enable_cursor);
+    request.set_parameter_row_size(parameter_row.size());
+    request.set_parameter_row_slices(1);
+    for (auto& type : parameter_types) {
+        request.add_parameter_types(type);
+    }
+    auto& io_buf = callback->GetController()->request_attachment();
+    if (!codec::EncodeRpcRow(reinterpret_cast<const int8_t*>(parameter_row.data()), parameter_row.size(), &io_buf)) {
+        LOG(WARNING) << "Encode parameter buffer failed";
+        return false;
+    }
+    callback->GetController()->set_timeout_ms(timeout_ms);
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::Query, callback->GetController().get(), &request,
+                               callback->GetResponse().get(), callback);
+}
+
+bool TabletClient::Put(uint32_t tid, uint32_t pid, uint64_t time,
+                       const std::vector<std::pair<std::string, uint32_t>>& dimensions,
+                       const std::vector<uint64_t>& ts_dimensions, const std::string& value, uint32_t format_version,
+                       uint64_t timeout_ms, openmldb::RpcCallback<openmldb::api::PutResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    ::openmldb::api::PutRequest request;
+    request.set_value(value);
+    request.set_tid(tid);
+    request.set_pid(pid);
+    request.set_format_version(format_version);
+    for (size_t i = 0; i < dimensions.size(); i++) {
+        ::openmldb::api::Dimension* d = request.add_dimensions();
+        d->set_key(dimensions[i].first);
+        d->set_idx(dimensions[i].second);
+    }
+    if (ts_dimensions.empty()) {
+        request.set_time(time);
+    }
+    for (size_t i = 0; i < ts_dimensions.size(); i++) {
+        ::openmldb::api::TSDimension* d = request.add_ts_dimensions();
+        d->set_ts(ts_dimensions[i]);
+        d->set_idx(i);
+    }
+    callback->GetController()->set_timeout_ms(timeout_ms);
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::Put, callback->GetController().get(), &request,
+                               callback->GetResponse().get(), callback);
+}
+
 }  // namespace client
 }  // namespace openmldb
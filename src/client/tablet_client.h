@@ -67,11 +67,17 @@ class TabletClient : public Client {
 
     bool Query(const std::string& db, const std::string& sql,
                const std::vector<openmldb::type::DataType>& parameter_types, const std::string& parameter_row,
-               brpc::Controller* cntl, ::openmldb::api::QueryResponse* response, const bool is_debug = false);
+               brpc::Controller* cntl, ::openmldb::api::QueryResponse* response, const bool is_debug = false,
+               const bool enable_cursor = false);
 
     bool Query(const std::string& db, const std::string& sql, const std::string& row, brpc::Controller* cntl,
                ::openmldb::api::QueryResponse* response, const bool is_debug = false);
 
+    // fetch the next chunk of a batch query opened with `enable_cursor`
+    bool FetchQuery(uint64_t cursor_id, brpc::Controller* cntl, ::openmldb::api::QueryResponse* response);
+
+    bool CloseQueryCursor(uint64_t cursor_id);
+
     bool SQLBatchRequestQuery(const std::string& db, const std::string& sql,
                               std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch>, brpc::Controller* cntl,
                               ::openmldb::api::SQLBatchRequestQueryResponse* response, const bool is_debug = false);
@@ -251,7 +257,7 @@ class TabletClient : public Client {
 
     bool CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row,
                        brpc::Controller* cntl, openmldb::api::QueryResponse* response, bool is_debug,
-                       uint64_t timeout_ms);
+                       uint64_t timeout_ms, bool enable_result_cache);
 
     bool CallSQLBatchRequestProcedure(const std::string& db, const std::string& sp_name,
                                       std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch>, brpc::Controller* cntl,
@@ -265,16 +271,37 @@ class TabletClient : public Client {
     bool SubQuery(const ::openmldb::api::QueryRequest& request,
                   openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
 
+    // run the batch sql on partitions `pids` of table `tid` in the tablet only,
+    // the rows beyond the first chunk are kept as a cursor
+    bool ScatterQuery(const std::string& db, const std::string& sql,
+                      const std::vector<openmldb::type::DataType>& parameter_types, const std::string& parameter_row,
+                      uint32_t tid, const std::vector<uint32_t>& pids, bool is_debug,
+                      openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
+
     bool SubBatchRequestQuery(const ::openmldb::api::SQLBatchRequestQueryRequest& request,
                               openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>* callback);
     bool CallProcedure(const std::string& db, const std::string& sp_name, const std::string& row, uint64_t timeout_ms,
-                       bool is_debug, openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
+                       bool is_debug, bool enable_result_cache,
+                       openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
 
     bool CallSQLBatchRequestProcedure(const std::string& db, const std::string& sp_name,
                                       std::shared_ptr<::openmldb::sdk::SQLRequestRowBatch> row_batch, bool is_debug,
                                       uint64_t timeout_ms,
                                       openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>* callback);
 
+    bool Query(const std::string& db, const std::string& sql, const std::string& row, uint64_t timeout_ms,
+               bool is_debug, openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
+
+    bool Query(const std::string& db, const std::string& sql,
+               const std::vector<openmldb::type::DataType>& parameter_types, const std::string& parameter_row,
+               uint64_t timeout_ms, bool is_debug, bool enable_cursor,
+               openmldb::RpcCallback<openmldb::api::QueryResponse>* callback);
+
+    // `time` is used only if there is no `ts_dimensions`
+    bool Put(uint32_t tid, uint32_t pid, uint64_t time, const std::vector<std::pair<std::string, uint32_t>>& dimensions,
+             const std::vector<uint64_t>& ts_dimensions, const std::string& value, uint32_t format_version,
+             uint64_t timeout_ms, openmldb::RpcCallback<openmldb::api::PutResponse>* callback);
+
  private:
     ::openmldb::RpcClient<::openmldb::api::TabletServer_Stub> client_;
     std::vector<uint64_t> percentile_;
@@ -51,13 +51,35 @@ DEFINE_uint32(gc_deleted_pk_version_delta, 2, "config the gc version delta");
 DEFINE_double(mem_release_rate, 5, "specify memory release rate, which should be in 0 ~ 10");
 DEFINE_int32(task_pool_size, 3, "the size of tablet task thread pool");
 DEFINE_int32(io_pool_size, 2, "the size of tablet io task thread pool");
+DEFINE_int32(procedure_compile_pool_size, 4, "the size of tablet thread pool for compiling procedures");
 DEFINE_bool(use_name, false, "enable or disable use server name");
 DEFINE_string(data_dir, "./data", "the path of data dir");
 DEFINE_bool(enable_distsql, false, "enable or disable distribute sql");
 DEFINE_bool(enable_localtablet, true, "enable or disable local tablet opt when distribute sql circumstance");
+DEFINE_string(jit_object_cache_dir, "",
+              "the dir of cached object code of compiled sql, empty means disabled");
+DEFINE_bool(enable_tiered_compile, false,
+            "compile ad-hoc queries with minimal optimizations and re-optimize them in background");
+DEFINE_bool(enable_literal_normalize, false,
+            "lift literals in where clauses of queries into parameters to share compiled plans");
+DEFINE_uint64(interpret_max_rows, 0,
+              "interpret simple batch queries until they project this many rows in total before jit compiling, "
+              "0 means never");
+DEFINE_uint64(max_batch_memory_bytes, 0,
+              "the memory budget of partition buffers in one batch query, rows beyond it are spilled to disk, "
+              "0 means unlimited");
+DEFINE_string(spill_dir, "/tmp", "the dir of batch query rows spilled to disk");
+DEFINE_string(udf_plugins, "", "comma separated paths of shared libraries of native udfs to load at startup");
 
 // scan configuration
 DEFINE_uint32(scan_max_bytes_size, 2 * 1024 * 1024, "config the max size of scan bytes size");
+DEFINE_uint32(query_cursor_max_num, 1024, "the max number of open cursors of batch query results in tablet");
+DEFINE_uint32(query_cursor_expire_ms, 60000, "the time after which a batch query cursor not fetched is dropped");
+DEFINE_uint64(query_cursor_max_bytes, 1024 * 1024 * 1024,
+              "the max total bytes of the rows kept by batch query cursors in tablet");
+DEFINE_uint64(procedure_result_cache_max_bytes, 64 * 1024 * 1024,
+              "the max bytes of cached outputs of procedures with result cache enabled, 0 means disabled");
+DEFINE_uint32(procedure_result_cache_expire_ms, 10000, "the time after which a cached procedure output is dropped");
 DEFINE_uint32(scan_reserve_size, 1024, "config the size of vec reserve");
 DEFINE_uint32(preview_limit_max_num, 1000, "config the max num of preview limit");
 DEFINE_uint32(preview_default_limit, 100, "config the default limit of preview");
@@ -157,16 +157,17 @@ bool SQLBatchRequestResultSet::GetString(uint32_t index, std::string* str) {
         return false;
     }
     size_t mapped_index = column_remap_[index];
-    butil::IOBuf tmp;
+    char* data = nullptr;
+    uint32_t size = 0;
     int32_t ret = -1;
     if (IsCommonColumnIdx(index)) {
-        ret = common_row_view_->GetString(mapped_index, &tmp);
+        ret = common_row_view_->GetString(mapped_index, &data, &size);
     } else {
-        ret = non_common_row_view_->GetString(mapped_index, &tmp);
+        ret = non_common_row_view_->GetString(mapped_index, &data, &size);
     }
     if (ret == 0) {
-        DLOG(INFO) << "get str size " << tmp.size();
-        tmp.append_to(str, tmp.size(), 0);
+        DLOG(INFO) << "get str size " << size;
+        str->assign(data, size);
         return true;
     }
     DLOG(INFO) << "fail to get string with ret " << ret;
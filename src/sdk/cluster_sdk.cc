@@ -388,6 +388,24 @@ std::shared_ptr<::openmldb::catalog::TabletAccessor> ClusterSDK::GetTablet(const
     return std::shared_ptr<::openmldb::catalog::TabletAccessor>();
 }
 
+std::shared_ptr<::openmldb::catalog::PartitionClientManager> ClusterSDK::GetPartitionClientManager(
+    const std::string& db, const std::string& name, const std::string& pk, uint32_t* tid, uint32_t* pid) {
+    auto table_handler = GetCatalog()->GetTable(db, name);
+    if (table_handler) {
+        auto sdk_table_handler = dynamic_cast<::openmldb::catalog::SDKTableHandler*>(table_handler.get());
+        if (sdk_table_handler) {
+            uint32_t pid_num = sdk_table_handler->GetPartitionNum();
+            *pid = 0;
+            if (pid_num > 0) {
+                *pid = pk.empty() ? rand_.Uniform(pid_num) : ::openmldb::base::hash64(pk) % pid_num;
+            }
+            *tid = sdk_table_handler->GetTid();
+            return sdk_table_handler->GetPartitionClientManager(*pid);
+        }
+    }
+    return std::shared_ptr<::openmldb::catalog::PartitionClientManager>();
+}
+
 std::shared_ptr<hybridse::sdk::ProcedureInfo> ClusterSDK::GetProcedureInfo(const std::string& db,
                                                                            const std::string& sp_name,
                                                                            std::string* msg) {
@@ -79,6 +79,13 @@ class ClusterSDK {
                                                                    uint32_t pid);
     std::shared_ptr<::openmldb::catalog::TabletAccessor> GetTablet(const std::string& db, const std::string& name,
                                                                    const std::string& pk);
+    // the replicas of the partition of `pk`, or of a random partition if `pk`
+    // is empty
+    std::shared_ptr<::openmldb::catalog::PartitionClientManager> GetPartitionClientManager(const std::string& db,
+                                                                                           const std::string& name,
+                                                                                           const std::string& pk,
+                                                                                           uint32_t* tid,
+                                                                                           uint32_t* pid);
 
     std::shared_ptr<hybridse::sdk::ProcedureInfo> GetProcedureInfo(const std::string& db, const std::string& sp_name,
                                                                    std::string* msg);
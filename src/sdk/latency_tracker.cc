@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/latency_tracker.h"
+
+#include <algorithm>
+
+namespace openmldb {
+namespace sdk {
+
+// the weight of a new latency in the average
+constexpr double kAverageWeight = 0.1;
+constexpr size_t kSampleSize = 128;
+constexpr size_t kMinSampleSize = 32;
+// the percentile is recomputed once per this number of requests
+constexpr uint32_t kP95UpdateInterval = 16;
+constexpr uint64_t kTokensPerHedge = 1000;
+
+LatencyTracker::LatencyTracker() : mu_(), stats_() {}
+
+void LatencyTracker::Record(const std::string& endpoint, uint64_t latency_us) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto& stat = stats_[endpoint];
+    if (stat.samples.empty()) {
+        stat.average = latency_us;
+    } else {
+        stat.average += kAverageWeight * (static_cast<double>(latency_us) - stat.average);
+    }
+    if (stat.samples.size() < kSampleSize) {
+        stat.samples.push_back(latency_us);
+    } else {
+        stat.samples[stat.next] = latency_us;
+        stat.next = (stat.next + 1) % kSampleSize;
+    }
+    if (++stat.pending_cnt < kP95UpdateInterval || stat.samples.size() < kMinSampleSize) {
+        return;
+    }
+    stat.pending_cnt = 0;
+    std::vector<uint64_t> sorted = stat.samples;
+    size_t idx = sorted.size() * 95 / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+    stat.p95 = sorted[idx];
+}
+
+uint64_t LatencyTracker::GetAverage(const std::string& endpoint) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = stats_.find(endpoint);
+    if (it == stats_.end()) {
+        return 0;
+    }
+    return static_cast<uint64_t>(it->second.average);
+}
+
+uint64_t LatencyTracker::GetP95(const std::string& endpoint) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = stats_.find(endpoint);
+    if (it == stats_.end()) {
+        return 0;
+    }
+    return it->second.p95;
+}
+
+HedgeBudget::HedgeBudget(double ratio, uint32_t max_burst)
+    : earn_per_request_(static_cast<uint64_t>(std::max(ratio, 0.0) * kTokensPerHedge + 0.5)),
+      max_tokens_(static_cast<uint64_t>(max_burst) * kTokensPerHedge),
+      mu_(),
+      tokens_(0) {}
+
+void HedgeBudget::OnRequest() {
+    std::lock_guard<std::mutex> lock(mu_);
+    tokens_ = std::min(tokens_ + earn_per_request_, max_tokens_);
+}
+
+bool HedgeBudget::TryAcquire() {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (tokens_ < kTokensPerHedge) {
+        return false;
+    }
+    tokens_ -= kTokensPerHedge;
+    return true;
+}
+
+}  // namespace sdk
+}  // namespace openmldb
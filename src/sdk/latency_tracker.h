@@ -0,0 +1,82 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_LATENCY_TRACKER_H_
+#define SRC_SDK_LATENCY_TRACKER_H_
+
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace openmldb {
+namespace sdk {
+
+/**
+ * Track the latency of the requests to each tablet endpoint, as the
+ * exponentially weighted moving average and the 95th percentile of the
+ * recent requests.
+ */
+class LatencyTracker {
+ public:
+    LatencyTracker();
+
+    void Record(const std::string& endpoint, uint64_t latency_us);
+
+    // 0 if there is no request to the endpoint yet
+    uint64_t GetAverage(const std::string& endpoint);
+
+    // 0 if there are too few requests to the endpoint
+    uint64_t GetP95(const std::string& endpoint);
+
+ private:
+    struct Stat {
+        double average = 0;
+        // the latencies of the recent requests, a ring buffer
+        std::vector<uint64_t> samples;
+        size_t next = 0;
+        uint64_t p95 = 0;
+        uint32_t pending_cnt = 0;
+    };
+
+ private:
+    std::mutex mu_;
+    std::map<std::string, Stat> stats_;
+};
+
+/**
+ * Limit the hedged requests to a ratio of all requests. Each request earns
+ * `ratio` of a hedge, and the unused hedges are kept up to `max_burst`.
+ */
+class HedgeBudget {
+ public:
+    HedgeBudget(double ratio, uint32_t max_burst);
+
+    void OnRequest();
+
+    bool TryAcquire();
+
+ private:
+    // in thousandths of a hedge
+    const uint64_t earn_per_request_;
+    const uint64_t max_tokens_;
+    std::mutex mu_;
+    uint64_t tokens_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+#endif  // SRC_SDK_LATENCY_TRACKER_H_
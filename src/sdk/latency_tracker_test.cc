@@ -0,0 +1,82 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/latency_tracker.h"
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace sdk {
+
+class LatencyTrackerTest : public ::testing::Test {};
+
+TEST_F(LatencyTrackerTest, average_and_p95) {
+    LatencyTracker tracker;
+    ASSERT_EQ(0u, tracker.GetAverage("tablet1"));
+    ASSERT_EQ(0u, tracker.GetP95("tablet1"));
+    for (uint64_t i = 1; i <= 16; i++) {
+        tracker.Record("tablet1", 100);
+    }
+    ASSERT_EQ(100u, tracker.GetAverage("tablet1"));
+    // too few requests for the percentile
+    ASSERT_EQ(0u, tracker.GetP95("tablet1"));
+
+    for (uint64_t i = 1; i <= 128; i++) {
+        tracker.Record("tablet2", i);
+    }
+    ASSERT_EQ(122u, tracker.GetP95("tablet2"));
+    // the average follows the recent latencies
+    ASSERT_GT(tracker.GetAverage("tablet2"), 110u);
+
+    // old latencies are evicted by the new ones
+    for (uint64_t i = 1; i <= 128; i++) {
+        tracker.Record("tablet2", 10);
+    }
+    ASSERT_EQ(10u, tracker.GetP95("tablet2"));
+    ASSERT_EQ(0u, tracker.GetP95("tablet3"));
+}
+
+TEST_F(LatencyTrackerTest, hedge_budget) {
+    HedgeBudget budget(0.1, 5);
+    ASSERT_FALSE(budget.TryAcquire());
+    for (int i = 0; i < 20; i++) {
+        budget.OnRequest();
+    }
+    ASSERT_TRUE(budget.TryAcquire());
+    ASSERT_TRUE(budget.TryAcquire());
+    ASSERT_FALSE(budget.TryAcquire());
+
+    // the unused hedges are capped by the burst
+    for (int i = 0; i < 1000; i++) {
+        budget.OnRequest();
+    }
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(budget.TryAcquire());
+    }
+    ASSERT_FALSE(budget.TryAcquire());
+
+    HedgeBudget no_hedge(0, 5);
+    no_hedge.OnRequest();
+    ASSERT_FALSE(no_hedge.TryAcquire());
+}
+
+}  // namespace sdk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
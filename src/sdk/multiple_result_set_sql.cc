@@ -0,0 +1,52 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/multiple_result_set_sql.h"
+
+namespace openmldb {
+namespace sdk {
+
+bool MultipleResultSetSQL::Reset() {
+    for (auto& result_set : result_sets_) {
+        if (!result_set->Reset()) {
+            return false;
+        }
+    }
+    cur_ = 0;
+    return true;
+}
+
+bool MultipleResultSetSQL::Next() {
+    while (!result_sets_[cur_]->Next()) {
+        // do not skip the rest of a failed result set
+        if (cur_ + 1 >= result_sets_.size() || result_sets_[cur_]->GetStatus().code != 0) {
+            return false;
+        }
+        cur_++;
+    }
+    return true;
+}
+
+int32_t MultipleResultSetSQL::Size() {
+    int32_t size = 0;
+    for (auto& result_set : result_sets_) {
+        size += result_set->Size();
+    }
+    return size;
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_MULTIPLE_RESULT_SET_SQL_H_
+#define SRC_SDK_MULTIPLE_RESULT_SET_SQL_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sdk/result_set.h"
+
+namespace openmldb {
+namespace sdk {
+
+// Concatenation of the result sets of a batch query scattered to several
+// tablets, which have the same schema
+class MultipleResultSetSQL : public ::hybridse::sdk::ResultSet {
+ public:
+    explicit MultipleResultSetSQL(const std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>>& result_sets)
+        : result_sets_(result_sets), cur_(0) {}
+
+    ~MultipleResultSetSQL() {}
+
+    bool Reset();
+
+    bool Next();
+
+    bool IsNULL(int index) { return result_sets_[cur_]->IsNULL(index); }
+
+    bool GetString(uint32_t index, std::string* str) { return result_sets_[cur_]->GetString(index, str); }
+
+    bool GetBool(uint32_t index, bool* result) { return result_sets_[cur_]->GetBool(index, result); }
+
+    bool GetChar(uint32_t index, char* result) { return result_sets_[cur_]->GetChar(index, result); }
+
+    bool GetInt16(uint32_t index, int16_t* result) { return result_sets_[cur_]->GetInt16(index, result); }
+
+    bool GetInt32(uint32_t index, int32_t* result) { return result_sets_[cur_]->GetInt32(index, result); }
+
+    bool GetInt64(uint32_t index, int64_t* result) { return result_sets_[cur_]->GetInt64(index, result); }
+
+    bool GetFloat(uint32_t index, float* result) { return result_sets_[cur_]->GetFloat(index, result); }
+
+    bool GetDouble(uint32_t index, double* result) { return result_sets_[cur_]->GetDouble(index, result); }
+
+    bool GetDate(uint32_t index, int32_t* date) { return result_sets_[cur_]->GetDate(index, date); }
+
+    bool GetDate(uint32_t index, int32_t* year, int32_t* month, int32_t* day) {
+        return result_sets_[cur_]->GetDate(index, year, month, day);
+    }
+
+    bool GetTime(uint32_t index, int64_t* mills) { return result_sets_[cur_]->GetTime(index, mills); }
+
+    const ::hybridse::sdk::Schema* GetSchema() { return result_sets_[0]->GetSchema(); }
+
+    int32_t Size();
+
+    ::hybridse::sdk::Status GetStatus() { return result_sets_[cur_]->GetStatus(); }
+
+ private:
+    std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>> result_sets_;
+    size_t cur_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+#endif  // SRC_SDK_MULTIPLE_RESULT_SET_SQL_H_
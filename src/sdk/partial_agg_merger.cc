@@ -0,0 +1,226 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/partial_agg_merger.h"
+
+#include <utility>
+
+#include "brpc/controller.h"
+#include "codec/fe_row_codec.h"
+#include "glog/logging.h"
+#include "sdk/result_set_sql.h"
+
+namespace openmldb {
+namespace sdk {
+
+using ::hybridse::vm::PartialAggMerge;
+
+PartialAggMerger::PartialAggMerger(const ::hybridse::vm::Schema& schema, const std::vector<PartialAggMerge>& merges)
+    : schema_(schema), merges_(merges), rows_(), groups_() {}
+
+bool PartialAggMerger::IsFloating(uint32_t idx) const {
+    auto type = schema_.Get(idx).type();
+    return type == ::hybridse::type::kFloat || type == ::hybridse::type::kDouble;
+}
+
+bool PartialAggMerger::Read(::hybridse::sdk::ResultSet* result_set, uint32_t idx, Cell* cell) {
+    cell->is_null = result_set->IsNULL(idx);
+    if (cell->is_null) {
+        return true;
+    }
+    switch (schema_.Get(idx).type()) {
+        case ::hybridse::type::kBool: {
+            bool val = false;
+            return result_set->GetBool(idx, &val) && (cell->i = val, true);
+        }
+        case ::hybridse::type::kInt16: {
+            int16_t val = 0;
+            return result_set->GetInt16(idx, &val) && (cell->i = val, true);
+        }
+        case ::hybridse::type::kInt32: {
+            int32_t val = 0;
+            return result_set->GetInt32(idx, &val) && (cell->i = val, true);
+        }
+        case ::hybridse::type::kInt64:
+            return result_set->GetInt64(idx, &cell->i);
+        case ::hybridse::type::kTimestamp:
+            return result_set->GetTime(idx, &cell->i);
+        case ::hybridse::type::kDate: {
+            int32_t year = 0, month = 0, day = 0;
+            if (!result_set->GetDate(idx, &year, &month, &day)) {
+                return false;
+            }
+            // keeps the order of dates
+            cell->i = year * 10000 + month * 100 + day;
+            return true;
+        }
+        case ::hybridse::type::kFloat: {
+            float val = 0;
+            return result_set->GetFloat(idx, &val) && (cell->d = val, true);
+        }
+        case ::hybridse::type::kDouble:
+            return result_set->GetDouble(idx, &cell->d);
+        case ::hybridse::type::kVarchar:
+            return result_set->GetString(idx, &cell->s);
+        default:
+            LOG(WARNING) << "unsupported type of partial aggregation " << schema_.Get(idx).type();
+            return false;
+    }
+}
+
+void PartialAggMerger::Merge(uint32_t idx, const Cell& cell, Cell* result) {
+    if (cell.is_null) {
+        return;
+    }
+    if (result->is_null) {
+        *result = cell;
+        return;
+    }
+    bool floating = IsFloating(idx);
+    bool is_string = schema_.Get(idx).type() == ::hybridse::type::kVarchar;
+    switch (merges_[idx]) {
+        case ::hybridse::vm::kMergeBySum:
+            if (floating) {
+                result->d += cell.d;
+            } else {
+                result->i += cell.i;
+            }
+            break;
+        case ::hybridse::vm::kMergeByMin:
+            if (is_string ? cell.s < result->s : (floating ? cell.d < result->d : cell.i < result->i)) {
+                *result = cell;
+            }
+            break;
+        case ::hybridse::vm::kMergeByMax:
+            if (is_string ? cell.s > result->s : (floating ? cell.d > result->d : cell.i > result->i)) {
+                *result = cell;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool PartialAggMerger::Add(const std::shared_ptr<::hybridse::sdk::ResultSet>& result_set) {
+    if (!result_set || result_set->GetSchema()->GetColumnCnt() != schema_.size() ||
+        static_cast<size_t>(schema_.size()) != merges_.size()) {
+        LOG(WARNING) << "schema of partial aggregation mismatch";
+        return false;
+    }
+    std::vector<Cell> row(merges_.size());
+    while (result_set->Next()) {
+        std::string key;
+        for (uint32_t i = 0; i < merges_.size(); i++) {
+            if (!Read(result_set.get(), i, &row[i])) {
+                LOG(WARNING) << "fail to read column " << i << " of partial aggregation";
+                return false;
+            }
+            if (merges_[i] != ::hybridse::vm::kMergeByKey) {
+                continue;
+            }
+            // values are tagged, so null and empty keys are different groups
+            if (row[i].is_null) {
+                key.append(1, 'n');
+                continue;
+            }
+            key.append(1, 'v');
+            if (schema_.Get(i).type() == ::hybridse::type::kVarchar) {
+                key.append(std::to_string(row[i].s.size())).append(1, ':').append(row[i].s);
+            } else if (IsFloating(i)) {
+                key.append(reinterpret_cast<const char*>(&row[i].d), sizeof(double));
+            } else {
+                key.append(reinterpret_cast<const char*>(&row[i].i), sizeof(int64_t));
+            }
+        }
+        auto it = groups_.find(key);
+        if (it == groups_.end()) {
+            groups_.emplace(key, rows_.size());
+            rows_.push_back(row);
+            continue;
+        }
+        auto& result = rows_[it->second];
+        for (uint32_t i = 0; i < merges_.size(); i++) {
+            if (merges_[i] != ::hybridse::vm::kMergeByKey) {
+                Merge(i, row[i], &result[i]);
+            }
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<::hybridse::sdk::ResultSet> PartialAggMerger::GetResultSet() {
+    ::hybridse::codec::RowBuilder builder(schema_);
+    auto cntl = std::make_shared<::brpc::Controller>();
+    uint32_t byte_size = 0;
+    for (auto& row : rows_) {
+        uint32_t str_size = 0;
+        for (int i = 0; i < schema_.size(); i++) {
+            if (!row[i].is_null && schema_.Get(i).type() == ::hybridse::type::kVarchar) {
+                str_size += row[i].s.size();
+            }
+        }
+        uint32_t size = builder.CalTotalLength(str_size);
+        std::string buf(size, '\0');
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&buf[0]), size);
+        for (int i = 0; i < schema_.size(); i++) {
+            auto& cell = row[i];
+            if (cell.is_null) {
+                builder.AppendNULL();
+                continue;
+            }
+            switch (schema_.Get(i).type()) {
+                case ::hybridse::type::kBool:
+                    builder.AppendBool(cell.i != 0);
+                    break;
+                case ::hybridse::type::kInt16:
+                    builder.AppendInt16(static_cast<int16_t>(cell.i));
+                    break;
+                case ::hybridse::type::kInt32:
+                    builder.AppendInt32(static_cast<int32_t>(cell.i));
+                    break;
+                case ::hybridse::type::kInt64:
+                    builder.AppendInt64(cell.i);
+                    break;
+                case ::hybridse::type::kTimestamp:
+                    builder.AppendTimestamp(cell.i);
+                    break;
+                case ::hybridse::type::kDate:
+                    builder.AppendDate(cell.i / 10000, cell.i / 100 % 100, cell.i % 100);
+                    break;
+                case ::hybridse::type::kFloat:
+                    builder.AppendFloat(static_cast<float>(cell.d));
+                    break;
+                case ::hybridse::type::kDouble:
+                    builder.AppendDouble(cell.d);
+                    break;
+                case ::hybridse::type::kVarchar:
+                    builder.AppendString(cell.s.data(), cell.s.size());
+                    break;
+                default:
+                    builder.AppendNULL();
+                    break;
+            }
+        }
+        cntl->response_attachment().append(buf);
+        byte_size += size;
+    }
+    auto rs = std::make_shared<ResultSetSQL>(schema_, rows_.size(), byte_size, cntl);
+    rs->Init();
+    return rs;
+}
+
+}  // namespace sdk
+}  // namespace openmldb
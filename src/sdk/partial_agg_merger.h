@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_PARTIAL_AGG_MERGER_H_
+#define SRC_SDK_PARTIAL_AGG_MERGER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sdk/result_set.h"
+#include "vm/catalog.h"
+#include "vm/router.h"
+
+namespace openmldb {
+namespace sdk {
+
+/**
+ * Merge the partial aggregations of a query scattered to several tablets,
+ * e.g. the `count(*)` of every tablet is summed up. Rows with equal group keys
+ * are merged into one, in the order they are first added.
+ */
+class PartialAggMerger {
+ public:
+    PartialAggMerger(const ::hybridse::vm::Schema& schema, const std::vector<::hybridse::vm::PartialAggMerge>& merges);
+
+    // Merge all rows of `result_set`, return false if the schema mismatches
+    bool Add(const std::shared_ptr<::hybridse::sdk::ResultSet>& result_set);
+
+    std::shared_ptr<::hybridse::sdk::ResultSet> GetResultSet();
+
+ private:
+    struct Cell {
+        bool is_null = true;
+        int64_t i = 0;
+        double d = 0;
+        std::string s;
+    };
+
+    bool Read(::hybridse::sdk::ResultSet* result_set, uint32_t idx, Cell* cell);
+
+    void Merge(uint32_t idx, const Cell& cell, Cell* result);
+
+    bool IsFloating(uint32_t idx) const;
+
+ private:
+    ::hybridse::vm::Schema schema_;
+    std::vector<::hybridse::vm::PartialAggMerge> merges_;
+    std::vector<std::vector<Cell>> rows_;
+    // serialized group keys to the index of `rows_`
+    std::map<std::string, size_t> groups_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+#endif  // SRC_SDK_PARTIAL_AGG_MERGER_H_
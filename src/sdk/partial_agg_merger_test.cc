@@ -0,0 +1,162 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/partial_agg_merger.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "brpc/controller.h"
+#include "codec/fe_row_codec.h"
+#include "gtest/gtest.h"
+#include "sdk/result_set_sql.h"
+
+namespace openmldb {
+namespace sdk {
+
+class PartialAggMergerTest : public ::testing::Test {};
+
+struct AggRow {
+    bool key_is_null;
+    std::string key;
+    int64_t cnt;
+    double sum;
+    int32_t min;
+};
+
+static ::hybridse::vm::Schema MakeSchema() {
+    ::hybridse::vm::Schema schema;
+    auto col = schema.Add();
+    col->set_name("key");
+    col->set_type(::hybridse::type::kVarchar);
+    col = schema.Add();
+    col->set_name("cnt");
+    col->set_type(::hybridse::type::kInt64);
+    col = schema.Add();
+    col->set_name("sum");
+    col->set_type(::hybridse::type::kDouble);
+    col = schema.Add();
+    col->set_name("min");
+    col->set_type(::hybridse::type::kInt32);
+    return schema;
+}
+
+static std::shared_ptr<::hybridse::sdk::ResultSet> MakeFragment(const std::vector<AggRow>& rows) {
+    auto schema = MakeSchema();
+    ::hybridse::codec::RowBuilder builder(schema);
+    auto cntl = std::make_shared<::brpc::Controller>();
+    uint32_t byte_size = 0;
+    for (auto& row : rows) {
+        uint32_t size = builder.CalTotalLength(row.key.size());
+        std::string buf(size, '\0');
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&buf[0]), size);
+        if (row.key_is_null) {
+            builder.AppendNULL();
+        } else {
+            builder.AppendString(row.key.data(), row.key.size());
+        }
+        builder.AppendInt64(row.cnt);
+        builder.AppendDouble(row.sum);
+        builder.AppendInt32(row.min);
+        cntl->response_attachment().append(buf);
+        byte_size += size;
+    }
+    auto rs = std::make_shared<ResultSetSQL>(schema, rows.size(), byte_size, cntl);
+    rs->Init();
+    return rs;
+}
+
+TEST_F(PartialAggMergerTest, merge_groups) {
+    std::vector<::hybridse::vm::PartialAggMerge> merges = {
+        ::hybridse::vm::kMergeByKey, ::hybridse::vm::kMergeBySum, ::hybridse::vm::kMergeBySum,
+        ::hybridse::vm::kMergeByMin};
+    PartialAggMerger merger(MakeSchema(), merges);
+    ASSERT_TRUE(merger.Add(MakeFragment({{false, "a", 2, 1.5, 3}, {false, "", 1, 1.0, 7}})));
+    ASSERT_TRUE(merger.Add(MakeFragment({})));
+    ASSERT_TRUE(merger.Add(MakeFragment({{true, "", 4, 2.0, 5}, {false, "a", 3, 2.5, -1}})));
+    ASSERT_TRUE(merger.Add(MakeFragment({{false, "", 1, 0.5, 9}})));
+
+    auto rs = merger.GetResultSet();
+    ASSERT_EQ(3, rs->Size());
+    // groups are in the order they are first seen
+    std::vector<AggRow> expect = {{false, "a", 5, 4.0, -1}, {false, "", 2, 1.5, 7}, {true, "", 4, 2.0, 5}};
+    for (auto& row : expect) {
+        ASSERT_TRUE(rs->Next());
+        ASSERT_EQ(row.key_is_null, rs->IsNULL(0));
+        if (!row.key_is_null) {
+            std::string key;
+            ASSERT_TRUE(rs->GetString(0, &key));
+            ASSERT_EQ(row.key, key);
+        }
+        ASSERT_EQ(row.cnt, rs->GetInt64Unsafe(1));
+        ASSERT_DOUBLE_EQ(row.sum, rs->GetDoubleUnsafe(2));
+        ASSERT_EQ(row.min, rs->GetInt32Unsafe(3));
+    }
+    ASSERT_FALSE(rs->Next());
+}
+
+TEST_F(PartialAggMergerTest, merge_groups_by_all_keys) {
+    // groups of `key, cnt`, which differ only in cnt, are not merged. The
+    // router scatters a query only if all of its group keys are in the output,
+    // since groups that differ only in a key not in the output can not be told
+    // apart here
+    std::vector<::hybridse::vm::PartialAggMerge> merges = {
+        ::hybridse::vm::kMergeByKey, ::hybridse::vm::kMergeByKey, ::hybridse::vm::kMergeBySum,
+        ::hybridse::vm::kMergeByMin};
+    PartialAggMerger merger(MakeSchema(), merges);
+    ASSERT_TRUE(merger.Add(MakeFragment({{false, "a", 1, 1.5, 3}, {false, "a", 2, 1.0, 7}})));
+    ASSERT_TRUE(merger.Add(MakeFragment({{false, "a", 2, 2.0, 5}})));
+
+    auto rs = merger.GetResultSet();
+    ASSERT_EQ(2, rs->Size());
+    std::vector<AggRow> expect = {{false, "a", 1, 1.5, 3}, {false, "a", 2, 3.0, 5}};
+    for (auto& row : expect) {
+        ASSERT_TRUE(rs->Next());
+        ASSERT_EQ(row.key, rs->GetStringUnsafe(0));
+        ASSERT_EQ(row.cnt, rs->GetInt64Unsafe(1));
+        ASSERT_DOUBLE_EQ(row.sum, rs->GetDoubleUnsafe(2));
+        ASSERT_EQ(row.min, rs->GetInt32Unsafe(3));
+    }
+    ASSERT_FALSE(rs->Next());
+}
+
+TEST_F(PartialAggMergerTest, merge_global) {
+    std::vector<::hybridse::vm::PartialAggMerge> merges = {
+        ::hybridse::vm::kMergeByMax, ::hybridse::vm::kMergeBySum, ::hybridse::vm::kMergeBySum,
+        ::hybridse::vm::kMergeByMax};
+    PartialAggMerger merger(MakeSchema(), merges);
+    ASSERT_TRUE(merger.Add(MakeFragment({{false, "b", 2, 1.5, 3}})));
+    ASSERT_TRUE(merger.Add(MakeFragment({{true, "", 0, 0, 0}})));
+    ASSERT_TRUE(merger.Add(MakeFragment({{false, "c", 3, 2.5, -1}})));
+
+    auto rs = merger.GetResultSet();
+    ASSERT_EQ(1, rs->Size());
+    ASSERT_TRUE(rs->Next());
+    // null is skipped by max
+    ASSERT_EQ("c", rs->GetStringUnsafe(0));
+    ASSERT_EQ(5, rs->GetInt64Unsafe(1));
+    ASSERT_DOUBLE_EQ(4.0, rs->GetDoubleUnsafe(2));
+    ASSERT_EQ(3, rs->GetInt32Unsafe(3));
+}
+
+}  // namespace sdk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/replica_selector.h"
+
+#include <set>
+
+#include "boost/bind.hpp"
+#include "common/timer.h"
+#include "glog/logging.h"
+
+namespace openmldb {
+namespace sdk {
+
+ReplicaSelector::ReplicaSelector(uint64_t refresh_interval_ms, const std::shared_ptr<LatencyTracker>& latency_tracker)
+    : refresh_interval_ms_(refresh_interval_ms),
+      latency_tracker_(latency_tracker),
+      mu_(),
+      replica_lags_(),
+      pool_(1) {}
+
+ReplicaSelector::~ReplicaSelector() { pool_.Stop(false); }
+
+std::shared_ptr<::openmldb::catalog::TabletAccessor> ReplicaSelector::Select(
+    uint32_t tid, uint32_t pid, const std::shared_ptr<::openmldb::catalog::PartitionClientManager>& partition,
+    uint64_t max_offset_lag) {
+    if (!partition) {
+        return std::shared_ptr<::openmldb::catalog::TabletAccessor>();
+    }
+    auto leader = partition->GetLeader();
+    if (partition->GetFollowers().empty()) {
+        return leader;
+    }
+    std::set<std::string> readable_followers;
+    bool need_refresh = false;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto& replica_lag = replica_lags_[std::make_pair(tid, pid)];
+        uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+        // only one caller refreshes the lags, the others read the last ones
+        if (!replica_lag.refreshing && cur_time >= replica_lag.update_time + refresh_interval_ms_) {
+            replica_lag.refreshing = true;
+            need_refresh = true;
+        }
+        for (const auto& kv : replica_lag.lags) {
+            if (kv.second <= max_offset_lag) {
+                readable_followers.insert(kv.first);
+            }
+        }
+    }
+    if (need_refresh) {
+        pool_.AddTask(boost::bind(&ReplicaSelector::Refresh, this, tid, pid, leader));
+    }
+    auto replica = partition->GetReplica(readable_followers);
+    if (!latency_tracker_ || !replica) {
+        return replica;
+    }
+    auto other = partition->GetReplica(readable_followers);
+    if (latency_tracker_->GetAverage(other->GetName()) < latency_tracker_->GetAverage(replica->GetName())) {
+        return other;
+    }
+    return replica;
+}
+
+void ReplicaSelector::Update(uint32_t tid, uint32_t pid, uint64_t offset,
+                             const std::map<std::string, uint64_t>& follower_offsets) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto& replica_lag = replica_lags_[std::make_pair(tid, pid)];
+    replica_lag.update_time = ::baidu::common::timer::get_micros() / 1000;
+    replica_lag.refreshing = false;
+    replica_lag.lags.clear();
+    for (const auto& kv : follower_offsets) {
+        replica_lag.lags.emplace(kv.first, offset > kv.second ? offset - kv.second : 0);
+    }
+}
+
+void ReplicaSelector::Refresh(uint32_t tid, uint32_t pid,
+                              const std::shared_ptr<::openmldb::catalog::TabletAccessor>& leader) {
+    uint64_t offset = 0;
+    std::map<std::string, uint64_t> follower_offsets;
+    auto client = leader ? leader->GetClient() : std::shared_ptr<::openmldb::client::TabletClient>();
+    std::string msg;
+    if (!client || !client->GetTableFollower(tid, pid, offset, follower_offsets, msg)) {
+        // read the leader only until the next refresh
+        LOG(WARNING) << "fail to get the followers of tid " << tid << " pid " << pid << ", msg " << msg;
+        follower_offsets.clear();
+    }
+    Update(tid, pid, offset, follower_offsets);
+}
+
+}  // namespace sdk
+}  // namespace openmldb
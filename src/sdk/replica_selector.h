@@ -0,0 +1,76 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_REPLICA_SELECTOR_H_
+#define SRC_SDK_REPLICA_SELECTOR_H_
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+
+#include "catalog/client_manager.h"
+#include "common/thread_pool.h"
+#include "sdk/latency_tracker.h"
+
+namespace openmldb {
+namespace sdk {
+
+/**
+ * Pick the replica of a partition to read from, which is the leader or a
+ * follower whose replication offset lags behind the leader within a bound.
+ * The offsets of the followers are refreshed from the leader, see
+ * `LogReplicator::GetReplicateInfo`, at most once per `refresh_interval_ms`
+ * in the background, and a replica is selected by the last offsets only, so
+ * the lag is bounded as of the last refresh. With a latency tracker, the
+ * faster one of two random replicas is picked.
+ */
+class ReplicaSelector {
+ public:
+    explicit ReplicaSelector(uint64_t refresh_interval_ms,
+                             const std::shared_ptr<LatencyTracker>& latency_tracker = nullptr);
+    ~ReplicaSelector();
+
+    std::shared_ptr<::openmldb::catalog::TabletAccessor> Select(
+        uint32_t tid, uint32_t pid, const std::shared_ptr<::openmldb::catalog::PartitionClientManager>& partition,
+        uint64_t max_offset_lag);
+
+    // update the offsets of the leader and the followers of a partition
+    void Update(uint32_t tid, uint32_t pid, uint64_t offset, const std::map<std::string, uint64_t>& follower_offsets);
+
+ private:
+    struct ReplicaLag {
+        uint64_t update_time = 0;
+        bool refreshing = false;
+        // the lag of each follower endpoint
+        std::map<std::string, uint64_t> lags;
+    };
+
+    void Refresh(uint32_t tid, uint32_t pid, const std::shared_ptr<::openmldb::catalog::TabletAccessor>& leader);
+
+ private:
+    const uint64_t refresh_interval_ms_;
+    std::shared_ptr<LatencyTracker> latency_tracker_;
+    std::mutex mu_;
+    std::map<std::pair<uint32_t, uint32_t>, ReplicaLag> replica_lags_;
+    // refreshes the offsets off the query path
+    ::baidu::common::ThreadPool pool_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+#endif  // SRC_SDK_REPLICA_SELECTOR_H_
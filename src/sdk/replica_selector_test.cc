@@ -0,0 +1,112 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/replica_selector.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace sdk {
+
+using ::openmldb::catalog::PartitionClientManager;
+using ::openmldb::catalog::TabletAccessor;
+
+class ReplicaSelectorTest : public ::testing::Test {};
+
+static std::shared_ptr<PartitionClientManager> MakePartition() {
+    std::vector<std::shared_ptr<TabletAccessor>> followers = {std::make_shared<TabletAccessor>("follower1"),
+                                                              std::make_shared<TabletAccessor>("follower2")};
+    return std::make_shared<PartitionClientManager>(0, std::make_shared<TabletAccessor>("leader"), followers);
+}
+
+static std::map<std::string, int> CountSelected(ReplicaSelector* selector,
+                                                const std::shared_ptr<PartitionClientManager>& partition,
+                                                uint64_t max_offset_lag) {
+    std::map<std::string, int> cnt;
+    for (int i = 0; i < 300; i++) {
+        auto tablet = selector->Select(1, 0, partition, max_offset_lag);
+        if (tablet) {
+            cnt[tablet->GetName()]++;
+        }
+    }
+    return cnt;
+}
+
+TEST_F(ReplicaSelectorTest, select_within_lag) {
+    // the lags are not refreshed during the test
+    ReplicaSelector selector(3600 * 1000);
+    auto partition = MakePartition();
+    selector.Update(1, 0, 100, {{"follower1", 95}, {"follower2", 50}});
+
+    auto cnt = CountSelected(&selector, partition, 10);
+    ASSERT_EQ(2u, cnt.size());
+    ASSERT_GT(cnt["leader"], 0);
+    ASSERT_GT(cnt["follower1"], 0);
+
+    cnt = CountSelected(&selector, partition, 50);
+    ASSERT_EQ(3u, cnt.size());
+
+    cnt = CountSelected(&selector, partition, 0);
+    ASSERT_EQ(1u, cnt.size());
+    ASSERT_EQ(300, cnt["leader"]);
+
+    // a follower which is ahead of the offset is not lagging
+    selector.Update(1, 0, 100, {{"follower1", 101}});
+    cnt = CountSelected(&selector, partition, 0);
+    ASSERT_EQ(2u, cnt.size());
+    ASSERT_GT(cnt["follower1"], 0);
+}
+
+TEST_F(ReplicaSelectorTest, select_faster) {
+    auto latency_tracker = std::make_shared<LatencyTracker>();
+    latency_tracker->Record("leader", 5000);
+    latency_tracker->Record("follower1", 100);
+    latency_tracker->Record("follower2", 1000);
+    ReplicaSelector selector(3600 * 1000, latency_tracker);
+    auto partition = MakePartition();
+    selector.Update(1, 0, 100, {{"follower1", 100}, {"follower2", 100}});
+    auto cnt = CountSelected(&selector, partition, 0);
+    // the slowest one is picked only if it is drawn twice
+    ASSERT_GT(cnt["follower1"], cnt["follower2"]);
+    ASSERT_GT(cnt["follower2"], cnt["leader"]);
+}
+
+TEST_F(ReplicaSelectorTest, refresh_fail) {
+    ReplicaSelector selector(3600 * 1000);
+    // the leader has no client, so the lags can not be refreshed
+    auto cnt = CountSelected(&selector, MakePartition(), 1000);
+    ASSERT_EQ(1u, cnt.size());
+    ASSERT_EQ(300, cnt["leader"]);
+
+    auto leader = std::make_shared<TabletAccessor>("leader");
+    auto no_follower =
+        std::make_shared<PartitionClientManager>(0, leader, std::vector<std::shared_ptr<TabletAccessor>>());
+    ASSERT_EQ(leader, selector.Select(1, 0, no_follower, 1000));
+    ASSERT_FALSE(selector.Select(1, 0, std::shared_ptr<PartitionClientManager>(), 1000));
+}
+
+}  // namespace sdk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/request_coalescer.h"
+
+#include <chrono>  // NOLINT
+
+#include "glog/logging.h"
+#include "sdk/batch_request_result_set_sql.h"
+
+namespace openmldb {
+namespace sdk {
+
+RequestCoalescer::RequestCoalescer(uint32_t window_us, uint32_t max_batch_size)
+    : window_us_(window_us), max_batch_size_(max_batch_size > 0 ? max_batch_size : 1), mu_(), pending_() {}
+
+std::shared_ptr<::hybridse::sdk::ResultSet> RequestCoalescer::Call(const std::string& key,
+                                                                   const std::shared_ptr<SQLRequestRow>& row,
+                                                                   const BatchRunner& runner,
+                                                                   ::hybridse::sdk::Status* status) {
+    std::unique_lock<std::mutex> lock(mu_);
+    auto& pending = pending_[key];
+    bool is_leader = !pending;
+    if (is_leader) {
+        pending = std::make_shared<Batch>();
+    }
+    auto batch = pending;
+    size_t idx = batch->rows.size();
+    batch->rows.push_back(row);
+    if (batch->rows.size() >= max_batch_size_) {
+        batch->sealed = true;
+        pending_.erase(key);
+        batch->cv.notify_all();
+    }
+    if (is_leader) {
+        batch->cv.wait_for(lock, std::chrono::microseconds(window_us_), [&batch] { return batch->sealed; });
+        if (!batch->sealed) {
+            batch->sealed = true;
+            pending_.erase(key);
+        }
+        lock.unlock();
+        bool ok = runner(batch->rows, &batch->results, &batch->status);
+        if (ok && batch->results.size() != batch->rows.size()) {
+            batch->status.code = -1;
+            batch->status.msg = "result count " + std::to_string(batch->results.size()) + " mismatch request count " +
+                                std::to_string(batch->rows.size());
+            ok = false;
+        }
+        if (!ok && batch->status.code == 0) {
+            batch->status.code = -1;
+        }
+        lock.lock();
+        batch->done = true;
+        batch->cv.notify_all();
+    } else {
+        batch->cv.wait(lock, [&batch] { return batch->done; });
+    }
+    if (batch->status.code != 0) {
+        status->code = batch->status.code;
+        status->msg = batch->status.msg;
+        return std::shared_ptr<::hybridse::sdk::ResultSet>();
+    }
+    return batch->results[idx];
+}
+
+bool RequestCoalescer::SplitResponse(const std::shared_ptr<::openmldb::api::SQLBatchRequestQueryResponse>& response,
+                                     const std::shared_ptr<brpc::Controller>& cntl,
+                                     std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>>* results) {
+    uint32_t common_cnt = response->common_slices() > 0 ? 1 : 0;
+    if (static_cast<uint32_t>(response->row_sizes_size()) != response->count() + common_cnt) {
+        LOG(WARNING) << "row sizes " << response->row_sizes_size() << " mismatch count " << response->count();
+        return false;
+    }
+    auto& buf = cntl->response_attachment();
+    uint32_t common_size = common_cnt > 0 ? response->row_sizes(0) : 0;
+    size_t offset = common_size;
+    for (uint32_t i = 0; i < response->count(); i++) {
+        auto row_response = std::make_shared<::openmldb::api::SQLBatchRequestQueryResponse>();
+        row_response->set_code(response->code());
+        row_response->set_schema(response->schema());
+        *row_response->mutable_common_column_indices() = response->common_column_indices();
+        row_response->set_common_slices(response->common_slices());
+        row_response->set_non_common_slices(response->non_common_slices());
+        row_response->set_count(1);
+        auto row_cntl = std::make_shared<brpc::Controller>();
+        if (common_cnt > 0) {
+            buf.append_to(&row_cntl->response_attachment(), common_size, 0);
+            row_response->add_row_sizes(common_size);
+        }
+        uint32_t row_size = response->row_sizes(common_cnt + i);
+        buf.append_to(&row_cntl->response_attachment(), row_size, offset);
+        row_response->add_row_sizes(row_size);
+        offset += row_size;
+        auto rs = std::make_shared<SQLBatchRequestResultSet>(row_response, row_cntl);
+        if (!rs->Init()) {
+            return false;
+        }
+        results->push_back(rs);
+    }
+    return true;
+}
+
+}  // namespace sdk
+}  // namespace openmldb
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_SDK_REQUEST_COALESCER_H_
+#define SRC_SDK_REQUEST_COALESCER_H_
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "brpc/controller.h"
+#include "proto/tablet.pb.h"
+#include "sdk/base.h"
+#include "sdk/result_set.h"
+#include "sdk/sql_request_row.h"
+
+namespace openmldb {
+namespace sdk {
+
+/**
+ * Coalesce the concurrent single row requests with the same key, e.g. calls
+ * of one procedure on one tablet, into batch requests. The first request of a
+ * batch waits at most `window_us` for the others, or until there are
+ * `max_batch_size` rows, and then runs the whole batch for all of them.
+ */
+class RequestCoalescer {
+ public:
+    // Run `rows` as a batch and fill one result set for each row in order
+    typedef std::function<bool(const std::vector<std::shared_ptr<SQLRequestRow>>& rows,
+                               std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>>* results,
+                               ::hybridse::sdk::Status* status)>
+        BatchRunner;
+
+    RequestCoalescer(uint32_t window_us, uint32_t max_batch_size);
+
+    std::shared_ptr<::hybridse::sdk::ResultSet> Call(const std::string& key, const std::shared_ptr<SQLRequestRow>& row,
+                                                     const BatchRunner& runner, ::hybridse::sdk::Status* status);
+
+    // Split the response of a batch request into the result sets of each row,
+    // which share the buffers of the response
+    static bool SplitResponse(const std::shared_ptr<::openmldb::api::SQLBatchRequestQueryResponse>& response,
+                              const std::shared_ptr<brpc::Controller>& cntl,
+                              std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>>* results);
+
+ private:
+    struct Batch {
+        std::vector<std::shared_ptr<SQLRequestRow>> rows;
+        std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>> results;
+        ::hybridse::sdk::Status status;
+        // no more rows are added
+        bool sealed = false;
+        bool done = false;
+        std::condition_variable cv;
+    };
+
+ private:
+    const uint32_t window_us_;
+    const uint32_t max_batch_size_;
+    std::mutex mu_;
+    // the batches not sealed yet
+    std::map<std::string, std::shared_ptr<Batch>> pending_;
+};
+
+}  // namespace sdk
+}  // namespace openmldb
+#endif  // SRC_SDK_REQUEST_COALESCER_H_
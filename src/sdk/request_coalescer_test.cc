@@ -0,0 +1,142 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/request_coalescer.h"
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "codec/fe_schema_codec.h"
+#include "gtest/gtest.h"
+#include "sdk/base_impl.h"
+
+namespace openmldb {
+namespace sdk {
+
+class RequestCoalescerTest : public ::testing::Test {};
+
+static ::hybridse::vm::Schema MakeSchema() {
+    ::hybridse::vm::Schema schema;
+    auto column = schema.Add();
+    column->set_type(::hybridse::type::kInt64);
+    column->set_name("col0");
+    return schema;
+}
+
+static std::shared_ptr<SQLRequestRow> MakeRow(int64_t val) {
+    std::shared_ptr<::hybridse::sdk::Schema> schema(new ::hybridse::sdk::SchemaImpl(MakeSchema()));
+    auto row = std::make_shared<SQLRequestRow>(schema, std::set<std::string>());
+    row->Init(0);
+    row->AppendInt64(val);
+    row->Build();
+    return row;
+}
+
+// echo the request rows as the response of a batch request
+static bool EchoRows(const std::vector<std::shared_ptr<SQLRequestRow>>& rows,
+                     std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>>* results,
+                     ::hybridse::sdk::Status* status) {
+    auto response = std::make_shared<::openmldb::api::SQLBatchRequestQueryResponse>();
+    auto cntl = std::make_shared<brpc::Controller>();
+    std::string schema;
+    ::hybridse::codec::SchemaCodec::Encode(MakeSchema(), &schema);
+    response->set_schema(schema);
+    response->set_common_slices(0);
+    response->set_non_common_slices(1);
+    for (auto& row : rows) {
+        cntl->response_attachment().append(row->GetRow());
+        response->add_row_sizes(row->GetRow().size());
+    }
+    response->set_count(rows.size());
+    response->set_code(0);
+    return RequestCoalescer::SplitResponse(response, cntl, results);
+}
+
+TEST_F(RequestCoalescerTest, split_response) {
+    std::vector<std::shared_ptr<SQLRequestRow>> rows = {MakeRow(1), MakeRow(2), MakeRow(3)};
+    std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>> results;
+    ::hybridse::sdk::Status status;
+    ASSERT_TRUE(EchoRows(rows, &results, &status));
+    ASSERT_EQ(3u, results.size());
+    for (int64_t i = 0; i < 3; i++) {
+        ASSERT_EQ(1, results[i]->Size());
+        ASSERT_TRUE(results[i]->Next());
+        ASSERT_EQ(i + 1, results[i]->GetInt64Unsafe(0));
+        ASSERT_FALSE(results[i]->Next());
+    }
+}
+
+TEST_F(RequestCoalescerTest, coalesce) {
+    // the window is long enough for all threads to join the batches
+    RequestCoalescer coalescer(2000000, 4);
+    std::atomic<int> batch_cnt(0);
+    auto runner = [&batch_cnt](const std::vector<std::shared_ptr<SQLRequestRow>>& rows,
+                               std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>>* results,
+                               ::hybridse::sdk::Status* status) {
+        batch_cnt++;
+        return EchoRows(rows, results, status);
+    };
+    std::vector<std::thread> threads;
+    std::atomic<int> ok_cnt(0);
+    for (int64_t i = 0; i < 8; i++) {
+        threads.emplace_back([&, i] {
+            ::hybridse::sdk::Status status;
+            auto rs = coalescer.Call("key", MakeRow(i), runner, &status);
+            if (rs && rs->Next() && rs->GetInt64Unsafe(0) == i) {
+                ok_cnt++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(8, ok_cnt.load());
+    // batches are sealed by the size
+    ASSERT_EQ(2, batch_cnt.load());
+}
+
+TEST_F(RequestCoalescerTest, window_and_error) {
+    RequestCoalescer coalescer(1000, 64);
+    auto fail = [](const std::vector<std::shared_ptr<SQLRequestRow>>& rows,
+                   std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>>* results,
+                   ::hybridse::sdk::Status* status) {
+        status->code = -1;
+        status->msg = "fail";
+        return false;
+    };
+    ::hybridse::sdk::Status status;
+    // a single request is run when the window is over
+    ASSERT_FALSE(coalescer.Call("key", MakeRow(1), fail, &status));
+    ASSERT_EQ(-1, status.code);
+    ASSERT_EQ("fail", status.msg);
+
+    status = ::hybridse::sdk::Status();
+    auto rs = coalescer.Call("key", MakeRow(2), EchoRows, &status);
+    ASSERT_TRUE(rs);
+    ASSERT_TRUE(rs->Next());
+    ASSERT_EQ(2, rs->GetInt64Unsafe(0));
+}
+
+}  // namespace sdk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -30,7 +30,8 @@ ResultSetBase::ResultSetBase(const std::shared_ptr<brpc::Controller>& cntl, uint
       row_view_(std::move(row_view)),
       schema_(),
       position_(0),
-      index_(-1) {
+      index_(-1),
+      remaining_(cntl->response_attachment()) {
     schema_.SetSchema(schema);
 }
 
@@ -39,6 +40,7 @@ ResultSetBase::~ResultSetBase() {}
 bool ResultSetBase::Reset() {
     index_ = -1;
     position_ = 0;
+    remaining_ = cntl_->response_attachment();
     return true;
 }
 
@@ -47,10 +49,10 @@ bool ResultSetBase::Next() {
     if (index_ < static_cast<int32_t>(count_) && position_ < buf_size_) {
         // get row size
         uint32_t row_size = 0;
-        cntl_->response_attachment().copy_to(reinterpret_cast<void*>(&row_size), 4, position_ + 2);
+        remaining_.copy_to(reinterpret_cast<void*>(&row_size), 4, 2);
         DLOG(INFO) << "row size " << row_size << " position " << position_ << " byte size " << buf_size_;
         butil::IOBuf tmp;
-        cntl_->response_attachment().append_to(&tmp, row_size, position_);
+        remaining_.cutn(&tmp, row_size);
         position_ += row_size;
         bool ok = row_view_->Reset(tmp);
         if (!ok) {
@@ -69,11 +71,12 @@ bool ResultSetBase::GetString(uint32_t index, std::string* str) {
         LOG(WARNING) << "input ptr is null pointer";
         return false;
     }
-    butil::IOBuf tmp;
-    int32_t ret = row_view_->GetString(index, &tmp);
+    char* data = nullptr;
+    uint32_t size = 0;
+    int32_t ret = row_view_->GetString(index, &data, &size);
     if (ret == 0) {
-        DLOG(INFO) << "get str size " << tmp.size();
-        tmp.append_to(str, tmp.size(), 0);
+        DLOG(INFO) << "get str size " << size;
+        str->assign(data, size);
         return true;
     }
     DLOG(INFO) << "fail to get string with ret " << ret;
@@ -73,6 +73,8 @@ class ResultSetBase {
     ::hybridse::sdk::SchemaImpl schema_;
     uint32_t position_;
     int32_t index_;
+    // the rows after position_, which share the blocks of the attachment
+    butil::IOBuf remaining_;
 };
 
 }  // namespace sdk
@@ -31,9 +31,25 @@ namespace sdk {
 
 ResultSetSQL::ResultSetSQL(const ::hybridse::vm::Schema& schema, uint32_t record_cnt, uint32_t buf_size,
                            const std::shared_ptr<brpc::Controller>& cntl)
-    : schema_(schema), record_cnt_(record_cnt), buf_size_(buf_size), cntl_(cntl), result_set_base_(nullptr) {}
+    : schema_(schema),
+      record_cnt_(record_cnt),
+      buf_size_(buf_size),
+      cntl_(cntl),
+      result_set_base_(nullptr),
+      client_(),
+      cursor_id_(0),
+      has_more_(false),
+      total_cnt_(record_cnt),
+      chunk_idx_(0),
+      status_() {}
 
-ResultSetSQL::~ResultSetSQL() { delete result_set_base_; }
+ResultSetSQL::~ResultSetSQL() {
+    delete result_set_base_;
+    if (has_more_ && client_) {
+        // release the rows not fetched on tablet
+        client_->CloseQueryCursor(cursor_id_);
+    }
+}
 
 bool ResultSetSQL::Init() {
     std::unique_ptr<::hybridse::sdk::RowIOBufView> row_view(new ::hybridse::sdk::RowIOBufView(schema_));
@@ -66,6 +82,72 @@ std::shared_ptr<::hybridse::sdk::ResultSet> ResultSetSQL::MakeResultSet(
     return rs;
 }
 
+void ResultSetSQL::SetCursor(const std::shared_ptr<::openmldb::client::TabletClient>& client, uint64_t cursor_id,
+                             uint32_t total_cnt) {
+    client_ = client;
+    cursor_id_ = cursor_id;
+    has_more_ = true;
+    total_cnt_ = total_cnt;
+}
+
+bool ResultSetSQL::Reset() {
+    if (status_.code != 0) {
+        return false;
+    }
+    if (chunk_idx_ > 0) {
+        LOG(WARNING) << "can not reset result set after the first chunk is read, the rows are released";
+        return false;
+    }
+    return result_set_base_->Reset();
+}
+
+bool ResultSetSQL::Next() {
+    if (status_.code != 0) {
+        LOG(WARNING) << "result set is broken: " << status_.msg;
+        return false;
+    }
+    while (!result_set_base_->Next()) {
+        if (!has_more_ || !FetchNextChunk()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ResultSetSQL::FetchNextChunk() {
+    auto cntl = std::make_shared<::brpc::Controller>();
+    cntl->set_timeout_ms(cntl_->timeout_ms());
+    ::openmldb::api::QueryResponse response;
+    if (!client_->FetchQuery(cursor_id_, cntl.get(), &response)) {
+        // the rows left on the tablet are lost, e.g. the cursor is expired
+        status_.code = response.code() != 0 ? response.code() : -1;
+        status_.msg = "fail to fetch the next chunk of result set from " + client_->GetEndpoint() + ": " +
+                      (cntl->Failed() ? cntl->ErrorText() : response.msg());
+        LOG(WARNING) << status_.msg;
+        has_more_ = false;
+        return false;
+    }
+    DLOG(INFO) << "fetch chunk " << chunk_idx_ + 1 << " with record cnt " << response.count();
+    has_more_ = response.has_more();
+    cntl_ = cntl;
+    record_cnt_ = response.count();
+    buf_size_ = response.byte_size();
+    chunk_idx_++;
+    delete result_set_base_;
+    return Init();
+}
+
+std::shared_ptr<::hybridse::sdk::ResultSet> ResultSetSQL::MakeResultSet(
+    const std::shared_ptr<::openmldb::api::QueryResponse>& response, const std::shared_ptr<brpc::Controller>& cntl,
+    const std::shared_ptr<::openmldb::client::TabletClient>& client, ::hybridse::sdk::Status* status) {
+    auto rs = MakeResultSet(response, cntl, status);
+    if (rs && client && response->has_more()) {
+        std::dynamic_pointer_cast<ResultSetSQL>(rs)->SetCursor(client, response->cursor_id(),
+                                                               response->total_count());
+    }
+    return rs;
+}
+
 std::shared_ptr<::hybridse::sdk::ResultSet> ResultSetSQL::MakeResultSet(
     const std::shared_ptr<::openmldb::api::ScanResponse>& response,
     const ::google::protobuf::RepeatedField<uint32_t>& projection, const std::shared_ptr<brpc::Controller>& cntl,
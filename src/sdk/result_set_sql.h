@@ -22,6 +22,7 @@
 
 #include "brpc/controller.h"
 #include "butil/iobuf.h"
+#include "client/tablet_client.h"
 #include "proto/tablet.pb.h"
 #include "sdk/base_impl.h"
 #include "sdk/codec_sdk.h"
@@ -42,6 +43,12 @@ class ResultSetSQL : public ::hybridse::sdk::ResultSet {
         const std::shared_ptr<::openmldb::api::QueryResponse>& response, const std::shared_ptr<brpc::Controller>& cntl,
         ::hybridse::sdk::Status* status);
 
+    // The rows beyond the first chunk are fetched from the cursor of `client`
+    // on demand, if the response has more rows
+    static std::shared_ptr<::hybridse::sdk::ResultSet> MakeResultSet(
+        const std::shared_ptr<::openmldb::api::QueryResponse>& response, const std::shared_ptr<brpc::Controller>& cntl,
+        const std::shared_ptr<::openmldb::client::TabletClient>& client, ::hybridse::sdk::Status* status);
+
     static std::shared_ptr<::hybridse::sdk::ResultSet> MakeResultSet(
         const std::shared_ptr<::openmldb::api::ScanResponse>& response,
         const ::google::protobuf::RepeatedField<uint32_t>& projection, const std::shared_ptr<brpc::Controller>& cntl,
@@ -49,9 +56,19 @@ class ResultSetSQL : public ::hybridse::sdk::ResultSet {
 
     bool Init();
 
-    bool Reset() { return result_set_base_->Reset(); }
+    void SetCursor(const std::shared_ptr<::openmldb::client::TabletClient>& client, uint64_t cursor_id,
+                   uint32_t total_cnt);
+
+    // Rewind to the first row. The rows of a cursor are not kept after their
+    // chunk is read, so it returns false and keeps the current row once Next()
+    // has moved beyond the first chunk. Run the query again to read it twice.
+    bool Reset();
 
-    bool Next() { return result_set_base_->Next(); }
+    // Return false at the end of rows, or if the next chunk can not be
+    // fetched, which is told apart by GetStatus()
+    bool Next();
+
+    ::hybridse::sdk::Status GetStatus() { return status_; }
 
     bool IsNULL(int index) { return result_set_base_->IsNULL(index); }
 
@@ -81,7 +98,10 @@ class ResultSetSQL : public ::hybridse::sdk::ResultSet {
 
     const ::hybridse::sdk::Schema* GetSchema() { return result_set_base_->GetSchema(); }
 
-    int32_t Size() { return result_set_base_->Size(); }
+    int32_t Size() { return client_ ? total_cnt_ : result_set_base_->Size(); }
+
+ private:
+    bool FetchNextChunk();
 
  private:
     ::hybridse::vm::Schema schema_;
@@ -89,6 +109,14 @@ class ResultSetSQL : public ::hybridse::sdk::ResultSet {
     uint32_t buf_size_;
     std::shared_ptr<brpc::Controller> cntl_;
     ResultSetBase* result_set_base_;
+    // cursor of the remaining rows
+    std::shared_ptr<::openmldb::client::TabletClient> client_;
+    uint64_t cursor_id_;
+    bool has_more_;
+    uint32_t total_cnt_;
+    uint32_t chunk_idx_;
+    // not ok once a chunk fails to be fetched, then Next() always fails
+    ::hybridse::sdk::Status status_;
 };
 
 }  // namespace sdk
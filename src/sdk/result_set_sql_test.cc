@@ -0,0 +1,115 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sdk/result_set_sql.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "brpc/controller.h"
+#include "codec/fe_row_codec.h"
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace sdk {
+
+class ResultSetSQLTest : public ::testing::Test {};
+
+static ::hybridse::vm::Schema MakeSchema() {
+    ::hybridse::vm::Schema schema;
+    auto col = schema.Add();
+    col->set_name("id");
+    col->set_type(::hybridse::type::kInt32);
+    col = schema.Add();
+    col->set_name("name");
+    col->set_type(::hybridse::type::kVarchar);
+    col = schema.Add();
+    col->set_name("score");
+    col->set_type(::hybridse::type::kFloat);
+    return schema;
+}
+
+// rows of (i, "name<i>", i / 2), and the scores of odd rows are null
+static std::shared_ptr<ResultSetSQL> MakeResultSet(int32_t cnt) {
+    auto schema = MakeSchema();
+    ::hybridse::codec::RowBuilder builder(schema);
+    auto cntl = std::make_shared<::brpc::Controller>();
+    uint32_t byte_size = 0;
+    for (int32_t i = 0; i < cnt; i++) {
+        std::string name = "name" + std::to_string(i);
+        uint32_t size = builder.CalTotalLength(name.size());
+        std::string buf(size, '\0');
+        builder.SetBuffer(reinterpret_cast<int8_t*>(&buf[0]), size);
+        builder.AppendInt32(i);
+        builder.AppendString(name.data(), name.size());
+        if (i % 2 == 1) {
+            builder.AppendNULL();
+        } else {
+            builder.AppendFloat(i / 2.0f);
+        }
+        cntl->response_attachment().append(buf);
+        byte_size += size;
+    }
+    auto rs = std::make_shared<ResultSetSQL>(schema, cnt, byte_size, cntl);
+    rs->Init();
+    return rs;
+}
+
+TEST_F(ResultSetSQLTest, next_and_reset) {
+    auto rs = MakeResultSet(100);
+    for (int round = 0; round < 2; round++) {
+        for (int32_t i = 0; i < 100; i++) {
+            ASSERT_TRUE(rs->Next());
+            ASSERT_EQ(i, rs->GetInt32Unsafe(0));
+            ASSERT_EQ("name" + std::to_string(i), rs->GetStringUnsafe(1));
+            ASSERT_EQ(i % 2 == 1, rs->IsNULL(2));
+        }
+        ASSERT_FALSE(rs->Next());
+        ASSERT_TRUE(rs->Reset());
+    }
+}
+
+TEST_F(ResultSetSQLTest, read_column) {
+    auto rs = MakeResultSet(5);
+    std::vector<int64_t> ids;
+    std::vector<bool> nulls;
+    ASSERT_TRUE(rs->GetInt64Column(0, 3, &ids, &nulls));
+    ASSERT_EQ(std::vector<int64_t>({0, 1, 2}), ids);
+    ASSERT_EQ(std::vector<bool>({false, false, false}), nulls);
+    // the cursor is at the last row read
+    ASSERT_EQ("name2", rs->GetStringUnsafe(1));
+
+    std::vector<double> scores;
+    ASSERT_TRUE(rs->GetDoubleColumn(2, 100, &scores, &nulls));
+    ASSERT_EQ(std::vector<double>({0, 2.0}), scores);
+    ASSERT_EQ(std::vector<bool>({true, false}), nulls);
+    ASSERT_TRUE(rs->GetDoubleColumn(2, 100, &scores, &nulls));
+    ASSERT_TRUE(scores.empty());
+
+    // the types mismatch
+    ASSERT_FALSE(rs->GetDoubleColumn(0, 100, &scores, &nulls));
+    ASSERT_FALSE(rs->GetInt64Column(1, 100, &ids, &nulls));
+    ASSERT_FALSE(rs->GetInt64Column(3, 100, &ids, &nulls));
+}
+
+}  // namespace sdk
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -16,12 +16,19 @@
 
 #include "sdk/sql_cluster_router.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "boost/none.hpp"
 #include "brpc/channel.h"
+#include "codec/fe_schema_codec.h"
 #include "common/timer.h"
 #include "glog/logging.h"
 #include "plan/plan_api.h"
@@ -30,6 +37,9 @@
 #include "sdk/base.h"
 #include "sdk/base_impl.h"
 #include "sdk/batch_request_result_set_sql.h"
+#include "sdk/multiple_result_set_sql.h"
+#include "sdk/partial_agg_merger.h"
+#include "sdk/request_coalescer.h"
 #include "sdk/result_set_sql.h"
 
 DECLARE_int32(request_timeout_ms);
@@ -78,6 +88,12 @@ class QueryFutureImpl : public QueryFuture {
             callback_->Ref();
         }
     }
+    // the remaining rows of a batch query are fetched from the cursor of `client`
+    QueryFutureImpl(openmldb::RpcCallback<openmldb::api::QueryResponse>* callback,
+                    const std::shared_ptr<::openmldb::client::TabletClient>& client)
+        : QueryFutureImpl(callback) {
+        client_ = client;
+    }
     ~QueryFutureImpl() {
         if (callback_) {
             callback_->UnRef();
@@ -104,6 +120,9 @@ class QueryFutureImpl : public QueryFuture {
             status->msg = "request error, " + callback_->GetResponse()->msg();
             return nullptr;
         }
+        if (client_) {
+            return ResultSetSQL::MakeResultSet(callback_->GetResponse(), callback_->GetController(), client_, status);
+        }
         auto rs = ResultSetSQL::MakeResultSet(callback_->GetResponse(), callback_->GetController(), status);
         return rs;
     }
@@ -115,6 +134,7 @@ class QueryFutureImpl : public QueryFuture {
 
  private:
     openmldb::RpcCallback<openmldb::api::QueryResponse>* callback_;
+    std::shared_ptr<::openmldb::client::TabletClient> client_;
 };
 
 class BatchQueryFutureImpl : public QueryFuture {
@@ -165,11 +185,159 @@ class BatchQueryFutureImpl : public QueryFuture {
     openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>* callback_;
 };
 
+class InsertFutureImpl : public InsertFuture {
+ public:
+    explicit InsertFutureImpl(const std::vector<openmldb::RpcCallback<openmldb::api::PutResponse>*>& callbacks)
+        : callbacks_(callbacks) {
+        for (auto callback : callbacks_) {
+            callback->Ref();
+        }
+    }
+
+    ~InsertFutureImpl() {
+        for (auto callback : callbacks_) {
+            callback->UnRef();
+        }
+    }
+
+    bool Get(hybridse::sdk::Status* status) override {
+        if (!status) {
+            return false;
+        }
+        for (auto callback : callbacks_) {
+            brpc::Join(callback->GetController()->call_id());
+            if (callback->GetController()->Failed()) {
+                status->code = hybridse::common::kRpcError;
+                status->msg = "request error, " + callback->GetController()->ErrorText();
+                return false;
+            }
+            if (callback->GetResponse()->code() != ::openmldb::base::kOk) {
+                status->code = callback->GetResponse()->code();
+                status->msg = "fail to put, " + callback->GetResponse()->msg();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool IsDone() const override {
+        for (auto callback : callbacks_) {
+            if (!callback->IsDone()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+ private:
+    std::vector<openmldb::RpcCallback<openmldb::api::PutResponse>*> callbacks_;
+};
+
+// Callback releasing an in-flight slot of the tablet when the response arrives
+template <class Response>
+class InflightRpcCallback : public openmldb::RpcCallback<Response> {
+ public:
+    InflightRpcCallback(const std::shared_ptr<Response>& response, const std::shared_ptr<brpc::Controller>& cntl,
+                        const std::shared_ptr<std::atomic<uint32_t>>& inflight)
+        : openmldb::RpcCallback<Response>(response, cntl), inflight_(inflight), released_(false) {}
+
+    void Run() override {
+        Release();
+        openmldb::RpcCallback<Response>::Run();
+    }
+
+    // drop the callback if the request is not sent, Run is never called then
+    void Cancel() {
+        Release();
+        openmldb::RpcCallback<Response>::UnRef();
+    }
+
+ private:
+    void Release() {
+        if (inflight_ && !released_.exchange(true)) {
+            inflight_->fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+ private:
+    std::shared_ptr<std::atomic<uint32_t>> inflight_;
+    std::atomic<bool> released_;
+};
+
+// Callback of a request racing in a hedged query, which records the latency
+// of the tablet and wakes up the caller
+class HedgeRpcCallback : public openmldb::RpcCallback<openmldb::api::QueryResponse> {
+ public:
+    struct Waiter {
+        std::mutex mu;
+        std::condition_variable cv;
+        // the indexes of the done requests in order
+        std::vector<size_t> done;
+    };
+
+    HedgeRpcCallback(const std::shared_ptr<Waiter>& waiter, size_t idx, const std::string& endpoint,
+                     const std::shared_ptr<openmldb::sdk::LatencyTracker>& latency_tracker)
+        : openmldb::RpcCallback<openmldb::api::QueryResponse>(std::make_shared<openmldb::api::QueryResponse>(),
+                                                              std::make_shared<brpc::Controller>()),
+          waiter_(waiter),
+          idx_(idx),
+          endpoint_(endpoint),
+          latency_tracker_(latency_tracker),
+          start_time_(::baidu::common::timer::get_micros()) {}
+
+    void Run() override {
+        latency_tracker_->Record(endpoint_, ::baidu::common::timer::get_micros() - start_time_);
+        {
+            std::lock_guard<std::mutex> lock(waiter_->mu);
+            waiter_->done.push_back(idx_);
+        }
+        waiter_->cv.notify_all();
+        openmldb::RpcCallback<openmldb::api::QueryResponse>::Run();
+    }
+
+    bool IsOk() const { return !GetController()->Failed() && GetResponse()->code() == ::openmldb::base::kOk; }
+
+ private:
+    std::shared_ptr<Waiter> waiter_;
+    size_t idx_;
+    std::string endpoint_;
+    std::shared_ptr<openmldb::sdk::LatencyTracker> latency_tracker_;
+    uint64_t start_time_;
+};
+
 SQLClusterRouter::SQLClusterRouter(const SQLRouterOptions& options)
-    : options_(options), cluster_sdk_(NULL), input_lru_cache_(), mu_(), rand_(::baidu::common::timer::now_time()) {}
+    : options_(options),
+      cluster_sdk_(NULL),
+      input_lru_cache_(),
+      mu_(),
+      rand_(::baidu::common::timer::now_time()),
+      coalescer_(),
+      inflight_(),
+      latency_tracker_(std::make_shared<LatencyTracker>()),
+      // allow a burst of hedges after a quiet period
+      hedge_budget_(new HedgeBudget(options_.hedge_ratio, 10)),
+      replica_selector_(new ReplicaSelector(options_.follower_lag_refresh_ms, latency_tracker_)),
+      sp_read_policies_(),
+      sp_result_caches_() {
+    if (options_.coalesce_window_us > 0) {
+        coalescer_.reset(new RequestCoalescer(options_.coalesce_window_us, options_.coalesce_max_batch_size));
+    }
+}
 
 SQLClusterRouter::SQLClusterRouter(ClusterSDK* sdk)
-    : options_(), cluster_sdk_(sdk), input_lru_cache_(), mu_(), rand_(::baidu::common::timer::now_time()) {}
+    : options_(),
+      cluster_sdk_(sdk),
+      input_lru_cache_(),
+      mu_(),
+      rand_(::baidu::common::timer::now_time()),
+      coalescer_(),
+      inflight_(),
+      latency_tracker_(std::make_shared<LatencyTracker>()),
+      // allow a burst of hedges after a quiet period
+      hedge_budget_(new HedgeBudget(options_.hedge_ratio, 10)),
+      replica_selector_(new ReplicaSelector(options_.follower_lag_refresh_ms, latency_tracker_)),
+      sp_read_policies_(),
+      sp_result_caches_() {}
 
 SQLClusterRouter::~SQLClusterRouter() { delete cluster_sdk_; }
 
@@ -684,12 +852,18 @@ std::shared_ptr<::openmldb::client::TabletClient> SQLClusterRouter::GetTabletCli
         const std::string& main_table = cache->router.GetMainTable();
         if (!main_table.empty()) {
             DLOG(INFO) << "get main table" << main_table;
+            // only the request mode queries may read the followers
+            ReadPolicy policy;
+            if (row) {
+                policy.enable_follower_read = options_.enable_follower_read;
+                policy.max_follower_offset_lag = options_.max_follower_offset_lag;
+            }
             std::string val;
             if (!col.empty() && row && row->GetRecordVal(col, &val)) {
-                tablet = cluster_sdk_->GetTablet(db, main_table, val);
+                tablet = GetReadTablet(db, main_table, val, policy);
             }
             if (!tablet) {
-                tablet = cluster_sdk_->GetTablet(db, main_table);
+                tablet = GetReadTablet(db, main_table, "", policy);
             }
         }
     }
@@ -710,6 +884,7 @@ std::shared_ptr<TableReader> SQLClusterRouter::GetTableReader() {
 
 std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetTablet(const std::string& db,
                                                                             const std::string& sp_name,
+                                                                            const std::shared_ptr<SQLRequestRow>& row,
                                                                             hybridse::sdk::Status* status) {
     if (status == nullptr) return nullptr;
     std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info = cluster_sdk_->GetProcedureInfo(db, sp_name, &status->msg);
@@ -720,7 +895,35 @@ std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetTablet(cons
         return nullptr;
     }
     const std::string& table = sp_info->GetMainTable();
-    auto tablet = cluster_sdk_->GetTablet(db, table);
+    ReadPolicy policy;
+    policy.enable_follower_read = options_.enable_follower_read;
+    policy.max_follower_offset_lag = options_.max_follower_offset_lag;
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+        auto db_it = sp_read_policies_.find(db);
+        if (db_it != sp_read_policies_.end()) {
+            auto it = db_it->second.find(sp_name);
+            if (it != db_it->second.end()) {
+                policy = it->second;
+            }
+        }
+    }
+    // a follower may only serve the partition of the key, like GetTabletClient
+    std::string pk;
+    if (row && policy.enable_follower_read) {
+        const std::string& sql = sp_info->GetSql();
+        auto cache = GetCache(db, sql);
+        if (!cache) {
+            // explain the procedure for the router column
+            ::hybridse::sdk::Status explain_status;
+            GetRequestRow(db, sql, &explain_status);
+            cache = GetCache(db, sql);
+        }
+        if (!cache || cache->router.GetRouterCol().empty() || !row->GetRecordVal(cache->router.GetRouterCol(), &pk)) {
+            pk.clear();
+        }
+    }
+    auto tablet = GetReadTablet(db, table, pk, policy);
     if (!tablet) {
         status->code = -1;
         status->msg = "fail to get tablet, table " + table;
@@ -730,6 +933,152 @@ std::shared_ptr<openmldb::client::TabletClient> SQLClusterRouter::GetTablet(cons
     return tablet->GetClient();
 }
 
+std::shared_ptr<::openmldb::catalog::TabletAccessor> SQLClusterRouter::GetReadTablet(const std::string& db,
+                                                                                   const std::string& table,
+                                                                                   const std::string& pk,
+                                                                                   const ReadPolicy& policy) {
+    if (!policy.enable_follower_read || pk.empty()) {
+        return pk.empty() ? cluster_sdk_->GetTablet(db, table) : cluster_sdk_->GetTablet(db, table, pk);
+    }
+    uint32_t tid = 0;
+    uint32_t pid = 0;
+    auto partition = cluster_sdk_->GetPartitionClientManager(db, table, pk, &tid, &pid);
+    return replica_selector_->Select(tid, pid, partition, policy.max_follower_offset_lag);
+}
+
+std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::HedgedQuery(
+    const std::shared_ptr<::openmldb::client::TabletClient>& tablet, const std::string& db, const std::string& table,
+    const std::string& pk, const QuerySender& sender, hybridse::sdk::Status* status) {
+    hedge_budget_->OnRequest();
+    auto waiter = std::make_shared<HedgeRpcCallback::Waiter>();
+    std::vector<HedgeRpcCallback*> callbacks;
+    auto send = [&](const std::shared_ptr<::openmldb::client::TabletClient>& client) {
+        auto callback = new HedgeRpcCallback(waiter, callbacks.size(), client->GetEndpoint(), latency_tracker_);
+        // hold the callback until the end of the query
+        callback->Ref();
+        if (!sender(client, callback)) {
+            callback->UnRef();
+            callback->UnRef();
+            return false;
+        }
+        callbacks.push_back(callback);
+        return true;
+    };
+    if (!send(tablet)) {
+        status->code = -1;
+        status->msg = "request server error, fail to send request to " + tablet->GetEndpoint();
+        LOG(WARNING) << status->msg;
+        return std::shared_ptr<hybridse::sdk::ResultSet>();
+    }
+    // no hedge until there are enough requests to know the p95 latency
+    uint64_t p95 = latency_tracker_->GetP95(tablet->GetEndpoint());
+    auto backup = p95 > 0 ? GetBackupTablet(db, table, pk, tablet->GetEndpoint())
+                          : std::shared_ptr<::openmldb::client::TabletClient>();
+    if (backup) {
+        uint64_t delay_us = std::max(p95, static_cast<uint64_t>(options_.hedge_min_delay_us));
+        bool done = false;
+        {
+            std::unique_lock<std::mutex> lock(waiter->mu);
+            done = waiter->cv.wait_for(lock, std::chrono::microseconds(delay_us),
+                                       [&waiter] { return !waiter->done.empty(); });
+        }
+        if (!done && hedge_budget_->TryAcquire() && send(backup)) {
+            DLOG(INFO) << "hedge the request of " << tablet->GetEndpoint() << " to " << backup->GetEndpoint();
+        }
+    }
+    // wait for the first success, or all of the requests fail
+    HedgeRpcCallback* result = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(waiter->mu);
+        waiter->cv.wait(lock, [&waiter, &callbacks, &result] {
+            for (auto idx : waiter->done) {
+                if (callbacks[idx]->IsOk()) {
+                    result = callbacks[idx];
+                    return true;
+                }
+            }
+            return waiter->done.size() == callbacks.size();
+        });
+    }
+    if (result == nullptr) {
+        result = callbacks[0];
+    }
+    auto cntl = result->GetController();
+    auto response = result->GetResponse();
+    for (auto callback : callbacks) {
+        if (callback != result) {
+            brpc::StartCancel(callback->GetController()->call_id());
+        }
+        callback->UnRef();
+    }
+    if (cntl->Failed()) {
+        status->code = -1;
+        status->msg = "request server error, msg: " + cntl->ErrorText();
+        LOG(WARNING) << status->msg;
+        return std::shared_ptr<hybridse::sdk::ResultSet>();
+    }
+    if (response->code() != ::openmldb::base::kOk) {
+        status->code = response->code();
+        status->msg = "request error, " + response->msg();
+        LOG(WARNING) << status->msg;
+        return std::shared_ptr<hybridse::sdk::ResultSet>();
+    }
+    return ResultSetSQL::MakeResultSet(response, cntl, status);
+}
+
+std::shared_ptr<::openmldb::client::TabletClient> SQLClusterRouter::GetBackupTablet(const std::string& db,
+                                                                                    const std::string& table,
+                                                                                    const std::string& pk,
+                                                                                    const std::string& endpoint) {
+    // without the key, the partition read by the request is not known
+    if (table.empty() || pk.empty()) {
+        return std::shared_ptr<::openmldb::client::TabletClient>();
+    }
+    uint32_t tid = 0;
+    uint32_t pid = 0;
+    auto partition = cluster_sdk_->GetPartitionClientManager(db, table, pk, &tid, &pid);
+    if (!partition) {
+        return std::shared_ptr<::openmldb::client::TabletClient>();
+    }
+    std::shared_ptr<::openmldb::client::TabletClient> backup;
+    uint64_t backup_latency = 0;
+    for (const auto& follower : partition->GetFollowers()) {
+        auto client = follower ? follower->GetClient() : std::shared_ptr<::openmldb::client::TabletClient>();
+        if (!client || client->GetEndpoint() == endpoint) {
+            continue;
+        }
+        uint64_t latency = latency_tracker_->GetAverage(client->GetEndpoint());
+        if (!backup || latency < backup_latency) {
+            backup = client;
+            backup_latency = latency;
+        }
+    }
+    return backup;
+}
+
+void SQLClusterRouter::SetProcedureReadPolicy(const std::string& db, const std::string& sp_name,
+                                              bool enable_follower_read, uint64_t max_follower_offset_lag) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto& policy = sp_read_policies_[db][sp_name];
+    policy.enable_follower_read = enable_follower_read;
+    policy.max_follower_offset_lag = max_follower_offset_lag;
+}
+
+void SQLClusterRouter::SetProcedureResultCache(const std::string& db, const std::string& sp_name, bool enable) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    if (enable) {
+        sp_result_caches_[db].insert(sp_name);
+    } else {
+        sp_result_caches_[db].erase(sp_name);
+    }
+}
+
+bool SQLClusterRouter::IsResultCacheEnabled(const std::string& db, const std::string& sp_name) {
+    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+    auto it = sp_result_caches_.find(db);
+    return it != sp_result_caches_.end() && it->second.count(sp_name) > 0;
+}
+
 bool SQLClusterRouter::IsConstQuery(::hybridse::vm::PhysicalOpNode* node) {
     if (node->GetOpType() == ::hybridse::vm::kPhysicalOpConstProject) {
         return true;
@@ -781,6 +1130,25 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQLRequest(co
         status->msg = "not tablet found";
         return std::shared_ptr<::hybridse::sdk::ResultSet>();
     }
+    if (options_.enable_hedged_request) {
+        // the cache is filled by GetTabletClient, which routes the request by
+        // the key in the router column
+        auto cache = GetCache(db, sql);
+        std::string table;
+        std::string pk;
+        if (cache) {
+            table = cache->router.GetMainTable();
+            const std::string& col = cache->router.GetRouterCol();
+            if (col.empty() || !row->GetRecordVal(col, &pk)) {
+                pk.clear();
+            }
+        }
+        auto sender = [this, &db, &sql, &row](const std::shared_ptr<::openmldb::client::TabletClient>& tablet,
+                                              openmldb::RpcCallback<openmldb::api::QueryResponse>* callback) {
+            return tablet->Query(db, sql, row->GetRow(), options_.request_timeout, options_.enable_debug, callback);
+        };
+        return HedgedQuery(client, db, table, pk, sender, status);
+    }
     if (!client->Query(db, sql, row->GetRow(), cntl.get(), response.get(), options_.enable_debug)) {
         status->msg = "request server error, msg: " + response->msg();
         return std::shared_ptr<::hybridse::sdk::ResultSet>();
@@ -816,17 +1184,121 @@ std::shared_ptr<::hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQLParamete
         DLOG(INFO) << "no tablet avilable for sql " << sql;
         return std::shared_ptr<::hybridse::sdk::ResultSet>();
     }
+    // the cache is filled by GetTabletClient
+    auto cache = GetCache(db, sql);
+    if (options_.enable_parallel_scan && cache && cache->router.IsScatterable()) {
+        return ExecuteScatterQuery(db, sql, cache->router.GetMainTable(), parameter_types,
+                                   parameter ? parameter->GetRow() : "", cache->router.GetPartialAggMerges(), status);
+    }
     DLOG(INFO) << " send query to tablet " << client->GetEndpoint();
     if (!client->Query(db, sql, parameter_types, parameter ? parameter->GetRow() : "", cntl.get(), response.get(),
-                       options_.enable_debug)) {
+                       options_.enable_debug, true)) {
         status->msg = response->msg();
         status->code = -1;
         return std::shared_ptr<::hybridse::sdk::ResultSet>();
     }
-    auto rs = ResultSetSQL::MakeResultSet(response, cntl, status);
+    auto rs = ResultSetSQL::MakeResultSet(response, cntl, client, status);
     return rs;
 }
 
+std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteScatterQuery(
+    const std::string& db, const std::string& sql, const std::string& table,
+    const std::vector<openmldb::type::DataType>& parameter_types, const std::string& parameter_row,
+    const std::vector<::hybridse::vm::PartialAggMerge>& merges, hybridse::sdk::Status* status) {
+    auto table_info = cluster_sdk_->GetTableInfo(db, table);
+    if (!table_info) {
+        status->code = -1;
+        status->msg = "table " + table + " does not exist";
+        return std::shared_ptr<::hybridse::sdk::ResultSet>();
+    }
+    // one fragment for each tablet, which scans all partitions it leads
+    std::map<std::string, std::pair<std::shared_ptr<::openmldb::client::TabletClient>, std::vector<uint32_t>>>
+        fragments;
+    for (uint32_t pid = 0; pid < static_cast<uint32_t>(table_info->table_partition_size()); pid++) {
+        auto tablet = cluster_sdk_->GetTablet(db, table, pid);
+        auto client = tablet ? tablet->GetClient() : std::shared_ptr<::openmldb::client::TabletClient>();
+        if (!client) {
+            status->code = -1;
+            status->msg = "no leader tablet of partition " + std::to_string(pid) + " of table " + table;
+            return std::shared_ptr<::hybridse::sdk::ResultSet>();
+        }
+        auto& fragment = fragments[client->GetEndpoint()];
+        fragment.first = client;
+        fragment.second.push_back(pid);
+    }
+    std::vector<std::shared_ptr<::openmldb::client::TabletClient>> clients;
+    std::vector<openmldb::RpcCallback<openmldb::api::QueryResponse>*> callbacks;
+    for (auto& kv : fragments) {
+        auto cntl = std::make_shared<::brpc::Controller>();
+        cntl->set_timeout_ms(options_.request_timeout);
+        auto callback = new openmldb::RpcCallback<openmldb::api::QueryResponse>(
+            std::make_shared<openmldb::api::QueryResponse>(), cntl);
+        // released by Run when the response arrives
+        callback->Ref();
+        if (!kv.second.first->ScatterQuery(db, sql, parameter_types, parameter_row, table_info->tid(),
+                                           kv.second.second, options_.enable_debug, callback)) {
+            callback->UnRef();
+            callback->UnRef();
+            status->code = -1;
+            status->msg = "fail to send query to tablet " + kv.first;
+            break;
+        }
+        clients.push_back(kv.second.first);
+        callbacks.push_back(callback);
+    }
+    std::vector<std::shared_ptr<::hybridse::sdk::ResultSet>> result_sets;
+    std::string schema;
+    for (size_t i = 0; i < callbacks.size(); i++) {
+        auto cntl = callbacks[i]->GetController();
+        auto response = callbacks[i]->GetResponse();
+        brpc::Join(cntl->call_id());
+        if (status->code != 0) {
+            if (!cntl->Failed() && response->has_more()) {
+                clients[i]->CloseQueryCursor(response->cursor_id());
+            }
+        } else {
+            if (cntl->Failed()) {
+                status->code = -1;
+                status->msg = "request error. " + cntl->ErrorText();
+            } else if (response->code() != 0) {
+                status->code = -1;
+                status->msg = response->msg();
+            } else {
+                // cursors of the other fragments are closed with their result sets
+                auto rs = ResultSetSQL::MakeResultSet(response, cntl, clients[i], status);
+                if (rs) {
+                    result_sets.push_back(rs);
+                    schema = response->schema();
+                }
+            }
+        }
+        callbacks[i]->UnRef();
+    }
+    if (status->code != 0 || result_sets.empty()) {
+        LOG(WARNING) << "fail to run scattered query " << sql << ": " << status->msg;
+        return std::shared_ptr<::hybridse::sdk::ResultSet>();
+    }
+    DLOG(INFO) << "scatter query to " << result_sets.size() << " tablets";
+    if (merges.empty()) {
+        return std::make_shared<MultipleResultSetSQL>(result_sets);
+    }
+    ::hybridse::vm::Schema output_schema;
+    if (!::hybridse::codec::SchemaCodec::Decode(schema, &output_schema)) {
+        status->code = -1;
+        status->msg = "fail to decode schema of partial aggregation";
+        return std::shared_ptr<::hybridse::sdk::ResultSet>();
+    }
+    PartialAggMerger merger(output_schema, merges);
+    for (auto& rs : result_sets) {
+        if (!merger.Add(rs)) {
+            status->code = -1;
+            status->msg = "fail to merge partial aggregation";
+            return std::shared_ptr<::hybridse::sdk::ResultSet>();
+        }
+    }
+    return merger.GetResultSet();
+}
+
 std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQLBatchRequest(
     const std::string& db, const std::string& sql, std::shared_ptr<SQLRequestRowBatch> row_batch,
     hybridse::sdk::Status* status) {
@@ -1048,15 +1520,22 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallProcedure(const
         LOG(WARNING) << "make sure the request row is built before execute sql";
         return nullptr;
     }
-    auto tablet = GetTablet(db, sp_name, status);
+    auto tablet = GetTablet(db, sp_name, row, status);
     if (!tablet) {
         return nullptr;
     }
+    bool enable_result_cache = IsResultCacheEnabled(db, sp_name);
+    // the result cache of tablets serves single row calls only
+    if (coalescer_ && !enable_result_cache && IsCoalescable(db, sp_name)) {
+        return CoalesceProcedure(tablet, db, sp_name, row, status);
+    }
+    // procedure calls are not hedged, since they are not routed by key and
+    // the partition a call reads is not known here
 
     auto cntl = std::make_shared<::brpc::Controller>();
     auto response = std::make_shared<::openmldb::api::QueryResponse>();
     bool ok = tablet->CallProcedure(db, sp_name, row->GetRow(), cntl.get(), response.get(), options_.enable_debug,
-                                    options_.request_timeout);
+                                    options_.request_timeout, enable_result_cache);
     if (!ok) {
         status->code = -1;
         status->msg = "request server error" + response->msg();
@@ -1073,13 +1552,67 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallProcedure(const
     return rs;
 }
 
+bool SQLClusterRouter::IsCoalescable(const std::string& db, const std::string& sp_name) {
+    std::string msg;
+    auto sp_info = cluster_sdk_->GetProcedureInfo(db, sp_name, &msg);
+    if (!sp_info) {
+        return false;
+    }
+    // rows of a batch share the values of common columns
+    auto& input_schema = sp_info->GetInputSchema();
+    for (int32_t i = 0; i < input_schema.GetColumnCnt(); i++) {
+        if (input_schema.IsConstant(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CoalesceProcedure(
+    const std::shared_ptr<::openmldb::client::TabletClient>& tablet, const std::string& db,
+    const std::string& sp_name, const std::shared_ptr<SQLRequestRow>& row, hybridse::sdk::Status* status) {
+    auto runner = [this, &tablet, &db, &sp_name](const std::vector<std::shared_ptr<SQLRequestRow>>& rows,
+                                                  std::vector<std::shared_ptr<hybridse::sdk::ResultSet>>* results,
+                                                  hybridse::sdk::Status* status) {
+        auto row_batch = std::make_shared<SQLRequestRowBatch>(
+            rows[0]->GetSchema(), std::make_shared<ColumnIndicesSet>(rows[0]->GetSchema()));
+        for (auto& row : rows) {
+            if (!row_batch->AddRow(row)) {
+                status->code = -1;
+                status->msg = "fail to add request row to batch";
+                return false;
+            }
+        }
+        auto cntl = std::make_shared<::brpc::Controller>();
+        auto response = std::make_shared<::openmldb::api::SQLBatchRequestQueryResponse>();
+        bool ok = tablet->CallSQLBatchRequestProcedure(db, sp_name, row_batch, cntl.get(), response.get(),
+                                                       options_.enable_debug, options_.request_timeout);
+        if (!ok || response->code() != ::openmldb::base::kOk) {
+            status->code = -1;
+            status->msg = "request server error, msg: " + response->msg();
+            return false;
+        }
+        if (!RequestCoalescer::SplitResponse(response, cntl, results)) {
+            status->code = -1;
+            status->msg = "fail to split batch response";
+            return false;
+        }
+        return true;
+    };
+    auto rs = coalescer_->Call(tablet->GetEndpoint() + "/" + db + "/" + sp_name, row, runner, status);
+    if (!rs) {
+        LOG(WARNING) << status->msg;
+    }
+    return rs;
+}
+
 std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallSQLBatchRequestProcedure(
     const std::string& db, const std::string& sp_name, std::shared_ptr<SQLRequestRowBatch> row_batch,
     hybridse::sdk::Status* status) {
     if (!row_batch || !status) {
         return nullptr;
     }
-    auto tablet = GetTablet(db, sp_name, status);
+    auto tablet = GetTablet(db, sp_name, std::shared_ptr<SQLRequestRow>(), status);
     if (!tablet) {
         return nullptr;
     }
@@ -1302,19 +1835,24 @@ std::shared_ptr<openmldb::sdk::QueryFuture> SQLClusterRouter::CallProcedure(cons
         LOG(WARNING) << "make sure the request row is built before execute sql";
         return std::shared_ptr<openmldb::sdk::QueryFuture>();
     }
-    auto tablet = GetTablet(db, sp_name, status);
+    auto tablet = GetTablet(db, sp_name, row, status);
     if (!tablet) {
         return std::shared_ptr<openmldb::sdk::QueryFuture>();
     }
 
+    std::shared_ptr<std::atomic<uint32_t>> inflight;
+    if (!AcquireInflight(tablet->GetEndpoint(), &inflight, status)) {
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
     std::shared_ptr<openmldb::api::QueryResponse> response = std::make_shared<openmldb::api::QueryResponse>();
     std::shared_ptr<brpc::Controller> cntl = std::make_shared<brpc::Controller>();
-    openmldb::RpcCallback<openmldb::api::QueryResponse>* callback =
-        new openmldb::RpcCallback<openmldb::api::QueryResponse>(response, cntl);
+    auto callback = new InflightRpcCallback<openmldb::api::QueryResponse>(response, cntl, inflight);
 
     std::shared_ptr<openmldb::sdk::QueryFutureImpl> future = std::make_shared<openmldb::sdk::QueryFutureImpl>(callback);
-    bool ok = tablet->CallProcedure(db, sp_name, row->GetRow(), timeout_ms, options_.enable_debug, callback);
+    bool ok = tablet->CallProcedure(db, sp_name, row->GetRow(), timeout_ms, options_.enable_debug,
+                                    IsResultCacheEnabled(db, sp_name), callback);
     if (!ok) {
+        callback->Cancel();
         status->code = -1;
         status->msg = "request server error, msg: " + response->msg();
         LOG(WARNING) << status->msg;
@@ -1329,20 +1867,24 @@ std::shared_ptr<openmldb::sdk::QueryFuture> SQLClusterRouter::CallSQLBatchReques
     if (!row_batch || !status) {
         return nullptr;
     }
-    auto tablet = GetTablet(db, sp_name, status);
+    auto tablet = GetTablet(db, sp_name, std::shared_ptr<SQLRequestRow>(), status);
     if (!tablet) {
         return nullptr;
     }
 
+    std::shared_ptr<std::atomic<uint32_t>> inflight;
+    if (!AcquireInflight(tablet->GetEndpoint(), &inflight, status)) {
+        return nullptr;
+    }
     std::shared_ptr<brpc::Controller> cntl = std::make_shared<brpc::Controller>();
     auto response = std::make_shared<openmldb::api::SQLBatchRequestQueryResponse>();
-    openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>* callback =
-        new openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>(response, cntl);
+    auto callback = new InflightRpcCallback<openmldb::api::SQLBatchRequestQueryResponse>(response, cntl, inflight);
 
     std::shared_ptr<openmldb::sdk::BatchQueryFutureImpl> future =
         std::make_shared<openmldb::sdk::BatchQueryFutureImpl>(callback);
     bool ok = tablet->CallSQLBatchRequestProcedure(db, sp_name, row_batch, options_.enable_debug, timeout_ms, callback);
     if (!ok) {
+        callback->Cancel();
         status->code = -1;
         status->msg = "request server error, msg: " + response->msg();
         LOG(WARNING) << status->msg;
@@ -1351,5 +1893,160 @@ std::shared_ptr<openmldb::sdk::QueryFuture> SQLClusterRouter::CallSQLBatchReques
     return future;
 }
 
+bool SQLClusterRouter::AcquireInflight(const std::string& endpoint, std::shared_ptr<std::atomic<uint32_t>>* inflight,
+                                       hybridse::sdk::Status* status) {
+    if (options_.max_inflight_per_tablet == 0) {
+        return true;
+    }
+    {
+        std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
+        auto& counter = inflight_[endpoint];
+        if (!counter) {
+            counter = std::make_shared<std::atomic<uint32_t>>(0);
+        }
+        *inflight = counter;
+    }
+    if ((*inflight)->fetch_add(1, std::memory_order_acq_rel) >= options_.max_inflight_per_tablet) {
+        (*inflight)->fetch_sub(1, std::memory_order_acq_rel);
+        status->code = -1;
+        status->msg = "too many in-flight requests to tablet " + endpoint;
+        LOG(WARNING) << status->msg;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<openmldb::sdk::QueryFuture> SQLClusterRouter::ExecuteSQLRequest(const std::string& db,
+                                                                                const std::string& sql,
+                                                                                int64_t timeout_ms,
+                                                                                std::shared_ptr<SQLRequestRow> row,
+                                                                                hybridse::sdk::Status* status) {
+    if (!row || !status) {
+        LOG(WARNING) << "input is invalid";
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
+    if (!row->OK()) {
+        status->code = -1;
+        status->msg = "make sure the request row is built before execute sql";
+        LOG(WARNING) << status->msg;
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
+    auto client = GetTabletClient(db, sql, row);
+    if (!client) {
+        status->code = -1;
+        status->msg = "not tablet found";
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
+    std::shared_ptr<std::atomic<uint32_t>> inflight;
+    if (!AcquireInflight(client->GetEndpoint(), &inflight, status)) {
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
+    auto response = std::make_shared<openmldb::api::QueryResponse>();
+    auto cntl = std::make_shared<brpc::Controller>();
+    auto callback = new InflightRpcCallback<openmldb::api::QueryResponse>(response, cntl, inflight);
+    auto future = std::make_shared<openmldb::sdk::QueryFutureImpl>(callback);
+    if (!client->Query(db, sql, row->GetRow(), timeout_ms, options_.enable_debug, callback)) {
+        callback->Cancel();
+        status->code = -1;
+        status->msg = "fail to send request to tablet " + client->GetEndpoint();
+        LOG(WARNING) << status->msg;
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
+    return future;
+}
+
+std::shared_ptr<openmldb::sdk::QueryFuture> SQLClusterRouter::ExecuteSQL(const std::string& db, const std::string& sql,
+                                                                         int64_t timeout_ms,
+                                                                         hybridse::sdk::Status* status) {
+    if (!status) {
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
+    auto client = GetTabletClient(db, sql, std::shared_ptr<SQLRequestRow>(), std::shared_ptr<SQLRequestRow>());
+    if (!client) {
+        status->code = -1;
+        status->msg = "not tablet found";
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
+    std::shared_ptr<std::atomic<uint32_t>> inflight;
+    if (!AcquireInflight(client->GetEndpoint(), &inflight, status)) {
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
+    auto response = std::make_shared<openmldb::api::QueryResponse>();
+    auto cntl = std::make_shared<brpc::Controller>();
+    auto callback = new InflightRpcCallback<openmldb::api::QueryResponse>(response, cntl, inflight);
+    auto future = std::make_shared<openmldb::sdk::QueryFutureImpl>(callback, client);
+    if (!client->Query(db, sql, std::vector<openmldb::type::DataType>(), "", timeout_ms, options_.enable_debug, true,
+                       callback)) {
+        callback->Cancel();
+        status->code = -1;
+        status->msg = "fail to send request to tablet " + client->GetEndpoint();
+        LOG(WARNING) << status->msg;
+        return std::shared_ptr<openmldb::sdk::QueryFuture>();
+    }
+    return future;
+}
+
+std::shared_ptr<openmldb::sdk::InsertFuture> SQLClusterRouter::ExecuteInsert(const std::string& db,
+                                                                             const std::string& sql,
+                                                                             int64_t timeout_ms,
+                                                                             std::shared_ptr<SQLInsertRow> row,
+                                                                             hybridse::sdk::Status* status) {
+    if (!row || !status) {
+        LOG(WARNING) << "input is invalid";
+        return std::shared_ptr<openmldb::sdk::InsertFuture>();
+    }
+    std::shared_ptr<SQLCache> cache = GetCache(db, sql);
+    if (!cache) {
+        status->code = -1;
+        status->msg = "please use getInsertRow with " + sql + " first";
+        LOG(WARNING) << status->msg;
+        return std::shared_ptr<openmldb::sdk::InsertFuture>();
+    }
+    auto table_info = cache->table_info;
+    std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>> tablets;
+    if (!cluster_sdk_->GetTablet(db, table_info->name(), &tablets) || tablets.empty()) {
+        status->code = -1;
+        status->msg = "fail to get table " + table_info->name() + " tablet";
+        LOG(WARNING) << status->msg;
+        return std::shared_ptr<openmldb::sdk::InsertFuture>();
+    }
+    uint64_t cur_ts = 0;
+    if (row->GetTs().empty()) {
+        cur_ts = ::baidu::common::timer::get_micros() / 1000;
+    }
+    std::vector<openmldb::RpcCallback<openmldb::api::PutResponse>*> callbacks;
+    for (const auto& kv : row->GetDimensions()) {
+        uint32_t pid = kv.first;
+        auto client = pid < tablets.size() && tablets[pid] ? tablets[pid]->GetClient()
+                                                           : std::shared_ptr<::openmldb::client::TabletClient>();
+        if (!client) {
+            status->code = -1;
+            status->msg = "fail to get tablet client. pid " + std::to_string(pid);
+            break;
+        }
+        std::shared_ptr<std::atomic<uint32_t>> inflight;
+        if (!AcquireInflight(client->GetEndpoint(), &inflight, status)) {
+            break;
+        }
+        auto callback = new InflightRpcCallback<openmldb::api::PutResponse>(
+            std::make_shared<openmldb::api::PutResponse>(), std::make_shared<brpc::Controller>(), inflight);
+        if (!client->Put(table_info->tid(), pid, cur_ts, kv.second, row->GetTs(), row->GetRow(), 1, timeout_ms,
+                         callback)) {
+            callback->Cancel();
+            status->code = -1;
+            status->msg = "fail to make a put request to table. tid " + std::to_string(table_info->tid());
+            break;
+        }
+        callbacks.push_back(callback);
+    }
+    auto future = std::make_shared<InsertFutureImpl>(callbacks);
+    if (status->code != 0) {
+        // the puts sent are not rolled back, as the synchronous insert
+        LOG(WARNING) << status->msg;
+        return std::shared_ptr<openmldb::sdk::InsertFuture>();
+    }
+    return future;
+}
+
 }  // namespace sdk
 }  // namespace openmldb
@@ -17,6 +17,8 @@
 #ifndef SRC_SDK_SQL_CLUSTER_ROUTER_H_
 #define SRC_SDK_SQL_CLUSTER_ROUTER_H_
 
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
@@ -30,6 +32,9 @@
 #include "catalog/schema_adapter.h"
 #include "client/tablet_client.h"
 #include "sdk/cluster_sdk.h"
+#include "sdk/latency_tracker.h"
+#include "sdk/replica_selector.h"
+#include "sdk/request_coalescer.h"
 #include "sdk/sql_router.h"
 #include "sdk/table_reader_impl.h"
 
@@ -98,6 +103,16 @@ struct SQLCache {
     ::hybridse::vm::Router router;
 };
 
+// send a query to the tablet asynchronously
+typedef std::function<bool(const std::shared_ptr<::openmldb::client::TabletClient>& tablet,
+                           openmldb::RpcCallback<openmldb::api::QueryResponse>* callback)>
+    QuerySender;
+
+struct ReadPolicy {
+    bool enable_follower_read = false;
+    uint64_t max_follower_offset_lag = 0;
+};
+
 class SQLClusterRouter : public SQLRouter {
  public:
     explicit SQLClusterRouter(const SQLRouterOptions& options);
@@ -170,6 +185,11 @@ class SQLClusterRouter : public SQLRouter {
 
     std::vector<std::shared_ptr<hybridse::sdk::ProcedureInfo>> ShowProcedure(std::string* msg);
 
+    void SetProcedureReadPolicy(const std::string& db, const std::string& sp_name, bool enable_follower_read,
+                                uint64_t max_follower_offset_lag) override;
+
+    void SetProcedureResultCache(const std::string& db, const std::string& sp_name, bool enable) override;
+
     std::shared_ptr<openmldb::sdk::QueryFuture> CallProcedure(const std::string& db, const std::string& sp_name,
                                                               int64_t timeout_ms, std::shared_ptr<SQLRequestRow> row,
                                                               hybridse::sdk::Status* status);
@@ -178,12 +198,30 @@ class SQLClusterRouter : public SQLRouter {
         const std::string& db, const std::string& sp_name, int64_t timeout_ms,
         std::shared_ptr<SQLRequestRowBatch> row_batch, hybridse::sdk::Status* status);
 
+    std::shared_ptr<openmldb::sdk::QueryFuture> ExecuteSQLRequest(const std::string& db, const std::string& sql,
+                                                                  int64_t timeout_ms,
+                                                                  std::shared_ptr<SQLRequestRow> row,
+                                                                  hybridse::sdk::Status* status) override;
+
+    std::shared_ptr<openmldb::sdk::QueryFuture> ExecuteSQL(const std::string& db, const std::string& sql,
+                                                           int64_t timeout_ms, hybridse::sdk::Status* status) override;
+
+    std::shared_ptr<openmldb::sdk::InsertFuture> ExecuteInsert(const std::string& db, const std::string& sql,
+                                                               int64_t timeout_ms, std::shared_ptr<SQLInsertRow> row,
+                                                               hybridse::sdk::Status* status) override;
+
     std::shared_ptr<::openmldb::client::TabletClient> GetTabletClient(
         const std::string& db, const std::string& sql, const std::shared_ptr<SQLRequestRow>& row);
     std::shared_ptr<::openmldb::client::TabletClient> GetTabletClient(
         const std::string& db, const std::string& sql, const std::shared_ptr<SQLRequestRow>& row,
         const std::shared_ptr<SQLRequestRow>& parameter_row);
 
+    // the fastest follower tablet of the partition of `pk` in the table except
+    // `endpoint`, null if `pk` is empty or there is no such follower
+    std::shared_ptr<::openmldb::client::TabletClient> GetBackupTablet(const std::string& db, const std::string& table,
+                                                                      const std::string& pk,
+                                                                      const std::string& endpoint);
+
  private:
     void GetTables(::hybridse::vm::PhysicalOpNode* node, std::set<std::string>* tables);
 
@@ -192,6 +230,14 @@ class SQLClusterRouter : public SQLRouter {
                 ::hybridse::sdk::Status* status);
 
     bool IsConstQuery(::hybridse::vm::PhysicalOpNode* node);
+
+    // send the batch query to the leader tablets of all partitions of `table`
+    // in parallel, and concatenate their results, or merge them by `merges` if
+    // they are partial aggregations
+    std::shared_ptr<hybridse::sdk::ResultSet> ExecuteScatterQuery(
+        const std::string& db, const std::string& sql, const std::string& table,
+        const std::vector<openmldb::type::DataType>& parameter_types, const std::string& parameter_row,
+        const std::vector<::hybridse::vm::PartialAggMerge>& merges, hybridse::sdk::Status* status);
     std::shared_ptr<SQLCache> GetCache(const std::string& db, const std::string& sql);
 
     void SetCache(const std::string& db, const std::string& sql, std::shared_ptr<SQLCache> router_cache);
@@ -218,8 +264,39 @@ class SQLClusterRouter : public SQLRouter {
 
     inline bool CheckSQLSyntax(const std::string& sql);
 
+    // the tablet to call the procedure on, routed by the key of `row` in the
+    // router column if `row` is not null
     std::shared_ptr<openmldb::client::TabletClient> GetTablet(const std::string& db, const std::string& sp_name,
+                                                              const std::shared_ptr<SQLRequestRow>& row,
                                                               hybridse::sdk::Status* status);
+
+    // send the request mode query by `sender` to `tablet`, and a duplicate to
+    // a follower of the partition of `pk` if it is slow, the first success is
+    // returned
+    std::shared_ptr<hybridse::sdk::ResultSet> HedgedQuery(
+        const std::shared_ptr<::openmldb::client::TabletClient>& tablet, const std::string& db,
+        const std::string& table, const std::string& pk, const QuerySender& sender, hybridse::sdk::Status* status);
+
+    // pick a replica of the partition of `pk` in the table to read by the
+    // policy, or the leader of a random partition if `pk` is empty, since the
+    // lag of a follower is only known for its partition
+    std::shared_ptr<::openmldb::catalog::TabletAccessor> GetReadTablet(const std::string& db, const std::string& table,
+                                                                       const std::string& pk,
+                                                                       const ReadPolicy& policy);
+
+    // take an in-flight slot of the tablet for an asynchronous request, which
+    // is released by the callback of the request
+    bool AcquireInflight(const std::string& endpoint, std::shared_ptr<std::atomic<uint32_t>>* inflight,
+                         hybridse::sdk::Status* status);
+
+    // whether the calls of the procedure can be coalesced into batch requests
+    bool IsCoalescable(const std::string& db, const std::string& sp_name);
+
+    bool IsResultCacheEnabled(const std::string& db, const std::string& sp_name);
+
+    std::shared_ptr<hybridse::sdk::ResultSet> CoalesceProcedure(
+        const std::shared_ptr<::openmldb::client::TabletClient>& tablet, const std::string& db,
+        const std::string& sp_name, const std::shared_ptr<SQLRequestRow>& row, hybridse::sdk::Status* status);
     bool ExtractDBTypes(const std::shared_ptr<hybridse::sdk::Schema> schema,
                                std::vector<openmldb::type::DataType>& parameter_types);  // NOLINT
 
@@ -229,6 +306,16 @@ class SQLClusterRouter : public SQLRouter {
     std::map<std::string, boost::compute::detail::lru_cache<std::string, std::shared_ptr<SQLCache>>> input_lru_cache_;
     ::openmldb::base::SpinMutex mu_;
     ::openmldb::base::Random rand_;
+    std::unique_ptr<RequestCoalescer> coalescer_;
+    // in-flight asynchronous requests of each tablet
+    std::map<std::string, std::shared_ptr<std::atomic<uint32_t>>> inflight_;
+    std::shared_ptr<LatencyTracker> latency_tracker_;
+    std::unique_ptr<HedgeBudget> hedge_budget_;
+    std::unique_ptr<ReplicaSelector> replica_selector_;
+    // the read policies of procedures, db -> sp_name -> policy
+    std::map<std::string, std::map<std::string, ReadPolicy>> sp_read_policies_;
+    // the procedures served from the result cache of tablets, db -> sp_names
+    std::map<std::string, std::set<std::string>> sp_result_caches_;
 };
 
 }  // namespace sdk
@@ -23,6 +23,7 @@
 
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
+#include "base/status.h"
 #include "catalog/schema_adapter.h"
 #include "codec/fe_row_codec.h"
 #include "common/timer.h"
@@ -34,6 +35,9 @@
 #include "sdk/sql_sdk_test.h"
 #include "vm/catalog.h"
 
+DECLARE_uint32(scan_max_bytes_size);
+DECLARE_uint32(query_cursor_expire_ms);
+
 namespace openmldb {
 namespace sdk {
 
@@ -381,6 +385,136 @@ TEST_F(SQLClusterTest, create_table) {
     ASSERT_TRUE(router->DropDB(db, &status));
 }
 
+TEST_F(SQLClusterTest, expired_query_cursor) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    auto router = NewClusterSQLRouter(sql_opt);
+    ASSERT_TRUE(router != nullptr);
+    std::string db = "db" + GenRand();
+    ::hybridse::sdk::Status status;
+    ASSERT_TRUE(router->CreateDB(db, &status));
+    std::string ddl =
+        "create table t1(col1 string, col2 bigint, index(key=col1, ts=col2)) "
+        "options(partitionnum=1);";
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status)) << status.msg;
+    ASSERT_TRUE(router->RefreshCatalog());
+    for (int i = 0; i < 20; i++) {
+        std::string insert = "insert into t1 values('key" + std::to_string(i) + "', " + std::to_string(i) + ");";
+        ASSERT_TRUE(router->ExecuteInsert(db, insert, &status)) << status.msg;
+    }
+
+    // a few rows per chunk, the rest are kept by a cursor on the tablet
+    uint32_t old_scan_max_bytes_size = FLAGS_scan_max_bytes_size;
+    FLAGS_scan_max_bytes_size = 100;
+    auto rs = router->ExecuteSQL(db, "select * from t1;", &status);
+    ASSERT_TRUE(rs != nullptr) << status.msg;
+    ASSERT_EQ(20, rs->Size());
+    int32_t cnt = 0;
+    while (cnt < 5 && rs->Next()) {
+        cnt++;
+    }
+    ASSERT_EQ(5, cnt);
+    ASSERT_EQ(0, rs->GetStatus().code);
+    ASSERT_FALSE(rs->Reset());
+
+    // the cursor is dropped when it is not fetched in time
+    sleep(FLAGS_query_cursor_expire_ms * 3 / 1000);
+    while (rs->Next()) {
+        cnt++;
+    }
+    ASSERT_LT(cnt, 20);
+    ASSERT_EQ(::openmldb::base::kQueryCursorNotFound, rs->GetStatus().code) << rs->GetStatus().msg;
+    ASSERT_FALSE(rs->Next());
+    FLAGS_scan_max_bytes_size = old_scan_max_bytes_size;
+
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table t1;", &status));
+    ASSERT_TRUE(router->DropDB(db, &status));
+}
+
+TEST_F(SQLClusterTest, hedge_to_follower_of_key) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    sql_opt.enable_hedged_request = true;
+    auto router = NewClusterSQLRouter(sql_opt);
+    ASSERT_TRUE(router != nullptr);
+    auto sql_cluster_router = std::dynamic_pointer_cast<SQLClusterRouter>(router);
+    std::string db = "db" + GenRand();
+    ::hybridse::sdk::Status status;
+    ASSERT_TRUE(router->CreateDB(db, &status));
+    std::string ddl =
+        "create table t1(col1 string, col2 bigint, index(key=col1, ts=col2)) "
+        "options(partitionnum=8, replicanum=2);";
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status)) << status.msg;
+    ddl =
+        "create table t2(col1 string, col2 bigint, index(key=col1, ts=col2)) "
+        "options(partitionnum=8, replicanum=1);";
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status)) << status.msg;
+    ASSERT_TRUE(router->RefreshCatalog());
+    auto ns_client = mc_->GetNsClient();
+    std::vector<::openmldb::nameserver::TableInfo> tables;
+    std::string msg;
+    ASSERT_TRUE(ns_client->ShowTable("t1", db, false, tables, msg));
+    ASSERT_EQ(1u, tables.size());
+
+    auto endpoints = mc_->GetTbEndpoint();
+    ASSERT_EQ(3u, endpoints.size());
+    for (int i = 0; i < 10; i++) {
+        std::string pk = "key" + std::to_string(i);
+        uint32_t pid = (uint32_t)(::openmldb::base::hash64(pk) % 8);
+        std::string leader;
+        std::string follower;
+        for (const auto& meta : tables[0].table_partition(pid).partition_meta()) {
+            if (meta.is_leader()) {
+                leader = meta.endpoint();
+            } else {
+                follower = meta.endpoint();
+            }
+        }
+        ASSERT_FALSE(leader.empty());
+        ASSERT_FALSE(follower.empty());
+        // the backup of the leader is the follower of the same partition, not
+        // the tablet without the key
+        auto backup = sql_cluster_router->GetBackupTablet(db, "t1", pk, leader);
+        ASSERT_TRUE(backup != nullptr);
+        ASSERT_EQ(follower, backup->GetEndpoint());
+        backup = sql_cluster_router->GetBackupTablet(db, "t1", pk, follower);
+        ASSERT_TRUE(backup == nullptr);
+        // the partition has no follower
+        ASSERT_TRUE(sql_cluster_router->GetBackupTablet(db, "t2", pk, leader) == nullptr);
+    }
+    // the partition is not known without the key
+    ASSERT_TRUE(sql_cluster_router->GetBackupTablet(db, "t1", "", endpoints[0]) == nullptr);
+
+    for (int i = 0; i < 10; i++) {
+        std::string insert = "insert into t1 values('key" + std::to_string(i % 2) + "', " + std::to_string(i) + ");";
+        ASSERT_TRUE(router->ExecuteInsert(db, insert, &status)) << status.msg;
+    }
+    std::string sql =
+        "select col1, sum(col2) over w1 as w1_sum from t1 "
+        "window w1 as (partition by col1 order by col2 rows between 100 preceding and current row);";
+    for (int i = 0; i < 100; i++) {
+        std::string pk = "key1";
+        auto request_row = router->GetRequestRow(db, sql, &status);
+        ASSERT_TRUE(request_row != nullptr) << status.msg;
+        request_row->Init(pk.size());
+        request_row->AppendString(pk);
+        request_row->AppendInt64(100);
+        ASSERT_TRUE(request_row->Build());
+        auto rs = router->ExecuteSQLRequest(db, sql, request_row, &status);
+        ASSERT_TRUE(rs != nullptr) << status.msg;
+        ASSERT_EQ(1, rs->Size());
+        ASSERT_TRUE(rs->Next());
+        // 1 + 3 + 5 + 7 + 9 + 100
+        ASSERT_EQ(125, rs->GetInt64Unsafe(1));
+    }
+
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table t1;", &status));
+    ASSERT_TRUE(router->ExecuteDDL(db, "drop table t2;", &status));
+    ASSERT_TRUE(router->DropDB(db, &status));
+}
+
 }  // namespace sdk
 }  // namespace openmldb
 
@@ -390,6 +524,8 @@ int main(int argc, char** argv) {
     ::openmldb::sdk::MiniCluster mc(6181);
     ::openmldb::sdk::mc_ = &mc;
     FLAGS_enable_distsql = true;
+    // expire query cursors quickly for expired_query_cursor
+    FLAGS_query_cursor_expire_ms = 1000;
     int ok = ::openmldb::sdk::mc_->SetUp(3);
     sleep(1);
     ::testing::InitGoogleTest(&argc, argv);
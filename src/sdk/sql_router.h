@@ -37,6 +37,32 @@ struct SQLRouterOptions {
     uint32_t session_timeout = 2000;
     uint32_t max_sql_cache_size = 10;
     uint32_t request_timeout = 60000;
+    // run the batch queries scanning a single table on all partition leaders
+    // in parallel, if they only filter and project rows
+    bool enable_parallel_scan = true;
+    // coalesce the concurrent calls of a procedure on a tablet into batch
+    // requests, which wait at most `coalesce_window_us` for each other. 0 means
+    // calling them one by one
+    uint32_t coalesce_window_us = 0;
+    uint32_t coalesce_max_batch_size = 64;
+    // the max number of asynchronous requests waiting for the responses of a
+    // tablet, 0 means unlimited
+    uint32_t max_inflight_per_tablet = 0;
+    // read the request mode queries and procedures from any replica whose
+    // replication offset lags behind the leader at most
+    // `max_follower_offset_lag`, otherwise only from the leaders. The lags are
+    // refreshed every `follower_lag_refresh_ms`
+    bool enable_follower_read = false;
+    uint64_t max_follower_offset_lag = 0;
+    uint32_t follower_lag_refresh_ms = 1000;
+    // send a duplicate of a request mode query to a follower of the partition
+    // of its key if the tablet does not respond within its p95 latency, or
+    // `hedge_min_delay_us` at least. Queries without a key and procedure calls
+    // are not hedged. The hedged requests are limited to `hedge_ratio` of all
+    // requests
+    bool enable_hedged_request = false;
+    uint32_t hedge_min_delay_us = 1000;
+    double hedge_ratio = 0.05;
 };
 
 class ExplainInfo {
@@ -60,6 +86,16 @@ class QueryFuture {
     virtual bool IsDone() const = 0;
 };
 
+class InsertFuture {
+ public:
+    InsertFuture() {}
+    virtual ~InsertFuture() {}
+
+    // wait for all writes of the insert, return false if any of them fails
+    virtual bool Get(hybridse::sdk::Status* status) = 0;
+    virtual bool IsDone() const = 0;
+};
+
 class SQLRouter {
  public:
     SQLRouter() {}
@@ -126,6 +162,16 @@ class SQLRouter {
                                                                         const std::string& sp_name,
                                                                         hybridse::sdk::Status* status) = 0;
 
+    // override the follower read options of the router for the calls of a
+    // procedure
+    virtual void SetProcedureReadPolicy(const std::string& db, const std::string& sp_name, bool enable_follower_read,
+                                        uint64_t max_follower_offset_lag) = 0;
+
+    // serve the calls of a procedure from the result cache of tablets, the
+    // cached outputs are dropped once any key read by them is written.
+    // disabled by default
+    virtual void SetProcedureResultCache(const std::string& db, const std::string& sp_name, bool enable) = 0;
+
     virtual std::shared_ptr<openmldb::sdk::QueryFuture> CallProcedure(const std::string& db, const std::string& sp_name,
                                                                       int64_t timeout_ms,
                                                                       std::shared_ptr<openmldb::sdk::SQLRequestRow> row,
@@ -134,6 +180,20 @@ class SQLRouter {
     virtual std::shared_ptr<openmldb::sdk::QueryFuture> CallSQLBatchRequestProcedure(
         const std::string& db, const std::string& sp_name, int64_t timeout_ms,
         std::shared_ptr<openmldb::sdk::SQLRequestRowBatch> row_batch, hybridse::sdk::Status* status) = 0;
+
+    virtual std::shared_ptr<openmldb::sdk::QueryFuture> ExecuteSQLRequest(
+        const std::string& db, const std::string& sql, int64_t timeout_ms,
+        std::shared_ptr<openmldb::sdk::SQLRequestRow> row, hybridse::sdk::Status* status) = 0;
+
+    // run a batch query on one tablet, it is never scattered to partitions
+    virtual std::shared_ptr<openmldb::sdk::QueryFuture> ExecuteSQL(const std::string& db, const std::string& sql,
+                                                                   int64_t timeout_ms,
+                                                                   hybridse::sdk::Status* status) = 0;
+
+    virtual std::shared_ptr<openmldb::sdk::InsertFuture> ExecuteInsert(const std::string& db, const std::string& sql,
+                                                                       int64_t timeout_ms,
+                                                                       std::shared_ptr<openmldb::sdk::SQLInsertRow> row,
+                                                                       hybridse::sdk::Status* status) = 0;
 };
 
 std::shared_ptr<SQLRouter> NewClusterSQLRouter(const SQLRouterOptions& options);
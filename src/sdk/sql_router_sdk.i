@@ -38,9 +38,13 @@
 %shared_ptr(openmldb::sdk::ExplainInfo);
 %shared_ptr(hybridse::sdk::ProcedureInfo);
 %shared_ptr(openmldb::sdk::QueryFuture);
+%shared_ptr(openmldb::sdk::InsertFuture);
 %shared_ptr(openmldb::sdk::TableReader);
 %template(VectorUint32) std::vector<uint32_t>;
 %template(VectorString) std::vector<std::string>;
+%template(VectorInt64) std::vector<int64_t>;
+%template(VectorDouble) std::vector<double>;
+%template(VectorBool) std::vector<bool>;
 
 %{
 #include "sdk/sql_router.h"
@@ -63,6 +67,7 @@ using openmldb::sdk::SQLInsertRows;
 using openmldb::sdk::ExplainInfo;
 using hybridse::sdk::ProcedureInfo;
 using openmldb::sdk::QueryFuture;
+using openmldb::sdk::InsertFuture;
 using openmldb::sdk::TableReader;
 %}
 
@@ -564,6 +564,60 @@ TEST_F(SQLSDKTest, table_reader_async_scan) {
     ASSERT_EQ(1609212669000l, rs->GetInt64Unsafe(1));
     ASSERT_FALSE(rs->Next());
 }
+
+TEST_F(SQLSDKTest, async_insert_and_query) {
+    SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mc_->GetZkCluster();
+    sql_opt.zk_path = mc_->GetZkPath();
+    sql_opt.max_inflight_per_tablet = 100;
+    auto router = NewClusterSQLRouter(sql_opt);
+    ASSERT_TRUE(router != nullptr);
+    std::string db = GenRand("db");
+    ::hybridse::sdk::Status status;
+    ASSERT_TRUE(router->CreateDB(db, &status));
+    std::string ddl = "create table test0(col1 string, col2 bigint, index(key=col1, ts=col2));";
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status));
+    ASSERT_TRUE(router->RefreshCatalog());
+
+    std::string insert = "insert into test0 values(?, ?);";
+    std::vector<std::shared_ptr<InsertFuture>> insert_futures;
+    for (int i = 0; i < 10; i++) {
+        auto row = router->GetInsertRow(db, insert, &status);
+        ASSERT_TRUE(row);
+        ASSERT_TRUE(row->Init(4));
+        ASSERT_TRUE(row->AppendString("key1"));
+        ASSERT_TRUE(row->AppendInt64(1609212669000l + i));
+        ASSERT_TRUE(row->Build());
+        auto future = router->ExecuteInsert(db, insert, 1000, row, &status);
+        ASSERT_TRUE(future) << status.msg;
+        insert_futures.push_back(future);
+    }
+    for (auto& future : insert_futures) {
+        ASSERT_TRUE(future->Get(&status)) << status.msg;
+        ASSERT_TRUE(future->IsDone());
+    }
+
+    auto query_future = router->ExecuteSQL(db, "select * from test0;", 1000, &status);
+    ASSERT_TRUE(query_future) << status.msg;
+    auto rs = query_future->GetResultSet(&status);
+    ASSERT_TRUE(rs) << status.msg;
+    ASSERT_EQ(10, rs->Size());
+
+    std::string sql = "select col1, col2 + 1 from test0;";
+    auto request_row = router->GetRequestRow(db, sql, &status);
+    ASSERT_TRUE(request_row);
+    ASSERT_TRUE(request_row->Init(4));
+    ASSERT_TRUE(request_row->AppendString("key2"));
+    ASSERT_TRUE(request_row->AppendInt64(10));
+    ASSERT_TRUE(request_row->Build());
+    auto request_future = router->ExecuteSQLRequest(db, sql, 1000, request_row, &status);
+    ASSERT_TRUE(request_future) << status.msg;
+    rs = request_future->GetResultSet(&status);
+    ASSERT_TRUE(rs) << status.msg;
+    ASSERT_TRUE(rs->Next());
+    ASSERT_EQ("key2", rs->GetStringUnsafe(0));
+    ASSERT_EQ(11, rs->GetInt64Unsafe(1));
+}
 TEST_F(SQLSDKTest, create_table) {
     SQLRouterOptions sql_opt;
     sql_opt.zk_cluster = mc_->GetZkCluster();
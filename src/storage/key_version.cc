@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/key_version.h"
+
+#include "base/hash.h"
+#include "storage/segment.h"
+
+namespace openmldb {
+namespace storage {
+
+// differs from the seed of segments, otherwise the keys of a segment would
+// fall into a part of the slots only
+static constexpr uint32_t KEY_VERSION_SEED = 0x9e3779b9;
+
+KeyVersions::KeyVersions() : retired_(false) {
+    for (auto& version : versions_) {
+        version.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint32_t KeyVersions::GetSlot(const ::openmldb::base::Slice& key) {
+    return ::openmldb::base::hash(key.data(), key.size(), KEY_VERSION_SEED) % SLOT_NUM;
+}
+
+void KeyReadRecorder::Record(Segment* segment, const ::openmldb::base::Slice& key) {
+    if (!tracked_ || segment == nullptr) {
+        return;
+    }
+    auto versions = segment->GetKeyVersions();
+    uint32_t slot = KeyVersions::GetSlot(key);
+    for (const auto& version : versions_) {
+        if (version.versions == versions && version.slot == slot) {
+            return;
+        }
+    }
+    versions_.push_back({versions, slot, versions->Get(slot)});
+}
+
+void KeyReadRecorder::MarkUntracked() {
+    tracked_ = false;
+    versions_.clear();
+}
+
+bool KeyReadRecorder::IsLatest(const std::vector<KeyVersion>& versions) {
+    for (const auto& version : versions) {
+        if (version.versions->IsRetired() || version.versions->Get(version.slot) != version.version) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace storage
+}  // namespace openmldb
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_STORAGE_KEY_VERSION_H_
+#define SRC_STORAGE_KEY_VERSION_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/slice.h"
+
+namespace openmldb {
+namespace storage {
+
+class Segment;
+
+// Versions of the keys of a segment, bumped by every write of the keys. Keys
+// are hashed into a fixed number of slots, so a write may bump other keys too.
+class KeyVersions {
+ public:
+    static constexpr uint32_t SLOT_NUM = 1024;
+
+    KeyVersions();
+    KeyVersions(const KeyVersions&) = delete;
+    KeyVersions& operator=(const KeyVersions&) = delete;
+
+    static uint32_t GetSlot(const ::openmldb::base::Slice& key);
+
+    uint64_t Get(uint32_t slot) const { return versions_[slot].load(std::memory_order_acquire); }
+
+    // call it after the write is visible to readers
+    void Incr(const ::openmldb::base::Slice& key) {
+        versions_[GetSlot(key)].fetch_add(1, std::memory_order_release);
+    }
+
+    // the segment is released, its keys will not be bumped any more
+    void Retire() { retired_.store(true, std::memory_order_release); }
+
+    bool IsRetired() const { return retired_.load(std::memory_order_acquire); }
+
+ private:
+    std::atomic<uint64_t> versions_[SLOT_NUM];
+    std::atomic<bool> retired_;
+};
+
+struct KeyVersion {
+    std::shared_ptr<KeyVersions> versions;
+    uint32_t slot;
+    uint64_t version;
+};
+
+// Record the versions of the keys read by a request, so the result of the
+// request can be checked later against the writes since. The recorder is
+// handed to the iterators of the request. Reads which can not be tracked by
+// keys, e.g. full scans and reads of remote partitions, make the whole
+// request untracked.
+class KeyReadRecorder {
+ public:
+    KeyReadRecorder() : tracked_(true), versions_() {}
+    KeyReadRecorder(const KeyReadRecorder&) = delete;
+    KeyReadRecorder& operator=(const KeyReadRecorder&) = delete;
+
+    // record `key` of `segment` before it is read
+    void Record(Segment* segment, const ::openmldb::base::Slice& key);
+
+    void MarkUntracked();
+
+    // return true if none of the keys is written since it was recorded
+    static bool IsLatest(const std::vector<KeyVersion>& versions);
+
+    bool IsTracked() const { return tracked_; }
+
+    const std::vector<KeyVersion>& GetVersions() const { return versions_; }
+
+ private:
+    bool tracked_;
+    std::vector<KeyVersion> versions_;
+};
+
+}  // namespace storage
+}  // namespace openmldb
+#endif  // SRC_STORAGE_KEY_VERSION_H_
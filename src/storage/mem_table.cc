@@ -24,6 +24,7 @@
 #include "base/slice.h"
 #include "common/timer.h"
 #include "gflags/gflags.h"
+#include "storage/key_version.h"
 #include "storage/record.h"
 
 DECLARE_string(db_root_path);
@@ -696,7 +697,7 @@ bool MemTable::DeleteIndex(const std::string& idx_name) {
     return true;
 }
 
-::hybridse::vm::WindowIterator* MemTable::NewWindowIterator(uint32_t index) {
+::hybridse::vm::WindowIterator* MemTable::NewWindowIterator(uint32_t index, KeyReadRecorder* recorder) {
     std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(index);
     if (!index_def || !index_def->IsReady()) {
         LOG(WARNING) << "index" << index << "  not found. tid " << id_ << " pid " << pid_;
@@ -715,7 +716,8 @@ bool MemTable::DeleteIndex(const std::string& idx_name) {
     if (ts_col) {
         ts_idx = ts_col->GetTsIdx();
     }
-    return new MemTableKeyIterator(segments_[real_idx], seg_cnt_, ttl->ttl_type, expire_time, expire_cnt, ts_idx);
+    return new MemTableKeyIterator(segments_[real_idx], seg_cnt_, ttl->ttl_type, expire_time, expire_cnt, ts_idx,
+                                   recorder);
 }
 
 TableIterator* MemTable::NewTraverseIterator(uint32_t index) {
@@ -825,7 +827,8 @@ bool MemTable::BulkLoad(const std::vector<DataBlock*>& data_blocks,
 }
 
 MemTableKeyIterator::MemTableKeyIterator(Segment** segments, uint32_t seg_cnt, ::openmldb::storage::TTLType ttl_type,
-                                         uint64_t expire_time, uint64_t expire_cnt, uint32_t ts_index)
+                                         uint64_t expire_time, uint64_t expire_cnt, uint32_t ts_index,
+                                         KeyReadRecorder* recorder)
     : segments_(segments),
       seg_cnt_(seg_cnt),
       seg_idx_(0),
@@ -835,7 +838,8 @@ MemTableKeyIterator::MemTableKeyIterator(Segment** segments, uint32_t seg_cnt, :
       expire_time_(expire_time),
       expire_cnt_(expire_cnt),
       ticket_(),
-      ts_idx_(0) {
+      ts_idx_(0),
+      recorder_(recorder) {
     uint32_t idx = 0;
     if (segments_[0]->GetTsIdx(ts_index, idx) == 0) {
         ts_idx_ = idx;
@@ -871,6 +875,9 @@ void MemTableKeyIterator::Seek(const std::string& key) {
         seg_idx_ = ::openmldb::base::hash(key.c_str(), key.length(), SEED) % seg_cnt_;
     }
     Slice spk(key);
+    if (recorder_ != nullptr) {
+        recorder_->Record(segments_[seg_idx_], spk);
+    }
     pk_it_ = segments_[seg_idx_]->GetKeyEntries()->NewIterator();
     pk_it_->Seek(spk);
     if (!pk_it_->Valid()) {
@@ -79,7 +79,8 @@ class MemTableWindowIterator : public ::hybridse::vm::RowIterator {
 class MemTableKeyIterator : public ::hybridse::vm::WindowIterator {
  public:
     MemTableKeyIterator(Segment** segments, uint32_t seg_cnt, ::openmldb::storage::TTLType ttl_type,
-                        uint64_t expire_time, uint64_t expire_cnt, uint32_t ts_index);
+                        uint64_t expire_time, uint64_t expire_cnt, uint32_t ts_index,
+                        KeyReadRecorder* recorder = nullptr);
 
     ~MemTableKeyIterator() override;
 
@@ -111,6 +112,8 @@ class MemTableKeyIterator : public ::hybridse::vm::WindowIterator {
     uint32_t ts_index_{};
     Ticket ticket_;
     uint32_t ts_idx_;
+    // records the seeked keys, null if they are not recorded
+    KeyReadRecorder* recorder_;
 };
 
 class MemTableTraverseIterator : public TableIterator {
@@ -181,7 +184,7 @@ class MemTable : public Table {
 
     TableIterator* NewTraverseIterator(uint32_t index) override;
 
-    ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index);
+    ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index, KeyReadRecorder* recorder = nullptr) override;
 
     // release all memory allocated
     uint64_t Release();
@@ -39,7 +39,9 @@ Segment::Segment()
       pk_cnt_(0),
       ts_cnt_(1),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      key_versions_(),
+      has_key_versions_(false) {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     key_entry_max_height_ = (uint8_t)FLAGS_skiplist_max_height;
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
@@ -54,7 +56,9 @@ Segment::Segment(uint8_t height)
       key_entry_max_height_(height),
       ts_cnt_(1),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      key_versions_(),
+      has_key_versions_(false) {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
 }
@@ -68,7 +72,9 @@ Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec)
       key_entry_max_height_(height),
       ts_cnt_(ts_idx_vec.size()),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      key_versions_(),
+      has_key_versions_(false) {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
     for (uint32_t i = 0; i < ts_idx_vec.size(); i++) {
@@ -78,10 +84,24 @@ Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec)
 }
 
 Segment::~Segment() {
+    if (key_versions_) {
+        key_versions_->Retire();
+    }
     delete entries_;
     delete entry_free_list_;
 }
 
+std::shared_ptr<KeyVersions> Segment::GetKeyVersions() {
+    if (!has_key_versions_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!key_versions_) {
+            key_versions_ = std::make_shared<KeyVersions>();
+            has_key_versions_.store(true, std::memory_order_release);
+        }
+    }
+    return key_versions_;
+}
+
 uint64_t Segment::Release() {
     uint64_t cnt = 0;
     KeyEntries::Iterator* it = entries_->NewIterator();
@@ -191,6 +211,9 @@ void Segment::PutUnlock(const Slice& key, uint64_t time, DataBlock* row) {
         ->count_.fetch_add(1, std::memory_order_relaxed);
     byte_size += GetRecordTsIdxSize(height);
     idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
+    if (key_versions_) {
+        key_versions_->Incr(key);
+    }
 }
 
 void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row) {
@@ -221,6 +244,9 @@ void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t
         byte_size += GetRecordTsIdxSize(height);
         idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
         idx_cnt_vec_[key_entry_id]->fetch_add(1, std::memory_order_relaxed);
+        if (key_versions_) {
+            key_versions_->Incr(key);
+        }
     }
 }
 
@@ -275,6 +301,9 @@ void Segment::Put(const Slice& key, const TSDimensions& ts_dimension, DataBlock*
         idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
         idx_cnt_vec_[pos->second]->fetch_add(1, std::memory_order_relaxed);
     }
+    if (entry_arr != NULL && key_versions_) {
+        key_versions_->Incr(key);
+    }
 }
 
 bool Segment::Get(const Slice& key, const uint64_t time, DataBlock** block) {
@@ -316,6 +345,9 @@ bool Segment::Delete(const Slice& key) {
         if (entry_node == NULL) {
             return false;
         }
+        if (key_versions_) {
+            key_versions_->Incr(key);
+        }
     }
     {
         std::lock_guard<std::mutex> lock(gc_mu_);
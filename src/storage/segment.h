@@ -27,6 +27,7 @@
 #include "base/slice.h"
 #include "proto/tablet.pb.h"
 #include "storage/iterator.h"
+#include "storage/key_version.h"
 #include "storage/schema.h"
 #include "storage/ticket.h"
 
@@ -241,6 +242,10 @@ class Segment {
 
     void IncrGcVersion() { gc_version_.fetch_add(1, std::memory_order_relaxed); }
 
+    // the versions of keys bumped by writes, created on the first call, so
+    // segments never read by cached requests do not pay for them
+    std::shared_ptr<KeyVersions> GetKeyVersions();
+
     void ReleaseAndCount(uint64_t& gc_idx_cnt,            // NOLINT
                          uint64_t& gc_record_cnt,         // NOLINT
                          uint64_t& gc_record_byte_size);  // NOLINT
@@ -273,6 +278,9 @@ class Segment {
     std::map<uint32_t, uint32_t> ts_idx_map_;
     std::vector<std::shared_ptr<std::atomic<uint64_t>>> idx_cnt_vec_;
     uint64_t ttl_offset_;
+    // set once under mu_
+    std::shared_ptr<KeyVersions> key_versions_;
+    std::atomic<bool> has_key_versions_;
 };
 
 }  // namespace storage
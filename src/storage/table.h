@@ -37,6 +37,8 @@ using Schema = google::protobuf::RepeatedPtrField<openmldb::common::ColumnDesc>;
 
 enum TableStat { kUndefined = 0, kNormal, kLoading, kMakingSnapshot, kSnapshotPaused };
 
+class KeyReadRecorder;
+
 class Table {
  public:
     Table();
@@ -73,7 +75,8 @@ class Table {
 
     virtual TableIterator* NewTraverseIterator(uint32_t index) = 0;
 
-    virtual ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index) = 0;
+    // the keys seeked by the iterator are recorded into `recorder` if it is not null
+    virtual ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index, KeyReadRecorder* recorder = nullptr) = 0;
 
     virtual void SchedGc() = 0;
 
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/procedure_result_cache.h"
+
+#include <iterator>
+#include <utility>
+
+namespace openmldb::tablet {
+
+ProcedureResultCache::ProcedureResultCache(uint64_t max_bytes, uint64_t expire_ms)
+    : max_bytes_(max_bytes), expire_ms_(expire_ms), mu_(), lru_(), entries_(), stats_() {}
+
+std::string ProcedureResultCache::MakeKey(const std::string& db, const std::string& sp_name,
+                                          const std::string& row) {
+    // names are length prefixed, so different procedures never share keys
+    std::string key;
+    key.reserve(db.size() + sp_name.size() + row.size() + 16);
+    key.append(std::to_string(db.size())).append(1, ':').append(db);
+    key.append(std::to_string(sp_name.size())).append(1, ':').append(sp_name);
+    key.append(row);
+    return key;
+}
+
+bool ProcedureResultCache::Get(const std::string& db, const std::string& sp_name, const std::string& row,
+                               uint64_t now_ms, butil::IOBuf* output) {
+    std::string key = MakeKey(db, sp_name, row);
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        stats_.miss_cnt++;
+        return false;
+    }
+    auto iter = it->second;
+    if (iter->put_time_ms + expire_ms_ < now_ms || !::openmldb::storage::KeyReadRecorder::IsLatest(iter->versions)) {
+        Erase(iter);
+        stats_.invalidate_cnt++;
+        stats_.miss_cnt++;
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, iter);
+    // blocks of the output are shared instead of copied
+    output->append(iter->output);
+    stats_.hit_cnt++;
+    return true;
+}
+
+void ProcedureResultCache::Put(const std::string& db, const std::string& sp_name, const std::string& row,
+                               const butil::IOBuf& output, const std::vector<::openmldb::storage::KeyVersion>& versions,
+                               uint64_t now_ms) {
+    std::string key = MakeKey(db, sp_name, row);
+    uint64_t byte_size = sizeof(Entry) + key.size() * 2 + db.size() + sp_name.size() + output.size() +
+                         versions.size() * sizeof(::openmldb::storage::KeyVersion);
+    if (byte_size > max_bytes_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        Erase(it->second);
+    }
+    while (!lru_.empty() && stats_.byte_size + byte_size > max_bytes_) {
+        Erase(std::prev(lru_.end()));
+        stats_.evict_cnt++;
+    }
+    lru_.push_front(Entry{key, db, sp_name, output, versions, now_ms, byte_size});
+    entries_.emplace(std::move(key), lru_.begin());
+    stats_.entry_cnt++;
+    stats_.byte_size += byte_size;
+}
+
+void ProcedureResultCache::Drop(const std::string& db, const std::string& sp_name) {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (auto iter = lru_.begin(); iter != lru_.end();) {
+        auto cur = iter++;
+        if (cur->db == db && cur->sp_name == sp_name) {
+            Erase(cur);
+        }
+    }
+}
+
+ProcedureResultCacheStats ProcedureResultCache::GetStats() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return stats_;
+}
+
+void ProcedureResultCache::Erase(EntryIter iter) {
+    stats_.entry_cnt--;
+    stats_.byte_size -= iter->byte_size;
+    entries_.erase(iter->key);
+    lru_.erase(iter);
+}
+
+}  // namespace openmldb::tablet
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_PROCEDURE_RESULT_CACHE_H_
+#define SRC_TABLET_PROCEDURE_RESULT_CACHE_H_
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "butil/iobuf.h"
+#include "storage/key_version.h"
+
+namespace openmldb::tablet {
+
+struct ProcedureResultCacheStats {
+    uint64_t hit_cnt = 0;
+    uint64_t miss_cnt = 0;
+    // misses of outputs found but stale
+    uint64_t invalidate_cnt = 0;
+    uint64_t evict_cnt = 0;
+    uint64_t entry_cnt = 0;
+    uint64_t byte_size = 0;
+};
+
+/**
+ * Outputs of request mode procedure calls keyed by the procedure and the
+ * request row. An output is served while none of the keys read to compute it
+ * has been written since and it is not older than `expire_ms`. The least
+ * recently used outputs are evicted once they take more than `max_bytes`.
+ */
+class ProcedureResultCache {
+ public:
+    ProcedureResultCache(uint64_t max_bytes, uint64_t expire_ms);
+
+    // Append the cached output of the request to `output`, return false on a
+    // miss
+    bool Get(const std::string& db, const std::string& sp_name, const std::string& row, uint64_t now_ms,
+             butil::IOBuf* output);
+
+    // `now_ms` should be taken before the request is run
+    void Put(const std::string& db, const std::string& sp_name, const std::string& row, const butil::IOBuf& output,
+             const std::vector<::openmldb::storage::KeyVersion>& versions, uint64_t now_ms);
+
+    // Drop the outputs of a procedure, e.g. it is dropped or deployed again
+    void Drop(const std::string& db, const std::string& sp_name);
+
+    ProcedureResultCacheStats GetStats();
+
+ private:
+    struct Entry {
+        std::string key;
+        std::string db;
+        std::string sp_name;
+        butil::IOBuf output;
+        std::vector<::openmldb::storage::KeyVersion> versions;
+        uint64_t put_time_ms;
+        uint64_t byte_size;
+    };
+    typedef std::list<Entry>::iterator EntryIter;
+
+    static std::string MakeKey(const std::string& db, const std::string& sp_name, const std::string& row);
+
+    void Erase(EntryIter iter);
+
+ private:
+    const uint64_t max_bytes_;
+    const uint64_t expire_ms_;
+    std::mutex mu_;
+    // the most recently used at the front
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, EntryIter> entries_;
+    ProcedureResultCacheStats stats_;
+};
+
+}  // namespace openmldb::tablet
+#endif  // SRC_TABLET_PROCEDURE_RESULT_CACHE_H_
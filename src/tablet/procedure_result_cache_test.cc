@@ -0,0 +1,143 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/procedure_result_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/segment.h"
+
+namespace openmldb::tablet {
+
+using ::openmldb::storage::KeyReadRecorder;
+using ::openmldb::storage::KeyVersion;
+using ::openmldb::storage::Segment;
+
+class ProcedureResultCacheTest : public ::testing::Test {};
+
+static butil::IOBuf MakeOutput(const std::string& value) {
+    butil::IOBuf buf;
+    buf.append(value);
+    return buf;
+}
+
+// versions of the keys read from `segment`
+static std::vector<KeyVersion> ReadKeys(Segment* segment, const std::vector<std::string>& keys) {
+    KeyReadRecorder recorder;
+    for (const auto& key : keys) {
+        recorder.Record(segment, ::openmldb::base::Slice(key));
+    }
+    return recorder.GetVersions();
+}
+
+TEST_F(ProcedureResultCacheTest, invalidate_by_put) {
+    Segment segment;
+    segment.Put(::openmldb::base::Slice("pk1"), 1, "v1", 2);
+    ProcedureResultCache cache(1024 * 1024, 10000);
+    auto versions = ReadKeys(&segment, {"pk1", "pk2", "pk1"});
+    // the same key is recorded once
+    ASSERT_EQ(2u, versions.size());
+    cache.Put("db", "sp", "row1", MakeOutput("out1"), versions, 100);
+    cache.Put("db", "sp", "row2", MakeOutput("out2"), ReadKeys(&segment, {"pk3"}), 100);
+
+    butil::IOBuf output;
+    ASSERT_TRUE(cache.Get("db", "sp", "row1", 200, &output));
+    ASSERT_EQ("out1", output.to_string());
+    // other procedures do not share the outputs
+    ASSERT_FALSE(cache.Get("db", "sp2", "row1", 200, &output));
+
+    segment.Put(::openmldb::base::Slice("pk2"), 2, "v2", 2);
+    output.clear();
+    ASSERT_FALSE(cache.Get("db", "sp", "row1", 200, &output));
+    ASSERT_TRUE(cache.Get("db", "sp", "row2", 200, &output));
+    ASSERT_EQ("out2", output.to_string());
+
+    segment.Delete(::openmldb::base::Slice("pk3"));
+    segment.Put(::openmldb::base::Slice("pk3"), 3, "v3", 2);
+    ASSERT_FALSE(cache.Get("db", "sp", "row2", 200, &output));
+
+    auto stats = cache.GetStats();
+    ASSERT_EQ(2u, stats.hit_cnt);
+    ASSERT_EQ(3u, stats.miss_cnt);
+    ASSERT_EQ(2u, stats.invalidate_cnt);
+    ASSERT_EQ(0u, stats.entry_cnt);
+    ASSERT_EQ(0u, stats.byte_size);
+}
+
+TEST_F(ProcedureResultCacheTest, untracked_reads) {
+    Segment segment;
+    KeyReadRecorder recorder;
+    recorder.Record(&segment, ::openmldb::base::Slice("pk1"));
+    ASSERT_TRUE(recorder.IsTracked());
+    ASSERT_EQ(1u, recorder.GetVersions().size());
+    {
+        // recorders of other requests are not affected
+        KeyReadRecorder other;
+        other.MarkUntracked();
+        ASSERT_FALSE(other.IsTracked());
+    }
+    ASSERT_TRUE(recorder.IsTracked());
+    recorder.MarkUntracked();
+    ASSERT_FALSE(recorder.IsTracked());
+    ASSERT_TRUE(recorder.GetVersions().empty());
+    recorder.Record(&segment, ::openmldb::base::Slice("pk2"));
+    ASSERT_TRUE(recorder.GetVersions().empty());
+}
+
+TEST_F(ProcedureResultCacheTest, expire_and_drop) {
+    ProcedureResultCache cache(1024 * 1024, 1000);
+    cache.Put("db", "sp1", "row", MakeOutput("out1"), {}, 100);
+    cache.Put("db", "sp2", "row", MakeOutput("out2"), {}, 100);
+    butil::IOBuf output;
+    ASSERT_TRUE(cache.Get("db", "sp1", "row", 1100, &output));
+    ASSERT_FALSE(cache.Get("db", "sp1", "row", 1101, &output));
+
+    cache.Put("db", "sp1", "row", MakeOutput("out1"), {}, 2000);
+    cache.Drop("db", "sp2");
+    ASSERT_FALSE(cache.Get("db", "sp2", "row", 2000, &output));
+    ASSERT_TRUE(cache.Get("db", "sp1", "row", 2000, &output));
+    ASSERT_EQ(1u, cache.GetStats().entry_cnt);
+}
+
+TEST_F(ProcedureResultCacheTest, evict) {
+    ProcedureResultCache cache(1024, 10000);
+    std::string value(300, 'a');
+    for (int i = 0; i < 10; i++) {
+        cache.Put("db", "sp", "row" + std::to_string(i), MakeOutput(value), {}, 100);
+        ASSERT_LE(cache.GetStats().byte_size, 1024u);
+    }
+    auto stats = cache.GetStats();
+    ASSERT_GT(stats.evict_cnt, 0u);
+    ASSERT_EQ(10u, stats.entry_cnt + stats.evict_cnt);
+    butil::IOBuf output;
+    // the least recently used are evicted
+    ASSERT_FALSE(cache.Get("db", "sp", "row0", 100, &output));
+    ASSERT_TRUE(cache.Get("db", "sp", "row9", 100, &output));
+
+    // an output larger than the cache is not kept
+    cache.Put("db", "sp", "large", MakeOutput(std::string(2048, 'b')), {}, 100);
+    ASSERT_FALSE(cache.Get("db", "sp", "large", 100, &output));
+}
+
+}  // namespace openmldb::tablet
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/query_cursor.h"
+
+#include <utility>
+
+#include "common/timer.h"
+#include "glog/logging.h"
+
+namespace openmldb::tablet {
+
+QueryCursorManager::QueryCursorManager(uint32_t max_cursors, uint64_t max_bytes, uint64_t expire_ms)
+    : max_cursors_(max_cursors),
+      max_bytes_(max_bytes),
+      expire_ms_(expire_ms),
+      mu_(),
+      rand_(std::random_device()()),
+      bytes_(0),
+      cursors_() {}
+
+size_t QueryCursorManager::AppendChunk(const std::vector<::hybridse::codec::Row>& rows, size_t offset,
+                                       uint32_t max_bytes, butil::IOBuf* buf, uint32_t* count, uint32_t* byte_size) {
+    *count = 0;
+    *byte_size = 0;
+    for (; offset < rows.size(); ++offset) {
+        auto& row = rows[offset];
+        if (*count > 0 && *byte_size + row.size() > max_bytes) {
+            break;
+        }
+        buf->append(reinterpret_cast<void*>(row.buf()), row.size());
+        *byte_size += row.size();
+        *count += 1;
+    }
+    return offset;
+}
+
+uint64_t QueryCursorManager::Open(const std::string& schema, std::vector<::hybridse::codec::Row>&& rows,
+                                  size_t offset) {
+    auto cursor = std::make_shared<QueryCursor>();
+    cursor->schema = schema;
+    cursor->rows = std::move(rows);
+    cursor->offset = offset;
+    for (size_t i = 0; i < cursor->rows.size(); i++) {
+        if (i < offset) {
+            cursor->rows[i] = ::hybridse::codec::Row();
+        } else {
+            cursor->bytes += cursor->rows[i].size();
+        }
+    }
+    cursor->last_access_ms = ::baidu::common::timer::get_micros() / 1000;
+    std::lock_guard<std::mutex> lock(mu_);
+    if (cursors_.size() >= max_cursors_) {
+        LOG(WARNING) << "reach the max number of query cursors " << max_cursors_;
+        return 0;
+    }
+    if (bytes_ + cursor->bytes > max_bytes_) {
+        LOG(WARNING) << "reach the max bytes of query cursors " << max_bytes_ << ", kept " << bytes_
+                     << " and request " << cursor->bytes;
+        return 0;
+    }
+    uint64_t id = 0;
+    do {
+        id = rand_();
+    } while (0 == id || cursors_.count(id) > 0);
+    cursors_.emplace(id, cursor);
+    bytes_ += cursor->bytes;
+    return id;
+}
+
+bool QueryCursorManager::Fetch(uint64_t id, uint32_t max_bytes, butil::IOBuf* buf, uint32_t* count,
+                               uint32_t* byte_size, bool* has_more, std::string* schema) {
+    std::shared_ptr<QueryCursor> cursor;
+    {
+        // mark the cursor, so that the chunk is copied without the lock
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = cursors_.find(id);
+        if (it == cursors_.end() || it->second->fetching) {
+            return false;
+        }
+        cursor = it->second;
+        cursor->fetching = true;
+    }
+    // only the fetching thread touches rows and offset of the cursor
+    size_t begin = cursor->offset;
+    size_t end = AppendChunk(cursor->rows, begin, max_bytes, buf, count, byte_size);
+    for (size_t i = begin; i < end; i++) {
+        cursor->rows[i] = ::hybridse::codec::Row();
+    }
+    *schema = cursor->schema;
+    *has_more = end < cursor->rows.size();
+    std::lock_guard<std::mutex> lock(mu_);
+    cursor->offset = end;
+    cursor->fetching = false;
+    if (cursor->closed) {
+        // its bytes were released by Close
+        *has_more = false;
+        return true;
+    }
+    cursor->bytes -= *byte_size;
+    cursor->last_access_ms = ::baidu::common::timer::get_micros() / 1000;
+    bytes_ -= *byte_size;
+    if (!*has_more) {
+        cursors_.erase(id);
+    }
+    return true;
+}
+
+bool QueryCursorManager::Close(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = cursors_.find(id);
+    if (it == cursors_.end()) {
+        return false;
+    }
+    bytes_ -= it->second->bytes;
+    it->second->closed = true;
+    cursors_.erase(it);
+    return true;
+}
+
+uint32_t QueryCursorManager::Expire(uint64_t now_ms) {
+    std::vector<std::shared_ptr<QueryCursor>> expired;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (auto it = cursors_.begin(); it != cursors_.end();) {
+            if (!it->second->fetching && it->second->last_access_ms + expire_ms_ <= now_ms) {
+                bytes_ -= it->second->bytes;
+                expired.push_back(it->second);
+                it = cursors_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    // rows are released out of the lock
+    return expired.size();
+}
+
+size_t QueryCursorManager::Size() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return cursors_.size();
+}
+
+uint64_t QueryCursorManager::Bytes() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return bytes_;
+}
+
+}  // namespace openmldb::tablet
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_QUERY_CURSOR_H_
+#define SRC_TABLET_QUERY_CURSOR_H_
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <vector>
+
+#include "butil/iobuf.h"
+#include "codec/row.h"
+
+namespace openmldb::tablet {
+
+// Remaining rows of a batch query, which are fetched chunk by chunk
+struct QueryCursor {
+    std::string schema;
+    // rows before `offset` are fetched and released
+    std::vector<::hybridse::codec::Row> rows;
+    size_t offset = 0;
+    // bytes of the rows not fetched
+    uint64_t bytes = 0;
+    uint64_t last_access_ms = 0;
+    // a chunk is being copied out of the lock
+    bool fetching = false;
+    // closed while fetching, the fetch drops it at the end
+    bool closed = false;
+};
+
+/**
+ * Batch query results larger than a chunk are kept as cursors, so clients can
+ * fetch them chunk by chunk instead of getting truncated results. Cursors
+ * which are not fetched in `expire_ms` are dropped by `Expire`.
+ *
+ * The rows kept by all cursors are bounded by `max_bytes`. A new cursor over
+ * the bound is rejected rather than evicting the cursors being read.
+ *
+ * Cursor ids are random, so a client can not fetch the cursors of others by
+ * guessing the next id.
+ */
+class QueryCursorManager {
+ public:
+    QueryCursorManager(uint32_t max_cursors, uint64_t max_bytes, uint64_t expire_ms);
+
+    // Append rows from `offset` until `max_bytes` is reached, and at least one
+    // row. Return the offset of the next row.
+    static size_t AppendChunk(const std::vector<::hybridse::codec::Row>& rows, size_t offset, uint32_t max_bytes,
+                              butil::IOBuf* buf, uint32_t* count, uint32_t* byte_size);
+
+    // Return the cursor id, or 0 if there are too many cursors or the rows
+    // exceed the bytes left
+    uint64_t Open(const std::string& schema, std::vector<::hybridse::codec::Row>&& rows, size_t offset);
+
+    // Append the next chunk of the cursor to `buf`, the cursor is closed when
+    // all rows are fetched. Return false if the cursor does not exist or
+    // another fetch of it is running.
+    bool Fetch(uint64_t id, uint32_t max_bytes, butil::IOBuf* buf, uint32_t* count, uint32_t* byte_size,
+               bool* has_more, std::string* schema);
+
+    bool Close(uint64_t id);
+
+    // Drop the cursors not accessed since `now_ms - expire_ms`, return the
+    // number of dropped cursors
+    uint32_t Expire(uint64_t now_ms);
+
+    size_t Size();
+
+    // Bytes of the rows kept by all cursors
+    uint64_t Bytes();
+
+ private:
+    const uint32_t max_cursors_;
+    const uint64_t max_bytes_;
+    const uint64_t expire_ms_;
+    std::mutex mu_;
+    std::mt19937_64 rand_;
+    uint64_t bytes_;
+    std::map<uint64_t, std::shared_ptr<QueryCursor>> cursors_;
+};
+
+}  // namespace openmldb::tablet
+#endif  // SRC_TABLET_QUERY_CURSOR_H_
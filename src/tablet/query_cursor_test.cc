@@ -0,0 +1,166 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/query_cursor.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb::tablet {
+
+class QueryCursorTest : public ::testing::Test {};
+
+static std::vector<::hybridse::codec::Row> MakeRows(uint32_t cnt, uint32_t row_size) {
+    std::vector<::hybridse::codec::Row> rows;
+    for (uint32_t i = 0; i < cnt; i++) {
+        rows.emplace_back(std::string(row_size, 'a' + i % 26));
+    }
+    return rows;
+}
+
+TEST_F(QueryCursorTest, append_chunk) {
+    auto rows = MakeRows(10, 100);
+    butil::IOBuf buf;
+    uint32_t count = 0;
+    uint32_t byte_size = 0;
+    ASSERT_EQ(3u, QueryCursorManager::AppendChunk(rows, 0, 350, &buf, &count, &byte_size));
+    ASSERT_EQ(3u, count);
+    ASSERT_EQ(300u, byte_size);
+    ASSERT_EQ(300u, buf.size());
+
+    // at least one row even if it is larger than the chunk
+    buf.clear();
+    ASSERT_EQ(4u, QueryCursorManager::AppendChunk(rows, 3, 10, &buf, &count, &byte_size));
+    ASSERT_EQ(1u, count);
+    ASSERT_EQ(100u, byte_size);
+
+    buf.clear();
+    ASSERT_EQ(10u, QueryCursorManager::AppendChunk(rows, 4, 10000, &buf, &count, &byte_size));
+    ASSERT_EQ(6u, count);
+}
+
+TEST_F(QueryCursorTest, fetch) {
+    QueryCursorManager mgr(10, 1 << 20, 60000);
+    uint64_t id = mgr.Open("schema", MakeRows(10, 100), 2);
+    ASSERT_NE(0u, id);
+    ASSERT_EQ(1u, mgr.Size());
+
+    uint32_t total = 0;
+    bool has_more = true;
+    while (has_more) {
+        butil::IOBuf buf;
+        uint32_t count = 0;
+        uint32_t byte_size = 0;
+        std::string schema;
+        ASSERT_TRUE(mgr.Fetch(id, 300, &buf, &count, &byte_size, &has_more, &schema));
+        ASSERT_EQ("schema", schema);
+        ASSERT_EQ(byte_size, buf.size());
+        total += count;
+    }
+    ASSERT_EQ(8u, total);
+    // closed after the last chunk
+    ASSERT_EQ(0u, mgr.Size());
+    butil::IOBuf buf;
+    uint32_t count = 0;
+    uint32_t byte_size = 0;
+    std::string schema;
+    ASSERT_FALSE(mgr.Fetch(id, 300, &buf, &count, &byte_size, &has_more, &schema));
+}
+
+TEST_F(QueryCursorTest, limit_and_expire) {
+    QueryCursorManager mgr(2, 1 << 20, 1000);
+    uint64_t id1 = mgr.Open("", MakeRows(2, 10), 1);
+    uint64_t id2 = mgr.Open("", MakeRows(2, 10), 1);
+    ASSERT_NE(0u, id1);
+    ASSERT_NE(0u, id2);
+    ASSERT_NE(id1, id2);
+    // ids are random rather than sequential
+    ASSERT_NE(id1 + 1, id2);
+    ASSERT_EQ(0u, mgr.Open("", MakeRows(2, 10), 1));
+
+    ASSERT_TRUE(mgr.Close(id1));
+    ASSERT_FALSE(mgr.Close(id1));
+    ASSERT_EQ(1u, mgr.Size());
+
+    ASSERT_EQ(0u, mgr.Expire(0));
+    ASSERT_EQ(1u, mgr.Expire(UINT64_MAX - 1000));
+    ASSERT_EQ(0u, mgr.Size());
+    ASSERT_EQ(0u, mgr.Bytes());
+}
+
+TEST_F(QueryCursorTest, max_bytes) {
+    QueryCursorManager mgr(10, 1000, 60000);
+    // only the rows not sent yet are counted
+    uint64_t id1 = mgr.Open("", MakeRows(10, 100), 4);
+    ASSERT_NE(0u, id1);
+    ASSERT_EQ(600u, mgr.Bytes());
+    ASSERT_EQ(0u, mgr.Open("", MakeRows(5, 100), 0));
+    uint64_t id2 = mgr.Open("", MakeRows(5, 100), 1);
+    ASSERT_NE(0u, id2);
+    ASSERT_EQ(1000u, mgr.Bytes());
+
+    // fetched rows are released
+    butil::IOBuf buf;
+    uint32_t count = 0;
+    uint32_t byte_size = 0;
+    bool has_more = false;
+    std::string schema;
+    ASSERT_TRUE(mgr.Fetch(id1, 300, &buf, &count, &byte_size, &has_more, &schema));
+    ASSERT_TRUE(has_more);
+    ASSERT_EQ(700u, mgr.Bytes());
+    ASSERT_NE(0u, mgr.Open("", MakeRows(3, 100), 0));
+    ASSERT_EQ(1000u, mgr.Bytes());
+
+    ASSERT_TRUE(mgr.Close(id2));
+    ASSERT_EQ(600u, mgr.Bytes());
+    ASSERT_EQ(2u, mgr.Expire(UINT64_MAX - 60000));
+    ASSERT_EQ(0u, mgr.Bytes());
+}
+
+TEST_F(QueryCursorTest, close_while_fetching) {
+    for (int round = 0; round < 100; round++) {
+        QueryCursorManager mgr(10, 1 << 20, 60000);
+        uint64_t id = mgr.Open("", MakeRows(100, 100), 0);
+        ASSERT_NE(0u, id);
+        std::thread fetcher([&mgr, id]() {
+            bool has_more = true;
+            while (has_more) {
+                butil::IOBuf buf;
+                uint32_t count = 0;
+                uint32_t byte_size = 0;
+                std::string schema;
+                if (!mgr.Fetch(id, 100, &buf, &count, &byte_size, &has_more, &schema)) {
+                    break;
+                }
+            }
+        });
+        mgr.Close(id);
+        fetcher.join();
+        // a closed cursor is never put back by a racing fetch
+        ASSERT_EQ(0u, mgr.Size());
+        ASSERT_EQ(0u, mgr.Bytes());
+    }
+}
+
+}  // namespace openmldb::tablet
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -18,6 +18,9 @@
 #include <gflags/gflags.h>
 #include <unistd.h>
 
+#include <string>
+#include <vector>
+
 #include "base/glog_wapper.h"
 #include "client/ns_client.h"
 #include "common/timer.h"
@@ -38,6 +41,7 @@ DECLARE_int32(request_timeout_ms);
 DECLARE_int32(request_timeout_ms);
 DECLARE_bool(binlog_notify_on_put);
 DECLARE_bool(auto_failover);
+DECLARE_int32(procedure_compile_pool_size);
 
 using ::openmldb::nameserver::NameServerImpl;
 using ::openmldb::zk::ZkClient;
@@ -423,6 +427,91 @@ TEST_F(SqlClusterTest, DropProcedureBeforeDropTable) {
     delete tablet2;
 }
 
+TEST_F(SqlClusterTest, RecoverProceduresConcurrently) {
+    FLAGS_auto_failover = true;
+    FLAGS_zk_cluster = "127.0.0.1:6181";
+    FLAGS_zk_root_path = "/rtidb4" + GenRand();
+    FLAGS_procedure_compile_pool_size = 3;
+
+    // ns1
+    FLAGS_endpoint = "127.0.0.1:9633";
+    brpc::Server ns_server;
+    StartNameServer(ns_server);
+    ::openmldb::RpcClient<::openmldb::nameserver::NameServer_Stub> name_server_client(FLAGS_endpoint, "");
+    name_server_client.Init();
+
+    // tablet1
+    FLAGS_endpoint = "127.0.0.1:9833";
+    FLAGS_db_root_path = "/tmp/" + GenRand();
+    brpc::Server tb_server1;
+    ::openmldb::tablet::TabletImpl* tablet1 = new ::openmldb::tablet::TabletImpl();
+    StartTablet(&tb_server1, tablet1);
+
+    std::string ddl =
+        "create table trans(c1 string,\n"
+        "                   c3 int,\n"
+        "                   c4 bigint,\n"
+        "                   c7 timestamp,\n"
+        "                   index(key=c1, ts=c7));";
+    auto router = GetNewSQLRouter();
+    if (!router) {
+        FAIL() << "Fail new cluster sql router";
+    }
+    std::string db = "test";
+    hybridse::sdk::Status status;
+    ASSERT_TRUE(router->CreateDB(db, &status));
+    ASSERT_TRUE(router->ExecuteDDL(db, ddl, &status));
+    ASSERT_TRUE(router->RefreshCatalog());
+    ASSERT_TRUE(router->ExecuteInsert(db, "insert into trans values(\"bb\",24,34,1590738994000);", &status));
+    // more procedures than compiling threads, each with its own window size
+    std::vector<std::string> sp_names;
+    std::string sql;
+    for (int i = 0; i < 5; i++) {
+        std::string sp_name = "sp" + std::to_string(i);
+        sql = "SELECT c1, c3, sum(c4) OVER w1 as w1_c4_sum FROM trans WINDOW w1 AS"
+              " (PARTITION BY trans.c1 ORDER BY trans.c7 ROWS BETWEEN " +
+              std::to_string(i + 1) + " PRECEDING AND CURRENT ROW);";
+        std::string sp_ddl = "create procedure " + sp_name + " (c1 string, c3 int, c4 bigint, c7 timestamp)" +
+                             " begin " + sql + " end;";
+        ASSERT_TRUE(router->ExecuteDDL(db, sp_ddl, &status)) << status.msg;
+        sp_names.push_back(sp_name);
+    }
+    ASSERT_TRUE(router->RefreshCatalog());
+    auto request_row = router->GetRequestRow(db, sql, &status);
+    ASSERT_TRUE(request_row);
+    request_row->Init(2);
+    ASSERT_TRUE(request_row->AppendString("bb"));
+    ASSERT_TRUE(request_row->AppendInt32(23));
+    ASSERT_TRUE(request_row->AppendInt64(33));
+    ASSERT_TRUE(request_row->AppendTimestamp(1590738994000));
+    ASSERT_TRUE(request_row->Build());
+
+    // restart, procedures are compiled concurrently while the tablet loads
+    tb_server1.Stop(10);
+    delete tablet1;
+    sleep(3);
+    brpc::Server tb_server2;
+    ::openmldb::tablet::TabletImpl* tablet2 = new ::openmldb::tablet::TabletImpl();
+    StartTablet(&tb_server2, tablet2);
+    sleep(3);
+    for (const auto& sp_name : sp_names) {
+        auto rs = router->CallProcedure(db, sp_name, request_row, &status);
+        if (!rs) FAIL() << "call procedure " << sp_name << " failed";
+        ASSERT_TRUE(rs->Next());
+        ASSERT_EQ(rs->GetStringUnsafe(0), "bb");
+        ASSERT_EQ(rs->GetInt32Unsafe(1), 23);
+        ASSERT_EQ(rs->GetInt64Unsafe(2), 67);
+        ASSERT_FALSE(rs->Next());
+    }
+
+    for (const auto& sp_name : sp_names) {
+        DropProcedure(name_server_client, db, sp_name);
+    }
+    DropTable(name_server_client, db, "trans", true);
+    tb_server2.Stop(10);
+    delete tablet2;
+}
+
 }  // namespace tablet
 }  // namespace openmldb
 
@@ -27,6 +27,9 @@
 #include <snappy.h>
 
 #include <algorithm>
+#include <atomic>
+#include <set>
+#include <sstream>
 #include <thread>  // NOLINT
 #include <utility>
 #include <vector>
@@ -37,6 +40,7 @@
 #ifdef TCMALLOC_ENABLE
 #include "gperftools/malloc_extension.h"
 #endif
+#include "base/count_down_latch.h"
 #include "base/file_util.h"
 #include "base/glog_wapper.h"
 #include "base/hash.h"
@@ -51,6 +55,7 @@
 #include "common/timer.h"
 #include "glog/logging.h"
 #include "storage/binlog.h"
+#include "storage/key_version.h"
 #include "storage/segment.h"
 #include "tablet/file_sender.h"
 
@@ -64,12 +69,18 @@ DECLARE_int32(gc_interval);
 DECLARE_int32(gc_pool_size);
 DECLARE_int32(statdb_ttl);
 DECLARE_uint32(scan_max_bytes_size);
+DECLARE_uint32(query_cursor_max_num);
+DECLARE_uint32(query_cursor_expire_ms);
+DECLARE_uint64(query_cursor_max_bytes);
+DECLARE_uint64(procedure_result_cache_max_bytes);
+DECLARE_uint32(procedure_result_cache_expire_ms);
 DECLARE_uint32(scan_reserve_size);
 DECLARE_double(mem_release_rate);
 DECLARE_string(db_root_path);
 DECLARE_bool(binlog_notify_on_put);
 DECLARE_int32(task_pool_size);
 DECLARE_int32(io_pool_size);
+DECLARE_int32(procedure_compile_pool_size);
 DECLARE_int32(make_snapshot_time);
 DECLARE_int32(make_snapshot_check_interval);
 DECLARE_uint32(make_snapshot_offline_interval);
@@ -82,6 +93,13 @@ DECLARE_uint32(task_check_interval);
 DECLARE_uint32(load_index_max_wait_time);
 DECLARE_bool(use_name);
 DECLARE_bool(enable_distsql);
+DECLARE_string(jit_object_cache_dir);
+DECLARE_bool(enable_tiered_compile);
+DECLARE_bool(enable_literal_normalize);
+DECLARE_uint64(interpret_max_rows);
+DECLARE_uint64(max_batch_memory_bytes);
+DECLARE_string(spill_dir);
+DECLARE_string(udf_plugins);
 DECLARE_string(snapshot_compression);
 DECLARE_string(file_compression);
 
@@ -120,6 +138,8 @@ TabletImpl::TabletImpl()
       task_pool_(FLAGS_task_pool_size),
       io_pool_(FLAGS_io_pool_size),
       snapshot_pool_(FLAGS_snapshot_pool_size),
+      sp_compile_pool_(FLAGS_procedure_compile_pool_size),
+      query_cursor_mgr_(FLAGS_query_cursor_max_num, FLAGS_query_cursor_max_bytes, FLAGS_query_cursor_expire_ms),
       server_(NULL),
       mode_root_paths_(),
       mode_recycle_root_paths_(),
@@ -130,6 +150,7 @@ TabletImpl::TabletImpl()
       zk_path_(),
       endpoint_(),
       sp_cache_(std::shared_ptr<SpCache>(new SpCache())),
+      sp_result_cache_(FLAGS_procedure_result_cache_max_bytes, FLAGS_procedure_result_cache_expire_ms),
       notify_path_() {}
 
 TabletImpl::~TabletImpl() {
@@ -138,6 +159,7 @@ TabletImpl::~TabletImpl() {
     gc_pool_.Stop(true);
     io_pool_.Stop(true);
     snapshot_pool_.Stop(true);
+    sp_compile_pool_.Stop(true);
     delete zk_client_;
 }
 
@@ -147,8 +169,26 @@ bool TabletImpl::Init(const std::string& real_endpoint) {
 
 bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path, const std::string& endpoint,
                       const std::string& real_endpoint) {
+    std::vector<std::string> udf_plugins;
+    ::openmldb::base::SplitString(FLAGS_udf_plugins, ",", udf_plugins);
+    for (const auto& plugin : udf_plugins) {
+        if (plugin.empty()) {
+            continue;
+        }
+        auto status = ::hybridse::vm::Engine::LoadUdfPlugin(plugin);
+        if (!status.isOK()) {
+            LOG(WARNING) << "fail to load udf plugin: " << status.msg;
+            return false;
+        }
+    }
     ::hybridse::vm::EngineOptions options;
     options.set_cluster_optimized(FLAGS_enable_distsql);
+    options.jit_options().set_object_cache_dir(FLAGS_jit_object_cache_dir);
+    options.set_enable_tiered_compile(FLAGS_enable_tiered_compile);
+    options.set_enable_literal_normalize(FLAGS_enable_literal_normalize);
+    options.set_interpret_max_rows(FLAGS_interpret_max_rows);
+    options.set_max_batch_memory_bytes(FLAGS_max_batch_memory_bytes);
+    options.set_spill_dir(FLAGS_spill_dir);
     engine_ = std::unique_ptr<::hybridse::vm::Engine>(new ::hybridse::vm::Engine(catalog_, options));
     catalog_->SetLocalTablet(
         std::shared_ptr<::hybridse::vm::Tablet>(new ::hybridse::vm::LocalTablet(engine_.get(), sp_cache_)));
@@ -208,6 +248,7 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
     if (FLAGS_recycle_ttl != 0) {
         task_pool_.DelayTask(FLAGS_recycle_ttl * 60 * 1000, boost::bind(&TabletImpl::SchedDelRecycle, this));
     }
+    task_pool_.DelayTask(FLAGS_query_cursor_expire_ms, boost::bind(&TabletImpl::SchedExpireQueryCursor, this));
 #ifdef TCMALLOC_ENABLE
     MallocExtension* tcmalloc = MallocExtension::instance();
     tcmalloc->SetMemoryReleaseRate(FLAGS_mem_release_rate);
@@ -282,6 +323,12 @@ bool TabletImpl::RegisterZK() {
                 return false;
             }
         }
+        // compile procedures before the tablet is visible, so requests are
+        // only routed to it once procedures are ready
+        if (zk_client_->IsExistNode(notify_path_) == 0) {
+            RefreshTableInfo();
+            PDLOG(INFO, "procedures ready on tablet %s", endpoint_.c_str());
+        }
         if (!zk_client_->Register(true)) {
             PDLOG(WARNING, "fail to register tablet with endpoint %s", endpoint_.c_str());
             return false;
@@ -1525,6 +1572,20 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
             response->set_msg("fail to decode parameter row");
             return;
         }
+        std::set<uint32_t> scan_pids;
+        for (auto pid : request->scan_pids()) {
+            if (!GetTable(request->scan_tid(), pid)) {
+                response->set_code(::openmldb::base::ReturnCode::kTableIsNotExist);
+                response->set_msg("partition " + std::to_string(pid) + " of table " +
+                                  std::to_string(request->scan_tid()) + " does not exist");
+                return;
+            }
+            scan_pids.insert(pid);
+        }
+        if (!scan_pids.empty()) {
+            session.SetScanFilter(
+                std::make_shared<::openmldb::catalog::ScanPartitionFilter>(request->scan_tid(), scan_pids));
+        }
         std::vector<::hybridse::codec::Row> output_rows;
         int32_t run_ret = session.Run(parameter_row, output_rows);
         if (run_ret != 0) {
@@ -1535,18 +1596,36 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
         }
         uint32_t byte_size = 0;
         uint32_t count = 0;
-        for (auto& output_row : output_rows) {
-            if (byte_size > FLAGS_scan_max_bytes_size) {
-                LOG(WARNING) << "reach the max byte size truncate result";
-                response->set_schema(session.GetEncodedSchema());
-                response->set_byte_size(byte_size);
-                response->set_count(count);
-                response->set_code(::openmldb::base::kOk);
-                return;
+        if (request->enable_cursor()) {
+            size_t offset = QueryCursorManager::AppendChunk(output_rows, 0, FLAGS_scan_max_bytes_size, buf, &count,
+                                                            &byte_size);
+            response->set_total_count(output_rows.size());
+            if (offset < output_rows.size()) {
+                uint64_t cursor_id =
+                    query_cursor_mgr_.Open(session.GetEncodedSchema(), std::move(output_rows), offset);
+                if (cursor_id == 0) {
+                    buf->clear();
+                    response->set_msg("too many query cursors, or the rows of cursors exceed the limit");
+                    response->set_code(::openmldb::base::kTooManyQueryCursors);
+                    return;
+                }
+                response->set_cursor_id(cursor_id);
+                response->set_has_more(true);
+            }
+        } else {
+            for (auto& output_row : output_rows) {
+                if (byte_size > FLAGS_scan_max_bytes_size) {
+                    LOG(WARNING) << "reach the max byte size truncate result";
+                    response->set_schema(session.GetEncodedSchema());
+                    response->set_byte_size(byte_size);
+                    response->set_count(count);
+                    response->set_code(::openmldb::base::kOk);
+                    return;
+                }
+                byte_size += output_row.size();
+                buf->append(reinterpret_cast<void*>(output_row.buf()), output_row.size());
+                count += 1;
             }
-            byte_size += output_row.size();
-            buf->append(reinterpret_cast<void*>(output_row.buf()), output_row.size());
-            count += 1;
         }
         response->set_schema(session.GetEncodedSchema());
         response->set_byte_size(byte_size);
@@ -1575,7 +1654,13 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
             }
             session.SetCompileInfo(request_compile_info);
             session.SetSpName(sp_name);
-            RunRequestQuery(ctrl, *request, session, *response, *buf);
+            // keys read by sub queries on other tablets are not known here
+            if (request->enable_result_cache() && !request->has_task_id() &&
+                FLAGS_procedure_result_cache_max_bytes > 0 && !request_compile_info->HasSubQuery()) {
+                RunCachedRequestQuery(ctrl, *request, session, *response, *buf);
+            } else {
+                RunRequestQuery(ctrl, *request, session, *response, *buf);
+            }
         } else {
             bool ok = engine_->Get(request->sql(), request->db(), session, status);
             if (!ok || session.GetCompileInfo() == nullptr) {
@@ -1604,6 +1689,33 @@ void TabletImpl::SubQuery(RpcController* ctrl, const openmldb::api::QueryRequest
     ProcessQuery(ctrl, request, response, &buf);
 }
 
+void TabletImpl::FetchQuery(RpcController* ctrl, const openmldb::api::FetchQueryRequest* request,
+                            openmldb::api::QueryResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    if (request->close()) {
+        query_cursor_mgr_.Close(request->cursor_id());
+        response->set_code(::openmldb::base::kOk);
+        return;
+    }
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(ctrl);
+    uint32_t count = 0;
+    uint32_t byte_size = 0;
+    bool has_more = false;
+    std::string schema;
+    if (!query_cursor_mgr_.Fetch(request->cursor_id(), FLAGS_scan_max_bytes_size, &cntl->response_attachment(),
+                                 &count, &byte_size, &has_more, &schema)) {
+        response->set_msg("query cursor not found, it may be expired");
+        response->set_code(::openmldb::base::kQueryCursorNotFound);
+        return;
+    }
+    response->set_schema(schema);
+    response->set_count(count);
+    response->set_byte_size(byte_size);
+    response->set_cursor_id(request->cursor_id());
+    response->set_has_more(has_more);
+    response->set_code(::openmldb::base::kOk);
+}
+
 void TabletImpl::SQLBatchRequestQuery(RpcController* ctrl, const openmldb::api::SQLBatchRequestQueryRequest* request,
                                       openmldb::api::SQLBatchRequestQueryResponse* response, Closure* done) {
     DLOG(INFO) << "handle query batch request begin!";
@@ -3710,17 +3822,36 @@ std::shared_ptr<Table> TabletImpl::GetTableUnLock(uint32_t tid, uint32_t pid) {
 void TabletImpl::ShowMemPool(RpcController* controller, const ::openmldb::api::HttpRequest* request,
                              ::openmldb::api::HttpResponse* response, Closure* done) {
     brpc::ClosureGuard done_guard(done);
-#ifdef TCMALLOC_ENABLE
     brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    cntl->response_attachment().append("<html><head><title>Mem Stat</title></head><body><pre>");
+#ifdef TCMALLOC_ENABLE
     MallocExtension* tcmalloc = MallocExtension::instance();
     std::string stat;
     stat.resize(1024);
     char* buffer = reinterpret_cast<char*>(&(stat[0]));
     tcmalloc->GetStats(buffer, 1024);
-    cntl->response_attachment().append("<html><head><title>Mem Stat</title></head><body><pre>");
-    cntl->response_attachment().append(stat);
-    cntl->response_attachment().append("</pre></body></html>");
+    cntl->response_attachment().append(stat.c_str());
 #endif
+    auto jit_stats = ::hybridse::vm::Engine::GetJitMemoryStats();
+    std::ostringstream oss;
+    oss << "\n------------------------------------------------\n"
+        << "JIT: " << jit_stats.code_bytes << " code bytes, " << jit_stats.data_bytes << " data bytes, "
+        << jit_stats.object_cnt << " objects\n"
+        << "JIT runtime: " << ::hybridse::vm::Engine::GetRunStepPeakBytes() << " peak bytes of a run step\n";
+    std::vector<std::pair<std::string, ::hybridse::vm::JitMemoryStats>> sp_stats;
+    sp_cache_->GetJitMemoryStats(&sp_stats);
+    for (const auto& kv : sp_stats) {
+        oss << "  procedure " << kv.first << ": " << kv.second.code_bytes << " code bytes, "
+            << kv.second.data_bytes << " data bytes, " << kv.second.object_cnt << " objects\n";
+    }
+    auto cache_stats = sp_result_cache_.GetStats();
+    uint64_t lookup_cnt = cache_stats.hit_cnt + cache_stats.miss_cnt;
+    oss << "Procedure result cache: " << cache_stats.entry_cnt << " entries, " << cache_stats.byte_size << " bytes, "
+        << cache_stats.hit_cnt << " hits, " << cache_stats.miss_cnt << " misses, " << cache_stats.invalidate_cnt
+        << " invalidated, " << cache_stats.evict_cnt << " evicted, hit rate "
+        << (lookup_cnt > 0 ? static_cast<double>(cache_stats.hit_cnt) / lookup_cnt : 0.0) << "\n";
+    cntl->response_attachment().append(oss.str());
+    cntl->response_attachment().append("</pre></body></html>");
 }
 
 void TabletImpl::CheckZkClient() {
@@ -3838,6 +3969,7 @@ void TabletImpl::RefreshTableInfo() {
     auto old_db_sp_map = catalog_->GetProcedures();
     catalog_->Refresh(table_info_vec, version, db_sp_map);
     // skip exist procedure, don`t need recompile
+    std::vector<std::shared_ptr<hybridse::sdk::ProcedureInfo>> new_sp_infos;
     for (const auto& db_sp_map_kv : db_sp_map) {
         const auto& db = db_sp_map_kv.first;
         auto old_db_sp_map_it = old_db_sp_map.find(db);
@@ -3849,15 +3981,53 @@ void TabletImpl::RefreshTableInfo() {
                 if (old_sp_map_it != old_sp_map.end()) {
                     continue;
                 } else {
-                    CreateProcedure(sp_map_kv.second);
+                    new_sp_infos.push_back(sp_map_kv.second);
                 }
             }
         } else {
             for (const auto& sp_map_kv : db_sp_map_kv.second) {
-                CreateProcedure(sp_map_kv.second);
+                new_sp_infos.push_back(sp_map_kv.second);
             }
         }
     }
+    CreateProcedures(new_sp_infos);
+}
+
+void TabletImpl::CreateProcedures(const std::vector<std::shared_ptr<hybridse::sdk::ProcedureInfo>>& sp_infos) {
+    if (sp_infos.empty()) {
+        return;
+    }
+    if (sp_infos.size() == 1 || FLAGS_procedure_compile_pool_size <= 1) {
+        for (const auto& sp_info : sp_infos) {
+            CreateProcedure(sp_info);
+        }
+        return;
+    }
+    // every compiling has its own llvm context, procedures are compiled
+    // concurrently and all of them are ready once this returns. The pool and
+    // this thread claim procedures one by one, so procedures whose tasks never
+    // run, e.g. the pool is stopped, are compiled here, and the wait only
+    // covers compilings already started
+    uint64_t start = ::baidu::common::timer::get_micros();
+    auto infos = std::make_shared<std::vector<std::shared_ptr<hybridse::sdk::ProcedureInfo>>>(sp_infos);
+    auto claimed = std::make_shared<std::vector<std::atomic<bool>>>(sp_infos.size());
+    auto latch = std::make_shared<::openmldb::base::CountDownLatch>(sp_infos.size());
+    auto compile = [this, infos, claimed, latch](size_t idx) {
+        if (!(*claimed)[idx].exchange(true)) {
+            CreateProcedure((*infos)[idx]);
+            latch->CountDown();
+        }
+    };
+    for (size_t idx = 0; idx < sp_infos.size(); idx++) {
+        sp_compile_pool_.AddTask([compile, idx]() { compile(idx); });
+    }
+    // from the back, the pool takes tasks from the front
+    for (size_t idx = sp_infos.size(); idx > 0; idx--) {
+        compile(idx - 1);
+    }
+    latch->Wait();
+    PDLOG(INFO, "compile %u procedures in %lu us", static_cast<uint32_t>(sp_infos.size()),
+          ::baidu::common::timer::get_micros() - start);
 }
 
 int TabletImpl::CheckDimessionPut(const ::openmldb::api::PutRequest* request, uint32_t idx_cnt) {
@@ -3945,6 +4115,14 @@ void TabletImpl::DelRecycle(const std::string& path) {
     }
 }
 
+void TabletImpl::SchedExpireQueryCursor() {
+    uint32_t cnt = query_cursor_mgr_.Expire(::baidu::common::timer::get_micros() / 1000);
+    if (cnt > 0) {
+        PDLOG(INFO, "drop %u expired query cursors", cnt);
+    }
+    task_pool_.DelayTask(FLAGS_query_cursor_expire_ms, boost::bind(&TabletImpl::SchedExpireQueryCursor, this));
+}
+
 void TabletImpl::SchedDelRecycle() {
     for (auto path : mode_recycle_root_paths_) {
         DelRecycle(path);
@@ -4694,6 +4872,7 @@ void TabletImpl::CreateProcedure(RpcController* controller, const openmldb::api:
 
     sp_cache_->InsertSQLProcedureCacheEntry(db_name, sp_name, sp_info_impl, session.GetCompileInfo(),
                                             batch_session.GetCompileInfo());
+    sp_result_cache_.Drop(db_name, sp_name);
 
     response->set_code(::openmldb::base::ReturnCode::kOk);
     response->set_msg("ok");
@@ -4706,6 +4885,7 @@ void TabletImpl::DropProcedure(RpcController* controller, const ::openmldb::api:
     const std::string& db_name = request->db_name();
     const std::string& sp_name = request->sp_name();
     sp_cache_->DropSQLProcedureCacheEntry(db_name, sp_name);
+    sp_result_cache_.Drop(db_name, sp_name);
     if (!catalog_->DropProcedure(db_name, sp_name)) {
         LOG(WARNING) << "drop procedure" << db_name << "." << sp_name << " in catalog failed";
     }
@@ -4759,6 +4939,32 @@ void TabletImpl::RunRequestQuery(RpcController* ctrl, const openmldb::api::Query
     response.set_code(::openmldb::base::kOk);
 }
 
+void TabletImpl::RunCachedRequestQuery(RpcController* ctrl, const openmldb::api::QueryRequest& request,
+                                       ::hybridse::vm::RequestRunSession& session,
+                                       openmldb::api::QueryResponse& response, butil::IOBuf& buf) {
+    std::string row;
+    dynamic_cast<brpc::Controller*>(ctrl)->request_attachment().copy_to(&row, request.row_size(), 0);
+    uint64_t now = ::baidu::common::timer::get_micros() / 1000;
+    butil::IOBuf output;
+    if (sp_result_cache_.Get(request.db(), request.sp_name(), row, now, &output)) {
+        response.set_schema(session.GetEncodedSchema());
+        response.set_byte_size(output.size());
+        response.set_count(1);
+        response.set_row_slices(1);
+        response.set_code(::openmldb::base::kOk);
+        buf.append(output);
+        return;
+    }
+    auto key_read_filter = std::make_shared<::openmldb::catalog::KeyReadFilter>();
+    session.SetScanFilter(key_read_filter);
+    RunRequestQuery(ctrl, request, session, response, buf);
+    session.SetScanFilter(std::shared_ptr<::hybridse::vm::ScanFilter>());
+    const auto& recorder = key_read_filter->GetRecorder();
+    if (response.code() == ::openmldb::base::kOk && recorder.IsTracked()) {
+        sp_result_cache_.Put(request.db(), request.sp_name(), row, buf, recorder.GetVersions(), now);
+    }
+}
+
 void TabletImpl::CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info) {
     const std::string& db_name = sp_info->GetDbName();
     const std::string& sp_name = sp_info->GetSpName();
@@ -4786,6 +4992,7 @@ void TabletImpl::CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureI
     }
     sp_cache_->InsertSQLProcedureCacheEntry(db_name, sp_name, sp_info, session.GetCompileInfo(),
                                             batch_session.GetCompileInfo());
+    sp_result_cache_.Drop(db_name, sp_name);
     LOG(INFO) << "refresh procedure success! sp_name: " << sp_name << ", db: " << db_name << ", sql: " << sql;
 }
 
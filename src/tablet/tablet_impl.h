@@ -40,6 +40,8 @@
 #include "tablet/bulk_load_mgr.h"
 #include "tablet/combine_iterator.h"
 #include "tablet/file_receiver.h"
+#include "tablet/procedure_result_cache.h"
+#include "tablet/query_cursor.h"
 #include "vm/engine.h"
 #include "zk/zk_client.h"
 
@@ -147,6 +149,26 @@ class SpCache : public hybridse::vm::CompileInfoCache {
         return sp_it->second.batch_request_info;
     }
 
+    // jit memory of each procedure, named as db.sp_name
+    void GetJitMemoryStats(std::vector<std::pair<std::string, hybridse::vm::JitMemoryStats>>* stats) {
+        std::lock_guard<SpinMutex> spin_lock(spin_mutex_);
+        for (const auto& db_kv : db_sp_map_) {
+            for (const auto& sp_kv : db_kv.second) {
+                hybridse::vm::JitMemoryStats sp_stats;
+                for (const auto& info : {sp_kv.second.request_info, sp_kv.second.batch_request_info}) {
+                    if (!info) {
+                        continue;
+                    }
+                    auto info_stats = info->GetJitMemoryStats();
+                    sp_stats.code_bytes += info_stats.code_bytes;
+                    sp_stats.data_bytes += info_stats.data_bytes;
+                    sp_stats.object_cnt += info_stats.object_cnt;
+                }
+                stats->emplace_back(db_kv.first + "." + sp_kv.first, sp_stats);
+            }
+        }
+    }
+
  private:
     std::map<std::string, std::map<std::string, SQLProcedureCacheEntry>> db_sp_map_;
     SpinMutex spin_mutex_;
@@ -302,6 +324,9 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void SubQuery(RpcController* controller, const openmldb::api::QueryRequest* request,
                   openmldb::api::QueryResponse* response, Closure* done);
 
+    void FetchQuery(RpcController* controller, const openmldb::api::FetchQueryRequest* request,
+                    openmldb::api::QueryResponse* response, Closure* done);
+
     void SQLBatchRequestQuery(RpcController* controller, const openmldb::api::SQLBatchRequestQueryRequest* request,
                               openmldb::api::SQLBatchRequestQueryResponse* response, Closure* done);
     void SubBatchRequestQuery(RpcController* controller, const openmldb::api::SQLBatchRequestQueryRequest* request,
@@ -458,6 +483,8 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     void SchedDelRecycle();
 
+    void SchedExpireQueryCursor();
+
     bool GetRealEp(uint64_t tid, uint64_t pid, std::map<std::string, std::string>* real_ep_map);
 
     void ProcessQuery(RpcController* controller, const openmldb::api::QueryRequest* request,
@@ -471,8 +498,17 @@ class TabletImpl : public ::openmldb::api::TabletServer {
                          ::hybridse::vm::RequestRunSession& session,                  // NOLINT
                          openmldb::api::QueryResponse& response, butil::IOBuf& buf);  // NOLINT
 
+    // serve the call of a procedure from sp_result_cache_ if the output is
+    // still valid, otherwise run it and cache the output
+    void RunCachedRequestQuery(RpcController* controller, const openmldb::api::QueryRequest& request,
+                               ::hybridse::vm::RequestRunSession& session,                  // NOLINT
+                               openmldb::api::QueryResponse& response, butil::IOBuf& buf);  // NOLINT
+
     void CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureInfo>& sp_info);
 
+    // compile procedures on sp_compile_pool_ and wait for all of them
+    void CreateProcedures(const std::vector<std::shared_ptr<hybridse::sdk::ProcedureInfo>>& sp_infos);
+
     Tables tables_;
     std::mutex mu_;
     SpinMutex spin_mutex_;
@@ -484,10 +520,12 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     ThreadPool task_pool_;
     ThreadPool io_pool_;
     ThreadPool snapshot_pool_;
+    ThreadPool sp_compile_pool_;
     std::map<uint64_t, std::list<std::shared_ptr<::openmldb::api::TaskInfo>>> task_map_;
     std::set<std::string> sync_snapshot_set_;
     std::map<std::string, std::shared_ptr<FileReceiver>> file_receiver_map_;
     BulkLoadMgr bulk_load_mgr_;
+    QueryCursorManager query_cursor_mgr_;
     brpc::Server* server_;  // TODO(hw): need?
     std::vector<std::string> mode_root_paths_;
     std::vector<std::string> mode_recycle_root_paths_;
@@ -502,6 +540,7 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     std::string zk_path_;
     std::string endpoint_;
     std::shared_ptr<SpCache> sp_cache_;
+    ProcedureResultCache sp_result_cache_;
     std::string notify_path_;
     std::string sp_root_path_;
 };